@@ -238,7 +238,14 @@ void application::exec() {
      sigpipe_set->cancel();
    });
 
-   io_serv->run();
+   // handlers posted with a priority are moved into pri_queue as the io_service dispatches them, run the
+   // highest of those after each poll so that newly ready high priority work overtakes queued low priority work
+   bool more = true;
+   while( !io_serv->stopped() && (more || io_serv->run_one()) ) {
+      while( io_serv->poll_one() ) {}
+      more = pri_queue.execute_highest();
+   }
+   pri_queue.clear();
 
    shutdown(); /// perform synchronous shutdown
 }
@@ -0,0 +1,200 @@
+/**
+ * Exercises channel::subscribe_async: each backpressure policy, delivery order, draining on unsubscribe and
+ * concurrent stops of a dispatcher. Exits with a non-zero status if any check fails.
+ */
+#include <appbase/application.hpp>
+#include <appbase/channel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace appbase;
+
+namespace {
+
+struct async_example_tag {};
+using example_channel = channel_decl<async_example_tag, int>;
+
+int failures = 0;
+
+void check( bool ok, const std::string& what ) {
+   std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+   if( !ok )
+      ++failures;
+}
+
+/// holds the subscriber in its callback until opened, so the queue fills up behind it
+class gate {
+   public:
+      void wait() {
+         std::unique_lock<std::mutex> lock( _mtx );
+         _entered = true;
+         _cv.notify_all();
+         _cv.wait( lock, [this]() { return _open; } );
+      }
+
+      void wait_entered() {
+         std::unique_lock<std::mutex> lock( _mtx );
+         _cv.wait( lock, [this]() { return _entered; } );
+      }
+
+      void open() {
+         std::lock_guard<std::mutex> g( _mtx );
+         _open = true;
+         _cv.notify_all();
+      }
+
+   private:
+      std::mutex              _mtx;
+      std::condition_variable _cv;
+      bool                    _entered = false;
+      bool                    _open = false;
+};
+
+void run_channel() {
+   app().get_io_service().poll();
+   app().get_io_service().restart();
+}
+
+/// publishes 0 while the subscriber is let through, then 1..9 while it is held in its callback for 0
+std::vector<int> publish_behind_gate( backpressure policy, async_dispatch_stats& stats ) {
+   auto& chan = app().get_channel<example_channel>();
+   gate g;
+   std::mutex received_mtx;
+   std::vector<int> received;
+   auto h = chan.subscribe_async( [&]( int v ) {
+      if( v == 0 )
+         g.wait();
+      std::lock_guard<std::mutex> lock( received_mtx );
+      received.push_back( v );
+   }, async_dispatch_options{ 3, policy } );
+
+   chan.publish( 0 );
+   run_channel();
+   g.wait_entered();
+
+   for( int i = 1; i < 10; ++i )
+      chan.publish( i );
+   if( policy == backpressure::block ) {
+      // the blocked publisher holds the thread running the channel, so the gate is opened from this one
+      std::thread publisher( [&]() { run_channel(); } );
+      while( h.stats().blocked == 0 )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      g.open();
+      publisher.join();
+   } else {
+      run_channel();
+      g.open();
+   }
+
+   h.unsubscribe();
+   stats = h.stats();
+   return received;
+}
+
+void test_backpressure() {
+   async_dispatch_stats stats;
+
+   auto received = publish_behind_gate( backpressure::block, stats );
+   check( received == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }, "block delivers everything in order" );
+   check( stats.blocked > 0 && stats.dropped == 0 && stats.coalesced == 0, "block waits instead of discarding" );
+   check( stats.max_depth == 3 && stats.dispatched == 10, "block never queues more than max_queue_size" );
+
+   received = publish_behind_gate( backpressure::drop, stats );
+   check( received == std::vector<int>{ 0, 1, 2, 3 }, "drop discards what arrives at a full queue" );
+   check( stats.dropped == 6 && stats.blocked == 0 && stats.coalesced == 0, "drop counts the discarded data" );
+
+   received = publish_behind_gate( backpressure::coalesce, stats );
+   check( received == std::vector<int>{ 0, 1, 2, 9 }, "coalesce replaces the newest queued item" );
+   check( stats.coalesced == 6 && stats.blocked == 0 && stats.dropped == 0, "coalesce counts the replaced data" );
+}
+
+void test_drain_on_unsubscribe() {
+   auto& chan = app().get_channel<example_channel>();
+   std::atomic<int> received{0};
+   std::atomic<bool> in_order{true};
+   auto h = chan.subscribe_async( [&]( int v ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+      if( v != received )
+         in_order = false;
+      ++received;
+   }, async_dispatch_options{ 100, backpressure::block } );
+
+   for( int i = 0; i < 20; ++i )
+      chan.publish( i );
+   run_channel();
+   h.unsubscribe();
+   check( received == 20 && in_order, "unsubscribe delivers what is still queued" );
+   check( h.stats().depth == 0 && h.stats().dispatched == 20, "nothing is left queued after unsubscribe" );
+
+   chan.publish( 20 );
+   run_channel();
+   check( received == 20, "nothing is delivered after unsubscribe" );
+
+   // the callback's exceptions do not stop delivery
+   std::atomic<int> delivered{0};
+   auto thrower = chan.subscribe_async( [&]( int v ) {
+      ++delivered;
+      if( v == 0 )
+         throw std::runtime_error( "dropped" );
+   } );
+   chan.publish( 0 );
+   chan.publish( 1 );
+   run_channel();
+   thrower.unsubscribe();
+   check( delivered == 2, "exceptions thrown by the callback are dropped" );
+}
+
+void test_concurrent_stop() {
+   std::atomic<int> received{0};
+   async_dispatcher<int> dispatcher( [&]( const int& ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      ++received;
+   }, async_dispatch_options{ 100, backpressure::block } );
+   for( int i = 0; i < 50; ++i )
+      dispatcher.push( i );
+
+   std::vector<std::thread> stoppers;
+   std::atomic<int> drained_on_return{0};
+   for( int i = 0; i < 4; ++i ) {
+      stoppers.emplace_back( [&]() {
+         dispatcher.stop();
+         if( received == 50 )
+            ++drained_on_return;
+      } );
+   }
+   for( auto& t : stoppers )
+      t.join();
+   check( drained_on_return == 4, "concurrent stops all return once the queue is drained" );
+   check( !dispatcher.push( 50 ), "a stopped dispatcher discards data" );
+   dispatcher.stop();
+}
+
+void test_policy_option_parsing() {
+   backpressure policy = backpressure::block;
+   std::istringstream drop( "Drop" );
+   drop >> policy;
+   check( !drop.fail() && policy == backpressure::drop, "backpressure parses case-insensitively" );
+   std::istringstream bad( "never" );
+   bad >> policy;
+   check( bad.fail(), "an unknown backpressure policy fails to parse" );
+   std::ostringstream out;
+   out << backpressure::coalesce;
+   check( out.str() == "coalesce", "backpressure prints its option value" );
+}
+
+}
+
+int main() {
+   test_backpressure();
+   test_drain_on_unsubscribe();
+   test_concurrent_stop();
+   test_policy_option_parsing();
+   return failures ? 1 : 0;
+}
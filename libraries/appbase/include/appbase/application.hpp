@@ -2,6 +2,7 @@
 #include <appbase/plugin.hpp>
 #include <appbase/channel.hpp>
 #include <appbase/method.hpp>
+#include <appbase/execution_priority_queue.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/core/demangle.hpp>
 #include <typeindex>
@@ -151,6 +152,26 @@ namespace appbase {
          }
 
          boost::asio::io_service& get_io_service() { return *io_serv; }
+
+         /**
+          * Post func to run on the application thread ahead of any waiting work of lower priority, work of
+          * equal priority runs in the order it was posted
+          *
+          * @param priority - see @ref appbase::priority
+          * @param func - the handler, invoked with no arguments
+          */
+         template <typename Func>
+         auto post( int priority, Func&& func ) {
+            return boost::asio::post(*io_serv, pri_queue.wrap(priority, std::forward<Func>(func)));
+         }
+
+         /**
+          * Handlers for asynchronous operations on the application io_service, such as timer waits, can be
+          * given a priority with get_priority_queue().wrap(priority, handler)
+          */
+         execution_priority_queue& get_priority_queue() {
+            return pri_queue;
+         }
       protected:
          template<typename Impl>
          friend class plugin;
@@ -175,6 +196,7 @@ namespace appbase {
          map<std::type_index, erased_channel_ptr>  channels;
 
          std::shared_ptr<boost::asio::io_service>  io_serv;
+         execution_priority_queue                  pri_queue;
 
          void set_program_options();
          void write_default_config(const bfs::path& cfg_file);
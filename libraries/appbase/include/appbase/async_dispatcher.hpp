@@ -0,0 +1,185 @@
+#pragma once
+#include <boost/algorithm/string.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace appbase {
+
+   /**
+    * What an asynchronous subscriber does with data published while its queue is full
+    */
+   enum class backpressure {
+      block,    ///< the publisher waits until the subscriber has taken an item
+      drop,     ///< the new data is discarded
+      coalesce  ///< the new data replaces the most recently queued item
+   };
+
+   inline std::istream& operator>>( std::istream& in, backpressure& policy ) {
+      std::string s;
+      in >> s;
+      boost::algorithm::to_lower( s );
+      if( s == "block" )
+         policy = backpressure::block;
+      else if( s == "drop" )
+         policy = backpressure::drop;
+      else if( s == "coalesce" )
+         policy = backpressure::coalesce;
+      else
+         in.setstate( std::ios_base::failbit );
+      return in;
+   }
+
+   inline std::ostream& operator<<( std::ostream& out, backpressure policy ) {
+      switch( policy ) {
+         case backpressure::block:    return out << "block";
+         case backpressure::drop:     return out << "drop";
+         case backpressure::coalesce: return out << "coalesce";
+      }
+      return out;
+   }
+
+   struct async_dispatch_options {
+      size_t       max_queue_size = 1024;
+      backpressure policy = backpressure::block;
+   };
+
+   /**
+    * Counters of an asynchronous subscriber, sampled under its lock
+    */
+   struct async_dispatch_stats {
+      size_t   depth = 0;       ///< items waiting now
+      size_t   max_depth = 0;   ///< most items ever waiting at once
+      uint64_t dispatched = 0;  ///< items passed to the subscriber
+      uint64_t dropped = 0;     ///< items discarded by backpressure::drop
+      uint64_t coalesced = 0;   ///< queued items replaced by backpressure::coalesce
+      uint64_t blocked = 0;     ///< publishes that waited under backpressure::block
+   };
+
+   /**
+    * Delivers data to a callback on a thread of its own, so that a slow subscriber does not hold up the
+    * publisher for longer than it takes to queue the data.
+    *
+    * Data is delivered in the order it was pushed, less any discarded by the backpressure policy. Exceptions
+    * thrown by the callback are dropped, as with @ref drop_exceptions. Data still queued when the dispatcher is
+    * stopped is delivered before stop() returns, so it must not be stopped from within the callback.
+    *
+    * @tparam Data - the type of data to deliver, it is *copied* into the queue
+    */
+   template<typename Data>
+   class async_dispatcher {
+      public:
+         using callback_type = std::function<void(const Data&)>;
+
+         async_dispatcher( callback_type cb, const async_dispatch_options& options )
+         :_callback( std::move(cb) )
+         ,_options( options )
+         {
+            if( _options.max_queue_size == 0 )
+               _options.max_queue_size = 1;
+            _thread = std::thread( [this]() { run(); } );
+         }
+
+         ~async_dispatcher() {
+            stop();
+         }
+
+         async_dispatcher( const async_dispatcher& ) = delete;
+         async_dispatcher& operator=( const async_dispatcher& ) = delete;
+
+         /**
+          * Queue data for the subscriber, applying the backpressure policy when the queue is full
+          * @return false if the data was discarded
+          */
+         bool push( const Data& data ) {
+            std::unique_lock<std::mutex> lock( _mtx );
+            if( _stopping )
+               return false;
+            if( _queue.size() >= _options.max_queue_size ) {
+               switch( _options.policy ) {
+                  case backpressure::block:
+                     ++_stats.blocked;
+                     _space_available.wait( lock, [this]() { return _queue.size() < _options.max_queue_size || _stopping; } );
+                     if( _stopping )
+                        return false;
+                     break;
+                  case backpressure::drop:
+                     ++_stats.dropped;
+                     return false;
+                  case backpressure::coalesce:
+                     ++_stats.coalesced;
+                     _queue.back() = data;
+                     return true;
+               }
+            }
+            _queue.push_back( data );
+            if( _queue.size() > _stats.max_depth )
+               _stats.max_depth = _queue.size();
+            lock.unlock();
+            _data_available.notify_one();
+            return true;
+         }
+
+         /**
+          * Deliver whatever is queued, then end the dispatch thread; publishers blocked on a full queue give up
+          */
+         void stop() {
+            {
+               std::lock_guard<std::mutex> g( _mtx );
+               _stopping = true;
+            }
+            _data_available.notify_all();
+            _space_available.notify_all();
+            // one caller joins; concurrent callers wait for it to finish
+            std::call_once( _joined, [this]() { _thread.join(); } );
+         }
+
+         async_dispatch_stats stats() const {
+            std::lock_guard<std::mutex> g( _mtx );
+            async_dispatch_stats s = _stats;
+            s.depth = _queue.size();
+            return s;
+         }
+
+         const async_dispatch_options& options() const { return _options; }
+
+      private:
+         void run() {
+            std::unique_lock<std::mutex> lock( _mtx );
+            while( true ) {
+               _data_available.wait( lock, [this]() { return !_queue.empty() || _stopping; } );
+               if( _queue.empty() )
+                  break;
+               Data data = std::move( _queue.front() );
+               _queue.pop_front();
+               ++_stats.dispatched;
+               lock.unlock();
+               _space_available.notify_one();
+               try {
+                  _callback( data );
+               } catch (...) {
+                  // drop
+               }
+               lock.lock();
+            }
+         }
+
+         callback_type            _callback;
+         async_dispatch_options   _options;
+         mutable std::mutex       _mtx;
+         std::condition_variable  _data_available;
+         std::condition_variable  _space_available;
+         std::deque<Data>         _queue;
+         async_dispatch_stats     _stats;
+         bool                     _stopping = false;
+         std::once_flag           _joined;
+         std::thread              _thread;
+   };
+
+}
@@ -8,6 +8,10 @@
 #include <boost/signals2.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 
+#include <appbase/async_dispatcher.hpp>
+
+#include <memory>
+
 namespace appbase {
 
    using erased_channel_ptr = std::unique_ptr<void, void(*)(void*)>;
@@ -66,6 +70,16 @@ namespace appbase {
                   if (_handle.connected()) {
                      _handle.disconnect();
                   }
+                  if (_dispatcher) {
+                     _dispatcher->stop();
+                  }
+               }
+
+               /**
+                * Queue statistics of a subscription made with subscribe_async, all zero for a synchronous one
+                */
+               async_dispatch_stats stats() const {
+                  return _dispatcher ? _dispatcher->stats() : async_dispatch_stats();
                }
 
                // This handle can be constructed and moved
@@ -79,16 +93,20 @@ namespace appbase {
 
             private:
                using handle_type = boost::signals2::connection;
-               handle_type _handle;
+               using dispatcher_ptr = std::shared_ptr<async_dispatcher<Data>>;
+               handle_type    _handle;
+               dispatcher_ptr _dispatcher;
 
                /**
                 * Construct a handle from an internal represenation of a handle
                 * In this case a boost::signals2::connection
                 *
                 * @param _handle - the boost::signals2::connection to wrap
+                * @param _dispatcher - the queue feeding an asynchronous subscriber, if any
                 */
-               handle(handle_type&& _handle)
+               handle(handle_type&& _handle, dispatcher_ptr _dispatcher = dispatcher_ptr())
                :_handle(std::move(_handle))
+               ,_dispatcher(std::move(_dispatcher))
                {}
 
                friend class channel;
@@ -118,6 +136,30 @@ namespace appbase {
             return handle(_signal.connect(cb));
          }
 
+         /**
+          * subscribe to data on a channel, with the callback run on a thread of its own
+          *
+          * Published data is queued for the subscriber, up to options.max_queue_size items, and delivered in
+          * order; when the queue is full options.policy decides whether the publishing thread waits, the data is
+          * dropped or it replaces the newest queued item. The callback must be safe to call off the application
+          * thread. Unsubscribing delivers whatever is still queued.
+          *
+          * @tparam Callback the type of the callback (functor|lambda)
+          * @param cb the callback
+          * @param options queue size and backpressure policy
+          * @return handle to the subscription, see handle::stats
+          */
+         template<typename Callback>
+         handle subscribe_async(Callback cb, const async_dispatch_options& options = async_dispatch_options()) {
+            auto dispatcher = std::make_shared<async_dispatcher<Data>>(std::move(cb), options);
+            std::weak_ptr<async_dispatcher<Data>> weak_dispatcher = dispatcher;
+            return handle(_signal.connect([weak_dispatcher](const Data& data) {
+               if (auto d = weak_dispatcher.lock()) {
+                  d->push(data);
+               }
+            }), std::move(dispatcher));
+         }
+
          /**
           * set the dispatcher according to the DispatchPolicy
           * this can be used to set a stateful dispatcher
@@ -0,0 +1,172 @@
+#pragma once
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace appbase {
+
+/**
+ * Relative priority of work run on the application thread, higher runs first
+ */
+struct priority {
+   static constexpr int highest = std::numeric_limits<int>::max();
+   static constexpr int high    = 75;
+   static constexpr int medium  = 50;
+   static constexpr int low     = 25;
+   static constexpr int lowest  = std::numeric_limits<int>::min();
+};
+
+/**
+ * Handlers waiting to run on the application thread, ordered by priority and then by arrival.
+ *
+ * Handlers reach the queue through the io_service: a handler bound to one of its executors, see @ref wrap,
+ * is added to the queue when the io_service would have invoked it, and application::exec() then runs the
+ * queued handlers one at a time, highest priority first, in between polling the io_service.
+ */
+class execution_priority_queue : public boost::asio::execution_context
+{
+   public:
+
+      template <typename Function>
+      void add(int priority, Function function)
+      {
+         handlers.emplace_back(std::make_unique<queued_handler<Function>>(priority, --order, std::move(function)));
+         std::push_heap( handlers.begin(), handlers.end(), &queued_handler_base::less );
+      }
+
+      /**
+       * Run the highest priority handler, if any
+       * @return true if handlers remain queued
+       */
+      bool execute_highest()
+      {
+         if( !handlers.empty() ) {
+            // removed before running so that a handler which throws is not run again
+            std::pop_heap( handlers.begin(), handlers.end(), &queued_handler_base::less );
+            auto handler = std::move( handlers.back() );
+            handlers.pop_back();
+            handler->execute();
+         }
+         return !handlers.empty();
+      }
+
+      void clear()
+      {
+         handlers.clear();
+      }
+
+      size_t size() const { return handlers.size(); }
+
+      class executor
+      {
+         public:
+            executor(execution_priority_queue& q, int p)
+            : context_(q), priority_(p)
+            {
+            }
+
+            execution_priority_queue& context() const noexcept
+            {
+               return context_;
+            }
+
+            template <typename Function, typename Allocator>
+            void dispatch(Function f, const Allocator&) const
+            {
+               context_.add(priority_, std::move(f));
+            }
+
+            template <typename Function, typename Allocator>
+            void post(Function f, const Allocator&) const
+            {
+               context_.add(priority_, std::move(f));
+            }
+
+            template <typename Function, typename Allocator>
+            void defer(Function f, const Allocator&) const
+            {
+               context_.add(priority_, std::move(f));
+            }
+
+            void on_work_started() const noexcept {}
+            void on_work_finished() const noexcept {}
+
+            bool operator==(const executor& other) const noexcept
+            {
+               return &context_ == &other.context_ && priority_ == other.priority_;
+            }
+
+            bool operator!=(const executor& other) const noexcept
+            {
+               return !operator==(other);
+            }
+
+         private:
+            execution_priority_queue& context_;
+            int priority_;
+      };
+
+      /**
+       * Bind a handler to this queue, when the io_service invokes the returned handler the original handler
+       * is queued at the given priority instead of running right away
+       */
+      template <typename Function>
+      boost::asio::executor_binder<typename std::decay<Function>::type, executor>
+      wrap(int priority, Function&& func)
+      {
+         return boost::asio::bind_executor( executor(*this, priority), std::forward<Function>(func) );
+      }
+
+   private:
+
+      class queued_handler_base
+      {
+         public:
+            queued_handler_base(int p, size_t order)
+            : priority_(p), order_(order)
+            {
+            }
+
+            virtual ~queued_handler_base() = default;
+
+            virtual void execute() = 0;
+
+            /// heap order: higher priority first, then arrival order
+            static bool less(const std::unique_ptr<queued_handler_base>& a,
+                             const std::unique_ptr<queued_handler_base>& b) noexcept
+            {
+               return std::tie( a->priority_, a->order_ ) < std::tie( b->priority_, b->order_ );
+            }
+
+         private:
+            int    priority_;
+            size_t order_;
+      };
+
+      template <typename Function>
+      class queued_handler : public queued_handler_base
+      {
+         public:
+            queued_handler(int p, size_t order, Function f)
+            : queued_handler_base(p, order), function_(std::move(f))
+            {
+            }
+
+            void execute() override
+            {
+               function_();
+            }
+
+         private:
+            Function function_;
+      };
+
+      std::vector<std::unique_ptr<queued_handler_base>> handlers; ///< heap, see queued_handler_base::less
+      std::size_t order = std::numeric_limits<size_t>::max(); ///< counts down so that earlier handlers sort higher
+};
+
+} // appbase
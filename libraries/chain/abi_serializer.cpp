@@ -55,9 +55,112 @@ namespace dccio { namespace chain {
       set_abi(abi, max_serialization_time);
    }
 
+   abi_serializer::abi_serializer( const abi_serializer& other )
+   :typedefs(other.typedefs)
+   ,structs(other.structs)
+   ,actions(other.actions)
+   ,tables(other.tables)
+   ,error_messages(other.error_messages)
+   ,variants(other.variants)
+   ,built_in_types(other.built_in_types)
+   {
+      // plans hold iterators into the maps of the serializer they were compiled for
+      compile_plans();
+   }
+
+   abi_serializer& abi_serializer::operator=( const abi_serializer& other ) {
+      if( this != &other ) {
+         typedefs       = other.typedefs;
+         structs        = other.structs;
+         actions        = other.actions;
+         tables         = other.tables;
+         error_messages = other.error_messages;
+         variants       = other.variants;
+         built_in_types = other.built_in_types;
+         compile_plans();
+      }
+      return *this;
+   }
+
    void abi_serializer::add_specialized_unpack_pack( const string& name,
                                                      std::pair<abi_serializer::unpack_function, abi_serializer::pack_function> unpack_pack ) {
       built_in_types[name] = std::move( unpack_pack );
+      compile_plans();
+   }
+
+   void abi_serializer::compile_plans() {
+      plans.clear();
+      plan_ids.clear();
+      for( const auto& t : typedefs )
+         compile_plan( t.first );
+      for( const auto& s : structs )
+         compile_plan( s.first );
+      for( const auto& v : variants )
+         compile_plan( v.first );
+      for( const auto& a : actions )
+         compile_plan( a.second );
+      for( const auto& t : tables )
+         compile_plan( t.second );
+   }
+
+   uint32_t abi_serializer::compile_plan( const type_name& type ) {
+      auto itr = plan_ids.find( type );
+      if( itr != plan_ids.end() )
+         return itr->second;
+
+      // reserve the id first so recursive types refer back to it; plans may reallocate while recursing
+      const uint32_t id = plans.size();
+      plan_ids.emplace( type, id );
+      plans.emplace_back();
+
+      type_plan plan;
+      plan.name = type;
+      plan.resolved = resolve_type( type );
+      auto ftype = fundamental_type( plan.resolved );
+      auto btype = built_in_types.find( ftype );
+      if( btype != built_in_types.end() ) {
+         plan.kind = type_plan::built_in;
+         plan.built_in_functions = &btype->second;
+         plan.built_in_array = is_array( plan.resolved );
+         plan.built_in_optional = is_optional( plan.resolved );
+      } else if( is_array( plan.resolved ) ) {
+         plan.kind = type_plan::array;
+         plan.element = compile_plan( ftype );
+      } else if( is_optional( plan.resolved ) ) {
+         plan.kind = type_plan::optional;
+         plan.element = compile_plan( ftype );
+      } else if( (plan.variant_itr = variants.find( plan.resolved )) != variants.end() ) {
+         plan.kind = type_plan::variant;
+         for( const auto& t : plan.variant_itr->second.types )
+            plan.variant_types.push_back( compile_plan( t ) );
+      } else if( (plan.struct_itr = structs.find( plan.resolved )) != structs.end() ) {
+         plan.kind = type_plan::structure;
+         const auto& st = plan.struct_itr->second;
+         if( st.base != type_name() )
+            plan.base = compile_plan( resolve_type( st.base ) );
+         for( const auto& field : st.fields ) {
+            bool extension = ends_with( field.type, "$" );
+            plan.fields.push_back( type_plan::field_plan{ compile_plan( _remove_bin_extension( field.type ) ), extension } );
+         }
+         // the base chain is walked by name, as it may not be planned yet; it is bounded in case it is circular
+         set<field_name> names;
+         auto s_itr = plan.struct_itr;
+         for( size_t depth = 0; s_itr != structs.end() && depth <= structs.size() && !plan.shadowed_fields; ++depth ) {
+            for( const auto& field : s_itr->second.fields )
+               plan.shadowed_fields |= !names.insert( field.name ).second;
+            if( s_itr->second.base == type_name() )
+               break;
+            s_itr = structs.find( resolve_type( s_itr->second.base ) );
+         }
+      }
+
+      plans[id] = std::move( plan );
+      return id;
+   }
+
+   const abi_serializer::type_plan* abi_serializer::find_plan( const type_name& type )const {
+      auto itr = plan_ids.find( type );
+      return itr != plan_ids.end() ? &plans[itr->second] : nullptr;
    }
 
    void abi_serializer::configure_built_in_types() {
@@ -108,6 +211,8 @@ namespace dccio { namespace chain {
 
       dcc_ASSERT(starts_with(abi.version, "dccio::abi/1."), unsupported_abi_version_exception, "ABI has an unsupported version");
 
+      plans.clear();
+      plan_ids.clear();
       typedefs.clear();
       structs.clear();
       actions.clear();
@@ -148,6 +253,7 @@ namespace dccio { namespace chain {
       dcc_ASSERT( variants.size() == abi.variants.value.size(), duplicate_abi_variant_def_exception, "duplicate variant definition detected" );
 
       validate(ctx);
+      compile_plans();
    }
 
    bool abi_serializer::is_builtin_type(const type_name& type)const {
@@ -279,6 +385,105 @@ namespace dccio { namespace chain {
       return type;
    }
 
+   void abi_serializer::_binary_to_variant( const type_plan& plan, fc::datastream<const char *>& stream,
+                                            fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      dcc_ASSERT( plan.kind == type_plan::structure, invalid_type_inside_abi, "Unknown type ${type}", ("type",ctx.maybe_shorten(plan.resolved)) );
+      ctx.hint_struct_type_if_in_array( plan.struct_itr );
+      const auto& st = plan.struct_itr->second;
+      if( plan.base ) {
+         _binary_to_variant(plans[*plan.base], stream, obj, ctx);
+      }
+      bool encountered_extension = false;
+      for( uint32_t i = 0; i < st.fields.size(); ++i ) {
+         const auto& field = st.fields[i];
+         const auto& field_plan = plan.fields[i];
+         encountered_extension |= field_plan.extension;
+         if( !stream.remaining() ) {
+            if( field_plan.extension ) {
+               continue;
+            }
+            if( encountered_extension ) {
+               dcc_THROW( abi_exception, "Encountered field '${f}' without binary extension designation while processing struct '${p}'",
+                          ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+            }
+            dcc_THROW( unpack_exception, "Stream unexpectedly ended; unable to unpack field '${f}' of struct '${p}'",
+                       ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+
+         }
+         auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = plan.struct_itr, .field_ordinal = i } );
+         // a field named like an earlier one replaces its value rather than adding a second key
+         if( plan.shadowed_fields )
+            obj.set( field.name, _binary_to_variant(plans[field_plan.type], stream, ctx) );
+         else
+            obj( field.name, _binary_to_variant(plans[field_plan.type], stream, ctx) );
+      }
+   }
+
+   fc::variant abi_serializer::_binary_to_variant( const type_plan& plan, fc::datastream<const char *>& stream,
+                                                   impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      switch( plan.kind ) {
+         case type_plan::built_in:
+            try {
+               return plan.built_in_functions->first(stream, plan.built_in_array, plan.built_in_optional);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack ${class} type '${type}' while processing '${p}'",
+                                      ("class", plan.built_in_array ? "array of built-in" : plan.built_in_optional ? "optional of built-in" : "built-in")
+                                      ("type", fundamental_type(plan.resolved))("p", ctx.get_path_string()) )
+         case type_plan::array: {
+            ctx.hint_array_type_if_in_array();
+            fc::unsigned_int size;
+            try {
+               fc::raw::unpack(stream, size);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack size of array '${p}'", ("p", ctx.get_path_string()) )
+            const auto& element = plans[plan.element];
+            vector<fc::variant> vars;
+            // every element takes at least one byte, so the remaining stream bounds an untrusted size
+            vars.reserve( std::min<size_t>( size.value, stream.remaining() ) );
+            auto h1 = ctx.push_to_path( impl::array_index_path_item{} );
+            for( decltype(size.value) i = 0; i < size; ++i ) {
+               ctx.set_array_index_of_path_back(i);
+               auto v = _binary_to_variant(element, stream, ctx);
+               dcc_ASSERT( !v.is_null(), unpack_exception, "Invalid packed array '${p}'", ("p", ctx.get_path_string()) );
+               vars.emplace_back(std::move(v));
+            }
+            dcc_ASSERT( vars.size() == size.value,
+                        unpack_exception,
+                        "packed size does not match unpacked array size, packed size ${p} actual size ${a}",
+                        ("p", size)("a", vars.size()) );
+            return fc::variant( std::move(vars) );
+         }
+         case type_plan::optional: {
+            char flag;
+            try {
+               fc::raw::unpack(stream, flag);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()) )
+            return flag ? _binary_to_variant(plans[plan.element], stream, ctx) : fc::variant();
+         }
+         case type_plan::variant: {
+            ctx.hint_variant_type_if_in_array( plan.variant_itr );
+            const auto& types = plan.variant_itr->second.types;
+            fc::unsigned_int select;
+            try {
+               fc::raw::unpack(stream, select);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack tag of variant '${p}'", ("p", ctx.get_path_string()) )
+            dcc_ASSERT( (size_t)select < types.size(), unpack_exception,
+                        "Unpacked invalid tag (${select}) for variant '${p}'", ("select", select.value)("p",ctx.get_path_string()) );
+            auto h1 = ctx.push_to_path( impl::variant_path_item{ .variant_itr = plan.variant_itr, .variant_ordinal = static_cast<uint32_t>(select) } );
+            return vector<fc::variant>{types[select], _binary_to_variant(plans[plan.variant_types[select]], stream, ctx)};
+         }
+         default:
+            break;
+      }
+
+      fc::mutable_variant_object mvo;
+      _binary_to_variant(plan, stream, mvo, ctx);
+      dcc_ASSERT( mvo.size() > 0, unpack_exception, "Unable to unpack '${p}' from stream", ("p", ctx.get_path_string()) );
+      return fc::variant( std::move(mvo) );
+   }
+
    void abi_serializer::_binary_to_variant( const type_name& type, fc::datastream<const char *>& stream,
                                             fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const
    {
@@ -308,13 +513,16 @@ namespace dccio { namespace chain {
 
          }
          auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = s_itr, .field_ordinal = i } );
-         obj( field.name, _binary_to_variant(resolve_type( extension ? _remove_bin_extension(field.type) : field.type ), stream, ctx) );
+         obj.set( field.name, _binary_to_variant(resolve_type( extension ? _remove_bin_extension(field.type) : field.type ), stream, ctx) );
       }
    }
 
    fc::variant abi_serializer::_binary_to_variant( const type_name& type, fc::datastream<const char *>& stream,
                                                    impl::binary_to_variant_context& ctx )const
    {
+      if( const auto* plan = find_plan(type) )
+         return _binary_to_variant(*plan, stream, ctx);
+
       auto h = ctx.enter_scope();
       type_name rtype = resolve_type(type);
       auto ftype = fundamental_type(rtype);
@@ -396,8 +604,271 @@ namespace dccio { namespace chain {
       return _binary_to_variant(type, binary, ctx);
    }
 
+   void abi_serializer::_binary_to_writer( const type_plan& plan, fc::datastream<const char *>& stream, abi_writer& out,
+                                           size_t& fields_written, impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      dcc_ASSERT( plan.kind == type_plan::structure, invalid_type_inside_abi, "Unknown type ${type}", ("type",ctx.maybe_shorten(plan.resolved)) );
+      ctx.hint_struct_type_if_in_array( plan.struct_itr );
+      const auto& st = plan.struct_itr->second;
+      if( plan.base ) {
+         _binary_to_writer(plans[*plan.base], stream, out, fields_written, ctx);
+      }
+      bool encountered_extension = false;
+      for( uint32_t i = 0; i < st.fields.size(); ++i ) {
+         const auto& field = st.fields[i];
+         const auto& field_plan = plan.fields[i];
+         encountered_extension |= field_plan.extension;
+         if( !stream.remaining() ) {
+            if( field_plan.extension ) {
+               continue;
+            }
+            if( encountered_extension ) {
+               dcc_THROW( abi_exception, "Encountered field '${f}' without binary extension designation while processing struct '${p}'",
+                          ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+            }
+            dcc_THROW( unpack_exception, "Stream unexpectedly ended; unable to unpack field '${f}' of struct '${p}'",
+                       ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+
+         }
+         auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = plan.struct_itr, .field_ordinal = i } );
+         ++fields_written;
+         out.key( field.name );
+         _binary_to_writer(plans[field_plan.type], stream, out, ctx);
+      }
+   }
+
+   bool abi_serializer::_binary_to_writer( const type_plan& plan, fc::datastream<const char *>& stream, abi_writer& out,
+                                           impl::binary_to_variant_context& ctx )const
+   {
+      switch( plan.kind ) {
+         case type_plan::built_in: {
+            auto h = ctx.enter_scope();
+            fc::variant v;
+            try {
+               v = plan.built_in_functions->first(stream, plan.built_in_array, plan.built_in_optional);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack ${class} type '${type}' while processing '${p}'",
+                                      ("class", plan.built_in_array ? "array of built-in" : plan.built_in_optional ? "optional of built-in" : "built-in")
+                                      ("type", fundamental_type(plan.resolved))("p", ctx.get_path_string()) )
+            out.variant_value( v );
+            return !v.is_null();
+         }
+         case type_plan::array: {
+            auto h = ctx.enter_scope();
+            ctx.hint_array_type_if_in_array();
+            fc::unsigned_int size;
+            try {
+               fc::raw::unpack(stream, size);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack size of array '${p}'", ("p", ctx.get_path_string()) )
+            const auto& element = plans[plan.element];
+            out.begin_array();
+            auto h1 = ctx.push_to_path( impl::array_index_path_item{} );
+            for( decltype(size.value) i = 0; i < size; ++i ) {
+               ctx.set_array_index_of_path_back(i);
+               bool not_null = _binary_to_writer(element, stream, out, ctx);
+               dcc_ASSERT( not_null, unpack_exception, "Invalid packed array '${p}'", ("p", ctx.get_path_string()) );
+            }
+            out.end_array();
+            return true;
+         }
+         case type_plan::optional: {
+            auto h = ctx.enter_scope();
+            char flag;
+            try {
+               fc::raw::unpack(stream, flag);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()) )
+            if( flag )
+               return _binary_to_writer(plans[plan.element], stream, out, ctx);
+            out.null_value();
+            return false;
+         }
+         case type_plan::variant: {
+            auto h = ctx.enter_scope();
+            ctx.hint_variant_type_if_in_array( plan.variant_itr );
+            const auto& types = plan.variant_itr->second.types;
+            fc::unsigned_int select;
+            try {
+               fc::raw::unpack(stream, select);
+            } dcc_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack tag of variant '${p}'", ("p", ctx.get_path_string()) )
+            dcc_ASSERT( (size_t)select < types.size(), unpack_exception,
+                        "Unpacked invalid tag (${select}) for variant '${p}'", ("select", select.value)("p",ctx.get_path_string()) );
+            auto h1 = ctx.push_to_path( impl::variant_path_item{ .variant_itr = plan.variant_itr, .variant_ordinal = static_cast<uint32_t>(select) } );
+            out.begin_array();
+            out.string_value( types[select] );
+            _binary_to_writer(plans[plan.variant_types[select]], stream, out, ctx);
+            out.end_array();
+            return true;
+         }
+         default:
+            break;
+      }
+
+      auto h = ctx.enter_scope();
+      if( plan.shadowed_fields ) {
+         // the value of a shadowed field is only known once the fields naming it have all been read
+         out.variant_value( _binary_to_variant(plan, stream, ctx) );
+         return true;
+      }
+      size_t fields_written = 0;
+      out.begin_object();
+      _binary_to_writer(plan, stream, out, fields_written, ctx);
+      dcc_ASSERT( fields_written > 0, unpack_exception, "Unable to unpack '${p}' from stream", ("p", ctx.get_path_string()) );
+      out.end_object();
+      return true;
+   }
+
+   void abi_serializer::_binary_to_writer( const type_name& type, fc::datastream<const char *>& stream, abi_writer& out,
+                                           impl::binary_to_variant_context& ctx )const
+   {
+      if( const auto* plan = find_plan(type) ) {
+         _binary_to_writer(*plan, stream, out, ctx);
+         return;
+      }
+      // types the ABI does not name, such as "uint64[]" asked for by a caller, are not compiled
+      out.variant_value( _binary_to_variant(type, stream, ctx) );
+   }
+
+   void abi_serializer::_binary_to_writer( const type_name& type, const bytes& binary, abi_writer& out,
+                                           impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      fc::datastream<const char*> ds( binary.data(), binary.size() );
+      _binary_to_writer(type, ds, out, ctx);
+   }
+
+   void abi_serializer::binary_to_writer( const type_name& type, fc::datastream<const char*>& binary, abi_writer& out,
+                                          const fc::microseconds& max_serialization_time, bool short_path )const {
+      impl::binary_to_variant_context ctx(*this, max_serialization_time, type);
+      ctx.short_path = short_path;
+      _binary_to_writer(type, binary, out, ctx);
+   }
+
+   void abi_serializer::binary_to_json( const type_name& type, fc::datastream<const char*>& binary, std::ostream& out,
+                                        const fc::microseconds& max_serialization_time, bool short_path )const {
+      json_writer writer(out);
+      binary_to_writer(type, binary, writer, max_serialization_time, short_path);
+   }
+
+   string abi_serializer::binary_to_json( const type_name& type, const bytes& binary, const fc::microseconds& max_serialization_time, bool short_path )const {
+      impl::binary_to_variant_context ctx(*this, max_serialization_time, type);
+      ctx.short_path = short_path;
+      std::ostringstream out;
+      json_writer writer(out);
+      _binary_to_writer(type, binary, writer, ctx);
+      return out.str();
+   }
+
+   void abi_serializer::_variant_to_binary( const type_plan& plan, const fc::variant& var, fc::datastream<char *>& ds, impl::variant_to_binary_context& ctx )const
+   { const auto& type = plan.name; try {
+      auto h = ctx.enter_scope();
+      switch( plan.kind ) {
+         case type_plan::built_in:
+            plan.built_in_functions->second(var, ds, plan.built_in_array, plan.built_in_optional);
+            break;
+         case type_plan::array: {
+            ctx.hint_array_type_if_in_array();
+            const auto& vars = var.get_array();
+            fc::raw::pack(ds, (fc::unsigned_int)vars.size());
+
+            auto h1 = ctx.push_to_path( impl::array_index_path_item{} );
+            auto h2 = ctx.disallow_extensions_unless(false);
+
+            const auto& element = plans[plan.element];
+            int64_t i = 0;
+            for (const auto& var : vars) {
+               ctx.set_array_index_of_path_back(i);
+               _variant_to_binary(element, var, ds, ctx);
+               ++i;
+            }
+            break;
+         }
+         case type_plan::variant: {
+            ctx.hint_variant_type_if_in_array( plan.variant_itr );
+            auto& v = plan.variant_itr->second;
+            dcc_ASSERT( var.is_array() && var.size() == 2, pack_exception,
+                       "Expected input to be an array of two items while processing variant '${p}'", ("p", ctx.get_path_string()) );
+            dcc_ASSERT( var[size_t(0)].is_string(), pack_exception,
+                       "Encountered non-string as first item of input array while processing variant '${p}'", ("p", ctx.get_path_string()) );
+            const auto& variant_type_str = var[size_t(0)].get_string();
+            auto it = find(v.types.begin(), v.types.end(), variant_type_str);
+            dcc_ASSERT( it != v.types.end(), pack_exception,
+                        "Specified type '${t}' in input array is not valid within the variant '${p}'",
+                        ("t", ctx.maybe_shorten(variant_type_str))("p", ctx.get_path_string()) );
+            const auto select = static_cast<uint32_t>(it - v.types.begin());
+            fc::raw::pack(ds, fc::unsigned_int(select));
+            auto h1 = ctx.push_to_path( impl::variant_path_item{ .variant_itr = plan.variant_itr, .variant_ordinal = select } );
+            _variant_to_binary( plans[plan.variant_types[select]], var[size_t(1)], ds, ctx );
+            break;
+         }
+         case type_plan::structure: {
+            ctx.hint_struct_type_if_in_array( plan.struct_itr );
+            const auto& st = plan.struct_itr->second;
+
+            if( var.is_object() ) {
+               const auto& vo = var.get_object();
+
+               if( plan.base ) {
+                  auto h2 = ctx.disallow_extensions_unless(false);
+                  _variant_to_binary(plans[*plan.base], var, ds, ctx);
+               }
+               bool disallow_additional_fields = false;
+               for( uint32_t i = 0; i < st.fields.size(); ++i ) {
+                  const auto& field = st.fields[i];
+                  auto field_itr = vo.find( field.name );
+                  if( field_itr != vo.end() ) {
+                     if( disallow_additional_fields )
+                        dcc_THROW( pack_exception, "Unexpected field '${f}' found in input object while processing struct '${p}'",
+                                   ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+                     {
+                        auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = plan.struct_itr, .field_ordinal = i } );
+                        auto h2 = ctx.disallow_extensions_unless( &field == &st.fields.back() );
+                        _variant_to_binary(plans[plan.fields[i].type], field_itr->value(), ds, ctx);
+                     }
+                  } else if( plan.fields[i].extension && ctx.extensions_allowed() ) {
+                     disallow_additional_fields = true;
+                  } else if( disallow_additional_fields ) {
+                     dcc_THROW( abi_exception, "Encountered field '${f}' without binary extension designation while processing struct '${p}'",
+                                ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+                  } else {
+                     dcc_THROW( pack_exception, "Missing field '${f}' in input object while processing struct '${p}'",
+                                ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+                  }
+               }
+            } else if( var.is_array() ) {
+               const auto& va = var.get_array();
+               dcc_ASSERT( !plan.base, invalid_type_inside_abi,
+                           "Using input array to specify the fields of the derived struct '${p}'; input arrays are currently only allowed for structs without a base",
+                           ("p",ctx.get_path_string()) );
+               for( uint32_t i = 0; i < st.fields.size(); ++i ) {
+                  const auto& field = st.fields[i];
+                  if( va.size() > i ) {
+                     auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = plan.struct_itr, .field_ordinal = i } );
+                     auto h2 = ctx.disallow_extensions_unless( &field == &st.fields.back() );
+                     _variant_to_binary(plans[plan.fields[i].type], va[i], ds, ctx);
+                  } else if( plan.fields[i].extension && ctx.extensions_allowed() ) {
+                     break;
+                  } else {
+                     dcc_THROW( pack_exception, "Early end to input array specifying the fields of struct '${p}'; require input for field '${f}'",
+                                ("p", ctx.get_path_string())("f", ctx.maybe_shorten(field.name)) );
+                  }
+               }
+            } else {
+               dcc_THROW( pack_exception, "Unexpected input encountered while processing struct '${p}'", ("p",ctx.get_path_string()) );
+            }
+            break;
+         }
+         default:
+            // optionals of non built-in types have no packed form
+            dcc_THROW( invalid_type_inside_abi, "Unknown type ${type}", ("type",ctx.maybe_shorten(type)) );
+      }
+   } FC_CAPTURE_AND_RETHROW( (type)(var) ) }
+
    void abi_serializer::_variant_to_binary( const type_name& type, const fc::variant& var, fc::datastream<char *>& ds, impl::variant_to_binary_context& ctx )const
-   { try {
+   {
+      if( const auto* plan = find_plan(type) )
+         return _variant_to_binary(*plan, var, ds, ctx);
+
+      try {
       auto h = ctx.enter_scope();
       auto rtype = resolve_type(type);
 
@@ -502,11 +973,11 @@ namespace dccio { namespace chain {
          return var.as<bytes>();
       }
 
-      bytes temp( 1024*1024 );
+      // zeroing a fresh 1MB buffer per call cost more than packing a typical action, so reuse one per thread
+      static thread_local bytes temp( 1024*1024 );
       fc::datastream<char*> ds(temp.data(), temp.size() );
       _variant_to_binary(type, var, ds, ctx);
-      temp.resize(ds.tellp());
-      return temp;
+      return bytes( temp.begin(), temp.begin() + ds.tellp() );
    } FC_CAPTURE_AND_RETHROW( (type)(var) ) }
 
    bytes abi_serializer::variant_to_binary( const type_name& type, const fc::variant& var, const fc::microseconds& max_serialization_time, bool short_path )const {
@@ -542,6 +1013,100 @@ namespace dccio { namespace chain {
 
    namespace impl {
 
+      void write_value( abi_writer& out, bool v ) {
+         out.bool_value( v );
+      }
+
+      void write_value( abi_writer& out, uint64_t v ) {
+         out.uint64_value( v );
+      }
+
+      void write_value( abi_writer& out, int64_t v ) {
+         out.int64_value( v );
+      }
+
+      void write_value( abi_writer& out, uint32_t v ) {
+         out.uint64_value( v );
+      }
+
+      void write_value( abi_writer& out, const string& v ) {
+         out.string_value( v );
+      }
+
+      void write_value( abi_writer& out, const fc::unsigned_int& v ) {
+         out.uint64_value( v.value );
+      }
+
+      void write_value( abi_writer& out, const fc::microseconds& v ) {
+         out.int64_value( v.count() );
+      }
+
+      void write_value( abi_writer& out, const fc::sha256& v ) {
+         out.string_value( v.str() );
+      }
+
+      void write_value( abi_writer& out, const name& v ) {
+         out.string_value( v.to_string() );
+      }
+
+      void write_value( abi_writer& out, const permission_level& v ) {
+         out.begin_object();
+         out.key( "actor" );
+         write_value( out, v.actor );
+         out.key( "permission" );
+         write_value( out, v.permission );
+         out.end_object();
+      }
+
+      void write_value( abi_writer& out, const vector<permission_level>& v ) {
+         out.begin_array();
+         for( const auto& e : v )
+            write_value( out, e );
+         out.end_array();
+      }
+
+      void write_value( abi_writer& out, const action_receipt& v ) {
+         out.begin_object();
+         out.key( "receiver" );
+         write_value( out, v.receiver );
+         out.key( "act_digest" );
+         write_value( out, v.act_digest );
+         out.key( "global_sequence" );
+         write_value( out, v.global_sequence );
+         out.key( "recv_sequence" );
+         write_value( out, v.recv_sequence );
+         out.key( "auth_sequence" );
+         out.begin_array();
+         for( const auto& e : v.auth_sequence ) {
+            out.begin_array();
+            write_value( out, e.first );
+            write_value( out, e.second );
+            out.end_array();
+         }
+         out.end_array();
+         out.key( "code_sequence" );
+         write_value( out, v.code_sequence );
+         out.key( "abi_sequence" );
+         write_value( out, v.abi_sequence );
+         out.end_object();
+      }
+
+      void write_value( abi_writer& out, const account_delta& v ) {
+         out.begin_object();
+         out.key( "account" );
+         write_value( out, v.account );
+         out.key( "delta" );
+         write_value( out, v.delta );
+         out.end_object();
+      }
+
+      void write_value( abi_writer& out, const flat_set<account_delta>& v ) {
+         out.begin_array();
+         for( const auto& e : v )
+            write_value( out, e );
+         out.end_array();
+      }
+
       void abi_traverse_context::check_deadline()const {
          dcc_ASSERT( fc::time_point::now() < deadline, abi_serialization_deadline_exception,
                      "serialization time limit ${t}us exceeded", ("t", max_serialization_time) );
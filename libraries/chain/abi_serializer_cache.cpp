@@ -0,0 +1,82 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#include <dccio/chain/abi_serializer_cache.hpp>
+#include <dccio/chain/account_object.hpp>
+
+namespace dccio { namespace chain {
+
+   abi_serializer_cache::abi_serializer_cache( size_t max_entries )
+   :max_entries( max_entries )
+   {}
+
+   abi_serializer_cache::serializer_ptr abi_serializer_cache::get( const chainbase::database& db, account_name n,
+                                                                   const fc::microseconds& max_serialization_time ) {
+      const auto* account = db.find<account_object, by_name>( n );
+      if( account == nullptr || abi_serializer::is_empty_abi( account->abi ))
+         return serializer_ptr();
+      const auto& sequence = db.get<account_sequence_object, by_name>( n );
+
+      if( auto cached = find( n, sequence.abi_sequence, account->abi.data(), account->abi.size() ))
+         return cached;
+
+      // build outside the lock, concurrent misses on the same account may both build
+      abi_def abi;
+      abi_serializer::to_abi( account->abi, abi );
+      auto serializer = std::make_shared<const abi_serializer>( abi, max_serialization_time );
+      store( entry{ n, sequence.abi_sequence, std::string( account->abi.data(), account->abi.size() ), serializer } );
+      return serializer;
+   }
+
+   abi_serializer_cache::serializer_ptr abi_serializer_cache::get( account_name n, uint64_t abi_sequence,
+                                                                   const std::function<serializer_ptr()>& make_serializer ) {
+      if( auto cached = find( n, abi_sequence, nullptr, 0 ))
+         return cached;
+
+      auto serializer = make_serializer();
+      if( serializer )
+         store( entry{ n, abi_sequence, std::string(), serializer } );
+      return serializer;
+   }
+
+   abi_serializer_cache::serializer_ptr abi_serializer_cache::find( account_name n, uint64_t abi_sequence,
+                                                                    const char* abi, size_t abi_size ) {
+      std::lock_guard<std::mutex> g( mtx );
+      auto& by_acnt = entries.get<by_account>();
+      auto it = by_acnt.find( n );
+      if( it == by_acnt.end() || it->abi_sequence != abi_sequence )
+         return serializer_ptr();
+      if( it->abi.size() != abi_size || (abi_size && memcmp( it->abi.data(), abi, abi_size ) != 0) )
+         return serializer_ptr();
+      entries.relocate( entries.begin(), entries.project<0>( it ));
+      return it->serializer;
+   }
+
+   void abi_serializer_cache::store( entry e ) {
+      std::lock_guard<std::mutex> g( mtx );
+      auto& by_acnt = entries.get<by_account>();
+      auto it = by_acnt.find( e.account );
+      if( it != by_acnt.end() )
+         by_acnt.erase( it );
+      entries.push_front( std::move( e ));
+      while( entries.size() > max_entries )
+         entries.pop_back();
+   }
+
+   void abi_serializer_cache::invalidate( account_name n ) {
+      std::lock_guard<std::mutex> g( mtx );
+      entries.get<by_account>().erase( n );
+   }
+
+   void abi_serializer_cache::clear() {
+      std::lock_guard<std::mutex> g( mtx );
+      entries.clear();
+   }
+
+   size_t abi_serializer_cache::size()const {
+      std::lock_guard<std::mutex> g( mtx );
+      return entries.size();
+   }
+
+} } // dccio::chain
@@ -0,0 +1,225 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#include <dccio/chain/abi_writer.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <cstring>
+#include <sstream>
+
+namespace dccio { namespace chain {
+
+   void abi_writer::variant_value( const fc::variant& v ) {
+      switch( v.get_type() ) {
+         case fc::variant::null_type:
+            null_value();
+            return;
+         case fc::variant::int64_type:
+            int64_value( v.as_int64() );
+            return;
+         case fc::variant::uint64_type:
+            uint64_value( v.as_uint64() );
+            return;
+         case fc::variant::double_type:
+            double_value( v.as_double() );
+            return;
+         case fc::variant::bool_type:
+            bool_value( v.as_bool() );
+            return;
+         case fc::variant::string_type:
+            string_value( v.get_string() );
+            return;
+         case fc::variant::blob_type:
+            string_value( v.as_string() );
+            return;
+         case fc::variant::array_type:
+            begin_array();
+            for( const auto& e : v.get_array() )
+               variant_value( e );
+            end_array();
+            return;
+         case fc::variant::object_type:
+            begin_object();
+            for( const auto& e : v.get_object() ) {
+               key( e.key() );
+               variant_value( e.value() );
+            }
+            end_object();
+            return;
+         default:
+            FC_THROW_EXCEPTION( fc::invalid_arg_exception, "Unsupported variant type: " + std::to_string( v.get_type() ) );
+      }
+   }
+
+   void abi_writer::try_value( const std::function<void(abi_writer&)>& write ) {
+      abi_writer_buffer buffer;
+      write( buffer );
+      buffer.replay( *this );
+   }
+
+   void json_writer::separate() {
+      if( after_key )
+         after_key = false;
+      else if( need_comma )
+         out << ',';
+   }
+
+   void json_writer::begin_object() {
+      separate();
+      out << '{';
+      need_comma = false;
+   }
+
+   void json_writer::key( const string& name ) {
+      if( need_comma )
+         out << ',';
+      fc::json::to_stream( out, name );
+      out << ':';
+      after_key = true;
+   }
+
+   void json_writer::end_object() {
+      out << '}';
+      need_comma = true;
+   }
+
+   void json_writer::begin_array() {
+      separate();
+      out << '[';
+      need_comma = false;
+   }
+
+   void json_writer::end_array() {
+      out << ']';
+      need_comma = true;
+   }
+
+   void json_writer::null_value() {
+      raw_value() << "null";
+   }
+
+   void json_writer::bool_value( bool v ) {
+      raw_value() << (v ? "true" : "false");
+   }
+
+   // integers beyond 32 bits are quoted, as fc::json::stringify_large_ints_and_doubles does
+   void json_writer::int64_value( int64_t v ) {
+      if( v > 0xffffffff )
+         raw_value() << '"' << v << '"';
+      else
+         raw_value() << v;
+   }
+
+   void json_writer::uint64_value( uint64_t v ) {
+      if( v > 0xffffffff )
+         raw_value() << '"' << v << '"';
+      else
+         raw_value() << v;
+   }
+
+   void json_writer::double_value( double v ) {
+      fc::json::to_stream( raw_value(), fc::variant(v) );
+   }
+
+   void json_writer::string_value( const string& v ) {
+      fc::json::to_stream( raw_value(), v );
+   }
+
+   void json_writer::variant_value( const fc::variant& v ) {
+      fc::json::to_stream( raw_value(), v );
+   }
+
+   void json_writer::try_value( const std::function<void(abi_writer&)>& write ) {
+      std::ostringstream aside;
+      json_writer writer( aside );
+      write( writer );
+      raw_value() << aside.str();
+   }
+
+   std::ostream& json_writer::raw_value() {
+      separate();
+      need_comma = true;
+      return out;
+   }
+
+   void abi_writer_buffer::begin_object() {
+      entries.push_back( entry{ op::begin_object, 0 } );
+   }
+
+   void abi_writer_buffer::key( const string& name ) {
+      entries.push_back( entry{ op::key, strings.size() } );
+      strings.push_back( name );
+   }
+
+   void abi_writer_buffer::end_object() {
+      entries.push_back( entry{ op::end_object, 0 } );
+   }
+
+   void abi_writer_buffer::begin_array() {
+      entries.push_back( entry{ op::begin_array, 0 } );
+   }
+
+   void abi_writer_buffer::end_array() {
+      entries.push_back( entry{ op::end_array, 0 } );
+   }
+
+   void abi_writer_buffer::null_value() {
+      entries.push_back( entry{ op::null_value, 0 } );
+   }
+
+   void abi_writer_buffer::bool_value( bool v ) {
+      entries.push_back( entry{ op::bool_value, v } );
+   }
+
+   void abi_writer_buffer::int64_value( int64_t v ) {
+      entries.push_back( entry{ op::int64_value, static_cast<uint64_t>(v) } );
+   }
+
+   void abi_writer_buffer::uint64_value( uint64_t v ) {
+      entries.push_back( entry{ op::uint64_value, v } );
+   }
+
+   void abi_writer_buffer::double_value( double v ) {
+      uint64_t bits;
+      memcpy( &bits, &v, sizeof(bits) );
+      entries.push_back( entry{ op::double_value, bits } );
+   }
+
+   void abi_writer_buffer::string_value( const string& v ) {
+      entries.push_back( entry{ op::string_value, strings.size() } );
+      strings.push_back( v );
+   }
+
+   void abi_writer_buffer::variant_value( const fc::variant& v ) {
+      entries.push_back( entry{ op::variant_value, variants.size() } );
+      variants.push_back( v );
+   }
+
+   void abi_writer_buffer::replay( abi_writer& out )const {
+      for( const auto& e : entries ) {
+         switch( e.kind ) {
+            case op::begin_object:  out.begin_object(); break;
+            case op::key:           out.key( strings[e.value] ); break;
+            case op::end_object:    out.end_object(); break;
+            case op::begin_array:   out.begin_array(); break;
+            case op::end_array:     out.end_array(); break;
+            case op::null_value:    out.null_value(); break;
+            case op::bool_value:    out.bool_value( e.value != 0 ); break;
+            case op::int64_value:   out.int64_value( static_cast<int64_t>(e.value) ); break;
+            case op::uint64_value:  out.uint64_value( e.value ); break;
+            case op::double_value: {
+               double v;
+               memcpy( &v, &e.value, sizeof(v) );
+               out.double_value( v );
+               break;
+            }
+            case op::string_value:  out.string_value( strings[e.value] ); break;
+            case op::variant_value: out.variant_value( variants[e.value] ); break;
+         }
+      }
+   }
+
+} } // dccio::chain
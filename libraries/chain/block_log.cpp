@@ -4,8 +4,20 @@
  */
 #include <dccio/chain/block_log.hpp>
 #include <dccio/chain/exceptions.hpp>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include <fc/io/raw.hpp>
+#include <fc/compress/zlib.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fcntl.h>
+#include <unistd.h>
 
 #define LOG_READ  (std::ios::in | std::ios::binary)
 #define LOG_WRITE (std::ios::out | std::ios::binary | std::ios::app)
@@ -23,12 +35,174 @@ namespace dccio { namespace chain {
    const uint32_t block_log::max_supported_version = 2;
 
    namespace detail {
+      /// flushes a file, or the entries of a directory, to disk
+      static void sync_path( const fc::path& p ) {
+         int fd = ::open( p.generic_string().c_str(), O_RDONLY );
+         dcc_ASSERT( fd >= 0, block_log_exception, "Unable to open ${p} to sync it: ${e}", ("p", p.generic_string())("e", strerror(errno)) );
+         const bool synced = ::fsync( fd ) == 0;
+         const int err = errno;
+         ::close( fd );
+         dcc_ASSERT( synced, block_log_exception, "Unable to sync ${p}: ${e}", ("p", p.generic_string())("e", strerror(err)) );
+      }
+
+      /// Read-only mapping of one of the log's files, replaced by a larger one once the file outgrows it
+      struct mapped_log_file {
+         mapped_log_file( const fc::path& file )
+         :mapping( file.generic_string().c_str(), boost::interprocess::read_only ),
+          region( mapping, boost::interprocess::read_only )
+         {}
+
+         const char* data()const { return static_cast<const char*>( region.get_address() ); }
+         uint64_t    size()const { return region.get_size(); }
+
+         uint64_t read_pos( uint64_t offset )const {
+            dcc_ASSERT( offset + sizeof(uint64_t) <= size(), block_log_exception,
+                        "Block log position at ${offset} is beyond the end of its file", ("offset", offset) );
+            uint64_t pos;
+            memcpy( &pos, data() + offset, sizeof(pos) );
+            return pos;
+         }
+
+         boost::interprocess::file_mapping   mapping;
+         boost::interprocess::mapped_region  region;
+      };
+
+      const uint32_t compressed_segment_version = 1;
+
+      /// Name of the files of the segment holding blocks [first_block_num, last_block_num], without their extension
+      string segment_name( uint32_t first_block_num, uint32_t last_block_num ) {
+         char name[32];
+         snprintf( name, sizeof(name), "blocks-%010u-%010u", first_block_num, last_block_num );
+         return name;
+      }
+
+      bool parse_segment_file_name( const string& file_name, uint32_t& first_block_num, uint32_t& last_block_num, string& extension ) {
+         char ext[16] = {};
+         if( sscanf( file_name.c_str(), "blocks-%10u-%10u.%15s", &first_block_num, &last_block_num, ext ) != 3 )
+            return false;
+         extension = ext;
+         return segment_name( first_block_num, last_block_num ) + "." + extension == file_name;
+      }
+
+      void write_log_header( std::ostream& out, uint32_t version, uint32_t first_block_num, const genesis_state& gs ) {
+         auto data = fc::raw::pack(gs);
+         out.write((char*)&version, sizeof(version));
+         out.write((char*)&first_block_num, sizeof(first_block_num));
+         out.write(data.data(), data.size());
+
+         // append a totem to indicate the division between blocks and header
+         auto totem = block_log::npos;
+         out.write((char*)&totem, sizeof(totem));
+      }
+
+      /// A sealed part of the log holding blocks [first_block_num, last_block_num]: either a block log of its own with
+      /// its index file, or a compressed segment holding its index at its end
+      struct log_segment {
+         uint32_t                               first_block_num = 0;
+         uint32_t                               last_block_num = 0;
+         bool                                   compressed = false;
+         fc::path                               block_file;
+         fc::path                               index_file; ///< not used by compressed segments
+         std::shared_ptr<const mapped_log_file> blocks;
+         std::shared_ptr<const mapped_log_file> index;
+
+         uint32_t num_blocks()const { return last_block_num - first_block_num + 1; }
+
+         /// the bytes of a block as stored in the segment, packed or compressed
+         std::pair<const char*, uint64_t> stored_block( uint32_t block_num )const {
+            const uint64_t n = block_num - first_block_num;
+            uint64_t pos, end;
+            if( compressed ) {
+               const uint64_t index_pos = blocks->size() - sizeof(uint64_t) * num_blocks();
+               pos = blocks->read_pos( index_pos + sizeof(uint64_t) * n );
+               end = block_num == last_block_num ? index_pos : blocks->read_pos( index_pos + sizeof(uint64_t) * (n + 1) );
+            } else {
+               // each block is followed by its position
+               pos = index->read_pos( sizeof(uint64_t) * n );
+               end = (block_num == last_block_num ? blocks->size() : index->read_pos( sizeof(uint64_t) * (n + 1) )) - sizeof(uint64_t);
+            }
+            dcc_ASSERT( pos <= end && end <= blocks->size(), block_log_exception,
+                        "Block ${num} is malformed in block log segment ${file}", ("num", block_num)("file", block_file) );
+            return { blocks->data() + pos, end - pos };
+         }
+
+         void read_block( uint32_t block_num, signed_block& b )const {
+            const auto stored = stored_block( block_num );
+            if( compressed ) {
+               const auto data = fc::zlib_decompress( string( stored.first, stored.second ) );
+               fc::datastream<const char*> ds( data.data(), data.size() );
+               fc::raw::unpack( ds, b );
+            } else {
+               fc::datastream<const char*> ds( stored.first, stored.second );
+               fc::raw::unpack( ds, b );
+            }
+         }
+
+         genesis_state read_genesis()const {
+            // version 1 block logs have no first block number after their version
+            uint32_t version;
+            memcpy( &version, blocks->data(), sizeof(version) );
+            const uint64_t pos = compressed ? 3 * sizeof(uint32_t) : version == 1 ? sizeof(uint32_t) : 2 * sizeof(uint32_t);
+            fc::datastream<const char*> ds( blocks->data() + pos, blocks->size() - pos );
+            genesis_state gs;
+            fc::raw::unpack( ds, gs );
+            return gs;
+         }
+      };
+
+      using segment_list = vector<log_segment>;
+
+      /// What a reader needs to find blocks, so that it can read without holding the lock
+      struct block_log_view {
+         std::shared_ptr<const segment_list>    segments; ///< ordered, all before the blocks of blocks.log
+         std::shared_ptr<const mapped_log_file> blocks;
+         std::shared_ptr<const mapped_log_file> index;
+         uint32_t                               first_block_num = 0;
+         uint32_t                               head_block_num = 0; ///< 0 when blocks.log has no blocks
+
+         const log_segment* find_segment( uint32_t block_num )const {
+            if( segments->empty() || block_num < segments->front().first_block_num || block_num > segments->back().last_block_num )
+               return nullptr;
+            auto itr = std::upper_bound( segments->begin(), segments->end(), block_num,
+                                         []( uint32_t num, const log_segment& s ) { return num < s.first_block_num; } );
+            return &*(itr - 1);
+         }
+
+         uint32_t first_retained_block_num()const {
+            return segments->empty() ? first_block_num : segments->front().first_block_num;
+         }
+
+         /// 0 when the log has no blocks
+         uint32_t last_block_num()const {
+            if( head_block_num || segments->empty() )
+               return head_block_num;
+            return segments->back().last_block_num;
+         }
+
+         uint64_t get_block_pos( uint32_t block_num )const {
+            if( !head_block_num || block_num > head_block_num || block_num < first_block_num )
+               return block_log::npos;
+            dcc_ASSERT( index, block_log_exception, "Block log index does not contain block ${num}", ("num", block_num) );
+            return index->read_pos( sizeof(uint64_t) * (block_num - first_block_num) );
+         }
+
+         /// unpacks the block at pos, returning the position of the block after it
+         uint64_t read_block( uint64_t pos, signed_block& b )const {
+            dcc_ASSERT( blocks && pos < blocks->size(), block_log_exception,
+                        "Block position ${pos} is beyond the end of the block log", ("pos", pos) );
+            fc::datastream<const char*> ds( blocks->data() + pos, blocks->size() - pos );
+            fc::raw::unpack( ds, b );
+            return pos + ds.tellp() + sizeof(uint64_t);
+         }
+      };
+
       class block_log_impl {
          public:
             signed_block_ptr         head;
             block_id_type            head_id;
             std::fstream             block_stream;
             std::fstream             index_stream;
+            fc::path                 data_dir;
             fc::path                 block_file;
             fc::path                 index_file;
             bool                     block_write;
@@ -36,6 +210,11 @@ namespace dccio { namespace chain {
             bool                     genesis_written_to_block_log = false;
             uint32_t                 version = 0;
             uint32_t                 first_block_num = 0;
+            block_log_segment_config segment_config;
+
+            ~block_log_impl() {
+               stop_segment_thread();
+            }
 
             inline void check_block_read() {
                if (block_write) {
@@ -71,13 +250,315 @@ namespace dccio { namespace chain {
                   index_write = true;
                }
             }
+
+            /// number of the last block in blocks.log, 0 if all blocks are in segments
+            uint32_t head_file_block_num()const {
+               return head && head->block_num() >= first_block_num ? head->block_num() : 0;
+            }
+
+            /// Readers only see what has been written to the files up to here; must be called after the files are
+            /// flushed, with the number of their last block
+            void publish( uint32_t head_block_num ) {
+               std::lock_guard<std::mutex> g( read_mutex );
+               block_file_size = fc::file_size( block_file );
+               index_file_size = fc::file_size( index_file );
+               published_head_block_num = head_block_num;
+               published_first_block_num = first_block_num;
+            }
+
+            /// Drops the mappings before the files are replaced
+            void unpublish() {
+               std::lock_guard<std::mutex> g( read_mutex );
+               block_map.reset();
+               index_map.reset();
+               block_file_size = 0;
+               index_file_size = 0;
+               published_head_block_num = 0;
+            }
+
+            block_log_view view() {
+               std::lock_guard<std::mutex> g( read_mutex );
+               remap( block_file, block_file_size, block_map );
+               remap( index_file, index_file_size, index_map );
+               return { segments, block_map, index_map, published_first_block_num, published_head_block_num };
+            }
+
+            void load_segments();
+            void remove_segments();
+            void start_segment_thread();
+            void notify_segment_thread();
+            void stop_segment_thread();
+
+            std::mutex                               read_mutex; ///< guards the members below, which readers use
+            std::shared_ptr<const segment_list>      segments = std::make_shared<const segment_list>(); ///< replaced, never modified
+            std::shared_ptr<const mapped_log_file>   block_map;
+            std::shared_ptr<const mapped_log_file>   index_map;
+            uint64_t                                 block_file_size = 0;
+            uint64_t                                 index_file_size = 0;
+            uint32_t                                 published_first_block_num = 0;
+            uint32_t                                 published_head_block_num = 0;
+
+         private:
+            static void remap( const fc::path& file, uint64_t file_size, std::shared_ptr<const mapped_log_file>& map ) {
+               if( file_size == 0 )
+                  map.reset();
+               else if( !map || map->size() < file_size )
+                  map = std::make_shared<const mapped_log_file>( file );
+            }
+
+            void maintain_segments();
+            optional<log_segment> next_uncompressed_segment();
+            void compress_segment( const log_segment& segment );
+            void prune_segments();
+
+            std::thread                              segment_thread; ///< compresses and prunes sealed segments
+            std::mutex                               segment_thread_mutex;
+            std::condition_variable                  segment_thread_cv;
+            bool                                     segment_work_pending = false;
+            std::atomic<bool>                        stopping{false};
       };
+
+      void block_log_impl::load_segments() {
+         vector<string> file_names;
+         for( fc::directory_iterator itr( data_dir ), end; itr != end; ++itr )
+            file_names.emplace_back( (*itr).filename().generic_string() );
+
+         segment_list loaded;
+         for( const auto& file_name : file_names ) {
+            uint32_t first = 0, last = 0;
+            string extension;
+            if( !parse_segment_file_name( file_name, first, last, extension ) )
+               continue;
+            const auto name = segment_name( first, last );
+
+            if( extension == "zlog.tmp" ) {
+               ilog( "Removing incompletely compressed block log segment ${file}", ("file", file_name) );
+               fc::remove( data_dir / file_name );
+            } else if( extension == "index" ) {
+               if( !fc::exists( data_dir / (name + ".log") ) )
+                  fc::remove( data_dir / file_name ); // it was renamed but its blocks were not
+            } else if( extension == "log" && fc::exists( data_dir / (name + ".zlog") ) ) {
+               // compressed but not yet removed
+               fc::remove( data_dir / file_name );
+               fc::remove( data_dir / (name + ".index") );
+            } else if( extension == "log" || extension == "zlog" ) {
+               log_segment segment;
+               segment.first_block_num = first;
+               segment.last_block_num = last;
+               segment.compressed = extension == "zlog";
+               segment.block_file = data_dir / file_name;
+               segment.blocks = std::make_shared<const mapped_log_file>( segment.block_file );
+               if( segment.compressed ) {
+                  uint32_t header[3];
+                  dcc_ASSERT( segment.blocks->size() >= sizeof(header) + sizeof(uint64_t) * segment.num_blocks(), block_log_exception,
+                              "Block log segment ${file} is truncated", ("file", segment.block_file) );
+                  memcpy( header, segment.blocks->data(), sizeof(header) );
+                  dcc_ASSERT( header[0] == compressed_segment_version && header[1] == first && header[2] == last, block_log_exception,
+                              "Block log segment ${file} does not hold the blocks its name says", ("file", segment.block_file) );
+               } else {
+                  segment.index_file = data_dir / (name + ".index");
+                  dcc_ASSERT( fc::exists( segment.index_file ) && fc::file_size( segment.index_file ) == sizeof(uint64_t) * segment.num_blocks(),
+                              block_log_exception, "Index of block log segment ${file} is missing or incomplete", ("file", segment.block_file) );
+                  segment.index = std::make_shared<const mapped_log_file>( segment.index_file );
+               }
+               loaded.emplace_back( std::move(segment) );
+            }
+         }
+
+         std::sort( loaded.begin(), loaded.end(), []( const log_segment& a, const log_segment& b ) {
+            return a.first_block_num < b.first_block_num;
+         });
+         for( size_t i = 1; i < loaded.size(); ++i ) {
+            dcc_ASSERT( loaded[i].first_block_num == loaded[i-1].last_block_num + 1, block_log_exception,
+                        "Block log segments ${prev} and ${next} are not contiguous",
+                        ("prev", loaded[i-1].block_file)("next", loaded[i].block_file) );
+         }
+
+         std::lock_guard<std::mutex> g( read_mutex );
+         segments = std::make_shared<const segment_list>( std::move(loaded) );
+      }
+
+      void block_log_impl::remove_segments() {
+         std::shared_ptr<const segment_list> removed;
+         {
+            std::lock_guard<std::mutex> g( read_mutex );
+            removed = std::move( segments );
+            segments = std::make_shared<const segment_list>();
+         }
+         for( const auto& segment : *removed ) {
+            fc::remove( segment.block_file );
+            if( !segment.compressed )
+               fc::remove( segment.index_file );
+         }
+      }
+
+      void block_log_impl::start_segment_thread() {
+         if( segment_thread.joinable() || !(segment_config.compress || segment_config.retained_segments) )
+            return;
+         stopping = false;
+         segment_thread = std::thread( [this]() { maintain_segments(); } );
+      }
+
+      void block_log_impl::notify_segment_thread() {
+         {
+            std::lock_guard<std::mutex> g( segment_thread_mutex );
+            segment_work_pending = true;
+         }
+         segment_thread_cv.notify_one();
+      }
+
+      void block_log_impl::stop_segment_thread() {
+         if( !segment_thread.joinable() )
+            return;
+         {
+            std::lock_guard<std::mutex> g( segment_thread_mutex );
+            stopping = true;
+         }
+         segment_thread_cv.notify_one();
+         segment_thread.join();
+      }
+
+      void block_log_impl::maintain_segments() {
+         while( true ) {
+            {
+               std::unique_lock<std::mutex> g( segment_thread_mutex );
+               segment_thread_cv.wait( g, [this]() { return segment_work_pending || stopping; } );
+               if( stopping )
+                  return;
+               segment_work_pending = false;
+            }
+
+            try {
+               if( segment_config.compress ) {
+                  while( !stopping ) {
+                     auto segment = next_uncompressed_segment();
+                     if( !segment )
+                        break;
+                     compress_segment( *segment );
+                  }
+               }
+               prune_segments();
+            } FC_LOG_AND_DROP()
+         }
+      }
+
+      optional<log_segment> block_log_impl::next_uncompressed_segment() {
+         std::lock_guard<std::mutex> g( read_mutex );
+         for( const auto& segment : *segments ) {
+            if( !segment.compressed )
+               return segment;
+         }
+         return {};
+      }
+
+      void block_log_impl::compress_segment( const log_segment& segment ) {
+         const auto name = segment_name( segment.first_block_num, segment.last_block_num );
+         const auto compressed_file = data_dir / (name + ".zlog");
+         const auto tmp_file = data_dir / (name + ".zlog.tmp");
+
+         try {
+            std::fstream out;
+            out.exceptions(std::fstream::failbit | std::fstream::badbit);
+            // truncated, as a file left by an earlier attempt must not be appended to
+            out.open(tmp_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+            const uint32_t header[] = { compressed_segment_version, segment.first_block_num, segment.last_block_num };
+            out.write((char*)header, sizeof(header));
+            auto data = fc::raw::pack( segment.read_genesis() );
+            out.write(data.data(), data.size());
+
+            vector<uint64_t> positions;
+            positions.reserve( segment.num_blocks() );
+            uint64_t pos = out.tellp();
+            for( uint32_t block_num = segment.first_block_num; block_num <= segment.last_block_num; ++block_num ) {
+               if( stopping ) {
+                  out.close();
+                  fc::remove( tmp_file ); // started over on the next open
+                  return;
+               }
+               const auto stored = segment.stored_block( block_num );
+               const auto compressed = fc::zlib_compress( string( stored.first, stored.second ) );
+               out.write(compressed.data(), compressed.size());
+               positions.push_back( pos );
+               pos += compressed.size();
+            }
+            out.write((char*)positions.data(), positions.size() * sizeof(uint64_t));
+            out.close();
+
+            // the uncompressed files are removed below, so the compressed one must be on disk under its name first
+            sync_path( tmp_file );
+            fc::rename( tmp_file, compressed_file );
+            sync_path( data_dir );
+         } catch( ... ) {
+            // retried from scratch on the next wakeup
+            boost::system::error_code ec;
+            boost::filesystem::remove( tmp_file, ec );
+            throw;
+         }
+
+         log_segment replacement = segment;
+         replacement.compressed = true;
+         replacement.block_file = compressed_file;
+         replacement.index_file = fc::path();
+         replacement.blocks = std::make_shared<const mapped_log_file>( compressed_file );
+         replacement.index.reset();
+         {
+            std::lock_guard<std::mutex> g( read_mutex );
+            auto itr = std::find_if( segments->begin(), segments->end(), [&]( const log_segment& s ) {
+               return s.first_block_num == segment.first_block_num && !s.compressed;
+            });
+            if( itr == segments->end() ) {
+               // pruned while it was being compressed
+               fc::remove( compressed_file );
+               return;
+            }
+            auto updated = std::make_shared<segment_list>( *segments );
+            (*updated)[itr - segments->begin()] = std::move( replacement );
+            segments = std::move( updated );
+         }
+         // readers still holding the old mappings keep their pages
+         fc::remove( segment.block_file );
+         fc::remove( segment.index_file );
+         ilog( "Compressed block log segment ${name}", ("name", name) );
+      }
+
+      void block_log_impl::prune_segments() {
+         if( !segment_config.retained_segments )
+            return;
+
+         segment_list pruned;
+         {
+            std::lock_guard<std::mutex> g( read_mutex );
+            if( segments->size() <= segment_config.retained_segments )
+               return;
+            const auto split = segments->begin() + (segments->size() - segment_config.retained_segments);
+            pruned.assign( segments->begin(), split );
+            segments = std::make_shared<const segment_list>( split, segments->end() );
+         }
+
+         const auto& archive_dir = segment_config.archive_dir;
+         if( !archive_dir.string().empty() && !fc::is_directory( archive_dir ) )
+            fc::create_directories( archive_dir );
+         for( const auto& segment : pruned ) {
+            vector<fc::path> files{ segment.block_file };
+            if( !segment.compressed )
+               files.push_back( segment.index_file );
+            for( const auto& file : files ) {
+               if( archive_dir.string().empty() )
+                  fc::remove( file );
+               else
+                  fc::rename( file, archive_dir / file.filename() );
+            }
+            ilog( "Pruned block log segment ${file}", ("file", segment.block_file) );
+         }
+      }
    }
 
-   block_log::block_log(const fc::path& data_dir)
+   block_log::block_log(const fc::path& data_dir, const block_log_segment_config& segments)
    :my(new detail::block_log_impl()) {
       my->block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
       my->index_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+      my->segment_config = segments;
       open(data_dir);
    }
 
@@ -93,6 +574,7 @@ namespace dccio { namespace chain {
    }
 
    void block_log::open(const fc::path& data_dir) {
+      my->unpublish();
       if (my->block_stream.is_open())
          my->block_stream.close();
       if (my->index_stream.is_open())
@@ -100,9 +582,20 @@ namespace dccio { namespace chain {
 
       if (!fc::is_directory(data_dir))
          fc::create_directories(data_dir);
+      my->data_dir = data_dir;
       my->block_file = data_dir / "blocks.log";
       my->index_file = data_dir / "blocks.index";
 
+      // a blocks.log written aside while sealing the previous one, which is complete if that was renamed
+      auto next_block_file = data_dir / "blocks.log.tmp";
+      if (fc::exists(next_block_file)) {
+         if (fc::exists(my->block_file))
+            fc::remove(next_block_file);
+         else
+            fc::rename(next_block_file, my->block_file);
+      }
+      my->load_segments();
+
       //ilog("Opening block log at ${path}", ("path", my->block_file.generic_string()));
       my->block_stream.open(my->block_file.generic_string().c_str(), LOG_WRITE);
       my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
@@ -130,6 +623,15 @@ namespace dccio { namespace chain {
       auto log_size = fc::file_size(my->block_file);
       auto index_size = fc::file_size(my->index_file);
 
+      if (!log_size && !my->segments->empty()) {
+         // lost while sealing the last segment, so blocks.log continues after it
+         const auto& last_segment = my->segments->back();
+         ilog("Log is empty, starting it after block log segment ${file}", ("file", last_segment.block_file));
+         detail::write_log_header(my->block_stream, max_supported_version, last_segment.last_block_num + 1, last_segment.read_genesis());
+         my->block_stream.flush();
+         log_size = fc::file_size(my->block_file);
+      }
+
       if (log_size) {
          ilog("Log is nonempty");
          my->check_block_read();
@@ -150,11 +652,24 @@ namespace dccio { namespace chain {
          } else {
             my->first_block_num = 1;
          }
+         dcc_ASSERT( my->segments->empty() || my->segments->back().last_block_num + 1 == my->first_block_num, block_log_exception,
+                     "Block log does not continue from its last segment ${file}", ("file", my->segments->back().block_file) );
 
+         my->publish( 0 );
          my->head = read_head();
-         my->head_id = my->head->id();
-
-         if (index_size) {
+         if (my->head)
+            my->head_id = my->head->id();
+         my->unpublish(); // the index may be rebuilt below
+
+         if (!my->head_file_block_num()) {
+            if (index_size) {
+               ilog("Log has no blocks, remove the index");
+               my->index_stream.close();
+               fc::remove_all(my->index_file);
+               my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
+               my->index_write = true;
+            }
+         } else if (index_size) {
             my->check_block_read();
             my->check_index_read();
 
@@ -185,6 +700,13 @@ namespace dccio { namespace chain {
          my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
          my->index_write = true;
       }
+
+      flush();
+      my->publish( my->head_file_block_num() );
+
+      // compress and prune what an earlier run left behind
+      my->start_segment_thread();
+      my->notify_segment_thread();
    }
 
    uint64_t block_log::append(const signed_block_ptr& b) {
@@ -208,18 +730,78 @@ namespace dccio { namespace chain {
          my->head_id = b->id();
 
          flush();
+         my->publish( b->block_num() );
+
+         // not while reset() is still writing the header, which it marks with version 0
+         if (my->segment_config.segment_size && my->version && pos + data.size() + sizeof(pos) >= my->segment_config.segment_size)
+            seal_head_log();
 
          return pos;
       }
       FC_LOG_AND_RETHROW()
    }
 
+   void block_log::seal_head_log() {
+      const uint32_t last_block_num = my->head->block_num();
+      const auto name = detail::segment_name(my->first_block_num, last_block_num);
+      const auto next_block_file = my->data_dir / "blocks.log.tmp";
+      ilog("Sealing block log segment ${name}", ("name", name));
+
+      // the next blocks.log is written aside first, so open() can recover from a crash at any point below
+      {
+         std::fstream next_stream;
+         next_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+         next_stream.open(next_block_file.generic_string().c_str(), LOG_WRITE);
+         detail::write_log_header(next_stream, max_supported_version, last_block_num + 1, extract_genesis_state(my->data_dir));
+      }
+      flush();
+      my->block_stream.close();
+      my->index_stream.close();
+
+      detail::log_segment segment;
+      segment.first_block_num = my->first_block_num;
+      segment.last_block_num = last_block_num;
+      segment.block_file = my->data_dir / (name + ".log");
+      segment.index_file = my->data_dir / (name + ".index");
+      {
+         // readers must not map the new blocks.log with the size of the old one
+         std::lock_guard<std::mutex> g( my->read_mutex );
+         fc::rename(my->index_file, segment.index_file);
+         fc::rename(my->block_file, segment.block_file);
+         fc::rename(next_block_file, my->block_file);
+
+         segment.blocks = std::make_shared<const detail::mapped_log_file>(segment.block_file);
+         segment.index = std::make_shared<const detail::mapped_log_file>(segment.index_file);
+         auto segments = std::make_shared<detail::segment_list>(*my->segments);
+         segments->emplace_back(std::move(segment));
+         my->segments = std::move(segments);
+
+         my->version = max_supported_version;
+         my->first_block_num = last_block_num + 1;
+         my->block_map.reset();
+         my->index_map.reset();
+         my->block_file_size = fc::file_size(my->block_file);
+         my->index_file_size = 0;
+         my->published_first_block_num = my->first_block_num;
+         my->published_head_block_num = 0;
+      }
+
+      my->block_stream.open(my->block_file.generic_string().c_str(), LOG_WRITE);
+      my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
+      my->block_write = true;
+      my->index_write = true;
+
+      my->notify_segment_thread();
+   }
+
    void block_log::flush() {
       my->block_stream.flush();
       my->index_stream.flush();
    }
 
    void block_log::reset( const genesis_state& gs, const signed_block_ptr& first_block, uint32_t first_block_num ) {
+      my->unpublish();
+      my->remove_segments();
       if (my->block_stream.is_open())
          my->block_stream.close();
       if (my->index_stream.is_open())
@@ -233,18 +815,13 @@ namespace dccio { namespace chain {
       my->block_write = true;
       my->index_write = true;
 
-      auto data = fc::raw::pack(gs);
+      my->head.reset();
+      my->head_id = block_id_type();
       my->version = 0; // version of 0 is invalid; it indicates that the genesis was not properly written to the block log
       my->first_block_num = first_block_num;
-      my->block_stream.write((char*)&my->version, sizeof(my->version));
-      my->block_stream.write((char*)&my->first_block_num, sizeof(my->first_block_num));
-      my->block_stream.write(data.data(), data.size());
+      detail::write_log_header(my->block_stream, my->version, my->first_block_num, gs);
       my->genesis_written_to_block_log = true;
 
-      // append a totem to indicate the division between blocks and header
-      auto totem = npos;
-      my->block_stream.write((char*)&totem, sizeof(totem));
-
       if (first_block) {
          append(first_block);
       }
@@ -263,25 +840,32 @@ namespace dccio { namespace chain {
 
       my->block_write = false;
       my->check_block_write(); // Reset to append-only writing.
+
+      my->publish( my->head_file_block_num() );
    }
 
    std::pair<signed_block_ptr, uint64_t> block_log::read_block(uint64_t pos)const {
-      my->check_block_read();
-
-      my->block_stream.seekg(pos);
       std::pair<signed_block_ptr,uint64_t> result;
       result.first = std::make_shared<signed_block>();
-      fc::raw::unpack(my->block_stream, *result.first);
-      result.second = uint64_t(my->block_stream.tellg()) + 8;
+      result.second = my->view().read_block(pos, *result.first);
       return result;
    }
 
    signed_block_ptr block_log::read_block_by_num(uint32_t block_num)const {
       try {
+         const auto view = my->view();
          signed_block_ptr b;
-         uint64_t pos = get_block_pos(block_num);
-         if (pos != npos) {
-            b = read_block(pos).first;
+         if (const auto segment = view.find_segment(block_num)) {
+            b = std::make_shared<signed_block>();
+            segment->read_block(block_num, *b);
+         } else {
+            uint64_t pos = view.get_block_pos(block_num);
+            if (pos != npos) {
+               b = std::make_shared<signed_block>();
+               view.read_block(pos, *b);
+            }
+         }
+         if (b) {
             dcc_ASSERT(b->block_num() == block_num, reversible_blocks_exception,
                       "Wrong block was read from block log.", ("returned", b->block_num())("expected", block_num));
          }
@@ -289,33 +873,72 @@ namespace dccio { namespace chain {
       } FC_LOG_AND_RETHROW()
    }
 
+   vector<signed_block_ptr> block_log::read_blocks(uint32_t first_block_num, uint32_t last_block_num)const {
+      try {
+         const auto view = my->view();
+         vector<signed_block_ptr> blocks;
+         first_block_num = std::max(first_block_num, view.first_retained_block_num());
+         last_block_num = std::min(last_block_num, view.last_block_num());
+         if (first_block_num > last_block_num)
+            return blocks;
+
+         blocks.reserve(last_block_num - first_block_num + 1);
+         auto append_block = [&](signed_block_ptr b, uint32_t block_num) {
+            dcc_ASSERT(b->block_num() == block_num, reversible_blocks_exception,
+                      "Wrong block was read from block log.", ("returned", b->block_num())("expected", block_num));
+            blocks.emplace_back(std::move(b));
+         };
+
+         uint32_t block_num = first_block_num;
+         for (; block_num <= last_block_num; ++block_num) {
+            const auto segment = view.find_segment(block_num);
+            if (!segment)
+               break;
+            auto b = std::make_shared<signed_block>();
+            segment->read_block(block_num, *b);
+            append_block(std::move(b), block_num);
+         }
+
+         if (block_num <= last_block_num) {
+            // blocks are laid out in order, so only the first needs to be looked up in the index
+            uint64_t pos = view.get_block_pos(block_num);
+            for (; block_num <= last_block_num; ++block_num) {
+               auto b = std::make_shared<signed_block>();
+               pos = view.read_block(pos, *b);
+               append_block(std::move(b), block_num);
+            }
+         }
+         return blocks;
+      } FC_LOG_AND_RETHROW()
+   }
+
    uint64_t block_log::get_block_pos(uint32_t block_num) const {
-      my->check_index_read();
-      if (!(my->head && block_num <= block_header::num_from_id(my->head_id) && block_num >= my->first_block_num))
-         return npos;
-      my->index_stream.seekg(sizeof(uint64_t) * (block_num - my->first_block_num));
-      uint64_t pos;
-      my->index_stream.read((char*)&pos, sizeof(pos));
-      return pos;
+      return my->view().get_block_pos(block_num);
    }
 
    signed_block_ptr block_log::read_head()const {
-      my->check_block_read();
+      const auto view = my->view();
 
       uint64_t pos;
 
       // Check that the file is not empty
-      my->block_stream.seekg(0, std::ios::end);
-      if (my->block_stream.tellg() <= sizeof(pos))
-         return {};
+      if (view.blocks && view.blocks->size() > sizeof(pos)) {
+         pos = view.blocks->read_pos(view.blocks->size() - sizeof(pos));
+         if (pos != npos) {
+            auto b = std::make_shared<signed_block>();
+            view.read_block(pos, *b);
+            return b;
+         }
+      }
 
-      my->block_stream.seekg(-sizeof(pos), std::ios::end);
-      my->block_stream.read((char*)&pos, sizeof(pos));
-      if (pos != npos) {
-         return read_block(pos).first;
-      } else {
-         return {};
+      // all blocks are in sealed segments
+      if (!view.segments->empty()) {
+         const auto& segment = view.segments->back();
+         auto b = std::make_shared<signed_block>();
+         segment.read_block(segment.last_block_num, *b);
+         return b;
       }
+      return {};
    }
 
    const signed_block_ptr& block_log::head()const {
@@ -323,7 +946,8 @@ namespace dccio { namespace chain {
    }
 
    uint32_t block_log::first_block_num() const {
-      return my->first_block_num;
+      std::lock_guard<std::mutex> g( my->read_mutex );
+      return my->segments->empty() ? my->first_block_num : my->segments->front().first_block_num;
    }
 
    void block_log::construct_index() {
@@ -390,6 +1014,20 @@ namespace dccio { namespace chain {
       fc::create_directories(blocks_dir);
       auto block_log_path = blocks_dir / "blocks.log";
 
+      // sealed segments are not repaired, only blocks.log is, so they are linked back unchanged
+      for( fc::directory_iterator itr( backup_dir ), end; itr != end; ++itr ) {
+         uint32_t first = 0, last = 0;
+         string extension;
+         const auto file_name = (*itr).filename().generic_string();
+         if( !detail::parse_segment_file_name( file_name, first, last, extension ) || extension == "zlog.tmp" )
+            continue;
+         try {
+            fc::create_hard_link( *itr, blocks_dir / file_name );
+         } catch( const fc::exception& ) {
+            fc::copy( *itr, blocks_dir / file_name );
+         }
+      }
+
       ilog( "Reconstructing '${new_block_log}' from backed up block log", ("new_block_log", block_log_path) );
 
       std::fstream  old_block_stream;
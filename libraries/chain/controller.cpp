@@ -16,9 +16,12 @@
 #include <dccio/chain/authorization_manager.hpp>
 #include <dccio/chain/resource_limits.hpp>
 #include <dccio/chain/chain_snapshot.hpp>
+#include <dccio/chain/thread_utils.hpp>
 
 #include <chainbase/chainbase.hpp>
 #include <fc/io/json.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/shared_lock_guard.hpp>
 #include <fc/scoped_exit.hpp>
 
 #include <fc/variant_object.hpp>
@@ -129,6 +132,29 @@ struct controller_impl {
    bool                           replaying= false;
    optional<fc::time_point>       replay_head_time;
    db_read_mode                   read_mode = db_read_mode::SPECULATIVE;
+   optional<boost::asio::thread_pool> thread_pool;
+   mutable abi_serializer_cache   abi_cache;
+
+   /// shared by with_read_view, exclusive while chain state is modified; boost's shared_mutex does not starve the writer
+   mutable boost::shared_mutex    read_view_mutex;
+   uint32_t                       read_view_exclusions = 0;
+
+   /**
+    * Held by the controller methods that modify chain state. Reentrant, as they emit signals whose handlers may call
+    * other such methods; only the main thread modifies chain state.
+    */
+   struct read_view_exclusion {
+      explicit read_view_exclusion( controller_impl& impl ):impl(impl) {
+         if( impl.read_view_exclusions == 0 )
+            impl.read_view_mutex.lock();
+         ++impl.read_view_exclusions;
+      }
+      ~read_view_exclusion() {
+         if( --impl.read_view_exclusions == 0 )
+            impl.read_view_mutex.unlock();
+      }
+      controller_impl& impl;
+   };
    bool                           in_trx_requiring_checks = false; ///< if true, checks that are normally skipped on replay (e.g. auth checks) cannot be skipped
    optional<fc::microseconds>     subjective_cpu_leeway;
    bool                           trusted_producer_light_validation = false;
@@ -144,6 +170,13 @@ struct controller_impl {
     */
    map<digest_type, transaction_metadata_ptr>     unapplied_transactions;
 
+   /**
+    *  transaction_metadata of the packed transactions of blocks that were received but not yet applied, created on
+    *  the thread pool so that unpacking, hashing and signature recovery of a block are spread over all workers.
+    *  Entries are indexed like signed_block::transactions, receipts of scheduled transactions hold no future.
+    */
+   map<signed_block_ptr, vector<std::future<transaction_metadata_ptr>>> block_trx_metas;
+
    void pop_block() {
       auto prev = fork_db.get_block( head->header.previous );
       dcc_ASSERT( prev, block_validate_exception, "attempt to pop beyond last irreversible block" );
@@ -172,18 +205,20 @@ struct controller_impl {
    :self(s),
     db( cfg.state_dir,
         cfg.read_only ? database::read_only : database::read_write,
-        cfg.state_size ),
+        cfg.state_size, false, cfg.state_map_mode, cfg.state_hugepage_size ),
     reversible_blocks( cfg.blocks_dir/config::reversible_blocks_dir_name,
         cfg.read_only ? database::read_only : database::read_write,
         cfg.reversible_cache_size ),
-    blog( cfg.blocks_dir ),
+    blog( cfg.blocks_dir, cfg.blocks_log_segments ),
     fork_db( cfg.state_dir ),
-    wasmif( cfg.wasm_runtime ),
+    wasmif( cfg.wasm_runtime, cfg.wasm_code_cache_dir,
+            { cfg.wasm_cache_max_entries, cfg.wasm_cache_max_bytes, cfg.wasm_cache_pinned_accounts } ),
     resource_limits( db ),
     authorization( s, db ),
     conf( cfg ),
     chain_id( cfg.genesis.compute_chain_id() ),
-    read_mode( cfg.read_mode )
+    read_mode( cfg.read_mode ),
+    abi_cache( cfg.abi_serializer_cache_size )
    {
 
 #define SET_APP_HANDLER( receiver, contract, action) \
@@ -204,6 +239,8 @@ struct controller_impl {
 
    SET_APP_HANDLER( dccio, dccio, canceldelay );
 
+   thread_pool.emplace( cfg.thread_pool_size );
+
    fork_db.irreversible.connect( [&]( auto b ) {
                                  on_irreversible(b);
                                  });
@@ -304,12 +341,19 @@ struct controller_impl {
       ilog( "existing block log, attempting to replay ${n} blocks", ("n",blog_head->block_num()) );
 
       auto start = fc::time_point::now();
-      while( auto next = blog.read_block_by_num( head->block_num + 1 ) ) {
+      auto next = blog.read_block_by_num( head->block_num + 1 );
+      while( next ) {
+         // read and start preparing the following block while this one is being applied
+         auto following = blog.read_block_by_num( next->block_num() + 1 );
+         if( following )
+            prepare_block_trx_metas( following, controller::block_status::irreversible );
          self.push_block( next, controller::block_status::irreversible );
          if( next->block_num() % 100 == 0 ) {
             std::cerr << std::setw(10) << next->block_num() << " of " << blog_head->block_num() <<"\r";
          }
+         next = std::move( following );
       }
+      block_trx_metas.clear();
       std::cerr<< "\n";
       ilog( "${n} blocks replayed", ("n", head->block_num) );
 
@@ -391,6 +435,9 @@ struct controller_impl {
    }
 
    ~controller_impl() {
+      thread_pool->stop();
+      thread_pool->join();
+
       pending.reset();
 
       db.flush();
@@ -1155,19 +1202,57 @@ struct controller_impl {
       static_cast<signed_block_header&>(*p->block) = p->header;
    } /// sign_block
 
+   /**
+    *  Starts creating the transaction_metadata of every packed transaction of b on the thread pool, recovering the
+    *  signing keys as well unless authorization checks can be skipped for a block of status s.
+    *  Does nothing if b is already being prepared.
+    */
+   void prepare_block_trx_metas( const signed_block_ptr& b, controller::block_status s ) {
+      if( block_trx_metas.find( b ) != block_trx_metas.end() )
+         return;
+
+      // mirrors controller::skip_auth_check for a pending block of status s
+      bool skip_auth_check = !in_trx_requiring_checks &&
+                             ( ( !conf.force_all_checks && (s == controller::block_status::irreversible || s == controller::block_status::validated) ) ||
+                               ( s == controller::block_status::complete &&
+                                 (conf.block_validation_mode == validation_mode::LIGHT || conf.trusted_producers.count( b->producer )) ) );
+
+      auto& trx_metas = block_trx_metas[b];
+      trx_metas.reserve( b->transactions.size() );
+      for( const auto& receipt : b->transactions ) {
+         if( receipt.trx.contains<packed_transaction>() ) {
+            const packed_transaction* pt = &receipt.trx.get<packed_transaction>(); // kept alive by capturing b
+            trx_metas.emplace_back( async_thread_pool( *thread_pool, [this, b, pt, skip_auth_check]() {
+               auto mtrx = std::make_shared<transaction_metadata>( *pt );
+               if( !skip_auth_check )
+                  transaction_metadata::create_signing_keys_future( mtrx, *thread_pool, chain_id );
+               return mtrx;
+            } ) );
+         } else {
+            trx_metas.emplace_back();
+         }
+      }
+   }
+
    void apply_block( const signed_block_ptr& b, controller::block_status s ) { try {
       try {
          dcc_ASSERT( b->block_extensions.size() == 0, block_validate_exception, "no supported extensions" );
          auto producer_block_id = b->id();
+
+         prepare_block_trx_metas( b, s );
+         auto trx_metas = std::move( block_trx_metas[b] );
+         block_trx_metas.erase( b );
+
          start_block( b->timestamp, b->confirmed, s , producer_block_id);
 
          transaction_trace_ptr trace;
 
+         size_t trx_index = 0;
          for( const auto& receipt : b->transactions ) {
             auto num_pending_receipts = pending->_pending_block_state->block->transactions.size();
+            auto& trx_meta = trx_metas.at( trx_index++ );
             if( receipt.trx.contains<packed_transaction>() ) {
-               auto& pt = receipt.trx.get<packed_transaction>();
-               auto mtrx = std::make_shared<transaction_metadata>(pt);
+               auto mtrx = trx_meta.get();
                trace = push_transaction( mtrx, fc::time_point::maximum(), receipt.cpu_usage_us, true );
             } else if( receipt.trx.contains<transaction_id_type>() ) {
                trace = push_scheduled_transaction( receipt.trx.get<transaction_id_type>(), fc::time_point::maximum(), receipt.cpu_usage_us, true );
@@ -1232,6 +1317,14 @@ struct controller_impl {
       try {
          dcc_ASSERT( b, block_validate_exception, "trying to push empty block" );
          dcc_ASSERT( s != controller::block_status::incomplete, block_validate_exception, "invalid block status for a completed block" );
+         // unpack, hash and recover keys of the transactions while the header is being validated,
+         // in irreversible mode the block is only applied once it becomes irreversible
+         if( read_mode != db_read_mode::IRREVERSIBLE )
+            prepare_block_trx_metas( b, s );
+         auto drop_trx_metas = fc::make_scoped_exit([&b, this]() {
+            block_trx_metas.erase( b );
+         });
+
          emit( self.pre_accepted_block, b );
          bool trust = !conf.force_all_checks && (s == controller::block_status::irreversible || s == controller::block_status::validated);
          auto new_header_state = fork_db.add( b, trust );
@@ -1588,6 +1681,7 @@ void controller::add_indices() {
 }
 
 void controller::startup( const snapshot_reader_ptr& snapshot ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->head = my->fork_db.head();
    if( !my->head ) {
       elog( "No head block in fork db, perhaps we need to replay" );
@@ -1599,45 +1693,62 @@ const chainbase::database& controller::db()const { return my->db; }
 
 chainbase::database& controller::mutable_db()const { return my->db; }
 
+boost::asio::thread_pool& controller::get_thread_pool() { return *my->thread_pool; }
+
+void controller::with_read_view( const std::function<void()>& f )const {
+   boost::shared_lock_guard<boost::shared_mutex> lock( my->read_view_mutex );
+   f();
+}
+
+abi_serializer_cache& controller::get_abi_serializer_cache()const { return my->abi_cache; }
+
 const fork_database& controller::fork_db()const { return my->fork_db; }
 
 
 void controller::start_block( block_timestamp_type when, uint16_t confirm_block_count) {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    my->start_block(when, confirm_block_count, block_status::incomplete, optional<block_id_type>() );
 }
 
 void controller::finalize_block() {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    my->finalize_block();
 }
 
 void controller::sign_block( const std::function<signature_type( const digest_type& )>& signer_callback ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->sign_block( signer_callback );
 }
 
 void controller::commit_block() {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    validate_reversible_available_size();
    my->commit_block(true);
 }
 
 void controller::abort_block() {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->abort_block();
 }
 
 void controller::push_block( const signed_block_ptr& b, block_status s ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    validate_reversible_available_size();
    my->push_block( b, s );
 }
 
 void controller::push_confirmation( const header_confirmation& c ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    my->push_confirmation( c );
 }
 
 transaction_trace_ptr controller::push_transaction( const transaction_metadata_ptr& trx, fc::time_point deadline, uint32_t billed_cpu_time_us ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    dcc_ASSERT( get_read_mode() != chain::db_read_mode::READ_ONLY, transaction_type_exception, "push transaction not allowed in read-only mode" );
    dcc_ASSERT( trx && !trx->implicit && !trx->scheduled, transaction_type_exception, "Implicit/Scheduled transaction not allowed" );
@@ -1646,6 +1757,7 @@ transaction_trace_ptr controller::push_transaction( const transaction_metadata_p
 
 transaction_trace_ptr controller::push_scheduled_transaction( const transaction_id_type& trxid, fc::time_point deadline, uint32_t billed_cpu_time_us )
 {
+   controller_impl::read_view_exclusion exclusion( *my );
    validate_db_available_size();
    return my->push_scheduled_transaction( trxid, deadline, billed_cpu_time_us, billed_cpu_time_us > 0 );
 }
@@ -1670,18 +1782,23 @@ const flat_set<public_key_type>& controller::get_key_blacklist() const {
 }
 
 void controller::set_actor_whitelist( const flat_set<account_name>& new_actor_whitelist ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.actor_whitelist = new_actor_whitelist;
 }
 void controller::set_actor_blacklist( const flat_set<account_name>& new_actor_blacklist ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.actor_blacklist = new_actor_blacklist;
 }
 void controller::set_contract_whitelist( const flat_set<account_name>& new_contract_whitelist ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.contract_whitelist = new_contract_whitelist;
 }
 void controller::set_contract_blacklist( const flat_set<account_name>& new_contract_blacklist ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.contract_blacklist = new_contract_blacklist;
 }
 void controller::set_action_blacklist( const flat_set< pair<account_name, action_name> >& new_action_blacklist ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    for (auto& act: new_action_blacklist) {
       dcc_ASSERT(act.first != account_name(), name_type_exception, "Action blacklist - contract name should not be empty");
       dcc_ASSERT(act.second != action_name(), action_type_exception, "Action blacklist - action name should not be empty");
@@ -1689,6 +1806,7 @@ void controller::set_action_blacklist( const flat_set< pair<account_name, action
    my->conf.action_blacklist = new_action_blacklist;
 }
 void controller::set_key_blacklist( const flat_set<public_key_type>& new_key_blacklist ) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.key_blacklist = new_key_blacklist;
 }
 
@@ -1780,6 +1898,10 @@ signed_block_ptr controller::fetch_block_by_number( uint32_t block_num )const  {
    return my->blog.read_block_by_num(block_num);
 } FC_CAPTURE_AND_RETHROW( (block_num) ) }
 
+vector<signed_block_ptr> controller::fetch_irreversible_blocks_by_number( uint32_t first_block_num, uint32_t last_block_num )const  { try {
+   return my->blog.read_blocks( first_block_num, last_block_num );
+} FC_CAPTURE_AND_RETHROW( (first_block_num)(last_block_num) ) }
+
 block_state_ptr controller::fetch_block_state_by_id( block_id_type id )const {
    auto state = my->fork_db.get_block(id);
    return state;
@@ -1814,6 +1936,7 @@ void controller::write_snapshot( const snapshot_writer_ptr& snapshot ) const {
 }
 
 void controller::pop_block() {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->pop_block();
 }
 
@@ -1952,6 +2075,10 @@ wasm_interface& controller::get_wasm_interface() {
    return my->wasmif;
 }
 
+const wasm_interface& controller::get_wasm_interface()const {
+   return my->wasmif;
+}
+
 const account_object& controller::get_account( account_name name )const
 { try {
    return my->db.get<account_object, by_name>(name);
@@ -2088,10 +2215,12 @@ void controller::set_subjective_cpu_leeway(fc::microseconds leeway) {
 }
 
 void controller::add_resource_greylist(const account_name &name) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.resource_greylist.insert(name);
 }
 
 void controller::remove_resource_greylist(const account_name &name) {
+   controller_impl::read_view_exclusion exclusion( *my );
    my->conf.resource_greylist.erase(name);
 }
 
@@ -166,6 +166,10 @@ void apply_dccio_setcode(apply_context& context) {
       aso.code_sequence += 1;
    });
 
+   // compile the new code off the main thread; the first action sent to it waits for the result
+   if( code_size > 0 )
+      context.control.get_wasm_interface().precompile( act.account, code_id, account.code, context.control.get_thread_pool() );
+
    if (new_size != old_size) {
       context.add_ram_usage( act.account, new_size - old_size );
    }
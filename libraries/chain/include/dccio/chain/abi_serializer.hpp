@@ -4,10 +4,14 @@
  */
 #pragma once
 #include <dccio/chain/abi_def.hpp>
+#include <dccio/chain/abi_writer.hpp>
 #include <dccio/chain/trace.hpp>
 #include <dccio/chain/exceptions.hpp>
 #include <fc/variant_object.hpp>
 #include <fc/scoped_exit.hpp>
+#include <fc/io/json.hpp>
+
+#include <sstream>
 
 namespace dccio { namespace chain {
 
@@ -20,6 +24,8 @@ using namespace fc;
 namespace impl {
    struct abi_from_variant;
    struct abi_to_variant;
+   struct abi_to_writer;
+   class  json_object_writer;
 
    struct abi_traverse_context;
    struct abi_traverse_context_with_path;
@@ -34,6 +40,10 @@ namespace impl {
 struct abi_serializer {
    abi_serializer(){ configure_built_in_types(); }
    abi_serializer( const abi_def& abi, const fc::microseconds& max_serialization_time );
+   abi_serializer( const abi_serializer& other );
+   abi_serializer( abi_serializer&& other ) = default;
+   abi_serializer& operator=( const abi_serializer& other );
+   abi_serializer& operator=( abi_serializer&& other ) = default;
    void set_abi(const abi_def& abi, const fc::microseconds& max_serialization_time);
 
    type_name resolve_type(const type_name& t)const;
@@ -56,6 +66,18 @@ struct abi_serializer {
    fc::variant binary_to_variant( const type_name& type, const bytes& binary, const fc::microseconds& max_serialization_time, bool short_path = false )const;
    fc::variant binary_to_variant( const type_name& type, fc::datastream<const char*>& binary, const fc::microseconds& max_serialization_time, bool short_path = false )const;
 
+   /**
+    * Writes the same JSON as fc::json::to_string of binary_to_variant, straight from the binary without building
+    * the intermediate fc::variant tree.
+    */
+   void        binary_to_json( const type_name& type, fc::datastream<const char*>& binary, std::ostream& out, const fc::microseconds& max_serialization_time, bool short_path = false )const;
+   string      binary_to_json( const type_name& type, const bytes& binary, const fc::microseconds& max_serialization_time, bool short_path = false )const;
+
+   /**
+    * Hands the values binary_to_variant would hold to out as they are read from the binary.
+    */
+   void        binary_to_writer( const type_name& type, fc::datastream<const char*>& binary, abi_writer& out, const fc::microseconds& max_serialization_time, bool short_path = false )const;
+
    bytes       variant_to_binary( const type_name& type, const fc::variant& var, const fc::microseconds& max_serialization_time, bool short_path = false )const;
    void        variant_to_binary( const type_name& type, const fc::variant& var, fc::datastream<char*>& ds, const fc::microseconds& max_serialization_time, bool short_path = false )const;
 
@@ -65,6 +87,24 @@ struct abi_serializer {
    template<typename T, typename Resolver>
    static void from_variant( const fc::variant& v, T& o, Resolver resolver, const fc::microseconds& max_serialization_time );
 
+   /**
+    * Hands the values to_variant would hold to out as it walks o, rendering action data with binary_to_writer.
+    */
+   template<typename T, typename Resolver>
+   static void to_writer( const T& o, abi_writer& out, Resolver resolver, const fc::microseconds& max_serialization_time );
+
+   /**
+    * Writes the JSON of to_variant followed by fc::json::to_string through to_writer.
+    */
+   template<typename T, typename Resolver>
+   static void to_json( const T& o, std::ostream& out, Resolver resolver, const fc::microseconds& max_serialization_time );
+
+   /**
+    * Writes the members of o into an object the caller has opened, so that it can append its own members.
+    */
+   template<typename T, typename Resolver>
+   static void to_json( const T& o, impl::json_object_writer& obj, Resolver resolver, const fc::microseconds& max_serialization_time );
+
    template<typename Vec>
    static bool is_empty_abi(const Vec& abi_vec)
    {
@@ -101,7 +141,45 @@ private:
    map<type_name, pair<unpack_function, pack_function>> built_in_types;
    void configure_built_in_types();
 
+   /**
+    * A type of the ABI with its typedefs, array and optional suffixes, and struct or variant already resolved,
+    * so that (de)serialization follows plan ids instead of looking up type names for every value.
+    * Plans refer into the maps above, so they are rebuilt whenever those change and when the serializer is copied.
+    */
+   struct type_plan {
+      enum kind_type { built_in, array, optional, variant, structure, unknown };
+
+      struct field_plan {
+         uint32_t type; ///< plan of the field type, without its binary extension suffix
+         bool     extension;
+      };
+
+      kind_type                                   kind = unknown;
+      type_name                                   name;     ///< as referenced in the ABI
+      type_name                                   resolved; ///< name with typedefs resolved
+      const pair<unpack_function, pack_function>* built_in_functions = nullptr;
+      bool                                        built_in_array = false;
+      bool                                        built_in_optional = false;
+      uint32_t                                    element = 0; ///< array and optional
+      map<type_name, struct_def>::const_iterator  struct_itr{};
+      map<type_name, variant_def>::const_iterator variant_itr{};
+      fc::optional<uint32_t>                      base;
+      vector<field_plan>                          fields;
+      bool                                        shadowed_fields = false; ///< a field is named like an earlier one, here or in a base
+      vector<uint32_t>                            variant_types;
+   };
+
+   vector<type_plan>          plans;
+   map<type_name, uint32_t>   plan_ids;
+
+   void     compile_plans();
+   uint32_t compile_plan( const type_name& type );
+   const type_plan* find_plan( const type_name& type )const;
+
    fc::variant _binary_to_variant( const type_name& type, const bytes& binary, impl::binary_to_variant_context& ctx )const;
+   fc::variant _binary_to_variant( const type_plan& plan, fc::datastream<const char*>& stream, impl::binary_to_variant_context& ctx )const;
+   void        _binary_to_variant( const type_plan& plan, fc::datastream<const char*>& stream,
+                                   fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const;
    fc::variant _binary_to_variant( const type_name& type, fc::datastream<const char*>& binary, impl::binary_to_variant_context& ctx )const;
    void        _binary_to_variant( const type_name& type, fc::datastream<const char*>& stream,
                                    fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const;
@@ -109,6 +187,14 @@ private:
    bytes       _variant_to_binary( const type_name& type, const fc::variant& var, impl::variant_to_binary_context& ctx )const;
    void        _variant_to_binary( const type_name& type, const fc::variant& var,
                                    fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx )const;
+   void        _variant_to_binary( const type_plan& plan, const fc::variant& var,
+                                   fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx )const;
+
+   void        _binary_to_writer( const type_name& type, const bytes& binary, abi_writer& out, impl::binary_to_variant_context& ctx )const;
+   void        _binary_to_writer( const type_name& type, fc::datastream<const char*>& stream, abi_writer& out, impl::binary_to_variant_context& ctx )const;
+   bool        _binary_to_writer( const type_plan& plan, fc::datastream<const char*>& stream, abi_writer& out, impl::binary_to_variant_context& ctx )const;
+   void        _binary_to_writer( const type_plan& plan, fc::datastream<const char*>& stream, abi_writer& out,
+                                  size_t& fields_written, impl::binary_to_variant_context& ctx )const;
 
    static type_name _remove_bin_extension(const type_name& type);
    bool _is_type( const type_name& type, impl::abi_traverse_context& ctx )const;
@@ -117,6 +203,7 @@ private:
 
    friend struct impl::abi_from_variant;
    friend struct impl::abi_to_variant;
+   friend struct impl::abi_to_writer;
    friend struct impl::abi_traverse_context_with_path;
 };
 
@@ -380,7 +467,7 @@ namespace impl {
 
          try {
             auto abi = resolver(act.account);
-            if (abi.valid()) {
+            if (abi) {
                auto type = abi->get_action_type(act.name);
                if (!type.empty()) {
                   try {
@@ -467,6 +554,229 @@ namespace impl {
          abi_traverse_context& _ctx;
    };
 
+   /**
+    * Writes v as the abi_writer's variant_value of fc::variant(v) would; the overloads below cover the types repeated
+    * in every trace and block, which are written without building an fc::variant
+    */
+   template<typename T>
+   void write_value( abi_writer& out, const T& v ) {
+      out.variant_value( fc::variant(v) );
+   }
+
+   void write_value( abi_writer& out, bool v );
+   void write_value( abi_writer& out, uint64_t v );
+   void write_value( abi_writer& out, int64_t v );
+   void write_value( abi_writer& out, uint32_t v );
+   void write_value( abi_writer& out, const string& v );
+   void write_value( abi_writer& out, const fc::unsigned_int& v );
+   void write_value( abi_writer& out, const fc::microseconds& v );
+   void write_value( abi_writer& out, const fc::sha256& v );
+   void write_value( abi_writer& out, const name& v );
+   void write_value( abi_writer& out, const permission_level& v );
+   void write_value( abi_writer& out, const vector<permission_level>& v );
+   void write_value( abi_writer& out, const action_receipt& v );
+   void write_value( abi_writer& out, const account_delta& v );
+   void write_value( abi_writer& out, const flat_set<account_delta>& v );
+
+   template<typename T>
+   void write_value( abi_writer& out, const fc::optional<T>& v ) {
+      if( v )
+         write_value( out, *v );
+      else
+         out.null_value();
+   }
+
+   /**
+    * Writes the members of a JSON object in the format of fc::json::to_string
+    */
+   class json_object_writer {
+      public:
+         explicit json_object_writer( std::ostream& out )
+         :writer(out)
+         {
+            writer.begin_object();
+         }
+
+         /// starts the member called name and returns the stream its value is written to
+         std::ostream& key( const char* name ) {
+            writer.key( name );
+            return writer.raw_value();
+         }
+
+         template<typename T>
+         json_object_writer& operator()( const char* name, const T& v ) {
+            writer.key( name );
+            write_value( writer, v );
+            return *this;
+         }
+
+         void close() {
+            writer.end_object();
+         }
+
+         /// writes further members of the object
+         abi_writer& get_writer() { return writer; }
+
+      private:
+         json_writer writer;
+   };
+
+   /**
+    * Counterpart of abi_to_variant that hands the values to an abi_writer as it walks the object; types without
+    * ABI related info are written through write_value
+    */
+   struct abi_to_writer {
+      template<typename M, typename Resolver, not_require_abi_t<M> = 1>
+      static void write( abi_writer& out, const M& v, Resolver, abi_traverse_context& ctx )
+      {
+         auto h = ctx.enter_scope();
+         write_value( out, v );
+      }
+
+      template<typename M, typename Resolver, require_abi_t<M> = 1>
+      static void write( abi_writer& out, const M& v, Resolver resolver, abi_traverse_context& ctx );
+
+      template<typename M, typename Resolver, require_abi_t<M> = 1>
+      static void write( abi_writer& out, const vector<M>& v, Resolver resolver, abi_traverse_context& ctx )
+      {
+         auto h = ctx.enter_scope();
+         out.begin_array();
+         for( const auto& e : v )
+            write(out, e, resolver, ctx);
+         out.end_array();
+      }
+
+      template<typename Resolver>
+      struct write_static_variant
+      {
+         abi_writer& out;
+         Resolver& resolver;
+         abi_traverse_context& ctx;
+
+         write_static_variant( abi_writer& o, Resolver& r, abi_traverse_context& ctx )
+               :out(o), resolver(r), ctx(ctx) {}
+
+         typedef void result_type;
+         template<typename T> void operator()( T& v )const
+         {
+            write(out, v, resolver, ctx);
+         }
+      };
+
+      template<typename Resolver, typename... Args>
+      static void write( abi_writer& out, const fc::static_variant<Args...>& v, Resolver resolver, abi_traverse_context& ctx )
+      {
+         auto h = ctx.enter_scope();
+         write_static_variant<Resolver> writer(out, resolver, ctx);
+         v.visit(writer);
+      }
+
+      template<typename Resolver>
+      static void write( abi_writer& out, const action& act, Resolver resolver, abi_traverse_context& ctx )
+      {
+         auto h = ctx.enter_scope();
+         out.begin_object();
+         out.key("account");
+         write_value(out, act.account);
+         out.key("name");
+         write_value(out, act.name);
+         out.key("authorization");
+         write_value(out, act.authorization);
+
+         // data is rendered aside so that a failure part way through falls back to the hex data
+         out.key("data");
+         bool rendered = false;
+         try {
+            auto abi = resolver(act.account);
+            if (abi) {
+               auto type = abi->get_action_type(act.name);
+               if (!type.empty()) {
+                  try {
+                     binary_to_variant_context _ctx(*abi, ctx, type);
+                     _ctx.short_path = true; // Just to be safe while avoiding the complexity of threading an override boolean all over the place
+                     out.try_value( [&]( abi_writer& data ) {
+                        abi->_binary_to_writer( type, act.data, data, _ctx );
+                     } );
+                     rendered = true;
+                  } catch(...) {
+                     rendered = false;
+                  }
+               }
+            }
+         } catch(...) {
+            rendered = false;
+         }
+         if( rendered )
+            out.key("hex_data");
+         write_value(out, act.data);
+         out.end_object();
+      }
+
+      template<typename Resolver>
+      static void write( abi_writer& out, const packed_transaction& ptrx, Resolver resolver, abi_traverse_context& ctx )
+      {
+         auto h = ctx.enter_scope();
+         out.begin_object();
+         auto trx = ptrx.get_transaction();
+         out.key("id");
+         write_value(out, trx.id());
+         out.key("signatures");
+         write_value(out, ptrx.signatures);
+         out.key("compression");
+         write_value(out, ptrx.compression);
+         out.key("packed_context_free_data");
+         write_value(out, ptrx.packed_context_free_data);
+         out.key("context_free_data");
+         write_value(out, ptrx.get_context_free_data());
+         out.key("packed_trx");
+         write_value(out, ptrx.packed_trx);
+         out.key("transaction");
+         write(out, trx, resolver, ctx);
+         out.end_object();
+      }
+
+      template<typename M, typename Resolver>
+      static void add( abi_writer& out, const char* name, const M& v, Resolver resolver, abi_traverse_context& ctx )
+      {
+         out.key(name);
+         write(out, v, resolver, ctx);
+      }
+
+      /// like abi_to_variant, an empty shared_ptr leaves the member out
+      template<typename M, typename Resolver, require_abi_t<M> = 1>
+      static void add( abi_writer& out, const char* name, const std::shared_ptr<M>& v, Resolver resolver, abi_traverse_context& ctx )
+      {
+         auto h = ctx.enter_scope();
+         if( !v ) return;
+         out.key(name);
+         write(out, *v, resolver, ctx);
+      }
+   };
+
+   template<typename T, typename Resolver>
+   class abi_to_writer_visitor
+   {
+      public:
+         abi_to_writer_visitor( abi_writer& _out, const T& _val, Resolver _resolver, abi_traverse_context& _ctx )
+         :_out(_out)
+         ,_val(_val)
+         ,_resolver(_resolver)
+         ,_ctx(_ctx)
+         {}
+
+         template<typename Member, class Class, Member (Class::*member) >
+         void operator()( const char* name )const
+         {
+            abi_to_writer::add( _out, name, (_val.*member), _resolver, _ctx );
+         }
+
+      private:
+         abi_writer& _out;
+         const T& _val;
+         Resolver _resolver;
+         abi_traverse_context& _ctx;
+   };
+
    struct abi_from_variant {
       /**
        * template which overloads extract for types which are not relvant to ABI information
@@ -545,7 +855,7 @@ namespace impl {
                valid_empty_data = act.data.empty();
             } else if ( data.is_object() ) {
                auto abi = resolver(act.account);
-               if (abi.valid()) {
+               if (abi) {
                   auto type = abi->get_action_type(act.name);
                   if (!type.empty()) {
                      variant_to_binary_context _ctx(*abi, ctx, type);
@@ -655,6 +965,15 @@ namespace impl {
       mvo(name, std::move(member_mvo));
    }
 
+   template<typename M, typename Resolver, require_abi_t<M>>
+   void abi_to_writer::write( abi_writer& out, const M& v, Resolver resolver, abi_traverse_context& ctx )
+   {
+      auto h = ctx.enter_scope();
+      out.begin_object();
+      fc::reflector<M>::visit( impl::abi_to_writer_visitor<M, Resolver>( out, v, resolver, ctx ) );
+      out.end_object();
+   }
+
    template<typename M, typename Resolver, require_abi_t<M>>
    void abi_from_variant::extract( const variant& v, M& o, Resolver resolver, abi_traverse_context& ctx )
    {
@@ -672,6 +991,25 @@ void abi_serializer::to_variant( const T& o, variant& vo, Resolver resolver, con
    vo = std::move(mvo["_"]);
 } FC_RETHROW_EXCEPTIONS(error, "Failed to serialize type", ("object",o))
 
+template<typename T, typename Resolver>
+void abi_serializer::to_writer( const T& o, abi_writer& out, Resolver resolver, const fc::microseconds& max_serialization_time ) try {
+   impl::abi_traverse_context ctx(max_serialization_time);
+   impl::abi_to_writer::write(out, o, resolver, ctx);
+} FC_RETHROW_EXCEPTIONS(error, "Failed to serialize type", ("object",o))
+
+template<typename T, typename Resolver>
+void abi_serializer::to_json( const T& o, std::ostream& out, Resolver resolver, const fc::microseconds& max_serialization_time ) {
+   json_writer writer(out);
+   to_writer(o, writer, resolver, max_serialization_time);
+}
+
+template<typename T, typename Resolver>
+void abi_serializer::to_json( const T& o, impl::json_object_writer& obj, Resolver resolver, const fc::microseconds& max_serialization_time ) try {
+   impl::abi_traverse_context ctx(max_serialization_time);
+   auto h = ctx.enter_scope();
+   fc::reflector<T>::visit( impl::abi_to_writer_visitor<T, Resolver>( obj.get_writer(), o, resolver, ctx ) );
+} FC_RETHROW_EXCEPTIONS(error, "Failed to serialize type", ("object",o))
+
 template<typename T, typename Resolver>
 void abi_serializer::from_variant( const variant& v, T& o, Resolver resolver, const fc::microseconds& max_serialization_time ) try {
    impl::abi_traverse_context ctx(max_serialization_time);
@@ -0,0 +1,75 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#pragma once
+
+#include <dccio/chain/abi_serializer.hpp>
+#include <dccio/chain/multi_index_includes.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <chainbase/chainbase.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace dccio { namespace chain {
+
+   /**
+    * Bounded, least recently used cache of abi_serializers, one per account, keyed by the account's abi_sequence.
+    *
+    * Building an abi_serializer unpacks and validates the whole ABI, so API and history code that serializes
+    * actions and table rows shares serializers through this cache instead of rebuilding them per request.
+    * A setabi bumps the account's abi_sequence, which replaces the entry on its next lookup.
+    *
+    * Cached serializers are immutable and may be used concurrently; the cache itself is thread safe.
+    */
+   class abi_serializer_cache {
+      public:
+         using serializer_ptr = std::shared_ptr<const abi_serializer>;
+
+         explicit abi_serializer_cache( size_t max_entries );
+
+         /**
+          * Serializer for the ABI currently set on account n in db, or null if n has no ABI.
+          * The cached ABI bytes are compared with the account's, so a sequence number reused on another fork
+          * does not return a stale serializer.
+          */
+         serializer_ptr get( const chainbase::database& db, account_name n, const fc::microseconds& max_serialization_time );
+
+         /**
+          * Serializer for account n at abi_sequence, calling make_serializer on a miss.
+          * A null result from make_serializer is returned but not cached.
+          */
+         serializer_ptr get( account_name n, uint64_t abi_sequence, const std::function<serializer_ptr()>& make_serializer );
+
+         void   invalidate( account_name n );
+         void   clear();
+         size_t size()const;
+
+      private:
+         struct entry {
+            account_name   account;
+            uint64_t       abi_sequence = 0;
+            std::string    abi; ///< packed abi_def, empty when the entry was not built from chain state
+            serializer_ptr serializer;
+         };
+
+         struct by_account;
+         typedef bmi::multi_index_container<
+            entry,
+            indexed_by<
+               bmi::sequenced<>, // most recently used first
+               ordered_unique<tag<by_account>, member<entry, account_name, &entry::account>>
+            >
+         > entry_index;
+
+         serializer_ptr find( account_name n, uint64_t abi_sequence, const char* abi, size_t abi_size );
+         void           store( entry e );
+
+         mutable std::mutex mtx;
+         entry_index        entries;
+         size_t             max_entries;
+   };
+
+} } // dccio::chain
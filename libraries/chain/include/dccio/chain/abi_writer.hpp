@@ -0,0 +1,121 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#pragma once
+#include <fc/variant.hpp>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dccio { namespace chain {
+
+using std::string;
+
+/**
+ *  Receives the values abi_serializer walks, in the order fc::json::to_string of its fc::variant would write them,
+ *  so that a format other than JSON can be produced without building the fc::variant or the JSON text.
+ *
+ *  Each value in an object is preceded by the key() naming it; values in an array are not.
+ */
+class abi_writer {
+   public:
+      virtual ~abi_writer() {}
+
+      virtual void begin_object() = 0;
+      virtual void key( const string& name ) = 0;
+      virtual void end_object() = 0;
+      virtual void begin_array() = 0;
+      virtual void end_array() = 0;
+
+      virtual void null_value() = 0;
+      virtual void bool_value( bool v ) = 0;
+      virtual void int64_value( int64_t v ) = 0;
+      virtual void uint64_value( uint64_t v ) = 0;
+      virtual void double_value( double v ) = 0;
+      virtual void string_value( const string& v ) = 0;
+
+      /// writes a value that has no ABI related info; walks it through the calls above unless overridden
+      virtual void variant_value( const fc::variant& v );
+
+      /// writes the value that write writes to the writer it is given, or nothing if write throws
+      virtual void try_value( const std::function<void(abi_writer&)>& write );
+};
+
+/**
+ *  Writes JSON in the format of fc::json::to_string
+ */
+class json_writer : public abi_writer {
+   public:
+      explicit json_writer( std::ostream& out )
+      :out(out)
+      {}
+
+      void begin_object() override;
+      void key( const string& name ) override;
+      void end_object() override;
+      void begin_array() override;
+      void end_array() override;
+
+      void null_value() override;
+      void bool_value( bool v ) override;
+      void int64_value( int64_t v ) override;
+      void uint64_value( uint64_t v ) override;
+      void double_value( double v ) override;
+      void string_value( const string& v ) override;
+      void variant_value( const fc::variant& v ) override;
+      void try_value( const std::function<void(abi_writer&)>& write ) override;
+
+      /// returns the stream to write the next value to as JSON text, in place of the calls above
+      std::ostream& raw_value();
+
+   private:
+      /// writes the comma that precedes a value, unless it follows its key or opens its object or array
+      void separate();
+
+      std::ostream& out;
+      bool          need_comma = false;
+      bool          after_key = false;
+};
+
+/**
+ *  Records what is written to it so that it can be written to another abi_writer later, or dropped
+ */
+class abi_writer_buffer : public abi_writer {
+   public:
+      void begin_object() override;
+      void key( const string& name ) override;
+      void end_object() override;
+      void begin_array() override;
+      void end_array() override;
+
+      void null_value() override;
+      void bool_value( bool v ) override;
+      void int64_value( int64_t v ) override;
+      void uint64_value( uint64_t v ) override;
+      void double_value( double v ) override;
+      void string_value( const string& v ) override;
+      void variant_value( const fc::variant& v ) override;
+
+      void replay( abi_writer& out )const;
+
+   private:
+      enum class op : uint8_t {
+         begin_object, key, end_object, begin_array, end_array,
+         null_value, bool_value, int64_value, uint64_value, double_value, string_value, variant_value
+      };
+
+      /// integers and doubles are held in value; strings and variants are held aside, indexed by value
+      struct entry {
+         op       kind;
+         uint64_t value;
+      };
+
+      std::vector<entry>       entries;
+      std::vector<string>      strings;
+      std::vector<fc::variant> variants;
+};
+
+} } // dccio::chain
@@ -11,6 +11,14 @@ namespace dccio { namespace chain {
 
    namespace detail { class block_log_impl; }
 
+   /// How the block log is split into segments; by default it is kept as a single file
+   struct block_log_segment_config {
+      uint64_t segment_size = 0;      ///< start a new segment once blocks.log reaches this many bytes, 0 to never split
+      bool     compress = false;      ///< zlib compress each block of sealed segments
+      uint32_t retained_segments = 0; ///< prune all but this many of the newest sealed segments, 0 to keep all
+      fc::path archive_dir;           ///< pruned segments are moved here instead of being deleted, if set
+   };
+
    /* The block log is an external append only log of the blocks with a header. Blocks should only
     * be written to the log after they irreverisble as the log is append only. The log is a doubly
     * linked list of blocks. There is a secondary index file of only block positions that enables
@@ -34,11 +42,28 @@ namespace dccio { namespace chain {
     *
     * The main file is the only file that needs to persist. The index file can be reconstructed during a
     * linear scan of the main file.
+    *
+    * Reads go through read-only memory mappings of both files rather than the streams used for writing, so
+    * the read_* methods and get_block_pos may be called from any thread while the main thread appends.
+    * Readers only see blocks once append has returned.
+    *
+    * When a segment size is configured, blocks.log is sealed once it grows past it: it becomes the segment
+    * blocks-<first>-<last>.log (with blocks-<first>-<last>.index) and a new blocks.log, starting at the next
+    * block, takes its place. If compression is enabled a background thread then rewrites each sealed segment as
+    * blocks-<first>-<last>.zlog, which holds each block zlib compressed followed by its own index:
+    *
+    * +---------+-----------+----------+---------+-------------+-----+------------+-----------------+-----+----------------+
+    * | Version | First num | Last num | Genesis | First Block | ... | Last Block | Pos of First    | ... | Pos of Last    |
+    * +---------+-----------+----------+---------+-------------+-----+------------+-----------------+-----+----------------+
+    *
+    * Every segment is mapped once it is sealed, so any block is found through its segment's index. The same
+    * thread prunes the oldest segments beyond the configured number to keep, moving them to the archive directory
+    * if there is one. get_block_pos and read_block(pos) only refer to blocks.log.
     */
 
    class block_log {
       public:
-         block_log(const fc::path& data_dir);
+         block_log(const fc::path& data_dir, const block_log_segment_config& segments = block_log_segment_config());
          block_log(block_log&& other);
          ~block_log();
 
@@ -52,13 +77,19 @@ namespace dccio { namespace chain {
             return read_block_by_num(block_header::num_from_id(id));
          }
 
+         /**
+          * Return the blocks numbered [first_block_num, last_block_num] which are in the log, in order.
+          * Only the first block is looked up in the index, the rest are read sequentially.
+          */
+         vector<signed_block_ptr> read_blocks(uint32_t first_block_num, uint32_t last_block_num)const;
+
          /**
           * Return offset of block in file, or block_log::npos if it does not exist.
           */
          uint64_t get_block_pos(uint32_t block_num) const;
          signed_block_ptr        read_head()const;
-         const signed_block_ptr& head()const;
-         uint32_t                first_block_num() const;
+         const signed_block_ptr& head()const; ///< main thread only
+         uint32_t                first_block_num() const; ///< first block not pruned from the log
 
          static const uint64_t npos = std::numeric_limits<uint64_t>::max();
 
@@ -72,6 +103,7 @@ namespace dccio { namespace chain {
       private:
          void open(const fc::path& data_dir);
          void construct_index();
+         void seal_head_log();
 
          std::unique_ptr<detail::block_log_impl> my;
    };
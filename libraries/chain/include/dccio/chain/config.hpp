@@ -22,6 +22,8 @@ const static auto forkdb_filename            = "forkdb.dat";
 const static auto default_state_size            = 1*1024*1024*1024ll;
 const static auto default_state_guard_size      =    128*1024*1024ll;
 
+const static auto default_code_cache_dir_name = "code_cache";
+
 
 const static uint64_t system_account_name    = N(dccio);
 const static uint64_t null_account_name      = N(dccio.null);
@@ -95,6 +97,10 @@ const static uint32_t   hashing_checktime_block_size       = 10*1024;  /// call
 
 const static dccio::chain::wasm_interface::vm_type default_wasm_runtime = dccio::chain::wasm_interface::vm_type::wabt;
 const static uint32_t   default_abi_serializer_max_time_ms = 15*1000; ///< default deadline for abi serialization methods
+const static uint16_t   default_controller_thread_pool_size = 2; ///< default number of threads used for signature recovery
+const static uint32_t   default_wasm_cache_max_entries = 1024; ///< default number of instantiated contracts kept in memory
+const static uint64_t   default_wasm_cache_max_bytes   = 2*1024*1024*1024ll; ///< default bound on memory held by instantiated contracts
+const static uint32_t   default_abi_serializer_cache_size = 1024; ///< default number of accounts whose abi_serializer is kept in memory
 
 /**
  *  The number of sequential blocks produced by a single producer
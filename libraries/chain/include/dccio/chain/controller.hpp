@@ -2,9 +2,12 @@
 #include <dccio/chain/block_state.hpp>
 #include <dccio/chain/trace.hpp>
 #include <dccio/chain/genesis_state.hpp>
+#include <dccio/chain/block_log.hpp>
 #include <boost/signals2/signal.hpp>
+#include <boost/asio/thread_pool.hpp>
 
 #include <dccio/chain/abi_serializer.hpp>
+#include <dccio/chain/abi_serializer_cache.hpp>
 #include <dccio/chain/account_object.hpp>
 #include <dccio/chain/snapshot.hpp>
 
@@ -58,10 +61,15 @@ namespace dccio { namespace chain {
             flat_set<public_key_type> key_blacklist;
             path                     blocks_dir             =  chain::config::default_blocks_dir_name;
             path                     state_dir              =  chain::config::default_state_dir_name;
+            path                     wasm_code_cache_dir; ///< compiled contract code is cached here across restarts, disabled if empty
+            block_log_segment_config blocks_log_segments; ///< blocks.log is kept as a single file by default
             uint64_t                 state_size             =  chain::config::default_state_size;
             uint64_t                 state_guard_size       =  chain::config::default_state_guard_size;
+            chainbase::database::map_mode state_map_mode   =  chainbase::database::mapped;
+            uint64_t                 state_hugepage_size    =  0; ///< explicit hugepages for heap and locked state_map_mode, transparent if 0
             uint64_t                 reversible_cache_size  =  chain::config::default_reversible_cache_size;
             uint64_t                 reversible_guard_size  =  chain::config::default_reversible_guard_size;
+            uint16_t                 thread_pool_size       =  chain::config::default_controller_thread_pool_size;
             bool                     read_only              =  false;
             bool                     force_all_checks       =  false;
             bool                     disable_replay_opts    =  false;
@@ -70,6 +78,10 @@ namespace dccio { namespace chain {
 
             genesis_state            genesis;
             wasm_interface::vm_type  wasm_runtime = chain::config::default_wasm_runtime;
+            uint32_t                 wasm_cache_max_entries = chain::config::default_wasm_cache_max_entries;
+            uint64_t                 wasm_cache_max_bytes   = chain::config::default_wasm_cache_max_bytes;
+            flat_set<account_name>   wasm_cache_pinned_accounts = { chain::config::system_account_name };
+            uint32_t                 abi_serializer_cache_size = chain::config::default_abi_serializer_cache_size;
 
             db_read_mode             read_mode              = db_read_mode::SPECULATIVE;
             validation_mode          block_validation_mode  = validation_mode::FULL;
@@ -149,6 +161,24 @@ namespace dccio { namespace chain {
 
          const chainbase::database& db()const;
 
+         /**
+          * Worker threads for work that does not touch chain state, e.g. recovering transaction signing keys
+          */
+         boost::asio::thread_pool& get_thread_pool();
+
+         /**
+          * Calls f while none of the controller methods that modify chain state is running, so f reads a consistent
+          * state made of whole blocks and transactions, including those of the pending block. This is how threads
+          * other than the main thread read chain state; f must only read and must not call methods that modify it.
+          * Modifications wait for f to return.
+          */
+         void with_read_view( const std::function<void()>& f )const;
+
+         /**
+          * Serializers for the ABIs set on accounts in chain state, shared by API and history plugins
+          */
+         abi_serializer_cache& get_abi_serializer_cache()const;
+
          const fork_database& fork_db()const;
 
          const account_object&                 get_account( account_name n )const;
@@ -198,6 +228,11 @@ namespace dccio { namespace chain {
 
          signed_block_ptr fetch_block_by_number( uint32_t block_num )const;
          signed_block_ptr fetch_block_by_id( block_id_type id )const;
+         /**
+          * Returns the blocks numbered [first_block_num, last_block_num] that are in the block log, in order.
+          * Unlike the other fetch methods this may be called from any thread.
+          */
+         vector<signed_block_ptr> fetch_irreversible_blocks_by_number( uint32_t first_block_num, uint32_t last_block_num )const;
 
          block_state_ptr fetch_block_state_by_number( uint32_t block_num )const;
          block_state_ptr fetch_block_state_by_id( block_id_type id )const;
@@ -265,18 +300,16 @@ namespace dccio { namespace chain {
 
          const apply_handler* find_apply_handler( account_name contract, scope_name scope, action_name act )const;
          wasm_interface& get_wasm_interface();
+         const wasm_interface& get_wasm_interface()const;
 
 
-         optional<abi_serializer> get_abi_serializer( account_name n, const fc::microseconds& max_serialization_time )const {
+         abi_serializer_cache::serializer_ptr get_abi_serializer( account_name n, const fc::microseconds& max_serialization_time )const {
             if( n.good() ) {
                try {
-                  const auto& a = get_account( n );
-                  abi_def abi;
-                  if( abi_serializer::to_abi( a.abi, abi ))
-                     return abi_serializer( abi, max_serialization_time );
+                  return get_abi_serializer_cache().get( db(), n, max_serialization_time );
                } FC_CAPTURE_AND_LOG((n))
             }
-            return optional<abi_serializer>();
+            return abi_serializer_cache::serializer_ptr();
          }
 
          template<typename T>
@@ -288,6 +321,13 @@ namespace dccio { namespace chain {
             return pretty_output;
          }
 
+         template<typename T>
+         void to_json_with_abi( const T& obj, std::ostream& out, const fc::microseconds& max_serialization_time ) {
+            abi_serializer::to_json( obj, out,
+                                     [&]( account_name n ){ return get_abi_serializer( n, max_serialization_time ); },
+                                     max_serialization_time);
+         }
+
       private:
          friend class apply_context;
          friend class transaction_context;
@@ -300,6 +340,7 @@ namespace dccio { namespace chain {
 
 } }  /// dccio::chain
 
+FC_REFLECT( dccio::chain::block_log_segment_config, (segment_size)(compress)(retained_segments)(archive_dir) )
 FC_REFLECT( dccio::chain::controller::config,
             (actor_whitelist)
             (actor_blacklist)
@@ -307,6 +348,8 @@ FC_REFLECT( dccio::chain::controller::config,
             (contract_blacklist)
             (blocks_dir)
             (state_dir)
+            (wasm_code_cache_dir)
+            (blocks_log_segments)
             (state_size)
             (reversible_cache_size)
             (read_only)
@@ -315,6 +358,10 @@ FC_REFLECT( dccio::chain::controller::config,
             (contracts_console)
             (genesis)
             (wasm_runtime)
+            (wasm_cache_max_entries)
+            (wasm_cache_max_bytes)
+            (wasm_cache_pinned_accounts)
+            (abi_serializer_cache_size)
             (resource_greylist)
             (trusted_producers)
           )
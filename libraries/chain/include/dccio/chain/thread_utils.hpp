@@ -0,0 +1,24 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+#include <future>
+#include <memory>
+
+namespace dccio { namespace chain {
+
+   /**
+    *  Post the functor to the thread pool and return a future that will hold its result (or the exception it threw)
+    */
+   template<typename F>
+   auto async_thread_pool( boost::asio::thread_pool& thread_pool, F&& f ) {
+      auto task = std::make_shared<std::packaged_task<decltype( f() )()>>( std::forward<F>( f ) );
+      boost::asio::post( thread_pool, [task]() { (*task)(); } );
+      return task->get_future();
+   }
+
+} } // dccio::chain
@@ -6,9 +6,16 @@
 #include <dccio/chain/transaction.hpp>
 #include <dccio/chain/block.hpp>
 #include <dccio/chain/trace.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <functional>
+#include <future>
 
 namespace dccio { namespace chain {
 
+class transaction_metadata;
+using transaction_metadata_ptr = std::shared_ptr<transaction_metadata>;
+using signing_keys_future_type = std::shared_future<std::tuple<chain_id_type, flat_set<public_key_type>>>;
+
 /**
  *  This data structure should store context-free cached data about a transaction such as
  *  packed/unpacked/compressed and recovered keys
@@ -20,6 +27,7 @@ class transaction_metadata {
       signed_transaction                                         trx;
       packed_transaction                                         packed_trx;
       optional<pair<chain_id_type, flat_set<public_key_type>>>   signing_keys;
+      signing_keys_future_type                                   signing_keys_future; ///< set by create_signing_keys_future
       bool                                                       accepted = false;
       bool                                                       implicit = false;
       bool                                                       scheduled = false;
@@ -31,22 +39,31 @@ class transaction_metadata {
          signed_id = digest_type::hash(packed_trx);
       }
 
+      /// thread safe, does not touch the lazily unpacked transaction cached in ptrx
       explicit transaction_metadata( const packed_transaction& ptrx )
-      :trx( ptrx.get_signed_transaction() ), packed_trx(ptrx) {
+      :trx( fc::raw::unpack<transaction>( ptrx.get_raw_transaction() ), ptrx.signatures, ptrx.get_context_free_data() ), packed_trx(ptrx) {
          id = trx.id();
          //raw_packed = fc::raw::pack( static_cast<const transaction&>(trx) );
          signed_id = digest_type::hash(packed_trx);
       }
 
-      const flat_set<public_key_type>& recover_keys( const chain_id_type& chain_id ) {
-         if( !signing_keys || signing_keys->first != chain_id ) // Unlikely for more than one chain_id to be used in one noddcc instance
-            signing_keys = std::make_pair( chain_id, trx.get_signature_keys( chain_id ) );
-         return signing_keys->second;
-      }
+      /**
+       *  Returns the keys recovered from the signatures of this transaction. If a signing keys future was created
+       *  for the same chain_id its result is reused, otherwise the keys are recovered on the calling thread.
+       */
+      const flat_set<public_key_type>& recover_keys( const chain_id_type& chain_id );
+
+      /**
+       *  Starts recovery of the signing keys of mtrx on the thread pool, the result is stored in signing_keys_future
+       *  and picked up by recover_keys. Does nothing if the keys are already recovered or being recovered.
+       *  Must be called from the thread that owns mtrx (the main thread).
+       *  @param next if set, called on the thread pool once signing_keys_future is ready, or right away on the
+       *  calling thread if the keys are already recovered or being recovered
+       */
+      static void create_signing_keys_future( const transaction_metadata_ptr& mtrx, boost::asio::thread_pool& thread_pool,
+                                              const chain_id_type& chain_id, std::function<void()> next = {} );
 
       uint32_t total_actions()const { return trx.context_free_actions.size() + trx.actions.size(); }
 };
 
-using transaction_metadata_ptr = std::shared_ptr<transaction_metadata>;
-
 } } // dccio::chain
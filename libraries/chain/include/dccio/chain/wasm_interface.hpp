@@ -3,6 +3,7 @@
 #include <dccio/chain/exceptions.hpp>
 #include "Runtime/Linker.h"
 #include "Runtime/Runtime.h"
+#include <boost/asio/thread_pool.hpp>
 
 namespace dccio { namespace chain {
 
@@ -56,7 +57,27 @@ namespace dccio { namespace chain {
             wabt
          };
 
-         wasm_interface(vm_type vm);
+         /// Bounds the cache of instantiated contracts; the least recently used entries are evicted first
+         struct cache_config {
+            uint32_t                max_entries = 0;    ///< 0 for no limit
+            uint64_t                max_bytes = 0;      ///< 0 for no limit
+            flat_set<account_name>  pinned_accounts;    ///< the current code of these accounts is never evicted
+         };
+
+         struct cache_stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            uint32_t entries = 0;
+            uint32_t pinned_entries = 0;
+            uint64_t bytes = 0;
+            uint32_t pending_entries = 0;     ///< compilations started by precompile and not yet used
+            uint64_t pending_evictions = 0;   ///< compilations dropped because their code was replaced or the cache was full
+         };
+
+         /// @param code_cache_dir directory where compiled contract code is cached across restarts, disabled if empty
+         wasm_interface(vm_type vm, const fc::path& code_cache_dir = fc::path());
+         wasm_interface(vm_type vm, const fc::path& code_cache_dir, const cache_config& cache);
          ~wasm_interface();
 
          //validates code -- does a WASM validation pass and checks the wasm against dccIO specific constraints
@@ -65,9 +86,15 @@ namespace dccio { namespace chain {
          //Calls apply or error on a given code
          void apply(const digest_type& code_id, const shared_string& code, apply_context& context);
 
+         //Starts compiling account's new code on the thread pool so the first apply of it waits for that instead of
+         //compiling; a compilation of code the account had before that has not been used yet is dropped
+         void precompile(const account_name& account, const digest_type& code_id, const shared_string& code, boost::asio::thread_pool& thread_pool);
+
          //Immediately exits currently running wasm. UB is called when no wasm running
          void exit();
 
+         cache_stats get_cache_stats()const;
+
       private:
          unique_ptr<struct wasm_interface_impl> my;
          friend class dccio::chain::webassembly::common::intrinsics_accessor;
@@ -80,3 +107,4 @@ namespace dccio{ namespace chain {
 }}
 
 FC_REFLECT_ENUM( dccio::chain::wasm_interface::vm_type, (wavm)(wabt) )
+FC_REFLECT( dccio::chain::wasm_interface::cache_stats, (hits)(misses)(evictions)(entries)(pinned_entries)(bytes)(pending_entries)(pending_evictions) )
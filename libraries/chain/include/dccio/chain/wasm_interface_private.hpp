@@ -7,8 +7,16 @@
 #include <dccio/chain/wasm_dccio_injection.hpp>
 #include <dccio/chain/transaction_context.hpp>
 #include <dccio/chain/exceptions.hpp>
+#include <dccio/chain/thread_utils.hpp>
 #include <fc/scoped_exit.hpp>
 
+#include <dccio/chain/multi_index_includes.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <algorithm>
+#include <future>
+#include <mutex>
+
 #include "IR/Module.h"
 #include "Runtime/Intrinsics.h"
 #include "Platform/Platform.h"
@@ -22,10 +30,44 @@ using namespace Runtime;
 
 namespace dccio { namespace chain {
 
+   struct wasm_cache_entry {
+      digest_type                                          code_id;
+      std::unique_ptr<wasm_instantiated_module_interface> module;
+      size_t                                               size = 0;
+      bool                                                 pinned = false;
+   };
+
+   struct by_code_id;
+   typedef bmi::multi_index_container<
+      wasm_cache_entry,
+      indexed_by<
+         bmi::sequenced<>, // most recently used first
+         ordered_unique<tag<by_code_id>, member<wasm_cache_entry, digest_type, &wasm_cache_entry::code_id>>
+      >
+   > wasm_cache_index;
+
+   struct pending_instantiation {
+      digest_type                                                      code_id;
+      account_name                                                     account;
+      std::future<std::unique_ptr<wasm_instantiated_module_interface>> module;
+   };
+
+   struct by_account;
+   typedef bmi::multi_index_container<
+      pending_instantiation,
+      indexed_by<
+         bmi::sequenced<>, // oldest first
+         ordered_unique<tag<by_code_id>, member<pending_instantiation, digest_type, &pending_instantiation::code_id>>,
+         ordered_non_unique<tag<by_account>, member<pending_instantiation, account_name, &pending_instantiation::account>>
+      >
+   > pending_instantiation_index;
+
    struct wasm_interface_impl {
-      wasm_interface_impl(wasm_interface::vm_type vm) {
+      wasm_interface_impl(wasm_interface::vm_type vm, const fc::path& code_cache_dir, const wasm_interface::cache_config& cache)
+      :cache_config(cache)
+      {
          if(vm == wasm_interface::vm_type::wavm)
-            runtime_interface = std::make_unique<webassembly::wavm::wavm_runtime>();
+            runtime_interface = std::make_unique<webassembly::wavm::wavm_runtime>(code_cache_dir);
          else if(vm == wasm_interface::vm_type::wabt)
             runtime_interface = std::make_unique<webassembly::wabt_runtime::wabt_runtime>();
          else
@@ -50,47 +92,200 @@ namespace dccio { namespace chain {
          return mem_image;
       }
 
-      std::unique_ptr<wasm_instantiated_module_interface>& get_instantiated_module( const digest_type& code_id,
-                                                                                    const shared_string& code,
-                                                                                    transaction_context& trx_context )
+      ~wasm_interface_impl() {
+         // compilations still running on a worker thread reference this object
+         for( auto& p : pending_instantiations ) {
+            if( p.module.valid() )
+               p.module.wait();
+         }
+         for( auto& f : dropped_instantiations ) {
+            if( f.valid() )
+               f.wait();
+         }
+      }
+
+      wasm_instantiated_module_interface& get_instantiated_module( const digest_type& code_id,
+                                                                   const shared_string& code,
+                                                                   const account_name& receiver,
+                                                                   transaction_context& trx_context )
       {
-         auto it = instantiation_cache.find(code_id);
-         if(it == instantiation_cache.end()) {
+         auto& by_id = instantiation_cache.get<by_code_id>();
+         auto it = by_id.find(code_id);
+         if(it != by_id.end()) {
+            ++stats.hits;
+            instantiation_cache.relocate(instantiation_cache.begin(), instantiation_cache.project<0>(it));
+         } else {
+            ++stats.misses;
             auto timer_pause = fc::make_scoped_exit([&](){
                trx_context.resume_billing_timer();
             });
             trx_context.pause_billing_timer();
-            IR::Module module;
-            try {
-               Serialization::MemoryInputStream stream((const U8*)code.data(), code.size());
-               WASM::serialize(stream, module);
-               module.userSections.clear();
-            } catch(const Serialization::FatalSerializationException& e) {
-               dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
-            } catch(const IR::ValidationException& e) {
-               dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
+
+            std::unique_ptr<wasm_instantiated_module_interface> module;
+            auto& pending_by_id = pending_instantiations.get<by_code_id>();
+            auto pending = pending_by_id.find(code_id);
+            if(pending != pending_by_id.end()) {
+               // wait for the compilation started when the code was set
+               std::future<std::unique_ptr<wasm_instantiated_module_interface>> instantiation;
+               pending_by_id.modify(pending, [&](pending_instantiation& p){ instantiation = std::move(p.module); });
+               pending_by_id.erase(pending);
+               module = instantiation.get();
+            } else {
+               module = instantiate_module(code_id, code.data(), code.size());
+            }
+
+            const size_t size = module->memory_usage();
+            instantiation_cache.emplace_front(wasm_cache_entry{code_id, std::move(module), size});
+            stats.bytes += size;
+            it = by_id.find(code_id);
+         }
+
+         if(cache_config.pinned_accounts.count(receiver)) {
+            auto pinned = pinned_code.find(receiver);
+            if(pinned == pinned_code.end() || pinned->second != code_id)
+               pin(receiver, it);
+         }
+
+         evict();
+         return *it->module;
+      }
+
+      /// Marks the code running for a pinned account so it is never evicted, releasing the account's previous code
+      void pin( const account_name& account, wasm_cache_index::index<by_code_id>::type::iterator it ) {
+         auto& by_id = instantiation_cache.get<by_code_id>();
+         auto previous = pinned_code.find(account);
+         if(previous != pinned_code.end()) {
+            auto prev = by_id.find(previous->second);
+            // the same code may be deployed to several pinned accounts
+            bool still_pinned = false;
+            for(const auto& p : pinned_code)
+               still_pinned |= p.first != account && p.second == previous->second;
+            if(prev != by_id.end() && !still_pinned) {
+               by_id.modify(prev, [](wasm_cache_entry& e){ e.pinned = false; });
+               --stats.pinned_entries;
             }
+         }
+         pinned_code[account] = it->code_id;
+         if(!it->pinned) {
+            by_id.modify(it, [](wasm_cache_entry& e){ e.pinned = true; });
+            ++stats.pinned_entries;
+         }
+      }
 
-            wasm_injections::wasm_binary_injection injector(module);
-            injector.inject();
-
-            std::vector<U8> bytes;
-            try {
-               Serialization::ArrayOutputStream outstream;
-               WASM::serialize(outstream, module);
-               bytes = outstream.getBytes();
-            } catch(const Serialization::FatalSerializationException& e) {
-               dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
-            } catch(const IR::ValidationException& e) {
-               dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
+      /// Drops least recently used entries that are not pinned until the cache is within its limits; the most
+      /// recently used entry is always kept, since it is about to run. Compilations that have not been used yet
+      /// count against the entry limit, and the oldest of them are dropped once no cached entry can be.
+      void evict() {
+         auto over_entries = [&]() {
+            return cache_config.max_entries &&
+                   instantiation_cache.size() + pending_instantiations.size() > cache_config.max_entries;
+         };
+         auto over_limit = [&]() {
+            return over_entries() || (cache_config.max_bytes && stats.bytes > cache_config.max_bytes);
+         };
+
+         if(!instantiation_cache.empty()) {
+            auto it = instantiation_cache.end();
+            while(over_limit() && --it != instantiation_cache.begin()) {
+               if(it->pinned)
+                  continue;
+               stats.bytes -= it->size;
+               ++stats.evictions;
+               it = instantiation_cache.erase(it);
             }
-            it = instantiation_cache.emplace(code_id, runtime_interface->instantiate_module((const char*)bytes.data(), bytes.size(), parse_initial_memory(module))).first;
          }
-         return it->second;
+
+         while(over_entries() && !pending_instantiations.empty())
+            drop_pending(pending_instantiations.begin());
+      }
+
+      /// Forgets a compilation that will not be used; it cannot be cancelled, so its future is kept until it finishes
+      void drop_pending( pending_instantiation_index::iterator it ) {
+         auto finished = [](const std::future<std::unique_ptr<wasm_instantiated_module_interface>>& f) {
+            return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+         };
+         dropped_instantiations.erase(std::remove_if(dropped_instantiations.begin(), dropped_instantiations.end(), finished),
+                                      dropped_instantiations.end());
+
+         pending_instantiations.modify(it, [&](pending_instantiation& p){
+            if(!finished(p.module))
+               dropped_instantiations.emplace_back(std::move(p.module));
+         });
+         pending_instantiations.erase(it);
+         ++stats.pending_evictions;
+      }
+
+      wasm_interface::cache_stats get_cache_stats()const {
+         wasm_interface::cache_stats result = stats;
+         result.entries = instantiation_cache.size();
+         result.pending_entries = pending_instantiations.size();
+         return result;
+      }
+
+      /// Starts instantiating account's new code on the thread pool, so the first apply of code_id does not compile it
+      /// synchronously
+      void precompile( const account_name& account, const digest_type& code_id, const shared_string& code, boost::asio::thread_pool& thread_pool ) {
+         // the code the account had before cannot run any more. Code shared with another account is only recorded
+         // for the account that set it first, so replacing that account's code costs the other one its head start.
+         auto& by_acct = pending_instantiations.get<by_account>();
+         auto superseded = by_acct.lower_bound(account);
+         while( superseded != by_acct.end() && superseded->account == account ) {
+            drop_pending(pending_instantiations.project<0>(superseded));
+            superseded = by_acct.lower_bound(account);
+         }
+
+         if( instantiation_cache.get<by_code_id>().count(code_id) || pending_instantiations.get<by_code_id>().count(code_id) )
+            return;
+
+         // the code in the database may change or be undone before the worker gets to it
+         auto code_copy = std::make_shared<std::vector<char>>( code.begin(), code.end() );
+         pending_instantiations.emplace_back( pending_instantiation{ code_id, account,
+            async_thread_pool( thread_pool, [this, code_id, code_copy]() {
+               return instantiate_module( code_id, code_copy->data(), code_copy->size() );
+            } ) } );
+         evict();
+      }
+
+      /// Parses, injects and instantiates code; may be called from any thread
+      std::unique_ptr<wasm_instantiated_module_interface> instantiate_module( const digest_type& code_id, const char* code, size_t code_size ) {
+         // the injection pass keeps its state in statics, so only one instantiation can run at a time
+         std::lock_guard<std::mutex> lock(instantiation_mutex);
+
+         IR::Module module;
+         try {
+            Serialization::MemoryInputStream stream((const U8*)code, code_size);
+            WASM::serialize(stream, module);
+            module.userSections.clear();
+         } catch(const Serialization::FatalSerializationException& e) {
+            dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         } catch(const IR::ValidationException& e) {
+            dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         }
+
+         wasm_injections::wasm_binary_injection injector(module);
+         injector.inject();
+
+         std::vector<U8> bytes;
+         try {
+            Serialization::ArrayOutputStream outstream;
+            WASM::serialize(outstream, module);
+            bytes = outstream.getBytes();
+         } catch(const Serialization::FatalSerializationException& e) {
+            dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         } catch(const IR::ValidationException& e) {
+            dcc_ASSERT(false, wasm_serialization_error, e.message.c_str());
+         }
+         return runtime_interface->instantiate_module((const char*)bytes.data(), bytes.size(), parse_initial_memory(module), code_id);
       }
 
       std::unique_ptr<wasm_runtime_interface> runtime_interface;
-      map<digest_type, std::unique_ptr<wasm_instantiated_module_interface>> instantiation_cache;
+      wasm_interface::cache_config cache_config;
+      wasm_cache_index instantiation_cache;
+      map<account_name, digest_type> pinned_code;
+      wasm_interface::cache_stats stats;
+      pending_instantiation_index pending_instantiations;
+      vector<std::future<std::unique_ptr<wasm_instantiated_module_interface>>> dropped_instantiations;
+      std::mutex instantiation_mutex;
    };
 
 #define _REGISTER_INTRINSIC_EXPLICIT(CLS, MOD, METHOD, WASM_SIG, NAME, SIG)\
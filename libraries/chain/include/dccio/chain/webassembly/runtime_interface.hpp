@@ -1,4 +1,5 @@
 #pragma once
+#include <dccio/chain/types.hpp>
 #include <vector>
 #include <memory>
 
@@ -10,12 +11,16 @@ class wasm_instantiated_module_interface {
    public:
       virtual void apply(apply_context& context) = 0;
 
+      //approximate number of bytes of memory held by this instantiation, used to bound the instantiation cache
+      virtual size_t memory_usage() const = 0;
+
       virtual ~wasm_instantiated_module_interface();
 };
 
 class wasm_runtime_interface {
    public:
-      virtual std::unique_ptr<wasm_instantiated_module_interface> instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory) = 0;
+      //code_id identifies the original code that code_bytes was prepared from, so runtimes may cache work done for it
+      virtual std::unique_ptr<wasm_instantiated_module_interface> instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory, const digest_type& code_id) = 0;
 
       //immediately exit the currently running wasm_instantiated_module_interface. Yep, this assumes only one can possibly run at a time.
       virtual void immediately_exit_currently_running_module() = 0;
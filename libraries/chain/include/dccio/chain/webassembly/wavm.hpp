@@ -8,6 +8,9 @@
 #include "Runtime/Runtime.h"
 #include "IR/Types.h"
 
+#include <mutex>
+#include <set>
+
 
 namespace dccio { namespace chain { namespace webassembly { namespace wavm {
 
@@ -18,19 +21,33 @@ using namespace dccio::chain::webassembly::common;
 
 class wavm_runtime : public dccio::chain::wasm_runtime_interface {
    public:
-      wavm_runtime();
+      /// @param code_cache_dir directory where compiled code is persisted across restarts, disabled if empty
+      explicit wavm_runtime(const fc::path& code_cache_dir = fc::path());
       ~wavm_runtime();
-      std::unique_ptr<wasm_instantiated_module_interface> instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory) override;
+      std::unique_ptr<wasm_instantiated_module_interface> instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory, const digest_type& code_id) override;
 
       void immediately_exit_currently_running_module() override;
 
       struct runtime_guard {
          runtime_guard();
          ~runtime_guard();
+
+         void add_instance(ModuleInstance* instance);
+         //frees the instance along with the WAVM objects only it referenced
+         void release_instance(ModuleInstance* instance);
+         //must be called with gc_mutex held
+         void collect();
+
+         //held while instantiating or collecting, since a collection would free the objects of a partially built instance
+         std::mutex                 gc_mutex;
+         std::mutex                 instances_mutex;
+         std::set<ModuleInstance*>  live_instances;
+         bool                       collect_pending = false;
       };
 
    private:
-      std::shared_ptr<runtime_guard> _runtime_guard;
+      std::shared_ptr<runtime_guard>          _runtime_guard;
+      std::unique_ptr<Runtime::ObjectCache>   _code_cache;
 };
 
 //This is a temporary hack for the single threaded implementation
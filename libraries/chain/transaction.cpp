@@ -6,6 +6,7 @@
 #include <fc/bitutil.hpp>
 #include <fc/smart_ref_impl.hpp>
 #include <algorithm>
+#include <mutex>
 
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/multi_index_container.hpp>
@@ -88,19 +89,26 @@ flat_set<public_key_type> transaction::get_signature_keys( const vector<signatur
 
    constexpr size_t recovery_cache_size = 1000;
    static recovery_cache_type recovery_cache;
+   static std::mutex cache_mtx; // keys may be recovered concurrently on the controller thread pool
    const digest_type digest = sig_digest(chain_id, cfd);
 
+   std::unique_lock<std::mutex> lock(cache_mtx, std::defer_lock);
+   const transaction_id_type trx_id = use_cache ? id() : transaction_id_type();
    flat_set<public_key_type> recovered_pub_keys;
    for(const signature_type& sig : signatures) {
       public_key_type recov;
       if( use_cache ) {
+         lock.lock();
          recovery_cache_type::index<by_sig>::type::iterator it = recovery_cache.get<by_sig>().find( sig );
-         if( it == recovery_cache.get<by_sig>().end() || it->trx_id != id()) {
+         if( it == recovery_cache.get<by_sig>().end() || it->trx_id != trx_id) {
+            lock.unlock(); // do not hold the lock during the expensive recovery
             recov = public_key_type( sig, digest );
-            recovery_cache.emplace_back(cached_pub_key{id(), recov, sig} ); //could fail on dup signatures; not a problem
+            lock.lock();
+            recovery_cache.emplace_back(cached_pub_key{trx_id, recov, sig} ); //could fail on dup signatures; not a problem
          } else {
             recov = it->pub_key;
          }
+         lock.unlock();
       } else {
          recov = public_key_type( sig, digest );
       }
@@ -113,6 +121,7 @@ flat_set<public_key_type> transaction::get_signature_keys( const vector<signatur
    }
 
    if( use_cache ) {
+      std::lock_guard<std::mutex> g(cache_mtx);
       while ( recovery_cache.size() > recovery_cache_size )
          recovery_cache.erase( recovery_cache.begin() );
    }
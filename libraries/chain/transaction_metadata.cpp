@@ -0,0 +1,53 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#include <dccio/chain/transaction_metadata.hpp>
+#include <boost/asio/post.hpp>
+
+namespace dccio { namespace chain {
+
+const flat_set<public_key_type>& transaction_metadata::recover_keys( const chain_id_type& chain_id ) {
+   // Unlikely for more than one chain_id to be used in one noddcc instance
+   if( !signing_keys || signing_keys->first != chain_id ) {
+      if( signing_keys_future.valid() ) {
+         const std::tuple<chain_id_type, flat_set<public_key_type>>& sig_keys = signing_keys_future.get();
+         if( std::get<0>( sig_keys ) == chain_id ) {
+            signing_keys = std::make_pair( chain_id, std::get<1>( sig_keys ) );
+            return signing_keys->second;
+         }
+      }
+      signing_keys = std::make_pair( chain_id, trx.get_signature_keys( chain_id ) );
+   }
+   return signing_keys->second;
+}
+
+void transaction_metadata::create_signing_keys_future( const transaction_metadata_ptr& mtrx,
+                                                       boost::asio::thread_pool& thread_pool, const chain_id_type& chain_id,
+                                                       std::function<void()> next ) {
+   if( mtrx->signing_keys || mtrx->signing_keys_future.valid() ) { // already recovered or in progress
+      if( next ) next();
+      return;
+   }
+
+   // the promise is fulfilled before next runs, so that next finds the keys ready
+   auto keys_promise = std::make_shared<std::promise<std::tuple<chain_id_type, flat_set<public_key_type>>>>();
+   mtrx->signing_keys_future = keys_promise->get_future().share();
+
+   // only trx is read by the worker, it is never modified after construction
+   std::weak_ptr<transaction_metadata> mtrx_wp = mtrx;
+   boost::asio::post( thread_pool, [chain_id, mtrx_wp, keys_promise, next{std::move( next )}]() {
+      try {
+         flat_set<public_key_type> recovered_pub_keys;
+         auto mtrx = mtrx_wp.lock();
+         if( mtrx ) // no longer needed if the transaction was dropped before the worker got to it
+            recovered_pub_keys = mtrx->trx.get_signature_keys( chain_id );
+         keys_promise->set_value( std::make_tuple( chain_id, std::move( recovered_pub_keys ) ) );
+      } catch( ... ) {
+         keys_promise->set_exception( std::current_exception() );
+      }
+      if( next ) next();
+   } );
+}
+
+} } // dccio::chain
@@ -27,7 +27,8 @@ namespace dccio { namespace chain {
    using namespace webassembly;
    using namespace webassembly::common;
 
-   wasm_interface::wasm_interface(vm_type vm) : my( new wasm_interface_impl(vm) ) {}
+   wasm_interface::wasm_interface(vm_type vm, const fc::path& code_cache_dir) : wasm_interface(vm, code_cache_dir, cache_config()) {}
+   wasm_interface::wasm_interface(vm_type vm, const fc::path& code_cache_dir, const cache_config& cache) : my( new wasm_interface_impl(vm, code_cache_dir, cache) ) {}
 
    wasm_interface::~wasm_interface() {}
 
@@ -48,19 +49,25 @@ namespace dccio { namespace chain {
       root_resolver resolver(true);
       LinkResult link_result = linkModule(module, resolver);
 
-      //there are a couple opportunties for improvement here--
-      //Easy: Cache the Module created here so it can be reused for instantiaion
-      //Hard: Kick off instantiation in a separate thread at this location
+      //instantiation is kicked off in a separate thread by apply_dccio_setcode once the code is set
 	 }
 
    void wasm_interface::apply( const digest_type& code_id, const shared_string& code, apply_context& context ) {
-      my->get_instantiated_module(code_id, code, context.trx_context)->apply(context);
+      my->get_instantiated_module(code_id, code, context.receiver, context.trx_context).apply(context);
+   }
+
+   void wasm_interface::precompile( const account_name& account, const digest_type& code_id, const shared_string& code, boost::asio::thread_pool& thread_pool ) {
+      my->precompile(account, code_id, code, thread_pool);
    }
 
    void wasm_interface::exit() {
       my->runtime_interface->immediately_exit_currently_running_module();
    }
 
+   wasm_interface::cache_stats wasm_interface::get_cache_stats()const {
+      return my->get_cache_stats();
+   }
+
    wasm_instantiated_module_interface::~wasm_instantiated_module_interface() {}
    wasm_runtime_interface::~wasm_runtime_interface() {}
 
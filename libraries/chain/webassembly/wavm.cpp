@@ -12,6 +12,10 @@
 #include "Runtime/Linker.h"
 #include "Runtime/Intrinsics.h"
 
+#include <fc/io/fstream.hpp>
+#include <fc/scoped_exit.hpp>
+
+#include <fstream>
 #include <mutex>
 
 using namespace IR;
@@ -23,11 +27,25 @@ running_instance_context the_running_instance_context;
 
 class wavm_instantiated_module : public wasm_instantiated_module_interface {
    public:
-      wavm_instantiated_module(ModuleInstance* instance, std::unique_ptr<Module> module, std::vector<uint8_t> initial_mem) :
+      wavm_instantiated_module(ModuleInstance* instance, std::unique_ptr<Module> module, std::vector<uint8_t> initial_mem,
+                               size_t code_size, std::shared_ptr<wavm_runtime::runtime_guard> runtime_guard) :
          _initial_memory(initial_mem),
          _instance(instance),
-         _module(std::move(module))
-      {}
+         _module(std::move(module)),
+         _code_size(code_size),
+         _runtime_guard(std::move(runtime_guard))
+      {
+         //contracts with large initial memories are reset by mapping a snapshot of it, so that only the pages an
+         // action wrote to are restored instead of copying in the whole image every time
+         if(_module->memories.defs.size() &&
+            (_module->memories.defs[0].type.size.min << IR::numBytesPerPageLog2) >= memory_snapshot_min_bytes)
+            _memory_snapshot = createMemorySnapshot(_module->memories.defs[0].type, _initial_memory.data(), _initial_memory.size());
+      }
+
+      ~wavm_instantiated_module() {
+         destroyMemorySnapshot(_memory_snapshot);
+         _runtime_guard->release_instance(_instance);
+      }
 
       void apply(apply_context& context) override {
          vector<Value> args = {Value(uint64_t(context.receiver)),
@@ -37,6 +55,10 @@ class wavm_instantiated_module : public wasm_instantiated_module_interface {
          call("apply", args, context);
       }
 
+      size_t memory_usage() const override {
+         return _code_size + _initial_memory.size() + getModuleInstanceCodeSize(_instance);
+      }
+
    private:
       void call(const string &entry_point, const vector <Value> &args, apply_context &context) {
          try {
@@ -49,7 +71,10 @@ class wavm_instantiated_module : public wasm_instantiated_module_interface {
             //The memory instance is reused across all wavm_instantiated_modules, but for wasm instances
             // that didn't declare "memory", getDefaultMemory() won't see it
             MemoryInstance* default_mem = getDefaultMemory(_instance);
-            if(default_mem) {
+            if(default_mem && _memory_snapshot) {
+               resetMemoryToSnapshot(default_mem, _memory_snapshot);
+            }
+            else if(default_mem) {
                //reset memory resizes the sandbox'ed memory to the module's init memory size and then
                // (effectively) memzeros it all
                resetMemory(default_mem, _module->memories.defs[0].type);
@@ -76,12 +101,67 @@ class wavm_instantiated_module : public wasm_instantiated_module_interface {
 
       std::vector<uint8_t>     _initial_memory;
       //naked pointer because ModuleInstance is opaque
-      //_instance is deleted via WAVM's object garbage collection when wavm_rutime is deleted
+      //_instance is deleted via WAVM's object garbage collection once it has been released
       ModuleInstance*          _instance;
       std::unique_ptr<Module>  _module;
+      size_t                   _code_size;
+      std::shared_ptr<wavm_runtime::runtime_guard> _runtime_guard;
+      MemorySnapshot*          _memory_snapshot = nullptr;
+
+      //below this, zeroing and copying in the initial memory is about as fast as the page faults a snapshot takes
+      static constexpr uint64_t memory_snapshot_min_bytes = 4*IR::numBytesPerPage;
 };
 
 
+/**
+ * Persists the machine code WAVM generates for each contract in a directory, so that it is
+ * loaded instead of recompiled the first time the contract runs after a restart or replay.
+ * Failing to read or write the cache is not fatal; the code is simply compiled again.
+ */
+class wavm_code_cache : public Runtime::ObjectCache {
+   public:
+      explicit wavm_code_cache(const fc::path& dir) : _dir(dir) {
+         if( !fc::exists( _dir ) )
+            fc::create_directories( _dir );
+      }
+
+      bool load(const std::string& key, std::vector<U8>& object_bytes) override {
+         try {
+            const fc::path object_path = path_for( key );
+            if( !fc::exists( object_path ) )
+               return false;
+
+            std::string contents;
+            fc::read_file_contents( object_path, contents );
+            object_bytes.assign( contents.begin(), contents.end() );
+            return !object_bytes.empty();
+         } FC_LOG_AND_DROP()
+         return false;
+      }
+
+      void store(const std::string& key, const std::vector<U8>& object_bytes) override {
+         try {
+            // write to a temporary file and move it into place so readers never see a partial object
+            const fc::path object_path = path_for( key );
+            const fc::path tmp_path = object_path.generic_string() + ".tmp";
+            {
+               std::ofstream out( tmp_path.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc );
+               out.write( (const char*)object_bytes.data(), object_bytes.size() );
+               out.close();
+               dcc_ASSERT( !out.fail(), wasm_exception, "unable to write ${p}", ("p", tmp_path) );
+            }
+            fc::rename( tmp_path, object_path );
+         } FC_LOG_AND_DROP()
+      }
+
+   private:
+      fc::path path_for(const std::string& key) const {
+         return _dir / (fc::sha256::hash( key ).str() + ".o");
+      }
+
+      fc::path _dir;
+};
+
 wavm_runtime::runtime_guard::runtime_guard() {
    // TODO clean this up
    //check_wasm_opcode_dispositions();
@@ -92,10 +172,42 @@ wavm_runtime::runtime_guard::~runtime_guard() {
    Runtime::freeUnreferencedObjects({});
 }
 
+void wavm_runtime::runtime_guard::add_instance(ModuleInstance* instance) {
+   std::lock_guard<std::mutex> l(instances_mutex);
+   live_instances.insert(instance);
+}
+
+void wavm_runtime::runtime_guard::release_instance(ModuleInstance* instance) {
+   {
+      std::lock_guard<std::mutex> l(instances_mutex);
+      live_instances.erase(instance);
+      collect_pending = true;
+   }
+   // an instantiation running on another thread collects for us once it is done
+   std::unique_lock<std::mutex> gc(gc_mutex, std::try_to_lock);
+   if(gc.owns_lock())
+      collect();
+}
+
+void wavm_runtime::runtime_guard::collect() {
+   std::lock_guard<std::mutex> l(instances_mutex);
+   if(!collect_pending)
+      return;
+   collect_pending = false;
+   Runtime::freeUnreferencedObjects(std::vector<ObjectInstance*>(live_instances.begin(), live_instances.end()));
+}
+
+//must be incremented whenever a change to the injected code or the intrinsics changes what a contract compiles to,
+// so code cached by previous versions is not loaded
+static constexpr uint32_t code_cache_version = 1;
+
 static weak_ptr<wavm_runtime::runtime_guard> __runtime_guard_ptr;
 static std::mutex __runtime_guard_lock;
 
-wavm_runtime::wavm_runtime() {
+wavm_runtime::wavm_runtime(const fc::path& code_cache_dir) {
+   if( !code_cache_dir.string().empty() )
+      _code_cache = std::make_unique<wavm_code_cache>(code_cache_dir);
+
    std::lock_guard<std::mutex> l(__runtime_guard_lock);
    if (__runtime_guard_ptr.use_count() == 0) {
       _runtime_guard = std::make_shared<runtime_guard>();
@@ -108,7 +220,7 @@ wavm_runtime::wavm_runtime() {
 wavm_runtime::~wavm_runtime() {
 }
 
-std::unique_ptr<wasm_instantiated_module_interface> wavm_runtime::instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory) {
+std::unique_ptr<wasm_instantiated_module_interface> wavm_runtime::instantiate_module(const char* code_bytes, size_t code_size, std::vector<uint8_t> initial_memory, const digest_type& code_id) {
    std::unique_ptr<Module> module = std::make_unique<Module>();
    try {
       Serialization::MemoryInputStream stream((const U8*)code_bytes, code_size);
@@ -121,10 +233,18 @@ std::unique_ptr<wasm_instantiated_module_interface> wavm_runtime::instantiate_mo
 
    dccio::chain::webassembly::common::root_resolver resolver;
    LinkResult link_result = linkModule(*module, resolver);
-   ModuleInstance *instance = instantiateModule(*module, std::move(link_result.resolvedImports));
+
+   // objects of a half constructed instance must not be collected from under it
+   std::lock_guard<std::mutex> gc(_runtime_guard->gc_mutex);
+   auto collect_released = fc::make_scoped_exit([this](){
+      _runtime_guard->collect();
+   });
+   ModuleInstance *instance = instantiateModule(*module, std::move(link_result.resolvedImports), _code_cache.get(),
+                                                code_id.str() + "-" + std::to_string(code_cache_version));
    dcc_ASSERT(instance != nullptr, wasm_exception, "Fail to Instantiate WAVM Module");
+   _runtime_guard->add_instance(instance);
 
-   return std::make_unique<wavm_instantiated_module>(instance, std::move(module), initial_memory);
+   return std::make_unique<wavm_instantiated_module>(instance, std::move(module), initial_memory, code_size, _runtime_guard);
 }
 
 void wavm_runtime::immediately_exit_currently_running_module() {
@@ -7,6 +7,7 @@
 #include <boost/interprocess/containers/deque.hpp>
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
+#include <boost/interprocess/allocators/node_allocator.hpp>
 #include <boost/interprocess/sync/interprocess_sharable_mutex.hpp>
 #include <boost/interprocess/sync/sharable_lock.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
@@ -128,30 +129,43 @@ namespace chainbase {
    template<typename Constructor, typename Allocator> \
    OBJECT_TYPE( Constructor&& c, Allocator&&  ) { c(*this); }
 
+   /**
+    *  The undo state of one revision. The prior values of the objects changed during the revision are the
+    *  entries of the index's undo log starting at undo_log_begin; objects created during the revision are
+    *  exactly those with an id of at least old_next_id, because ids are handed out in increasing order.
+    *  recorded_ids lets modify find out whether the revision already holds the prior value of an object without
+    *  searching the undo log; it only grows with the objects the revision touches.
+    */
    template< typename value_type >
    class undo_state
    {
       public:
          typedef typename value_type::id_type                      id_type;
-         typedef allocator< std::pair<const id_type, value_type> > id_value_allocator_type;
-         typedef allocator< id_type >                              id_allocator_type;
+         typedef bip::node_allocator< id_type, bip::managed_mapped_file::segment_manager > id_allocator_type;
+         typedef bip::set< id_type, std::less<id_type>, id_allocator_type > id_set_type;
 
          template<typename T>
          undo_state( allocator<T> al )
-         :old_values( id_value_allocator_type( al.get_segment_manager() ) ),
-          removed_values( id_value_allocator_type( al.get_segment_manager() ) ),
-          new_ids( id_allocator_type( al.get_segment_manager() ) ){}
-
-         typedef boost::interprocess::map< id_type, value_type, std::less<id_type>, id_value_allocator_type >  id_value_type_map;
-         typedef boost::interprocess::set< id_type, std::less<id_type>, id_allocator_type >                    id_type_set;
+         :recorded_ids( std::less<id_type>(), id_allocator_type( al.get_segment_manager() ) ){}
 
-         id_value_type_map            old_values;
-         id_value_type_map            removed_values;
-         id_type_set                  new_ids;
+         id_set_type                  recorded_ids;
+         uint64_t                     undo_log_begin = 0;
          id_type                      old_next_id = 0;
          int64_t                      revision = 0;
    };
 
+   /**
+    *  An entry of the undo log: the value of an object before it was modified or removed
+    */
+   template< typename value_type >
+   struct undo_entry
+   {
+      undo_entry( const value_type& v, bool r ):value(v),removed(r){}
+
+      value_type                   value;
+      bool                         removed = false;
+   };
+
    /**
     * The code we want to implement is this:
     *
@@ -190,9 +204,10 @@ namespace chainbase {
          typedef typename index_type::value_type                       value_type;
          typedef bip::allocator< generic_index, segment_manager_type > allocator_type;
          typedef undo_state< value_type >                              undo_state_type;
+         typedef undo_entry< value_type >                              undo_entry_type;
 
          generic_index( allocator<value_type> a )
-         :_stack(a),_indices( a ),_size_of_value_type( sizeof(typename MultiIndexType::node_type) ),_size_of_this(sizeof(*this)){}
+         :_stack(a),_undo_log(a),_indices( a ),_size_of_value_type( sizeof(typename MultiIndexType::node_type) ),_size_of_this(sizeof(*this)){}
 
          void validate()const {
             if( sizeof(typename MultiIndexType::node_type) != _size_of_value_type || sizeof(*this) != _size_of_this )
@@ -258,7 +273,7 @@ namespace chainbase {
          class session {
             public:
                session( session&& mv )
-               :_index(mv._index),_apply(mv._apply){ mv._apply = false; }
+               :_index(mv._index),_apply(mv._apply),_revision(mv._revision){ mv._apply = false; }
 
                ~session() {
                   if( _apply ) {
@@ -276,6 +291,7 @@ namespace chainbase {
                   if( this == &mv ) return *this;
                   if( _apply ) _index.undo();
                   _apply = mv._apply;
+                  _revision = mv._revision;
                   mv._apply = false;
                   return *this;
                }
@@ -299,6 +315,7 @@ namespace chainbase {
          session start_undo_session( bool enabled ) {
             if( enabled ) {
                _stack.emplace_back( _indices.get_allocator() );
+               _stack.back().undo_log_begin = _undo_log.size();
                _stack.back().old_next_id = _next_id;
                _stack.back().revision = ++_revision;
                return session( *this, _revision );
@@ -318,22 +335,25 @@ namespace chainbase {
 
             const auto& head = _stack.back();
 
-            for( auto& item : head.old_values ) {
-               auto ok = _indices.modify( _indices.find( item.second.id ), [&]( value_type& v ) {
-                  v = std::move( item.second );
-               });
-               if( !ok ) BOOST_THROW_EXCEPTION( std::logic_error( "Could not modify object, most likely a uniqueness constraint was violated" ) );
-            }
-
-            for( auto id : head.new_ids )
-            {
-               _indices.erase( _indices.find( id ) );
-            }
+            _indices.erase( _indices.lower_bound( head.old_next_id ), _indices.end() );
             _next_id = head.old_next_id;
 
-            for( auto& item : head.removed_values ) {
-               bool ok = _indices.emplace( std::move( item.second ) ).second;
-               if( !ok ) BOOST_THROW_EXCEPTION( std::logic_error( "Could not restore object, most likely a uniqueness constraint was violated" ) );
+            // After a squash an object may have several entries, the oldest of them is applied last. Entries
+            // for objects created in this revision are left over from a squashed revision and can be skipped.
+            while( _undo_log.size() > head.undo_log_begin ) {
+               auto& entry = _undo_log.back();
+               if( entry.value.id._id < head.old_next_id._id ) {
+                  if( entry.removed ) {
+                     bool ok = _indices.emplace( std::move( entry.value ) ).second;
+                     if( !ok ) BOOST_THROW_EXCEPTION( std::logic_error( "Could not restore object, most likely a uniqueness constraint was violated" ) );
+                  } else {
+                     auto ok = _indices.modify( _indices.find( entry.value.id ), [&]( value_type& v ) {
+                        v = std::move( entry.value );
+                     });
+                     if( !ok ) BOOST_THROW_EXCEPTION( std::logic_error( "Could not modify object, most likely a uniqueness constraint was violated" ) );
+                  }
+               }
+               _undo_log.pop_back();
             }
 
             _stack.pop_back();
@@ -351,100 +371,20 @@ namespace chainbase {
             if( !enabled() ) return;
             if( _stack.size() == 1 ) {
                _stack.pop_front();
+               _undo_log.clear();
                --_revision;
                return;
             }
 
-            auto& state = _stack.back();
-            auto& prev_state = _stack[_stack.size()-2];
-
-            // An object's relationship to a state can be:
-            // in new_ids            : new
-            // in old_values (was=X) : upd(was=X)
-            // in removed (was=X)    : del(was=X)
-            // not in any of above   : nop
-            //
-            // When merging A=prev_state and B=state we have a 4x4 matrix of all possibilities:
-            //
-            //                   |--------------------- B ----------------------|
-            //
-            //                +------------+------------+------------+------------+
-            //                | new        | upd(was=Y) | del(was=Y) | nop        |
-            //   +------------+------------+------------+------------+------------+
-            // / | new        | N/A        | new       A| nop       C| new       A|
-            // | +------------+------------+------------+------------+------------+
-            // | | upd(was=X) | N/A        | upd(was=X)A| del(was=X)C| upd(was=X)A|
-            // A +------------+------------+------------+------------+------------+
-            // | | del(was=X) | N/A        | N/A        | N/A        | del(was=X)A|
-            // | +------------+------------+------------+------------+------------+
-            // \ | nop        | new       B| upd(was=Y)B| del(was=Y)B| nop      AB|
-            //   +------------+------------+------------+------------+------------+
-            //
-            // Each entry was composed by labelling what should occur in the given case.
-            //
-            // Type A means the composition of states contains the same entry as the first of the two merged states for that object.
-            // Type B means the composition of states contains the same entry as the second of the two merged states for that object.
-            // Type C means the composition of states contains an entry different from either of the merged states for that object.
-            // Type N/A means the composition of states violates causal timing.
-            // Type AB means both type A and type B simultaneously.
-            //
-            // The merge() operation is defined as modifying prev_state in-place to be the state object which represents the composition of
-            // state A and B.
-            //
-            // Type A (and AB) can be implemented as a no-op; prev_state already contains the correct value for the merged state.
-            // Type B (and AB) can be implemented by copying from state to prev_state.
-            // Type C needs special case-by-case logic.
-            // Type N/A can be ignored or assert(false) as it can only occur if prev_state and state have illegal values
-            // (a serious logic error which should never happen).
-            //
-
-            // We can only be outside type A/AB (the nop path) if B is not nop, so it suffices to iterate through B's three containers.
-
-            for( const auto& item : state.old_values )
-            {
-               if( prev_state.new_ids.find( item.second.id ) != prev_state.new_ids.end() )
-               {
-                  // new+upd -> new, type A
-                  continue;
-               }
-               if( prev_state.old_values.find( item.second.id ) != prev_state.old_values.end() )
-               {
-                  // upd(was=X) + upd(was=Y) -> upd(was=X), type A
-                  continue;
-               }
-               // del+upd -> N/A
-               assert( prev_state.removed_values.find(item.second.id) == prev_state.removed_values.end() );
-               // nop+upd(was=Y) -> upd(was=Y), type B
-               prev_state.old_values.emplace( std::move(item) );
-            }
-
-            // *+new, but we assume the N/A cases don't happen, leaving type B nop+new -> new
-            for( auto id : state.new_ids )
-               prev_state.new_ids.insert(id);
-
-            // *+del
-            for( auto& obj : state.removed_values )
-            {
-               if( prev_state.new_ids.find(obj.second.id) != prev_state.new_ids.end() )
-               {
-                  // new + del -> nop (type C)
-                  prev_state.new_ids.erase(obj.second.id);
-                  continue;
-               }
-               auto it = prev_state.old_values.find(obj.second.id);
-               if( it != prev_state.old_values.end() )
-               {
-                  // upd(was=X) + del(was=Y) -> del(was=X)
-                  prev_state.removed_values.emplace( std::move(*it) );
-                  prev_state.old_values.erase(obj.second.id);
-                  continue;
-               }
-               // del + del -> N/A
-               assert( prev_state.removed_values.find( obj.second.id ) == prev_state.removed_values.end() );
-               // nop + del(was=Y) -> del(was=Y)
-               prev_state.removed_values.emplace( std::move(obj) ); //[obj.second->id] = std::move(obj.second);
-            }
-
+            // The undo log entries of both revisions are contiguous, so the prior revision simply takes over
+            // those of the head revision. Entries for objects the prior revision already recorded or created
+            // are redundant but harmless: undo applies entries newest first and then the older ones win. The
+            // prior revision also takes over the recorded ids, merging the smaller set into the larger one.
+            auto& head = _stack.back();
+            auto& prior = _stack[_stack.size() - 2];
+            if( head.recorded_ids.size() > prior.recorded_ids.size() )
+               head.recorded_ids.swap( prior.recorded_ids );
+            prior.recorded_ids.insert( head.recorded_ids.begin(), head.recorded_ids.end() );
             _stack.pop_back();
             --_revision;
          }
@@ -458,6 +398,12 @@ namespace chainbase {
             {
                _stack.pop_front();
             }
+
+            const uint64_t discarded = _stack.size() ? _stack.front().undo_log_begin : _undo_log.size();
+            if( discarded == 0 ) return;
+            _undo_log.erase( _undo_log.begin(), _undo_log.begin() + discarded );
+            for( auto& state : _stack )
+               state.undo_log_begin -= discarded;
          }
 
          /**
@@ -504,52 +450,46 @@ namespace chainbase {
       private:
          bool enabled()const { return _stack.size(); }
 
+         /**
+          *  Returns true if the prior value of v must be recorded in the undo log of the head revision, that is
+          *  if v existed before the head revision started and has not been recorded since then.
+          */
+         bool needs_undo_entry( const value_type& v )const {
+            const auto& head = _stack.back();
+            if( v.id._id >= head.old_next_id._id )
+               return false;
+            return head.recorded_ids.find( v.id ) == head.recorded_ids.end();
+         }
+
          void on_modify( const value_type& v ) {
             if( !enabled() ) return;
+            if( !needs_undo_entry( v ) ) return;
 
-            auto& head = _stack.back();
-
-            if( head.new_ids.find( v.id ) != head.new_ids.end() )
-               return;
-
-            auto itr = head.old_values.find( v.id );
-            if( itr != head.old_values.end() )
-               return;
-
-            head.old_values.emplace( std::pair< typename value_type::id_type, const value_type& >( v.id, v ) );
+            _undo_log.emplace_back( v, false );
+            _stack.back().recorded_ids.insert( v.id );
          }
 
          void on_remove( const value_type& v ) {
             if( !enabled() ) return;
+            if( v.id._id >= _stack.back().old_next_id._id ) return;
 
-            auto& head = _stack.back();
-            if( head.new_ids.count(v.id) ) {
-               head.new_ids.erase( v.id );
-               return;
-            }
-
-            auto itr = head.old_values.find( v.id );
-            if( itr != head.old_values.end() ) {
-               head.removed_values.emplace( std::move( *itr ) );
-               head.old_values.erase( v.id );
-               return;
-            }
-
-            if( head.removed_values.count( v.id ) )
-               return;
-
-            head.removed_values.emplace( std::pair< typename value_type::id_type, const value_type& >( v.id, v ) );
+            // also recorded when already modified in this revision, undo restores the object before reverting the modification
+            _undo_log.emplace_back( v, true );
+            _stack.back().recorded_ids.insert( v.id );
          }
 
-         void on_create( const value_type& v ) {
-            if( !enabled() ) return;
-            auto& head = _stack.back();
-
-            head.new_ids.insert( v.id );
+         void on_create( const value_type& ) {
+            // objects created in a revision are identified by their id, see undo_state
          }
 
          boost::interprocess::deque< undo_state_type, allocator<undo_state_type> > _stack;
 
+         /**
+          *  The prior values recorded by all revisions on the stack, oldest first; appended to by modify and
+          *  remove, truncated by undo and commit.
+          */
+         boost::interprocess::deque< undo_entry_type, allocator<undo_entry_type> > _undo_log;
+
          /**
           *  Each new session increments the revision, a squash will decrement the revision by combining
           *  the two most recent revisions into one revision.
@@ -687,9 +627,25 @@ namespace chainbase {
             read_write    = 1
          };
 
+         /**
+          *  How the state in shared_memory.bin is accessed when the database is opened read_write; read only
+          *  databases are always mapped.
+          */
+         enum map_mode {
+            mapped,  ///< through a shared mapping of the file, dirty pages are written back by the kernel
+            heap,    ///< the file is loaded into anonymous memory at startup and written back on clean shutdown
+            locked   ///< as heap, and the memory is locked with mlock so that it is never paged out
+         };
+
          using database_index_row_count_multiset = std::multiset<std::pair<unsigned, std::string>>;
 
-         database(const bfs::path& dir, open_flags write = read_only, uint64_t shared_file_size = 0, bool allow_dirty = false);
+         /**
+          *  In heap and locked mode, hugepage_size selects explicit hugepages of that size (e.g. 2 MiB or 1 GiB,
+          *  which must be reserved by the system, and the database size must be a multiple of it); when 0
+          *  transparent hugepages are requested instead, for any database size.
+          */
+         database(const bfs::path& dir, open_flags write = read_only, uint64_t shared_file_size = 0, bool allow_dirty = false,
+                  map_mode db_map_mode = mapped, uint64_t hugepage_size = 0);
          ~database();
          database(database&&) = default;
          database& operator=(database&&) = default;
@@ -1024,6 +980,7 @@ namespace chainbase {
          read_write_mutex_manager*                                   _rw_manager = nullptr;
          bool                                                        _read_only = false;
          bip::file_lock                                              _flock;
+         map_mode                                                    _map_mode = mapped;
 
          /**
           * This is a sparse list of known indices kept to accelerate creation of undo sessions
@@ -1044,6 +1001,9 @@ namespace chainbase {
 #endif
 
          void                                                        _msync_database();
+         void                                                        _load_into_memory( uint64_t hugepage_size );
+         void                                                        _mark_file_dirty( uint64_t offset );
+         bool                                                        _write_back();
    };
 
    template<typename Object, typename... Args>
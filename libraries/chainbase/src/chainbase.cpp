@@ -1,12 +1,33 @@
 #include <chainbase/chainbase.hpp>
 #include <boost/array.hpp>
 
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 namespace chainbase {
 
+   namespace {
+      constexpr uint64_t default_segment_alignment = 2*1024*1024; // lets transparent hugepages back the whole segment
+
+      // An address at which size bytes can be mapped with the given alignment
+      void* find_aligned_address( uint64_t size, uint64_t alignment ) {
+         void* reserved = mmap( nullptr, size + alignment, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+         if( reserved == MAP_FAILED )
+            BOOST_THROW_EXCEPTION( std::runtime_error( std::string( "could not reserve address space for database: " ) + strerror( errno ) ) );
+         munmap( reserved, size + alignment );
+         return reinterpret_cast<void*>( ( reinterpret_cast<uintptr_t>( reserved ) + alignment - 1 ) & ~uintptr_t( alignment - 1 ) );
+      }
+
+      bool is_zero( const char* data, size_t size ) {
+         return !size || ( !data[0] && !memcmp( data, data + 1, size - 1 ) );
+      }
+   }
+
    struct environment_check {
       environment_check() {
          memset( &compiler_version, 0, sizeof( compiler_version ) );
@@ -34,9 +55,23 @@ namespace chainbase {
       uint32_t                boost_version;
    };
 
-   database::database(const bfs::path& dir, open_flags flags, uint64_t shared_file_size, bool allow_dirty ) {
+   database::database(const bfs::path& dir, open_flags flags, uint64_t shared_file_size, bool allow_dirty,
+                      map_mode db_map_mode, uint64_t hugepage_size ) {
       bool write = flags & database::read_write;
 
+      _map_mode = write ? db_map_mode : mapped;
+      const uint64_t segment_alignment = hugepage_size ? hugepage_size : default_segment_alignment;
+      if( _map_mode != mapped && ( segment_alignment & ( segment_alignment - 1 ) ) )
+         BOOST_THROW_EXCEPTION( std::runtime_error( "hugepage size must be a power of two" ) );
+      auto segment_address = [&]( uint64_t size ) -> void* {
+         if( _map_mode == mapped )
+            return nullptr;
+         // only explicit hugepages need whole pages; transparent ones just back what is aligned
+         if( hugepage_size && size % hugepage_size )
+            BOOST_THROW_EXCEPTION( std::runtime_error( "database size must be a multiple of the hugepage size" ) );
+         return find_aligned_address( size, segment_alignment );
+      };
+
       if (!bfs::exists(dir)) {
          if(!write) BOOST_THROW_EXCEPTION( std::runtime_error( "database file not found at " + dir.native() ) );
       }
@@ -58,7 +93,8 @@ namespace chainbase {
             }
 
             _segment.reset( new bip::managed_mapped_file( bip::open_only,
-                                                          abs_path.generic_string().c_str()
+                                                          abs_path.generic_string().c_str(),
+                                                          segment_address( bfs::file_size( abs_path ) )
                                                           ) );
          } else {
             _segment.reset( new bip::managed_mapped_file( bip::open_read_only,
@@ -109,7 +145,7 @@ namespace chainbase {
       } else {
          _segment.reset( new bip::managed_mapped_file( bip::create_only,
                                                        abs_path.generic_string().c_str(), shared_file_size,
-                                                       0, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH
+                                                       segment_address( shared_file_size ), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH
                                                        ) );
          _segment->find_or_construct< environment_check >( "environment" )();
       }
@@ -160,8 +196,19 @@ namespace chainbase {
          if( !_flock.try_lock() )
             BOOST_THROW_EXCEPTION( std::runtime_error( "could not gain write access to the shared memory file" ) );
 
-         *db_is_dirty = *meta_is_dirty = true;
-         _msync_database();
+         if( _map_mode == mapped ) {
+            *db_is_dirty = *meta_is_dirty = true;
+            _msync_database();
+         } else {
+            // the file is only marked dirty once its copy is in memory, so a failed load leaves it clean; it then
+            // keeps its dirty flag until _write_back replaces it on a clean shutdown
+            const uint64_t flag_offset = reinterpret_cast<char*>( db_is_dirty ) - static_cast<char*>( _segment->get_address() );
+            _load_into_memory( hugepage_size );
+            *db_is_dirty = true;
+            _mark_file_dirty( flag_offset );
+            *meta_is_dirty = true;
+            _msync_database();
+         }
       }
    }
 
@@ -170,6 +217,9 @@ namespace chainbase {
       if(!_read_only) {
          _msync_database();
          *_segment->get_segment_manager()->find<bool>(_db_dirty_flag_string).first = false;
+         if( _map_mode != mapped && !_write_back() )
+            std::cerr << "Failed to write database back to " << ( _data_dir / "shared_memory.bin" ).native()
+                      << ", it is left marked dirty" << std::endl;
          *_meta->get_segment_manager()->find<bool>(_db_dirty_flag_string).first = false;
          _msync_database();
       }
@@ -198,6 +248,138 @@ namespace chainbase {
 #endif
    }
 
+   /**
+    *  Replaces the shared mapping of shared_memory.bin by anonymous memory at the same address holding the same
+    *  content. The segment only contains offset pointers, but keeping its address leaves _segment valid.
+    */
+   void database::_load_into_memory( uint64_t hugepage_size ) {
+      const auto path = bfs::absolute( _data_dir / "shared_memory.bin" ).generic_string();
+      char* const base = static_cast<char*>( _segment->get_address() );
+      const uint64_t size = _segment->get_size();
+
+      int fd = ::open( path.c_str(), O_RDONLY );
+      if( fd < 0 )
+         BOOST_THROW_EXCEPTION( std::runtime_error( "could not open " + path + ": " + strerror( errno ) ) );
+
+      int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+      if( hugepage_size ) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+         flags |= MAP_HUGETLB | ( __builtin_ctzll( hugepage_size ) << MAP_HUGE_SHIFT );
+#else
+         ::close( fd );
+         BOOST_THROW_EXCEPTION( std::runtime_error( "explicit hugepages are not supported on this platform" ) );
+#endif
+      }
+      if( mmap( base, size, PROT_READ | PROT_WRITE, flags, -1, 0 ) == MAP_FAILED ) {
+         const int err = errno;
+         ::close( fd );
+         BOOST_THROW_EXCEPTION( std::runtime_error( std::string( "could not allocate memory for database: " ) + strerror( err ) ) );
+      }
+#ifdef MADV_HUGEPAGE
+      if( !hugepage_size )
+         madvise( base, size, MADV_HUGEPAGE );
+#endif
+
+      // only the parts of the file holding data are read, the rest of the anonymous memory is already zero
+      uint64_t offset = 0;
+      while( offset < size ) {
+         uint64_t end = size;
+#ifdef SEEK_DATA
+         off_t data = lseek( fd, offset, SEEK_DATA );
+         if( data < 0 && errno == ENXIO )
+            break;
+         if( data >= 0 ) {
+            offset = data;
+            off_t hole = lseek( fd, offset, SEEK_HOLE );
+            if( hole >= 0 )
+               end = std::min<uint64_t>( hole, size );
+         }
+#endif
+         while( offset < end ) {
+            ssize_t r = pread( fd, base + offset, end - offset, offset );
+            if( r <= 0 ) {
+               if( r < 0 && errno == EINTR ) continue;
+               const int err = r < 0 ? errno : EIO;
+               ::close( fd );
+               BOOST_THROW_EXCEPTION( std::runtime_error( "could not read " + path + ": " + strerror( err ) ) );
+            }
+            offset += r;
+         }
+      }
+      ::close( fd );
+
+      if( _map_mode == locked && mlock( base, size ) )
+         BOOST_THROW_EXCEPTION( std::runtime_error( std::string( "could not lock database memory: " ) + strerror( errno ) ) );
+   }
+
+   /**
+    *  Sets the dirty flag at offset in shared_memory.bin, which is no longer mapped once the database is in memory
+    */
+   void database::_mark_file_dirty( uint64_t offset ) {
+      const auto path = bfs::absolute( _data_dir / "shared_memory.bin" ).generic_string();
+      int fd = ::open( path.c_str(), O_WRONLY );
+      if( fd < 0 )
+         BOOST_THROW_EXCEPTION( std::runtime_error( "could not open " + path + ": " + strerror( errno ) ) );
+      const bool dirty = true;
+      ssize_t w;
+      do {
+         w = pwrite( fd, &dirty, sizeof( dirty ), offset );
+      } while( w < 0 && errno == EINTR );
+      const bool ok = w == sizeof( dirty ) && fsync( fd ) == 0;
+      const int err = errno;
+      ::close( fd );
+      if( !ok )
+         BOOST_THROW_EXCEPTION( std::runtime_error( "could not mark " + path + " dirty: " + strerror( err ) ) );
+   }
+
+   /**
+    *  Writes the in memory database to a temporary file which then replaces shared_memory.bin, so that a failure
+    *  part way leaves the previous, dirty, file in place.
+    */
+   bool database::_write_back() {
+      const auto path = bfs::absolute( _data_dir / "shared_memory.bin" ).generic_string();
+      const auto temp_path = path + ".tmp";
+      const char* const base = static_cast<const char*>( _segment->get_address() );
+      const uint64_t size = _segment->get_size();
+
+      int fd = ::open( temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH );
+      if( fd < 0 ) {
+         perror( "Failed to create database file" );
+         return false;
+      }
+
+      // zero chunks are left as holes, which keeps the file as sparse as a mapped database
+      const uint64_t chunk_size = 1024*1024;
+      bool ok = ftruncate( fd, size ) == 0;
+      for( uint64_t chunk = 0; ok && chunk < size; chunk += chunk_size ) {
+         const uint64_t chunk_end = std::min( chunk + chunk_size, size );
+         if( is_zero( base + chunk, chunk_end - chunk ) )
+            continue;
+         for( uint64_t offset = chunk; ok && offset < chunk_end; ) {
+            ssize_t w = pwrite( fd, base + offset, chunk_end - offset, offset );
+            if( w < 0 && errno == EINTR ) continue;
+            ok = w > 0;
+            if( ok ) offset += w;
+         }
+      }
+      ok = ok && fsync( fd ) == 0;
+      if( ::close( fd ) )
+         ok = false;
+      if( ok )
+         ok = rename( temp_path.c_str(), path.c_str() ) == 0;
+      if( !ok ) {
+         perror( "Failed to write database file" );
+         return false;
+      }
+
+      int dir_fd = ::open( _data_dir.generic_string().c_str(), O_RDONLY );
+      if( dir_fd >= 0 ) {
+         fsync( dir_fd );
+         ::close( dir_fd );
+      }
+      return true;
+   }
+
    void database::set_require_locking( bool enable_require_locking )
    {
 #ifdef CHAINBASE_CHECK_LOCKING
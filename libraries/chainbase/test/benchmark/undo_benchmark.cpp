@@ -0,0 +1,118 @@
+/**
+ *  Measures the throughput of undo sessions in the pattern used by the chain controller: a session per block,
+ *  a session per transaction squashed into it, some transactions undone, and blocks committed once they are
+ *  old enough.
+ *
+ *  Usage: chainbase_undo_benchmark [rows] [blocks] [transactions per block]
+ */
+#include <chainbase/chainbase.hpp>
+
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+
+using namespace chainbase;
+using namespace boost::multi_index;
+
+struct account : public chainbase::object<0, account> {
+   CHAINBASE_DEFAULT_CONSTRUCTOR( account )
+
+   id_type  id;
+   uint64_t name = 0;
+   int64_t  balance = 0;
+};
+
+struct by_name;
+typedef multi_index_container<
+   account,
+   indexed_by<
+      ordered_unique< member<account,account::id_type,&account::id> >,
+      ordered_unique< tag<by_name>, member<account,uint64_t,&account::name> >
+   >,
+   chainbase::allocator<account>
+> account_index;
+
+CHAINBASE_SET_INDEX_TYPE( account, account_index )
+
+int main( int argc, char** argv ) {
+   const uint64_t rows         = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 100000;
+   const uint64_t blocks       = argc > 2 ? std::strtoull( argv[2], nullptr, 10 ) : 1000;
+   const uint64_t trxs         = argc > 3 ? std::strtoull( argv[3], nullptr, 10 ) : 100;
+   const uint64_t reversible   = 100; // blocks kept on the undo stack before they are committed
+   if( !rows || !blocks || !trxs ) {
+      std::fprintf( stderr, "Usage: %s [rows] [blocks] [transactions per block]\n", argv[0] );
+      return EXIT_FAILURE;
+   }
+
+   const auto dir = boost::filesystem::unique_path();
+   {
+      database db( dir, database::read_write, 1024ull*1024*1024 );
+      db.add_index<account_index>();
+
+      uint64_t next_name = 0;
+      for( uint64_t i = 0; i < rows; ++i )
+         db.create<account>( [&]( account& a ) { a.name = next_name++; } );
+
+      std::mt19937_64 rng( 1 );
+      auto random_account = [&]() -> const account* {
+         return db.find<account, by_name>( rng() % next_name );
+      };
+
+      std::deque<int64_t> block_revisions;
+      uint64_t sessions = 0, undone = 0;
+      const auto start = std::chrono::steady_clock::now();
+      for( uint64_t b = 0; b < blocks; ++b ) {
+         auto block_session = db.start_undo_session( true );
+         ++sessions;
+         for( uint64_t t = 0; t < trxs; ++t ) {
+            auto trx_session = db.start_undo_session( true );
+            ++sessions;
+
+            // a transfer, a fee charged to a frequently used account and an occasional new or closed account
+            for( int i = 0; i < 2; ++i ) {
+               if( auto a = random_account() )
+                  db.modify( *a, [&]( account& a ) { a.balance += 1; } );
+            }
+            db.modify( db.get( account::id_type(0) ), []( account& a ) { a.balance -= 1; } );
+            if( t % 10 == 0 )
+               db.create<account>( [&]( account& a ) { a.name = next_name++; } );
+            if( t % 10 == 5 ) {
+               if( auto a = random_account() )
+                  if( a->id._id != 0 ) db.remove( *a );
+            }
+
+            if( t % 20 == 19 ) {
+               trx_session.undo();
+               ++undone;
+            } else {
+               trx_session.squash();
+            }
+         }
+         block_session.push();
+         block_revisions.push_back( db.revision() );
+         if( block_revisions.size() > reversible ) {
+            db.commit( block_revisions.front() );
+            block_revisions.pop_front();
+         }
+      }
+      const auto elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+      // forks switch by undoing whole blocks
+      const auto undo_start = std::chrono::steady_clock::now();
+      const auto undone_blocks = block_revisions.size();
+      db.undo_all();
+      const auto undo_elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - undo_start ).count();
+
+      std::printf( "%llu rows, %llu blocks of %llu transactions (%llu undone)\n",
+                   (unsigned long long)rows, (unsigned long long)blocks, (unsigned long long)trxs, (unsigned long long)undone );
+      std::printf( "%12.0f sessions/s %10.3f us/session\n", sessions / elapsed, elapsed * 1e6 / sessions );
+      std::printf( "%12.3f ms to undo %zu reversible blocks\n", undo_elapsed * 1e3, undone_blocks );
+   }
+   boost::filesystem::remove_all( dir );
+   return EXIT_SUCCESS;
+}
@@ -9,6 +9,8 @@
 
 #include <iostream>
 
+#include <sys/resource.h>
+
 using namespace chainbase;
 using namespace boost::multi_index;
 
@@ -131,4 +133,162 @@ BOOST_AUTO_TEST_CASE( open_and_create ) {
    }
 }
 
+BOOST_AUTO_TEST_CASE( undo_squash_commit ) {
+   boost::filesystem::path temp = boost::filesystem::unique_path();
+   try {
+      chainbase::database db(temp, database::read_write, 1024*1024*8);
+      db.add_index< book_index >();
+
+      auto contents = [&]() {
+         std::vector<std::pair<int,int>> result;
+         for( const auto& b : db.get_index<book_index>().indices() )
+            result.emplace_back( b.a, b.b );
+         return result;
+      };
+
+      for( int i = 0; i < 4; ++i )
+         db.create<book>( [&]( book& b ) { b.a = i; b.b = i; } );
+      const auto initial = contents();
+
+      {
+         auto block = db.start_undo_session(true);
+         {
+            auto trx = db.start_undo_session(true);
+            db.modify( db.get( book::id_type(0) ), []( book& b ) { b.a = 10; } );
+            db.modify( db.get( book::id_type(0) ), []( book& b ) { b.a = 11; } );
+            db.remove( db.get( book::id_type(1) ) );
+            db.create<book>( []( book& b ) { b.a = 20; } );
+            trx.squash();
+         }
+         {
+            auto trx = db.start_undo_session(true);
+            db.modify( db.get( book::id_type(0) ), []( book& b ) { b.a = 12; } );
+            db.modify( db.get( book::id_type(4) ), []( book& b ) { b.a = 21; } );
+            db.modify( db.get( book::id_type(2) ), []( book& b ) { b.b = 30; } );
+            db.remove( db.get( book::id_type(2) ) );
+            trx.squash();
+         }
+         {
+            auto trx = db.start_undo_session(true);
+            db.modify( db.get( book::id_type(3) ), []( book& b ) { b.a = 40; } );
+            db.create<book>( []( book& b ) { b.a = 50; } );
+            // not squashed, undone when it goes out of scope
+         }
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(3) ).a, 3 );
+         BOOST_REQUIRE( db.find( book::id_type(5) ) == nullptr );
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).a, 12 );
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(4) ).a, 21 );
+         BOOST_REQUIRE( db.find( book::id_type(1) ) == nullptr );
+         BOOST_REQUIRE( db.find( book::id_type(2) ) == nullptr );
+
+         // the block took over the objects its squashed transactions recorded, not those of the undone one
+         const auto& recorded = db.get_index<book_index>().stack().back().recorded_ids;
+         BOOST_REQUIRE_EQUAL( recorded.size(), 4u );
+         BOOST_REQUIRE_EQUAL( recorded.count( book::id_type(2) ), 1u );
+         BOOST_REQUIRE_EQUAL( recorded.count( book::id_type(3) ), 0u );
+      }
+      BOOST_REQUIRE( contents() == initial );
+      BOOST_REQUIRE( db.find( book::id_type(4) ) == nullptr );
+
+      // committed revisions can no longer be undone, later ones still can
+      auto first = db.start_undo_session(true);
+      db.modify( db.get( book::id_type(0) ), []( book& b ) { b.a = 60; } );
+      first.push();
+      auto second = db.start_undo_session(true);
+      db.modify( db.get( book::id_type(0) ), []( book& b ) { b.a = 61; } );
+      db.remove( db.get( book::id_type(3) ) );
+      second.push();
+      db.commit( first.revision() );
+      db.undo_all();
+      BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).a, 60 );
+      BOOST_REQUIRE_EQUAL( db.get( book::id_type(3) ).a, 3 );
+      BOOST_REQUIRE_EQUAL( db.revision(), first.revision() );
+   } catch ( ... ) {
+      bfs::remove_all( temp );
+      throw;
+   }
+   bfs::remove_all( temp );
+}
+
+BOOST_AUTO_TEST_CASE( heap_map_mode ) {
+   boost::filesystem::path temp = boost::filesystem::unique_path();
+   try {
+      {
+         chainbase::database db(temp, database::read_write, 1024*1024*8, false, database::heap);
+         db.add_index< book_index >();
+         db.create<book>( []( book& b ) { b.a = 1; b.b = 2; } );
+      }
+      {
+         // written back on close, readable in mapped mode
+         chainbase::database db(temp, database::read_write, 1024*1024*8);
+         db.add_index< book_index >();
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).a, 1 );
+         db.modify( db.get( book::id_type(0) ), []( book& b ) { b.a = 3; } );
+      }
+      {
+         chainbase::database db(temp, database::read_write, 1024*1024*8, false, database::heap);
+         db.add_index< book_index >();
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).a, 3 );
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).b, 2 );
+      }
+      BOOST_REQUIRE( !bfs::exists( temp / "shared_memory.bin.tmp" ) );
+   } catch ( ... ) {
+      bfs::remove_all( temp );
+      throw;
+   }
+   bfs::remove_all( temp );
+}
+
+BOOST_AUTO_TEST_CASE( heap_map_mode_failed_load_leaves_file_clean ) {
+   boost::filesystem::path temp = boost::filesystem::unique_path();
+   try {
+      {
+         chainbase::database db(temp, database::read_write, 1024*1024*8);
+         db.add_index< book_index >();
+         db.create<book>( []( book& b ) { b.a = 1; } );
+      }
+
+      // locking fails under a memlock limit of zero, explicit hugepages fail unless the system reserved them
+      rlimit original;
+      BOOST_REQUIRE( getrlimit( RLIMIT_MEMLOCK, &original ) == 0 );
+      rlimit none = original;
+      none.rlim_cur = 0;
+      BOOST_REQUIRE( setrlimit( RLIMIT_MEMLOCK, &none ) == 0 );
+      for( auto mode : { std::make_pair( database::locked, uint64_t(0) ), std::make_pair( database::heap, uint64_t(2*1024*1024) ) } ) {
+         try {
+            chainbase::database db(temp, database::read_write, 1024*1024*8, false, mode.first, mode.second);
+         } catch( const std::runtime_error& ) {
+         }
+         chainbase::database db(temp, database::read_write, 1024*1024*8);
+         db.add_index< book_index >();
+         BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).a, 1 );
+      }
+      setrlimit( RLIMIT_MEMLOCK, &original );
+   } catch ( ... ) {
+      bfs::remove_all( temp );
+      throw;
+   }
+   bfs::remove_all( temp );
+}
+
+BOOST_AUTO_TEST_CASE( heap_map_mode_any_size ) {
+   boost::filesystem::path temp = boost::filesystem::unique_path();
+   try {
+      // transparent hugepages do not need the size to be a whole number of them
+      const uint64_t size = 1024*1024*8 + 64*1024;
+      {
+         chainbase::database db(temp, database::read_write, size, false, database::heap);
+         db.add_index< book_index >();
+         db.create<book>( []( book& b ) { b.a = 5; } );
+      }
+      chainbase::database db(temp, database::read_write, size);
+      db.add_index< book_index >();
+      BOOST_REQUIRE_EQUAL( db.get( book::id_type(0) ).a, 5 );
+   } catch ( ... ) {
+      bfs::remove_all( temp );
+      throw;
+   }
+   bfs::remove_all( temp );
+}
+
 // BOOST_AUTO_TEST_SUITE_END()
@@ -6,5 +6,11 @@ namespace fc
 {
 
   string zlib_compress(const string& in);
+  string zlib_decompress(const string& in);
+
+  /// compresses in as a single member gzip stream (RFC 1952)
+  string gzip_compress(const string& in);
+  /// decompresses a single member gzip stream, checking its CRC-32 and length
+  string gzip_decompress(const string& in);
 
 } // namespace fc
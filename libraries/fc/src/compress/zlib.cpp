@@ -1,4 +1,5 @@
 #include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
 
 #include "miniz.c"
 
@@ -12,4 +13,87 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  string zlib_decompress(const string& in)
+  {
+    size_t decompressed_message_length;
+    char* decompressed_message = (char*)tinfl_decompress_mem_to_heap(in.c_str(), in.size(), &decompressed_message_length, TINFL_FLAG_PARSE_ZLIB_HEADER);
+    FC_ASSERT( decompressed_message, "Unable to decompress zlib data" );
+    string result(decompressed_message, decompressed_message_length);
+    free(decompressed_message);
+    return result;
+  }
+
+  string gzip_compress(const string& in)
+  {
+    size_t deflated_length;
+    char* deflated = (char*)tdefl_compress_mem_to_heap(in.c_str(), in.size(), &deflated_length, TDEFL_DEFAULT_MAX_PROBES);
+    FC_ASSERT( deflated || in.empty(), "Unable to gzip compress data" );
+
+    // fixed header: magic, deflate method, no flags, no mtime, no extra flags, unknown OS
+    static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff' };
+    const mz_uint32 crc = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const mz_uint8*)in.c_str(), in.size());
+    const mz_uint32 isize = (mz_uint32)in.size();
+
+    string result;
+    result.reserve(sizeof(header) + deflated_length + 8);
+    result.append(header, sizeof(header));
+    if (deflated) {
+      result.append(deflated, deflated_length);
+      free(deflated);
+    } else {
+      // an empty final stored block
+      result.append("\x03\x00", 2);
+    }
+    // trailer is little endian
+    for (int i = 0; i < 4; ++i)
+      result.push_back((char)((crc >> (8 * i)) & 0xff));
+    for (int i = 0; i < 4; ++i)
+      result.push_back((char)((isize >> (8 * i)) & 0xff));
+    return result;
+  }
+
+  string gzip_decompress(const string& in)
+  {
+    enum { FHCRC = 2, FEXTRA = 4, FNAME = 8, FCOMMENT = 16 };
+    const auto* data = (const unsigned char*)in.data();
+    const size_t size = in.size();
+    FC_ASSERT( size >= 18 && data[0] == 0x1f && data[1] == 0x8b && data[2] == 8, "Not gzip data" );
+    const unsigned char flags = data[3];
+    size_t pos = 10;
+    if (flags & FEXTRA) {
+      FC_ASSERT( pos + 2 <= size, "Truncated gzip header" );
+      pos += 2 + (data[pos] | (data[pos + 1] << 8));
+    }
+    for (int field : { FNAME, FCOMMENT }) {
+      if (flags & field) {
+        while (pos < size && data[pos] != 0)
+          ++pos;
+        ++pos;
+      }
+    }
+    if (flags & FHCRC)
+      pos += 2;
+    FC_ASSERT( pos + 8 <= size, "Truncated gzip data" );
+
+    auto read_le32 = [&](size_t at) {
+      return (mz_uint32)data[at] | ((mz_uint32)data[at + 1] << 8) | ((mz_uint32)data[at + 2] << 16) | ((mz_uint32)data[at + 3] << 24);
+    };
+
+    // the trailer is taken from the end of the data, as tinfl may read past the end of the deflate stream
+    const size_t trailer = size - 8;
+    string result;
+    size_t deflated_length = trailer - pos;
+    auto append = [](const void* buf, int len, void* out) -> int {
+      ((string*)out)->append((const char*)buf, len);
+      return 1;
+    };
+    FC_ASSERT( tinfl_decompress_mem_to_callback(data + pos, &deflated_length, append, &result, 0) == 1,
+               "Unable to decompress gzip data" );
+
+    const mz_uint32 crc = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const mz_uint8*)result.data(), result.size());
+    FC_ASSERT( read_le32(trailer) == crc, "gzip CRC-32 mismatch" );
+    FC_ASSERT( read_le32(trailer + 4) == (mz_uint32)result.size(), "gzip length mismatch" );
+    return result;
+  }
 }
@@ -10,8 +10,131 @@
 
 #include <boost/filesystem/fstream.hpp>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace fc
 {
+   namespace detail
+   {
+      /**
+       *  Reads JSON text held in memory with the peek(), get() and eof() behavior of std::istream that the
+       *  parsers rely on: reading at the end returns EOF and sets eof() instead of throwing.
+       */
+      class buffer_reader
+      {
+         public:
+            buffer_reader( const char* begin, const char* end )
+            :pos(begin),end(end){}
+
+            int peek()
+            {
+               if( pos == end )
+               {
+                  at_eof = true;
+                  return EOF;
+               }
+               return static_cast<unsigned char>(*pos);
+            }
+
+            int get()
+            {
+               if( pos == end )
+               {
+                  at_eof = true;
+                  return EOF;
+               }
+               return static_cast<unsigned char>(*pos++);
+            }
+
+            bool eof()const { return at_eof; }
+
+            /**
+             *  Appends the characters up to the next '"', '\\' or ^D to str, the ones a quoted string
+             *  passes through unchanged.
+             */
+            void read_plain_chars( std::string& str )
+            {
+               const char* start = pos;
+#if defined(__SSE2__)
+               const __m128i quote = _mm_set1_epi8( '"' );
+               const __m128i backslash = _mm_set1_epi8( '\\' );
+               const __m128i eot = _mm_set1_epi8( 0x04 );
+               while( end - pos >= 16 )
+               {
+                  __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pos) );
+                  __m128i special = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, quote ),
+                                                                _mm_cmpeq_epi8( chunk, backslash ) ),
+                                                  _mm_cmpeq_epi8( chunk, eot ) );
+                  int mask = _mm_movemask_epi8( special );
+                  if( mask != 0 )
+                  {
+                     pos += __builtin_ctz( mask );
+                     str.append( start, pos );
+                     return;
+                  }
+                  pos += 16;
+               }
+#endif
+               while( pos != end && *pos != '"' && *pos != '\\' && *pos != 0x04 )
+                  ++pos;
+               str.append( start, pos );
+            }
+
+         private:
+            const char* pos;
+            const char* end;
+            bool        at_eof = false;
+      };
+
+      /**
+       *  Appends to a std::string with the subset of std::ostream operations the JSON writer uses, without the
+       *  per character overhead of a stream.
+       */
+      class string_writer
+      {
+         public:
+            explicit string_writer( std::string& out )
+            :out(out){}
+
+            string_writer& operator<<( char c )                { out.push_back( c ); return *this; }
+            string_writer& operator<<( const char* str )       { out.append( str ); return *this; }
+            string_writer& operator<<( const std::string& str ) { out.append( str ); return *this; }
+            string_writer& operator<<( uint64_t i )
+            {
+               char buf[20];
+               char* p = buf + sizeof(buf);
+               do {
+                  *--p = char('0' + i % 10);
+                  i /= 10;
+               } while( i != 0 );
+               out.append( p, buf + sizeof(buf) );
+               return *this;
+            }
+            string_writer& operator<<( int64_t i )
+            {
+               if( i < 0 )
+               {
+                  out.push_back( '-' );
+                  return *this << (0 - static_cast<uint64_t>(i));
+               }
+               return *this << static_cast<uint64_t>(i);
+            }
+
+            string_writer& write( const char* data, size_t size ) { out.append( data, size ); return *this; }
+
+         private:
+            std::string& out;
+      };
+
+      /// generic streams read a quoted string one character at a time
+      template<typename T>
+      void read_plain_chars( T&, std::string& ) {}
+
+      inline void read_plain_chars( buffer_reader& in, std::string& str ) { in.read_plain_chars( str ); }
+   }
+
     // forward declarations of provided functions
     template<typename T, json::parse_type parser_type> variant variant_from_stream( T& in, uint32_t max_depth );
     template<typename T> char parseEscape( T& in );
@@ -89,7 +212,7 @@ namespace fc
    template<typename T>
    std::string stringFromStream( T& in )
    {
-      std::stringstream token;
+      std::string token;
       try
       {
          char c = in.peek();
@@ -104,28 +227,29 @@ namespace fc
             switch( c = in.peek() )
             {
                case '\\':
-                  token << parseEscape( in );
+                  token += parseEscape( in );
                   break;
                case 0x04:
                   FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '${token}'",
-                                                   ("token", token.str() ) );
+                                                   ("token", token ) );
                case '"':
                   in.get();
-                  return token.str();
+                  return token;
                default:
-                  token << c;
+                  token += c;
                   in.get();
+                  detail::read_plain_chars( in, token );
             }
          }
          FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '${token}'",
-                                          ("token", token.str() ) );
+                                          ("token", token ) );
        } FC_RETHROW_EXCEPTIONS( warn, "while parsing token '${token}'",
-                                          ("token", token.str() ) );
+                                          ("token", token ) );
    }
    template<typename T>
    std::string stringFromToken( T& in )
    {
-      std::stringstream token;
+      std::string token;
       try
       {
          char c = in.peek();
@@ -135,37 +259,37 @@ namespace fc
             switch( c = in.peek() )
             {
                case '\\':
-                  token << parseEscape( in );
+                  token += parseEscape( in );
                   break;
                case '\t':
                case ' ':
                case '\n':
                   in.get();
-                  return token.str();
+                  return token;
                case '\0':
                   FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
                default:
                 if( isalnum( c ) || c == '_' || c == '-' || c == '.' || c == ':' || c == '/' )
                 {
-                  token << c;
+                  token += c;
                   in.get();
                 }
-                else return token.str();
+                else return token;
             }
          }
-         return token.str();
+         return token;
       }
       catch( const fc::eof_exception& eof )
       {
-         return token.str();
+         return token;
       }
       catch (const std::ios_base::failure&)
       {
-         return token.str();
+         return token;
       }
 
       FC_RETHROW_EXCEPTIONS( warn, "while parsing token '${token}'",
-                                          ("token", token.str() ) );
+                                          ("token", token ) );
    }
 
    template<typename T, json::parse_type parser_type>
@@ -253,14 +377,14 @@ namespace fc
    template<typename T, json::parse_type parser_type>
    variant number_from_stream( T& in )
    {
-      std::stringstream ss;
+      std::string ss;
 
       bool  dot = false;
       bool  neg = false;
       if( in.peek() == '-')
       {
         neg = true;
-        ss.put( in.get() );
+        ss += char( in.get() );
       }
       bool done = false;
 
@@ -285,14 +409,14 @@ namespace fc
               case '7':
               case '8':
               case '9':
-                 ss.put( in.get() );
+                 ss += char( in.get() );
                  break;
               case '\0':
                  FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
               default:
                  if( isalnum( c ) )
                  {
-                    return ss.str() + stringFromToken( in );
+                    return ss + stringFromToken( in );
                  }
                 done = true;
                 break;
@@ -305,7 +429,7 @@ namespace fc
       catch (const std::ios_base::failure&)
       {
       }
-      std::string str = ss.str();
+      std::string& str = ss;
       if (str == "-." || str == "." || str == "-") // check the obviously wrong things we could have encountered
         FC_THROW_EXCEPTION(parse_error_exception, "Can't parse token \"${token}\" as a JSON numeric constant", ("token", str));
       if( dot )
@@ -317,8 +441,7 @@ namespace fc
    template<typename T>
    variant token_from_stream( T& in )
    {
-      std::stringstream ss;
-      ss.exceptions( std::ifstream::badbit );
+      std::string ss;
       bool received_eof = false;
       bool done = false;
 
@@ -338,7 +461,7 @@ namespace fc
               case 'f':
               case 'a':
               case 's':
-                 ss.put( in.get() );
+                 ss += char( in.get() );
                  break;
               default:
                  done = true;
@@ -357,7 +480,7 @@ namespace fc
 
       // we can get here either by processing a delimiter as in "null,"
       // an EOF like "null<EOF>", or an invalid token like "nullZ"
-      std::string str = ss.str();
+      std::string& str = ss;
       if( str == "null" )
         return variant();
       if( str == "true" )
@@ -442,18 +565,17 @@ namespace fc
 
    variant json::from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
-      std::stringstream in( utf8_str );
-      //in.exceptions( std::ifstream::eofbit );
+      detail::buffer_reader in( utf8_str.data(), utf8_str.data() + utf8_str.size() );
       switch( ptype )
       {
           case legacy_parser:
-             return variant_from_stream<std::stringstream, legacy_parser>( in, max_depth );
+             return variant_from_stream<detail::buffer_reader, legacy_parser>( in, max_depth );
           case legacy_parser_with_string_doubles:
-              return variant_from_stream<std::stringstream, legacy_parser_with_string_doubles>( in, max_depth );
+              return variant_from_stream<detail::buffer_reader, legacy_parser_with_string_doubles>( in, max_depth );
           case strict_parser:
-              return json_relaxed::variant_from_stream<std::stringstream, true>( in, max_depth );
+              return json_relaxed::variant_from_stream<detail::buffer_reader, true>( in, max_depth );
           case relaxed_parser:
-              return json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth );
+              return json_relaxed::variant_from_stream<detail::buffer_reader, false>( in, max_depth );
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
       }
@@ -462,13 +584,12 @@ namespace fc
    variants json::variants_from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
       variants result;
-      std::stringstream in( utf8_str );
-      //in.exceptions( std::ifstream::eofbit );
+      detail::buffer_reader in( utf8_str.data(), utf8_str.data() + utf8_str.size() );
       try {
          while( true )
          {
            // result.push_back( variant_from_stream( in ));
-           result.push_back(json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth ));
+           result.push_back(json_relaxed::variant_from_stream<detail::buffer_reader, false>( in, max_depth ));
          }
       } catch ( const fc::eof_exception& ){}
       return result;
@@ -491,11 +612,19 @@ namespace fc
     *
     *  All other characters are printed as UTF8.
     */
-   void escape_string( const string& str, std::ostream& os )
+   template<typename T>
+   void escape_string( const string& str, T& os )
    {
       os << '"';
-      for( auto itr = str.begin(); itr != str.end(); ++itr )
+      const char* run = str.data();
+      const char* end = str.data() + str.size();
+      for( const char* itr = run; itr != end; ++itr )
       {
+         // runs of characters that need no escaping are written as one block
+         if( static_cast<unsigned char>(*itr) >= 0x20 && *itr != '"' && *itr != '\\' )
+            continue;
+         os.write( run, itr - run );
+         run = itr + 1;
          switch( *itr )
          {
             case '\b':        // \x08
@@ -552,14 +681,16 @@ namespace fc
             case '\x1d': os << "\\u001d"; break;
             case '\x1e': os << "\\u001e"; break;
             case '\x1f': os << "\\u001f"; break;
-
-            default:
-               os << *itr;
-               //toUTF8( *itr, os );
          }
       }
+      os.write( run, end - run );
       os << '"';
    }
+
+   void escape_string( const string& str, std::ostream& os )
+   {
+      escape_string<std::ostream>( str, os );
+   }
    std::ostream& json::to_stream( std::ostream& out, const std::string& str )
    {
         escape_string( str, out );
@@ -663,9 +794,10 @@ namespace fc
 
    std::string   json::to_string( const variant& v, output_formatting format )
    {
-      std::stringstream ss;
-      fc::to_stream( ss, v, format );
-      return ss.str();
+      std::string out;
+      detail::string_writer w( out );
+      fc::to_stream( w, v, format );
+      return out;
    }
 
 
@@ -836,20 +968,20 @@ namespace fc
    bool json::is_valid( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    {
       if( utf8_str.size() == 0 ) return false;
-      std::stringstream in( utf8_str );
+      detail::buffer_reader in( utf8_str.data(), utf8_str.data() + utf8_str.size() );
       switch( ptype )
       {
           case legacy_parser:
-             variant_from_stream<std::stringstream, legacy_parser>( in, max_depth );
+             variant_from_stream<detail::buffer_reader, legacy_parser>( in, max_depth );
               break;
           case legacy_parser_with_string_doubles:
-             variant_from_stream<std::stringstream, legacy_parser_with_string_doubles>( in, max_depth );
+             variant_from_stream<detail::buffer_reader, legacy_parser_with_string_doubles>( in, max_depth );
               break;
           case strict_parser:
-             json_relaxed::variant_from_stream<std::stringstream, true>( in, max_depth );
+             json_relaxed::variant_from_stream<detail::buffer_reader, true>( in, max_depth );
               break;
           case relaxed_parser:
-             json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth );
+             json_relaxed::variant_from_stream<detail::buffer_reader, false>( in, max_depth );
               break;
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
@@ -94,6 +94,29 @@ namespace Platform
 	// baseVirtualAddress must be a multiple of the preferred page size.
 	PLATFORM_API void freeVirtualPages(U8* baseVirtualAddress,Uptr numPages);
 
+	// Creates an unnamed file of numPages pages that holds the given data followed by zeros, for mapPageFileCopyOnWrite.
+	// Returns -1 if the platform doesn't support page files or the file couldn't be created.
+	PLATFORM_API I64 createPageFile(const U8* data,Uptr numDataBytes,Uptr numPages);
+
+	// Closes a page file. Pages that are still mapped from it remain valid.
+	PLATFORM_API void closePageFile(I64 pageFile);
+
+	// Replaces the specified virtual pages with a private mapping of the first numPages pages of a page file: they read
+	// the file's contents, and are only copied when written to.
+	// baseVirtualAddress must be a multiple of the preferred page size.
+	// Returns false if the pages couldn't be mapped and the file's contents were copied into them instead.
+	PLATFORM_API bool mapPageFileCopyOnWrite(U8* baseVirtualAddress,Uptr numPages,I64 pageFile);
+
+	// Discards the writes to pages mapped by mapPageFileCopyOnWrite, so they read the file's contents again.
+	// baseVirtualAddress must be a multiple of the preferred page size.
+	// Returns false if the platform can't discard them in place, in which case they must be mapped again.
+	PLATFORM_API bool discardPrivatePages(U8* baseVirtualAddress,Uptr numPages);
+
+	// Replaces pages mapped by mapPageFileCopyOnWrite with decommitted anonymous pages, which read as zeros once
+	// committed again; decommitting a page file's pages only drops the private copies of them.
+	// baseVirtualAddress must be a multiple of the preferred page size.
+	PLATFORM_API void unmapPageFile(U8* baseVirtualAddress,Uptr numPages);
+
 	//
 	// Call stack and exceptions
 	//
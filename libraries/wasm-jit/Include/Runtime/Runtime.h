@@ -202,18 +202,47 @@ namespace Runtime
 		std::vector<GlobalInstance*> globals;
 	};
 
+	// A store for the machine code generated for modules, e.g. to reuse it across process restarts.
+	struct ObjectCache
+	{
+		virtual ~ObjectCache() {}
+
+		// Looks up the object code stored for a key. Returns false if there is none.
+		virtual bool load(const std::string& key,std::vector<U8>& outObjectBytes) = 0;
+
+		// Stores the object code generated for a key.
+		virtual void store(const std::string& key,const std::vector<U8>& objectBytes) = 0;
+	};
+
 	// Instantiates a module, bindings its imports to the specified objects. May throw InstantiationException.
-	RUNTIME_API ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports);
+	// If an object cache is given, the module's machine code is loaded from it instead of being generated when possible.
+	// objectCacheKey must uniquely identify the module's code; the runtime adds its own version information to it.
+	RUNTIME_API ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports,ObjectCache* objectCache = nullptr,const std::string& objectCacheKey = std::string());
 
 	// Gets the default table/memory for a ModuleInstance.
 	RUNTIME_API MemoryInstance* getDefaultMemory(ModuleInstance* moduleInstance);
 	RUNTIME_API uint64_t getDefaultMemorySize(ModuleInstance* moduleInstance);
 	RUNTIME_API TableInstance* getDefaultTable(ModuleInstance* moduleInstance);
 
+	// Gets the number of bytes of memory used by a ModuleInstance's generated machine code.
+	RUNTIME_API Uptr getModuleInstanceCodeSize(ModuleInstance* moduleInstance);
+
 	RUNTIME_API void runInstanceStartFunc(ModuleInstance* moduleInstance);
 	RUNTIME_API void resetGlobalInstances(ModuleInstance* moduleInstance);
 	RUNTIME_API void resetMemory(MemoryInstance* memory, IR::MemoryType& newMemoryType);
 
+	// The initial contents of a memory, kept in pages that a memory can be reset to by mapping them copy-on-write.
+	struct MemorySnapshot;
+
+	// Creates a snapshot of a memory of the given type that starts with initialData followed by zeros.
+	// Returns null if the platform can't map snapshots, in which case memories must be reset with resetMemory.
+	RUNTIME_API MemorySnapshot* createMemorySnapshot(const IR::MemoryType& type,const U8* initialData,Uptr numInitialBytes);
+	RUNTIME_API void destroyMemorySnapshot(MemorySnapshot* snapshot);
+
+	// Resets a memory to the type and contents of a snapshot. When the memory was last reset to the same snapshot,
+	// only the pages written since then are restored.
+	RUNTIME_API void resetMemoryToSnapshot(MemoryInstance* memory,MemorySnapshot* snapshot);
+
 	// Gets an object exported by a ModuleInstance by name.
 	RUNTIME_API ObjectInstance* getInstanceExport(ModuleInstance* moduleInstance,const std::string& name);
 }
@@ -1,6 +1,7 @@
 #include "Types.h"
 
 #include <map>
+#include <mutex>
 
 namespace IR
 {
@@ -20,11 +21,18 @@ namespace IR
 			static std::map<Key,FunctionType*> map;
 			return map;
 		}
+		// Modules may be loaded on multiple threads, so access to the map is serialized.
+		static std::mutex& getMutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
 	};
 
 	template<typename Key,typename Value,typename CreateValueThunk>
 	Value findExistingOrCreateNew(std::map<Key,Value>& map,Key&& key,CreateValueThunk createValueThunk)
 	{
+		std::lock_guard<std::mutex> lock(FunctionTypeMap::getMutex());
 		auto mapIt = map.find(key);
 		if(mapIt != map.end()) { return mapIt->second; }
 		else
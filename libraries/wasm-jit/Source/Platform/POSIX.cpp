@@ -6,11 +6,13 @@
 
 #include <pthread.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/mman.h>
 
 #include <errno.h>
 #include <signal.h>
 #include <setjmp.h>
+#include <stdlib.h>
 #include <sys/resource.h>
 #include <string.h>
 #include <iostream>
@@ -28,6 +30,7 @@
 #ifdef __linux__
 	#include <execinfo.h>
 	#include <dlfcn.h>
+	#include <sys/syscall.h>
 #endif
 #ifdef __FreeBSD__
 	#include <execinfo.h>
@@ -107,6 +110,95 @@ namespace Platform
 		if(munmap(baseVirtualAddress,numPages << getPageSizeLog2())) { Errors::fatal("munmap failed"); }
 	}
 
+	static int createUnnamedFile()
+	{
+		int fd = -1;
+		#if defined(__linux__) && defined(SYS_memfd_create)
+			// MFD_CLOEXEC
+			fd = (int)syscall(SYS_memfd_create,"wavm-page-file",1u);
+			if(fd >= 0) { return fd; }
+		#endif
+
+		const char* tmpDir = getenv("TMPDIR");
+		std::string path = std::string(tmpDir && *tmpDir ? tmpDir : "/tmp") + "/wavm-page-file-XXXXXX";
+		fd = mkstemp(&path[0]);
+		if(fd < 0) { return -1; }
+		unlink(path.c_str());
+		fcntl(fd,F_SETFD,FD_CLOEXEC);
+		return fd;
+	}
+
+	I64 createPageFile(const U8* data,Uptr numDataBytes,Uptr numPages)
+	{
+		const Uptr numBytes = numPages << getPageSizeLog2();
+		errorUnless(numDataBytes <= numBytes);
+
+		int fd = createUnnamedFile();
+		if(fd < 0) { return -1; }
+		if(ftruncate(fd,numBytes)) { close(fd); return -1; }
+
+		Uptr numWrittenBytes = 0;
+		while(numWrittenBytes < numDataBytes)
+		{
+			auto result = pwrite(fd,data + numWrittenBytes,numDataBytes - numWrittenBytes,numWrittenBytes);
+			if(result < 0 && errno == EINTR) { continue; }
+			if(result <= 0) { close(fd); return -1; }
+			numWrittenBytes += result;
+		}
+		return fd;
+	}
+
+	void closePageFile(I64 pageFile)
+	{
+		close((int)pageFile);
+	}
+
+	bool mapPageFileCopyOnWrite(U8* baseVirtualAddress,Uptr numPages,I64 pageFile)
+	{
+		errorUnless(isPageAligned(baseVirtualAddress));
+		auto numBytes = numPages << getPageSizeLog2();
+		if(mmap(baseVirtualAddress,numBytes,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_FIXED,(int)pageFile,0) != MAP_FAILED)
+		{
+			return true;
+		}
+
+		// A failed MAP_FIXED may have unmapped the pages, so map anonymous pages back in before something else can take
+		// their addresses, and read the file into them.
+		if(mmap(baseVirtualAddress,numBytes,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,-1,0) == MAP_FAILED)
+		{
+			Errors::fatal("mmap failed");
+		}
+		Uptr numReadBytes = 0;
+		while(numReadBytes < numBytes)
+		{
+			auto result = pread((int)pageFile,baseVirtualAddress + numReadBytes,numBytes - numReadBytes,numReadBytes);
+			if(result < 0 && errno == EINTR) { continue; }
+			if(result <= 0) { Errors::fatal("pread failed"); }
+			numReadBytes += result;
+		}
+		return false;
+	}
+
+	bool discardPrivatePages(U8* baseVirtualAddress,Uptr numPages)
+	{
+		errorUnless(isPageAligned(baseVirtualAddress));
+		#ifdef __linux__
+			// On Linux, dropping the private copies of a file mapping's pages makes them read the file again.
+			return madvise(baseVirtualAddress,numPages << getPageSizeLog2(),MADV_DONTNEED) == 0;
+		#else
+			return false;
+		#endif
+	}
+
+	void unmapPageFile(U8* baseVirtualAddress,Uptr numPages)
+	{
+		errorUnless(isPageAligned(baseVirtualAddress));
+		if(mmap(baseVirtualAddress,numPages << getPageSizeLog2(),PROT_NONE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,-1,0) == MAP_FAILED)
+		{
+			Errors::fatal("mmap failed");
+		}
+	}
+
 	bool describeInstructionPointer(Uptr ip,std::string& outDescription)
 	{
 		#if defined __linux__ || defined __FreeBSD__
@@ -85,6 +85,31 @@ namespace Platform
 		if(baseVirtualAddress && !result) { Errors::fatal("VirtualFree(MEM_RELEASE) failed"); }
 	}
 
+	I64 createPageFile(const U8* data,Uptr numDataBytes,Uptr numPages)
+	{
+		return -1;
+	}
+
+	void closePageFile(I64 pageFile)
+	{
+		Errors::unreachable();
+	}
+
+	bool mapPageFileCopyOnWrite(U8* baseVirtualAddress,Uptr numPages,I64 pageFile)
+	{
+		Errors::unreachable();
+	}
+
+	bool discardPrivatePages(U8* baseVirtualAddress,Uptr numPages)
+	{
+		return false;
+	}
+
+	void unmapPageFile(U8* baseVirtualAddress,Uptr numPages)
+	{
+		Errors::unreachable();
+	}
+
 	// The interface to the DbgHelp DLL
 	struct DbgHelp
 	{
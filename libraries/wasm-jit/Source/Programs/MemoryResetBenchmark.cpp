@@ -0,0 +1,94 @@
+#include "Inline/BasicTypes.h"
+#include "Inline/Timing.h"
+#include "Platform/Platform.h"
+#include "Runtime/Runtime.h"
+
+#include "CLI.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace IR;
+using namespace Runtime;
+
+// Compares resetting a memory by zeroing it and copying in its initial image with resetting it to a snapshot,
+// for memories of several sizes and actions that write to several numbers of pages between resets.
+
+static void writePages(MemoryInstance* memory,Uptr numMemoryBytes,Uptr numDirtyPages)
+{
+	const Uptr platformPageBytes = Uptr(1) << Platform::getPageSizeLog2();
+	const Uptr numPlatformPages = numMemoryBytes / platformPageBytes;
+	U8* base = getMemoryBaseAddress(memory);
+	for(Uptr pageIndex = 0;pageIndex < numDirtyPages && pageIndex < numPlatformPages;++pageIndex)
+	{
+		// Spread the writes over the whole memory.
+		const Uptr offset = (pageIndex * numPlatformPages / numDirtyPages) * platformPageBytes;
+		base[offset] += 1;
+	}
+}
+
+static F64 benchmarkCopyReset(MemoryInstance* memory,MemoryType type,const std::vector<U8>& image,Uptr numDirtyPages,Uptr numIterations)
+{
+	Timing::Timer timer;
+	for(Uptr iteration = 0;iteration < numIterations;++iteration)
+	{
+		resetMemory(memory,type);
+		memcpy(getMemoryBaseAddress(memory),image.data(),image.size());
+		writePages(memory,type.size.min << numBytesPerPageLog2,numDirtyPages);
+	}
+	return F64(timer.getMicroseconds()) / numIterations;
+}
+
+static F64 benchmarkSnapshotReset(MemoryInstance* memory,MemorySnapshot* snapshot,MemoryType type,Uptr numDirtyPages,Uptr numIterations)
+{
+	Timing::Timer timer;
+	for(Uptr iteration = 0;iteration < numIterations;++iteration)
+	{
+		resetMemoryToSnapshot(memory,snapshot);
+		writePages(memory,type.size.min << numBytesPerPageLog2,numDirtyPages);
+	}
+	return F64(timer.getMicroseconds()) / numIterations;
+}
+
+int commandMain(int argc,char** argv)
+{
+	if(argc > 2)
+	{
+		std::cerr << "Usage: MemoryResetBenchmark [iterations]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const Uptr numIterations = argc == 2 ? Uptr(std::strtoull(argv[1],nullptr,10)) : 1000;
+	if(!numIterations) { return EXIT_FAILURE; }
+
+	const U64 memoryPageCounts[] = {1, 4, 16, 33};
+	const Uptr dirtyPageCounts[] = {1, 16, 256};
+
+	std::printf("%8s %8s %14s %14s\n","pages","dirtied","copy (us)","snapshot (us)");
+	for(U64 numPages : memoryPageCounts)
+	{
+		const MemoryType type(false,{numPages,numPages + 1});
+		MemoryInstance* memory = createMemory(type);
+		if(!memory) { std::cerr << "Failed to create memory" << std::endl; return EXIT_FAILURE; }
+
+		// An initial image that fills half the memory.
+		std::vector<U8> image((numPages << numBytesPerPageLog2) / 2);
+		for(Uptr index = 0;index < image.size();++index) { image[index] = U8(index * 31); }
+
+		MemorySnapshot* snapshot = createMemorySnapshot(type,image.data(),image.size());
+		if(!snapshot) { std::cerr << "Memory snapshots are not supported on this platform" << std::endl; return EXIT_FAILURE; }
+
+		for(Uptr numDirtyPages : dirtyPageCounts)
+		{
+			const F64 copyMicroseconds = benchmarkCopyReset(memory,type,image,numDirtyPages,numIterations);
+			const F64 snapshotMicroseconds = benchmarkSnapshotReset(memory,snapshot,type,numDirtyPages,numIterations);
+			std::printf("%8" PRIu64 " %8" PRIuPTR " %14.2f %14.2f\n",numPages,numDirtyPages,copyMicroseconds,snapshotMicroseconds);
+		}
+
+		destroyMemorySnapshot(snapshot);
+	}
+
+	freeUnreferencedObjects({});
+	return EXIT_SUCCESS;
+}
@@ -116,6 +116,13 @@ namespace Intrinsics
 		delete memory;
 	}
 
+	Runtime::FunctionInstance* findFunctionByDecoratedName(const std::string& decoratedName)
+	{
+		Platform::Lock Lock(Singleton::get().mutex);
+		auto keyValue = Singleton::get().functionMap.find(decoratedName);
+		return keyValue == Singleton::get().functionMap.end() ? nullptr : keyValue->second->function;
+	}
+
 	Runtime::ObjectInstance* find(const std::string& name,const IR::ObjectType& type)
 	{
 		std::string decoratedName = getDecoratedName(name,type);
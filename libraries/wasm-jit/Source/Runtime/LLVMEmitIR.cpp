@@ -27,6 +27,9 @@ namespace LLVMJIT
 		llvm::Constant* defaultTableMaxElementIndex;
 		llvm::Constant* defaultMemoryBase;
 		llvm::Constant* defaultMemoryEndOffset;
+
+		// An opaque type for the runtime objects referenced through imported symbols, so LLVM doesn't make assumptions about their size.
+		llvm::StructType* importedObjectType;
 		
 		llvm::DIBuilder diBuilder;
 		llvm::DICompileUnit* diCompileUnit;
@@ -41,6 +44,7 @@ namespace LLVMJIT
 		: module(inModule)
 		, moduleInstance(inModuleInstance)
 		, llvmModule(new llvm::Module("",context))
+		, importedObjectType(llvm::StructType::create(context,"wavmImportedObject"))
 		, diBuilder(*llvmModule)
 		{
 			diModuleScope = diBuilder.createFile("unknown","unknown");
@@ -62,6 +66,19 @@ namespace LLVMJIT
 
 		}
 		llvm::Module* emit();
+
+		// Emits a reference to an imported symbol, as either a pointer or an integer of the given type.
+		llvm::Constant* emitImportedSymbol(const std::string& symbolName,llvm::Type* type)
+		{
+			auto symbol = llvmModule->getOrInsertGlobal(symbolName,importedObjectType);
+			return type->isPointerTy()
+				? llvm::ConstantExpr::getPointerCast(symbol,type)
+				: llvm::ConstantExpr::getPtrToInt(symbol,type);
+		}
+		llvm::Constant* emitImportedSymbol(ImportedSymbolKind kind,Uptr index,llvm::Type* type)
+		{
+			return emitImportedSymbol(getImportedSymbolName(kind,index),type);
+		}
 	};
 
 	// The context used by functions involved in JITing a single AST function.
@@ -299,6 +316,15 @@ namespace LLVMJIT
 			return llvm::Intrinsic::getDeclaration(moduleContext.llvmModule,id,llvm::ArrayRef<llvm::Type*>(argTypes.begin(),argTypes.end()));
 		}
 		
+		// Emits a reference to the FunctionInstance of the function being emitted, as an i64.
+		llvm::Constant* emitFunctionInstanceSymbol()
+		{
+			auto& functionDefs = moduleContext.moduleInstance->functionDefs;
+			auto functionDefIt = std::find(functionDefs.begin(),functionDefs.end(),functionInstance);
+			WAVM_ASSERT_THROW(functionDefIt != functionDefs.end());
+			return moduleContext.emitImportedSymbol(ImportedSymbolKind::functionDef,Uptr(functionDefIt - functionDefs.begin()),llvmI64Type);
+		}
+
 		// Emits a call to a WAVM intrinsic function.
 		llvm::Value* emitRuntimeIntrinsic(const char* intrinsicName,const FunctionType* intrinsicType,const std::initializer_list<llvm::Value*>& args)
 		{
@@ -306,7 +332,7 @@ namespace LLVMJIT
 			WAVM_ASSERT_THROW(intrinsicObject);
 			FunctionInstance* intrinsicFunction = asFunction(intrinsicObject);
 			WAVM_ASSERT_THROW(intrinsicFunction->type == intrinsicType);
-			auto intrinsicFunctionPointer = emitLiteralPointer(intrinsicFunction->nativeFunction,asLLVMType(intrinsicType)->getPointerTo());
+			auto intrinsicFunctionPointer = moduleContext.emitImportedSymbol(getIntrinsicSymbolName(intrinsicName,intrinsicType),asLLVMType(intrinsicType)->getPointerTo());
 			return irBuilder.CreateCall(intrinsicFunctionPointer,llvm::ArrayRef<llvm::Value*>(args.begin(),args.end()));
 		}
 
@@ -687,7 +713,7 @@ namespace LLVMJIT
 			// Load the type for this table entry.
 			auto functionTypePointerPointer = irBuilder.CreateInBoundsGEP(moduleContext.defaultTablePointer,{functionIndexZExt,emitLiteral((U32)0)});
 			auto functionTypePointer = irBuilder.CreateLoad(functionTypePointerPointer);
-			auto llvmCalleeType = emitLiteralPointer(calleeType,llvmI8PtrType);
+			auto llvmCalleeType = moduleContext.emitImportedSymbol(ImportedSymbolKind::functionType,imm.type.index,llvmI8PtrType);
 			
 			// If the function type doesn't match, trap.
 			emitConditionalTrapIntrinsic(
@@ -696,7 +722,7 @@ namespace LLVMJIT
 				FunctionType::get(ResultType::none,{ValueType::i32,ValueType::i64,ValueType::i64}),
 				{	tableElementIndex,
 					irBuilder.CreatePtrToInt(llvmCalleeType,llvmI64Type),
-					emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultTable))	}
+					moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultTable,0,llvmI64Type)	}
 				);
 
 			// Call the function loaded from the table.
@@ -750,7 +776,7 @@ namespace LLVMJIT
 		void grow_memory(MemoryImm)
 		{
 			auto deltaNumPages = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultMemory,0,llvmI64Type);
 			auto previousNumPages = emitRuntimeIntrinsic(
 				"wavmIntrinsics.growMemory",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i64}),
@@ -759,7 +785,7 @@ namespace LLVMJIT
 		}
 		void current_memory(MemoryImm)
 		{
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultMemory,0,llvmI64Type);
 			auto currentNumPages = emitRuntimeIntrinsic(
 				"wavmIntrinsics.currentMemory",
 				FunctionType::get(ResultType::i32,{ValueType::i64}),
@@ -1234,7 +1260,7 @@ namespace LLVMJIT
 		{
 			auto numWaiters = pop();
 			auto address = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultMemory,0,llvmI64Type);
 			push(emitRuntimeIntrinsic(
 				"wavmIntrinsics.wake",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i32,ValueType::i64}),
@@ -1245,7 +1271,7 @@ namespace LLVMJIT
 			auto timeout = pop();
 			auto expectedValue = pop();
 			auto address = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultMemory,0,llvmI64Type);
 			push(emitRuntimeIntrinsic(
 				"wavmIntrinsics.wait",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i32,ValueType::f64,ValueType::i64}),
@@ -1256,7 +1282,7 @@ namespace LLVMJIT
 			auto timeout = pop();
 			auto expectedValue = pop();
 			auto address = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultMemory,0,llvmI64Type);
 			push(emitRuntimeIntrinsic(
 				"wavmIntrinsics.wait",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i64,ValueType::f64,ValueType::i64}),
@@ -1269,7 +1295,7 @@ namespace LLVMJIT
 			auto errorFunctionIndex = pop();
 			auto argument = pop();
 			auto functionIndex = pop();
-			auto defaultTableAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultTable));
+			auto defaultTableAsI64 = moduleContext.emitImportedSymbol(ImportedSymbolKind::defaultTable,0,llvmI64Type);
 			emitRuntimeIntrinsic(
 				"wavmIntrinsics.launchThread",
 				FunctionType::get(ResultType::none,{ValueType::i32,ValueType::i32,ValueType::i32,ValueType::i64}),
@@ -1513,7 +1539,7 @@ namespace LLVMJIT
 			emitRuntimeIntrinsic(
 				"wavmIntrinsics.debugEnterFunction",
 				FunctionType::get(ResultType::none,{ValueType::i64}),
-				{emitLiteral(reinterpret_cast<U64>(functionInstance))}
+				{emitFunctionInstanceSymbol()}
 				);
 		}
 
@@ -1564,7 +1590,7 @@ namespace LLVMJIT
 			emitRuntimeIntrinsic(
 				"wavmIntrinsics.debugExitFunction",
 				FunctionType::get(ResultType::none,{ValueType::i64}),
-				{emitLiteral(reinterpret_cast<U64>(functionInstance))}
+				{emitFunctionInstanceSymbol()}
 				);
 		}
 
@@ -1580,7 +1606,7 @@ namespace LLVMJIT
 		// Create literals for the default memory base and mask.
 		if(moduleInstance->defaultMemory)
 		{
-			defaultMemoryBase = emitLiteralPointer(moduleInstance->defaultMemory->baseAddress,llvmI8PtrType);
+			defaultMemoryBase = emitImportedSymbol(ImportedSymbolKind::defaultMemoryBase,0,llvmI8PtrType);
 			const Uptr defaultMemoryEndOffsetValue = Uptr(moduleInstance->defaultMemory->endOffset);
 			defaultMemoryEndOffset = emitLiteral(defaultMemoryEndOffsetValue);
 		}
@@ -1593,7 +1619,7 @@ namespace LLVMJIT
 				llvmI8PtrType,
 				llvmI8PtrType
 				});
-			defaultTablePointer = emitLiteralPointer(moduleInstance->defaultTable->baseAddress,tableElementType->getPointerTo());
+			defaultTablePointer = emitImportedSymbol(ImportedSymbolKind::defaultTableBase,0,tableElementType->getPointerTo());
 			defaultTableMaxElementIndex = emitLiteral(((Uptr)moduleInstance->defaultTable->endOffset)/sizeof(TableInstance::FunctionElement));
 		}
 		else
@@ -1605,12 +1631,15 @@ namespace LLVMJIT
 		for(Uptr functionIndex = 0;functionIndex < module.functions.imports.size();++functionIndex)
 		{
 			const FunctionInstance* functionInstance = moduleInstance->functions[functionIndex];
-			importedFunctionPointers.push_back(emitLiteralPointer(functionInstance->nativeFunction,asLLVMType(functionInstance->type)->getPointerTo()));
+			importedFunctionPointers.push_back(emitImportedSymbol(ImportedSymbolKind::importedFunction,functionIndex,asLLVMType(functionInstance->type)->getPointerTo()));
 		}
 
 		// Create LLVM pointer constants for the module's globals.
-		for(auto global : moduleInstance->globals)
-		{ globalPointers.push_back(emitLiteralPointer(&global->value,asLLVMType(global->type.valueType)->getPointerTo())); }
+		for(Uptr globalIndex = 0;globalIndex < moduleInstance->globals.size();++globalIndex)
+		{
+			const GlobalInstance* global = moduleInstance->globals[globalIndex];
+			globalPointers.push_back(emitImportedSymbol(ImportedSymbolKind::global,globalIndex,asLLVMType(global->type.valueType)->getPointerTo()));
+		}
 		
 		// Create the LLVM functions.
 		functionDefs.resize(module.functions.defs.size());
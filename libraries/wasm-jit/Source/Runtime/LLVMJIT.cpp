@@ -4,6 +4,8 @@
 #include "Logging/Logging.h"
 #include "RuntimePrivate.h"
 #include "IR/Validate.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 #ifdef _DEBUG
 	// This needs to be 1 to allow debuggers such as Visual Studio to place breakpoints and step through the JITed code.
@@ -57,8 +59,13 @@ namespace LLVMJIT
 	std::map<Uptr,struct JITSymbol*> addressToSymbolMap;
 
 	// A map from function types to function indices in the invoke thunk unit.
+	Platform::Mutex* invokeThunkMapMutex = Platform::createMutex();
 	std::map<const FunctionType*,struct JITSymbol*> invokeThunkTypeToSymbolMap;
 
+	// Serializes use of the LLVM context and target machine, so modules can be compiled on another thread
+	// than the one executing WebAssembly code.
+	Platform::Mutex* llvmMutex = Platform::createMutex();
+
 	// Information about a JIT symbol, used to map instruction pointers to descriptive names.
 	struct JITSymbol
 	{
@@ -169,6 +176,7 @@ namespace LLVMJIT
 		}
 
 		U8* getImageBaseAddress() const { return imageBaseAddress; }
+		Uptr getNumImageBytes() const { return numAllocatedImagePages << Platform::getPageSizeLog2(); }
 
 	private:
 		struct Section
@@ -227,21 +235,30 @@ namespace LLVMJIT
 		{
 			objectLayer = llvm::make_unique<ObjectLayer>(NotifyLoadedFunctor(this),NotifyFinalizedFunctor(this));
 			objectLayer->setProcessAllSections(true);
-			compileLayer = llvm::make_unique<CompileLayer>(*objectLayer,llvm::orc::SimpleCompiler(*targetMachine));
 		}
 		~JITUnit()
 		{
 			if(handleIsValid)
-				compileLayer->removeModuleSet(handle);
+				objectLayer->removeObjectSet(handle);
 			#ifdef _WIN64
 				if(pdataCopy) { Platform::deregisterSEHUnwindInfo(reinterpret_cast<Uptr>(pdataCopy)); }
 			#endif
 		}
 
-		void compile(llvm::Module* llvmModule);
+		// Generates machine code for a LLVM module and loads it. If outObjectBytes is non-null, the object code is copied to it.
+		void compile(llvm::Module* llvmModule,llvm::JITSymbolResolver* resolver,std::vector<U8>* outObjectBytes = nullptr);
 
 		virtual void notifySymbolLoaded(const char* name,Uptr baseAddress,Uptr numBytes,std::map<U32,U32>&& offsetToOpIndexMap) = 0;
 
+		Uptr getNumUnitImageBytes() const { return memoryManager.getNumImageBytes(); }
+
+	protected:
+
+		typedef std::unique_ptr<llvm::object::OwningBinary<llvm::object::ObjectFile>> ObjectPtr;
+
+		// Links an object into memory, resolving its external symbols with the given resolver.
+		void loadObject(ObjectPtr&& object,llvm::JITSymbolResolver* resolver);
+
 	private:
 		
 		// Functor that receives notifications when an object produced by the JIT is loaded.
@@ -264,12 +281,10 @@ namespace LLVMJIT
 			void operator()(const llvm::orc::ObjectLinkingLayerBase::ObjSetHandleT& objectSetHandle);
 		};
 		typedef llvm::orc::ObjectLinkingLayer<NotifyLoadedFunctor> ObjectLayer;
-		typedef llvm::orc::IRCompileLayer<ObjectLayer> CompileLayer;
 
 		UnitMemoryManager memoryManager;
 		std::unique_ptr<ObjectLayer> objectLayer;
-		std::unique_ptr<CompileLayer> compileLayer;
-		CompileLayer::ModuleSetHandleT handle;
+		ObjectLayer::ObjSetHandleT handle;
 		bool handleIsValid = false;
 		bool shouldLogMetrics;
 
@@ -324,6 +339,11 @@ namespace LLVMJIT
 				}
 			}
 		}
+
+		Uptr getNumImageBytes() const override { return getNumUnitImageBytes(); }
+
+		// Loads object code previously generated for the module. Returns false if the object code can't be used for this instance.
+		bool load(const IR::Module& module,const std::vector<U8>& objectBytes,llvm::JITSymbolResolver* resolver);
 	};
 
 	// The JIT compilation unit for a single invoke thunk.
@@ -394,6 +414,22 @@ namespace LLVMJIT
 	}
 	llvm::JITSymbol NullResolver::findSymbolInLogicalDylib(const std::string& name) { return llvm::JITSymbol(nullptr); }
 
+	// Resolves the symbols imported by a module's code to the objects of a module instance.
+	struct ModuleSymbolResolver : NullResolver
+	{
+		const IR::Module& module;
+		ModuleInstance* moduleInstance;
+
+		ModuleSymbolResolver(const IR::Module& inModule,ModuleInstance* inModuleInstance): module(inModule), moduleInstance(inModuleInstance) {}
+
+		virtual llvm::JITSymbol findSymbol(const std::string& name) override
+		{
+			Uptr address = 0;
+			if(getImportedSymbolAddress(module,moduleInstance,name,address)) { return llvm::JITSymbol(address,llvm::JITSymbolFlags::None); }
+			return NullResolver::findSymbol(name);
+		}
+	};
+
 	void JITUnit::NotifyLoadedFunctor::operator()(
 		const llvm::orc::ObjectLinkingLayerBase::ObjSetHandleT& objectSetHandle,
 		const std::vector<std::unique_ptr<llvm::object::OwningBinary<llvm::object::ObjectFile>>>& objectSet,
@@ -555,7 +591,7 @@ namespace LLVMJIT
 		Log::printf(Log::Category::debug,"Dumped LLVM module to: %s\n",augmentedFilename.c_str());
 	}
 
-	void JITUnit::compile(llvm::Module* llvmModule)
+	void JITUnit::compile(llvm::Module* llvmModule,llvm::JITSymbolResolver* resolver,std::vector<U8>* outObjectBytes)
 	{
 		// Get a target machine object for this host, and set the module to use its data layout.
 		llvmModule->setDataLayout(targetMachine->createDataLayout());
@@ -593,14 +629,18 @@ namespace LLVMJIT
 
 		if(DUMP_OPTIMIZED_MODULE) { printModule(llvmModule,"llvmOptimizedDump"); }
 
-		// Pass the module to the JIT compiler.
+		// Generate machine code for the module.
 		Timing::Timer machineCodeTimer;
-		handle = compileLayer->addModuleSet(
-			std::vector<llvm::Module*>{llvmModule},
-			&memoryManager,
-			&NullResolver::singleton);
-		handleIsValid = true;
-		compileLayer->emitAndFinalize(handle);
+		auto object = llvm::make_unique<llvm::object::OwningBinary<llvm::object::ObjectFile>>(llvm::orc::SimpleCompiler(*targetMachine)(*llvmModule));
+		if(!object->getBinary()) { Errors::fatal("LLVM failed to generate an object file"); }
+		if(outObjectBytes)
+		{
+			const llvm::StringRef objectData = object->getBinary()->getData();
+			outObjectBytes->assign(objectData.bytes_begin(),objectData.bytes_end());
+		}
+
+		// Load the generated machine code.
+		loadObject(std::move(object),resolver);
 
 		if(shouldLogMetrics)
 		{
@@ -610,17 +650,89 @@ namespace LLVMJIT
 		delete llvmModule;
 	}
 
-	void instantiateModule(const IR::Module& module,ModuleInstance* moduleInstance)
+	void JITUnit::loadObject(ObjectPtr&& object,llvm::JITSymbolResolver* resolver)
 	{
-		// Emit LLVM IR for the module.
-		auto llvmModule = emitModule(module,moduleInstance);
+		std::vector<ObjectPtr> objectSet;
+		objectSet.push_back(std::move(object));
+		handle = objectLayer->addObjectSet(std::move(objectSet),&memoryManager,resolver);
+		handleIsValid = true;
+		objectLayer->emitAndFinalize(handle);
+	}
+
+	bool JITModule::load(const IR::Module& module,const std::vector<U8>& objectBytes,llvm::JITSymbolResolver* resolver)
+	{
+		auto objectBuffer = llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef((const char*)objectBytes.data(),objectBytes.size()));
+		auto objectFile = llvm::object::ObjectFile::createObjectFile(objectBuffer->getMemBufferRef());
+		if(!objectFile)
+		{
+			llvm::consumeError(objectFile.takeError());
+			return false;
+		}
+
+		// Check that all the runtime objects the code refers to exist, rather than failing to link it.
+		for(const auto& symbol : (*objectFile)->symbols())
+		{
+			if(!(symbol.getFlags() & llvm::object::SymbolRef::SF_Undefined)) { continue; }
+			auto name = symbol.getName();
+			if(!name)
+			{
+				llvm::consumeError(name.takeError());
+				return false;
+			}
+			Uptr address = 0;
+			if(isImportedSymbolName(name->str()) && !getImportedSymbolAddress(module,moduleInstance,name->str(),address)) { return false; }
+		}
+
+		loadObject(llvm::make_unique<llvm::object::OwningBinary<llvm::object::ObjectFile>>(std::move(*objectFile),std::move(objectBuffer)),resolver);
+		return true;
+	}
+
+	// Changes to the JIT that affect the generated object code must increment this, to invalidate previously cached object code.
+	static const U32 objectCodeVersion = 1;
+
+	// Gets the key that a module's object code is cached under: the caller's key for the module's code,
+	// and everything else that affects the generated code.
+	static std::string getObjectCacheKey(const std::string& moduleKey)
+	{
+		return moduleKey
+			+ "-wavm" + std::to_string(objectCodeVersion)
+			+ "-llvm" + LLVM_VERSION_STRING
+			+ "-" + targetMachine->getTargetTriple().str()
+			+ "-" + targetMachine->getTargetCPU().str()
+			+ "-" + targetMachine->getTargetFeatureString().str();
+	}
+
+	void instantiateModule(const IR::Module& module,ModuleInstance* moduleInstance,ObjectCache* objectCache,const std::string& objectCacheKey)
+	{
+		Platform::Lock llvmLock(llvmMutex);
 
 		// Construct the JIT compilation pipeline for this module.
 		auto jitModule = new JITModule(moduleInstance);
 		moduleInstance->jitModule = jitModule;
 
-		// Compile the module.
-		jitModule->compile(llvmModule);
+		// The module's code refers to the instance's objects through symbols that are resolved when it is loaded.
+		ModuleSymbolResolver resolver(module,moduleInstance);
+
+		// Load the module's object code from the cache if it was generated before.
+		std::string cacheKey;
+		if(objectCache)
+		{
+			cacheKey = getObjectCacheKey(objectCacheKey);
+			std::vector<U8> objectBytes;
+			if(objectCache->load(cacheKey,objectBytes))
+			{
+				if(jitModule->load(module,objectBytes,&resolver)) { return; }
+				Log::printf(Log::Category::error,"Ignoring unusable cached object code\n");
+			}
+		}
+
+		// Emit LLVM IR for the module.
+		auto llvmModule = emitModule(module,moduleInstance);
+
+		// Compile the module, and add the generated object code to the cache.
+		std::vector<U8> objectBytes;
+		jitModule->compile(llvmModule,&resolver,objectCache ? &objectBytes : nullptr);
+		if(objectCache) { objectCache->store(cacheKey,objectBytes); }
 	}
 
 	std::string getExternalFunctionName(ModuleInstance* moduleInstance,Uptr functionDefIndex)
@@ -630,6 +742,113 @@ namespace LLVMJIT
 			+ "_" + moduleInstance->functionDefs[functionDefIndex]->debugName;
 	}
 
+	static const char importedSymbolPrefix[] = "wavmImport.";
+	static const char intrinsicSymbolPrefix[] = "wavmIntrinsic.";
+	static const char* importedSymbolKindNames[(Uptr)ImportedSymbolKind::num] =
+	{
+		"defaultMemoryBase",
+		"defaultMemory",
+		"defaultTableBase",
+		"defaultTable",
+		"importedFunction",
+		"functionDef",
+		"global",
+		"functionType"
+	};
+
+	std::string getImportedSymbolName(ImportedSymbolKind kind,Uptr index)
+	{
+		WAVM_ASSERT_THROW(kind < ImportedSymbolKind::num);
+		return importedSymbolPrefix + std::string(importedSymbolKindNames[(Uptr)kind]) + "." + std::to_string(index);
+	}
+
+	std::string getIntrinsicSymbolName(const std::string& intrinsicName,const FunctionType* intrinsicType)
+	{
+		return intrinsicSymbolPrefix + Intrinsics::getDecoratedName(intrinsicName,intrinsicType);
+	}
+
+	static bool hasPrefix(const std::string& string,const char* prefix,Uptr numPrefixChars)
+	{
+		return !string.compare(0,numPrefixChars,prefix);
+	}
+
+	bool isImportedSymbolName(const std::string& symbolName)
+	{
+		#if defined(_WIN32) && !defined(_WIN64)
+			if(symbolName.size() && symbolName[0] == '_') { return isImportedSymbolName(symbolName.substr(1)); }
+		#endif
+		return hasPrefix(symbolName,importedSymbolPrefix,sizeof(importedSymbolPrefix) - 1)
+			|| hasPrefix(symbolName,intrinsicSymbolPrefix,sizeof(intrinsicSymbolPrefix) - 1);
+	}
+
+	bool getImportedSymbolAddress(const IR::Module& module,ModuleInstance* moduleInstance,const std::string& symbolName,Uptr& outAddress)
+	{
+		#if defined(_WIN32) && !defined(_WIN64)
+			if(symbolName.size() && symbolName[0] == '_') { return getImportedSymbolAddress(module,moduleInstance,symbolName.substr(1),outAddress); }
+		#endif
+
+		// Intrinsic functions are looked up by their name and type.
+		const Uptr numIntrinsicPrefixChars = sizeof(intrinsicSymbolPrefix) - 1;
+		if(hasPrefix(symbolName,intrinsicSymbolPrefix,numIntrinsicPrefixChars))
+		{
+			FunctionInstance* intrinsicFunction = Intrinsics::findFunctionByDecoratedName(symbolName.substr(numIntrinsicPrefixChars));
+			if(!intrinsicFunction) { return false; }
+			outAddress = reinterpret_cast<Uptr>(intrinsicFunction->nativeFunction);
+			return true;
+		}
+
+		// Other imported symbols are named <prefix><kind>.<index>.
+		const Uptr numImportedPrefixChars = sizeof(importedSymbolPrefix) - 1;
+		if(!hasPrefix(symbolName,importedSymbolPrefix,numImportedPrefixChars)) { return false; }
+		const Uptr indexSeparator = symbolName.rfind('.');
+		if(indexSeparator < numImportedPrefixChars || indexSeparator + 1 == symbolName.size()) { return false; }
+
+		char* indexEnd = nullptr;
+		const U64 index = std::strtoull(symbolName.c_str() + indexSeparator + 1,&indexEnd,10);
+		if(*indexEnd) { return false; }
+
+		const std::string kindName = symbolName.substr(numImportedPrefixChars,indexSeparator - numImportedPrefixChars);
+		Uptr kindIndex = 0;
+		while(kindIndex < (Uptr)ImportedSymbolKind::num && kindName != importedSymbolKindNames[kindIndex]) { ++kindIndex; }
+
+		switch((ImportedSymbolKind)kindIndex)
+		{
+		case ImportedSymbolKind::defaultMemoryBase:
+			if(!moduleInstance->defaultMemory) { return false; }
+			outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultMemory->baseAddress);
+			return true;
+		case ImportedSymbolKind::defaultMemory:
+			if(!moduleInstance->defaultMemory) { return false; }
+			outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultMemory);
+			return true;
+		case ImportedSymbolKind::defaultTableBase:
+			if(!moduleInstance->defaultTable) { return false; }
+			outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultTable->baseAddress);
+			return true;
+		case ImportedSymbolKind::defaultTable:
+			if(!moduleInstance->defaultTable) { return false; }
+			outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultTable);
+			return true;
+		case ImportedSymbolKind::importedFunction:
+			if(index >= module.functions.imports.size()) { return false; }
+			outAddress = reinterpret_cast<Uptr>(moduleInstance->functions[index]->nativeFunction);
+			return true;
+		case ImportedSymbolKind::functionDef:
+			if(index >= moduleInstance->functionDefs.size()) { return false; }
+			outAddress = reinterpret_cast<Uptr>(moduleInstance->functionDefs[index]);
+			return true;
+		case ImportedSymbolKind::global:
+			if(index >= moduleInstance->globals.size()) { return false; }
+			outAddress = reinterpret_cast<Uptr>(&moduleInstance->globals[index]->value);
+			return true;
+		case ImportedSymbolKind::functionType:
+			if(index >= module.types.size()) { return false; }
+			outAddress = reinterpret_cast<Uptr>(module.types[index]);
+			return true;
+		default: return false;
+		};
+	}
+
 	bool getFunctionIndexFromExternalName(const char* externalName,Uptr& outFunctionDefIndex)
 	{
 		#if defined(_WIN32) && !defined(_WIN64)
@@ -687,8 +906,20 @@ namespace LLVMJIT
 	InvokeFunctionPointer getInvokeThunk(const FunctionType* functionType)
 	{
 		// Reuse cached invoke thunks for the same function type.
-		auto mapIt = invokeThunkTypeToSymbolMap.find(functionType);
-		if(mapIt != invokeThunkTypeToSymbolMap.end()) { return reinterpret_cast<InvokeFunctionPointer>(mapIt->second->baseAddress); }
+		// Only the map lock is held for this, so a module being compiled on another thread doesn't block calls.
+		{
+			Platform::Lock invokeThunkMapLock(invokeThunkMapMutex);
+			auto mapIt = invokeThunkTypeToSymbolMap.find(functionType);
+			if(mapIt != invokeThunkTypeToSymbolMap.end()) { return reinterpret_cast<InvokeFunctionPointer>(mapIt->second->baseAddress); }
+		}
+
+		Platform::Lock llvmLock(llvmMutex);
+		{
+			// Another thread may have compiled the thunk while this one waited for the LLVM lock.
+			Platform::Lock invokeThunkMapLock(invokeThunkMapMutex);
+			auto mapIt = invokeThunkTypeToSymbolMap.find(functionType);
+			if(mapIt != invokeThunkTypeToSymbolMap.end()) { return reinterpret_cast<InvokeFunctionPointer>(mapIt->second->baseAddress); }
+		}
 
 		auto llvmModule = new llvm::Module("",context);
 		auto llvmFunctionType = llvm::FunctionType::get(
@@ -734,10 +965,13 @@ namespace LLVMJIT
 
 		// Compile the invoke thunk.
 		auto jitUnit = new JITInvokeThunkUnit(functionType);
-		jitUnit->compile(llvmModule);
+		jitUnit->compile(llvmModule,&NullResolver::singleton);
 
 		WAVM_ASSERT_THROW(jitUnit->symbol);
-		invokeThunkTypeToSymbolMap[functionType] = jitUnit->symbol;
+		{
+			Platform::Lock invokeThunkMapLock(invokeThunkMapMutex);
+			invokeThunkTypeToSymbolMap[functionType] = jitUnit->symbol;
+		}
 
 		{
 			Platform::Lock addressToSymbolMapLock(addressToSymbolMapMutex);
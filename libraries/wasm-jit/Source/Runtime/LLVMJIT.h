@@ -125,6 +125,29 @@ namespace LLVMJIT
 	std::string getExternalFunctionName(ModuleInstance* moduleInstance,Uptr functionDefIndex);
 	bool getFunctionIndexFromExternalName(const char* externalName,Uptr& outFunctionDefIndex);
 
+	// The runtime objects that the code generated for a module refers to by symbol instead of by literal address.
+	// The symbols are resolved when the code is loaded, so the same machine code can be cached and loaded for a
+	// later instance of the module, e.g. after a process restart.
+	enum class ImportedSymbolKind : U8
+	{
+		defaultMemoryBase,
+		defaultMemory,
+		defaultTableBase,
+		defaultTable,
+		importedFunction,
+		functionDef,
+		global,
+		functionType,
+
+		num
+	};
+
+	// Functions that map between imported symbol names and the runtime objects they refer to.
+	std::string getImportedSymbolName(ImportedSymbolKind kind,Uptr index = 0);
+	std::string getIntrinsicSymbolName(const std::string& intrinsicName,const IR::FunctionType* intrinsicType);
+	bool isImportedSymbolName(const std::string& symbolName);
+	bool getImportedSymbolAddress(const IR::Module& module,ModuleInstance* moduleInstance,const std::string& symbolName,Uptr& outAddress);
+
 	// Emits LLVM IR for a module.
 	llvm::Module* emitModule(const IR::Module& module,ModuleInstance* moduleInstance);
 }
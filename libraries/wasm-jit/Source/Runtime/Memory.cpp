@@ -88,7 +88,26 @@ namespace Runtime
 		return Uptr(memory->type.size.max);
 	}
 
+	// Replaces the snapshot pages mapped at the start of the memory, if any, with zeroed anonymous pages. Pages that are
+	// still mapped from a snapshot read its contents again after they are decommitted and committed, so this must be
+	// done before the memory shrinks into or grows over them, or another snapshot is mapped over part of them.
+	static void unmapMemorySnapshot(MemoryInstance* memory)
+	{
+		if(!memory->mappedSnapshotId) { return; }
+		const Uptr numMappedPages = memory->mappedSnapshotNumPlatformPages;
+		Platform::unmapPageFile(memory->baseAddress,numMappedPages);
+		memory->mappedSnapshotId = 0;
+		memory->mappedSnapshotNumPlatformPages = 0;
+
+		const Uptr numCommittedPages = std::min(numMappedPages,memory->numPages << getPlatformPagesPerWebAssemblyPageLog2());
+		if(numCommittedPages && !Platform::commitVirtualPages(memory->baseAddress,numCommittedPages))
+		{
+			causeException(Exception::Cause::outOfMemory);
+		}
+	}
+
 	void resetMemory(MemoryInstance* memory, MemoryType& newMemoryType) {
+		unmapMemorySnapshot(memory);
 		memory->type.size.min = 1;
 		if(shrinkMemory(memory, memory->numPages - 1) == -1)
 			causeException(Exception::Cause::outOfMemory);
@@ -98,6 +117,52 @@ namespace Runtime
 			causeException(Exception::Cause::outOfMemory);
    }
 
+	static std::atomic<U64> nextMemorySnapshotId(1);
+
+	MemorySnapshot* createMemorySnapshot(const MemoryType& type,const U8* initialData,Uptr numInitialBytes)
+	{
+		WAVM_ASSERT_THROW(type.size.min <= UINTPTR_MAX);
+		const Uptr numPlatformPages = Uptr(type.size.min) << getPlatformPagesPerWebAssemblyPageLog2();
+		if(!numPlatformPages || numInitialBytes > (numPlatformPages << Platform::getPageSizeLog2())) { return nullptr; }
+
+		const I64 pageFile = Platform::createPageFile(initialData,numInitialBytes,numPlatformPages);
+		if(pageFile < 0) { return nullptr; }
+		return new MemorySnapshot {type,numPlatformPages,pageFile,nextMemorySnapshotId++};
+	}
+
+	void destroyMemorySnapshot(MemorySnapshot* snapshot)
+	{
+		if(!snapshot) { return; }
+		Platform::closePageFile(snapshot->pageFile);
+		delete snapshot;
+	}
+
+	void resetMemoryToSnapshot(MemoryInstance* memory,MemorySnapshot* snapshot)
+	{
+		// Decommit the pages the memory grew by beyond the snapshot.
+		const Uptr numSnapshotPages = Uptr(snapshot->type.size.min);
+		memory->type = snapshot->type;
+		if(memory->numPages > numSnapshotPages && shrinkMemory(memory,memory->numPages - numSnapshotPages) == -1)
+		{
+			causeException(Exception::Cause::outOfMemory);
+		}
+
+		// Dropping the pages written since the last reset to this snapshot is enough to restore the rest of the memory;
+		// otherwise, replace whatever is there with the snapshot's pages. Another snapshot's mapping is removed first, as
+		// it may extend past this one's pages.
+		if(memory->mappedSnapshotId != snapshot->id
+		|| !Platform::discardPrivatePages(memory->baseAddress,snapshot->numPlatformPages))
+		{
+			unmapMemorySnapshot(memory);
+			if(Platform::mapPageFileCopyOnWrite(memory->baseAddress,snapshot->numPlatformPages,snapshot->pageFile))
+			{
+				memory->mappedSnapshotId = snapshot->id;
+				memory->mappedSnapshotNumPlatformPages = snapshot->numPlatformPages;
+			}
+		}
+		memory->numPages = numSnapshotPages;
+	}
+
 	Iptr growMemory(MemoryInstance* memory,Uptr numNewPages)
 	{
 		const Uptr previousNumPages = memory->numPages;
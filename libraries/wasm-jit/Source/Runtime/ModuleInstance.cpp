@@ -7,8 +7,6 @@
 
 namespace Runtime
 {
-	std::vector<ModuleInstance*> moduleInstances;
-	
 	Value evaluateInitializer(ModuleInstance* moduleInstance,InitializerExpression expression)
 	{
 		switch(expression.type)
@@ -30,7 +28,7 @@ namespace Runtime
 
 	MemoryInstance* MemoryInstance::theMemoryInstance = nullptr;
 
-	ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports)
+	ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports,ObjectCache* objectCache,const std::string& objectCacheKey)
 	{
 		ModuleInstance* moduleInstance = new ModuleInstance(
 			std::move(imports.functions),
@@ -130,7 +128,7 @@ namespace Runtime
 		}
 
 		// Generate machine code for the module.
-		LLVMJIT::instantiateModule(module,moduleInstance);
+		LLVMJIT::instantiateModule(module,moduleInstance,objectCache,objectCacheKey);
 
 		// Set up the instance's exports.
 		for(const Export& exportIt : module.exports)
@@ -172,7 +170,6 @@ namespace Runtime
 			moduleInstance->startFunctionIndex = module.startFunctionIndex;
 		}
 
-		moduleInstances.push_back(moduleInstance);
 		return moduleInstance;
 	}
 
@@ -185,6 +182,11 @@ namespace Runtime
 	uint64_t getDefaultMemorySize(ModuleInstance* moduleInstance) { return moduleInstance->defaultMemory->numPages << IR::numBytesPerPageLog2; }
 	TableInstance* getDefaultTable(ModuleInstance* moduleInstance) { return moduleInstance->defaultTable; }
 
+	Uptr getModuleInstanceCodeSize(ModuleInstance* moduleInstance)
+	{
+		return moduleInstance->jitModule ? moduleInstance->jitModule->getNumImageBytes() : 0;
+	}
+
 	void runInstanceStartFunc(ModuleInstance* moduleInstance) {
 		if(moduleInstance->startFunctionIndex != UINTPTR_MAX)
 			invokeFunction(moduleInstance->functions[moduleInstance->startFunctionIndex],{});
@@ -12,6 +12,7 @@ namespace Runtime
 	struct GCGlobals
 	{
 		std::set<GCObject*> allObjects;
+		Platform::Mutex* mutex = Platform::createMutex();
 
 		static GCGlobals& get()
 		{
@@ -26,12 +27,14 @@ namespace Runtime
 	GCObject::GCObject(ObjectKind inKind): ObjectInstance(inKind)
 	{
 		// Add the object to the global array.
+		Platform::Lock lock(GCGlobals::get().mutex);
 		GCGlobals::get().allObjects.insert(this);
 	}
 
 	GCObject::~GCObject()
 	{
 		// Remove the object from the global array.
+		Platform::Lock lock(GCGlobals::get().mutex);
 		GCGlobals::get().allObjects.erase(this);
 	}
 
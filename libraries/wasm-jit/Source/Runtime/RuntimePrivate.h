@@ -17,10 +17,13 @@ namespace LLVMJIT
 	struct JITModuleBase
 	{
 		virtual ~JITModuleBase() {}
+
+		// The number of bytes of memory holding the module's machine code and read-only data.
+		virtual Uptr getNumImageBytes() const = 0;
 	};
 
 	void init();
-	void instantiateModule(const IR::Module& module,Runtime::ModuleInstance* moduleInstance);
+	void instantiateModule(const IR::Module& module,Runtime::ModuleInstance* moduleInstance,Runtime::ObjectCache* objectCache,const std::string& objectCacheKey);
 	bool describeInstructionPointer(Uptr ip,std::string& outDescription);
 	
 	typedef void (*InvokeFunctionPointer)(void*,U64*);
@@ -88,12 +91,25 @@ namespace Runtime
 		U8* reservedBaseAddress;
 		Uptr reservedNumPlatformPages;
 
-		MemoryInstance(const MemoryType& inType): GCObject(ObjectKind::memory), type(inType), baseAddress(nullptr), numPages(0), endOffset(0), reservedBaseAddress(nullptr), reservedNumPlatformPages(0) {}
+		// The id of the snapshot whose pages are mapped at the start of the memory, or 0 if none are, and the number of
+		// platform pages mapped from it.
+		U64 mappedSnapshotId;
+		Uptr mappedSnapshotNumPlatformPages;
+
+		MemoryInstance(const MemoryType& inType): GCObject(ObjectKind::memory), type(inType), baseAddress(nullptr), numPages(0), endOffset(0), reservedBaseAddress(nullptr), reservedNumPlatformPages(0), mappedSnapshotId(0), mappedSnapshotNumPlatformPages(0) {}
 		~MemoryInstance() override;
 
       static MemoryInstance* theMemoryInstance;
 	};
 
+	struct MemorySnapshot
+	{
+		MemoryType type;
+		Uptr numPlatformPages;
+		I64 pageFile;
+		U64 id;
+	};
+
 	// An instance of a WebAssembly global.
 	struct GlobalInstance : GCObject
 	{
@@ -159,3 +175,11 @@ namespace Runtime
 	// Adds GC roots from WASM threads to the provided array.
 	void getThreadGCRoots(std::vector<ObjectInstance*>& outGCRoots);
 }
+
+namespace Intrinsics
+{
+	// Gets the name an intrinsic object is registered under, and finds an intrinsic function by that name.
+	// Used by the JIT to refer to intrinsic functions from object code that doesn't embed their addresses.
+	std::string getDecoratedName(const std::string& name,const IR::ObjectType& type);
+	Runtime::FunctionInstance* findFunctionByDecoratedName(const std::string& decoratedName);
+}
@@ -48,6 +48,44 @@ struct async_result_visitor : public fc::visitor<std::string> {
           } \
        }}
 
+// Runs the call through chain_plugin::post_read_only, which serves it on a read-only thread when
+// read-only-threads is configured; the response is always delivered on the main thread.
+// call_method produces the result of call_name and to_json turns it into the response body.
+#define CALL_READ_VIEW_WITH(api_name, api_handle, api_namespace, call_name, call_method, to_json, http_response_code) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle](string, string body, url_response_callback cb) mutable { \
+      api_handle.validate(); \
+      if (body.empty()) body = "{}"; \
+      app().get_plugin<chain_plugin>().post_read_only([api_handle, body, cb]() mutable { \
+         std::string json; \
+         std::exception_ptr error; \
+         try { \
+            auto result = api_handle.call_method(fc::json::from_string(body).as<api_namespace::call_name ## _params>()); \
+            json = to_json(result); \
+         } catch (...) { \
+            error = std::current_exception(); \
+         } \
+         app().post(priority::low, [body = std::move(body), cb = std::move(cb), json = std::move(json), error]() { \
+            if (!error) { \
+               cb(http_response_code, json); \
+               return; \
+            } \
+            try { \
+               std::rethrow_exception(error); \
+            } catch (...) { \
+               http_plugin::handle_exception(#api_name, #call_name, body, cb); \
+            } \
+         }); \
+      }); \
+   }}
+
+#define CALL_READ_VIEW(api_name, api_handle, api_namespace, call_name, http_response_code) \
+   CALL_READ_VIEW_WITH(api_name, api_handle, api_namespace, call_name, call_name, fc::json::to_string, http_response_code)
+
+// for calls with a call_name_json method that writes the response itself instead of building an fc::variant
+#define CALL_READ_VIEW_JSON(api_name, api_handle, api_namespace, call_name, http_response_code) \
+   CALL_READ_VIEW_WITH(api_name, api_handle, api_namespace, call_name, call_name ## _json, std::move, http_response_code)
+
 #define CALL_ASYNC(api_name, api_handle, api_namespace, call_name, call_result, http_response_code) \
 {std::string("/v1/" #api_name "/" #call_name), \
    [api_handle](string, string body, url_response_callback cb) mutable { \
@@ -69,6 +107,8 @@ struct async_result_visitor : public fc::visitor<std::string> {
 }
 
 #define CHAIN_RO_CALL(call_name, http_response_code) CALL(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
+#define CHAIN_RO_VIEW_CALL(call_name, http_response_code) CALL_READ_VIEW(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
+#define CHAIN_RO_VIEW_JSON_CALL(call_name, http_response_code) CALL_READ_VIEW_JSON(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
 #define CHAIN_RW_CALL(call_name, http_response_code) CALL(chain, rw_api, chain_apis::read_write, call_name, http_response_code)
 #define CHAIN_RO_CALL_ASYNC(call_name, call_result, http_response_code) CALL_ASYNC(chain, ro_api, chain_apis::read_only, call_name, call_result, http_response_code)
 #define CHAIN_RW_CALL_ASYNC(call_name, call_result, http_response_code) CALL_ASYNC(chain, rw_api, chain_apis::read_write, call_name, call_result, http_response_code)
@@ -83,30 +123,34 @@ void chain_api_plugin::plugin_startup() {
    ro_api.set_shorten_abi_errors( !_http_plugin.verbose_errors() );
 
    _http_plugin.add_api({
-      CHAIN_RO_CALL(get_info, 200l),
-      CHAIN_RO_CALL(get_block, 200),
-      CHAIN_RO_CALL(get_block_header_state, 200),
-      CHAIN_RO_CALL(get_account, 200),
-      CHAIN_RO_CALL(get_code, 200),
-      CHAIN_RO_CALL(get_code_hash, 200),
-      CHAIN_RO_CALL(get_abi, 200),
-      CHAIN_RO_CALL(get_raw_code_and_abi, 200),
-      CHAIN_RO_CALL(get_raw_abi, 200),
-      CHAIN_RO_CALL(get_table_rows, 200),
-      CHAIN_RO_CALL(get_table_by_scope, 200),
-      CHAIN_RO_CALL(get_currency_balance, 200),
-      CHAIN_RO_CALL(get_currency_stats, 200),
-      CHAIN_RO_CALL(get_producers, 200),
-      CHAIN_RO_CALL(get_producer_schedule, 200),
-      CHAIN_RO_CALL(get_scheduled_transactions, 200),
-      CHAIN_RO_CALL(abi_json_to_bin, 200),
-      CHAIN_RO_CALL(abi_bin_to_json, 200),
-      CHAIN_RO_CALL(get_required_keys, 200),
-      CHAIN_RO_CALL(get_transaction_id, 200),
+      CHAIN_RO_VIEW_CALL(get_info, 200l),
+      CHAIN_RO_VIEW_JSON_CALL(get_block, 200),
+      CHAIN_RO_VIEW_CALL(get_block_header_state, 200),
+      CHAIN_RO_VIEW_CALL(get_account, 200),
+      CHAIN_RO_VIEW_CALL(get_code, 200),
+      CHAIN_RO_VIEW_CALL(get_code_hash, 200),
+      CHAIN_RO_VIEW_CALL(get_abi, 200),
+      CHAIN_RO_VIEW_CALL(get_raw_code_and_abi, 200),
+      CHAIN_RO_VIEW_CALL(get_raw_abi, 200),
+      CHAIN_RO_VIEW_JSON_CALL(get_table_rows, 200),
+      CHAIN_RO_VIEW_CALL(get_table_by_scope, 200),
+      CHAIN_RO_VIEW_CALL(get_currency_balance, 200),
+      CHAIN_RO_VIEW_CALL(get_currency_stats, 200),
+      CHAIN_RO_VIEW_CALL(get_producers, 200),
+      CHAIN_RO_VIEW_CALL(get_producer_schedule, 200),
+      CHAIN_RO_CALL(get_wasm_cache_stats, 200),
+      CHAIN_RO_VIEW_CALL(get_scheduled_transactions, 200),
+      CHAIN_RO_VIEW_CALL(abi_json_to_bin, 200),
+      CHAIN_RO_VIEW_CALL(abi_bin_to_json, 200),
+      CHAIN_RO_VIEW_CALL(get_required_keys, 200),
+      CHAIN_RO_VIEW_CALL(get_transaction_id, 200)
+   });
+   // pushed blocks and transactions are dispatched ahead of any queued queries
+   _http_plugin.add_api({
       CHAIN_RW_CALL_ASYNC(push_block, chain_apis::read_write::push_block_results, 202),
       CHAIN_RW_CALL_ASYNC(push_transaction, chain_apis::read_write::push_transaction_results, 202),
       CHAIN_RW_CALL_ASYNC(push_transactions, chain_apis::read_write::push_transactions_results, 202)
-   });
+   }, http_priority::high);
 }
 
 void chain_api_plugin::plugin_shutdown() {}
@@ -25,12 +25,56 @@
 #include <boost/signals2/connection.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
 
 #include <fc/io/json.hpp>
 #include <fc/variant.hpp>
 #include <signal.h>
 #include <cstdlib>
 
+//declare operator<< and validate function for map_mode in the same namespace as database
+namespace chainbase {
+
+std::ostream& operator<<(std::ostream& osm, database::map_mode m) {
+   if ( m == database::mapped ) {
+      osm << "mapped";
+   } else if ( m == database::heap ) {
+      osm << "heap";
+   } else if ( m == database::locked ) {
+      osm << "locked";
+   }
+
+   return osm;
+}
+
+void validate(boost::any& v,
+              const std::vector<std::string>& values,
+              database::map_mode* /* target_type */,
+              int)
+{
+  using namespace boost::program_options;
+
+  // Make sure no previous assignment to 'v' was made.
+  validators::check_first_occurrence(v);
+
+  // Extract the first string from 'values'. If there is more than
+  // one string, it's an error, and exception will be thrown.
+  std::string const& s = validators::get_single_string(values);
+
+  if ( s == "mapped" ) {
+     v = boost::any(database::mapped);
+  } else if ( s == "heap" ) {
+     v = boost::any(database::heap);
+  } else if ( s == "locked" ) {
+     v = boost::any(database::locked);
+  } else {
+     throw validation_error(validation_error::invalid_option_value);
+  }
+}
+
+}
+
 namespace dccio {
 
 //declare operator<< and validate funciton for read_mode in the same namespace as read_mode itself
@@ -169,6 +213,8 @@ public:
    fc::optional<vm_type>            wasm_runtime;
    fc::microseconds                 abi_serializer_max_time_ms;
    fc::optional<bfs::path>          snapshot_path;
+   uint16_t                         read_only_thread_count = 0;
+   fc::optional<boost::asio::thread_pool> read_only_thread_pool;
 
 
    // retained references to channels for easy publication
@@ -214,14 +260,47 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
    cfg.add_options()
          ("blocks-dir", bpo::value<bfs::path>()->default_value("blocks"),
           "the location of the blocks directory (absolute path or relative to application data dir)")
+         ("blocks-log-segment-size-mb", bpo::value<uint64_t>()->default_value(0),
+          "Seal blocks.log into a segment file and start a new one once it reaches this size in MiB (0 to keep a single file)")
+         ("blocks-log-compress-segments", bpo::bool_switch()->default_value(false),
+          "Compress the blocks of sealed block log segments in the background")
+         ("blocks-log-retained-segments", bpo::value<uint32_t>()->default_value(0),
+          "Number of the newest sealed block log segments to keep, older ones are pruned (0 to keep all). "
+          "A pruned block log can only be replayed from a snapshot")
+         ("blocks-archive-dir", bpo::value<bfs::path>(),
+          "Move pruned block log segments to this directory instead of deleting them (absolute path or relative to the blocks dir)")
          ("checkpoint", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
          ("wasm-runtime", bpo::value<dccio::chain::wasm_interface::vm_type>()->value_name("wavm/wabt"), "Override default WASM runtime")
+         ("wasm-code-cache-dir", bpo::value<bfs::path>()->default_value(config::default_code_cache_dir_name),
+          "the location of the cache of contract code compiled by the wavm runtime (absolute path or relative to application data dir)")
+         ("disable-wasm-code-cache", bpo::bool_switch()->default_value(false),
+          "Compile contract code on first use after every restart instead of caching it on disk")
          ("abi-serializer-max-time-ms", bpo::value<uint32_t>()->default_value(config::default_abi_serializer_max_time_ms),
           "Override default maximum ABI serialization time allowed in ms")
          ("chain-state-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_size / (1024  * 1024)), "Maximum size (in MiB) of the chain state database")
          ("chain-state-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_guard_size / (1024  * 1024)), "Safely shut down node when free space remaining in the chain state database drops below this size (in MiB).")
+         ("database-map-mode", bpo::value<chainbase::database::map_mode>()->default_value(chainbase::database::mapped),
+          "Database map mode (\"mapped\", \"heap\", or \"locked\").\n"
+          "In \"mapped\" mode the chain state database is accessed through a shared mapping of its file.\n"
+          "In \"heap\" mode it is loaded into memory at startup and written back to its file on clean shutdown.\n"
+          "In \"locked\" mode it is loaded as in \"heap\" mode and locked in memory.")
+         ("database-hugepage-size-mb", bpo::value<uint64_t>()->default_value(0),
+          "In \"heap\" or \"locked\" database map mode, back the chain state database with explicit hugepages of this size (e.g. 2 or 1024), "
+          "which must be reserved by the system; 0 requests transparent hugepages. chain-state-db-size-mb must be a multiple of it.")
          ("reversible-blocks-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_cache_size / (1024  * 1024)), "Maximum size (in MiB) of the reversible blocks database")
          ("reversible-blocks-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_guard_size / (1024  * 1024)), "Safely shut down node when free space remaining in the reverseible blocks database drops below this size (in MiB).")
+         ("wasm-cache-max-entries", bpo::value<uint32_t>()->default_value(config::default_wasm_cache_max_entries),
+          "Maximum number of instantiated contracts kept in memory, least recently used are evicted first (0 for no limit)")
+         ("wasm-cache-max-size-mb", bpo::value<uint64_t>()->default_value(config::default_wasm_cache_max_bytes / (1024  * 1024)),
+          "Maximum size (in MiB) of memory held by instantiated contracts kept in memory (0 for no limit)")
+         ("wasm-cache-pinned-account", boost::program_options::value<vector<string>>()->composing()->multitoken(),
+          "Account whose contract is never evicted from the instantiated contract cache (may specify multiple times, defaults to the system account)")
+         ("abi-serializer-cache-size", bpo::value<uint32_t>()->default_value(config::default_abi_serializer_cache_size),
+          "Number of accounts whose parsed ABI is kept in memory for serializing API and history responses")
+         ("chain-threads", bpo::value<uint16_t>()->default_value(config::default_controller_thread_pool_size),
+          "Number of worker threads in controller thread pool, used to recover transaction signing keys off the main thread")
+         ("read-only-threads", bpo::value<uint16_t>()->default_value(0),
+          "Number of worker threads serving read-only chain API calls against a consistent view of chain state (0 to serve them on the main thread)")
          ("contracts-console", bpo::bool_switch()->default_value(false),
           "print contract's output to console")
          ("actor-whitelist", boost::program_options::value<vector<string>>()->composing()->multitoken(),
@@ -350,6 +429,11 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
 
       LOAD_VALUE_SET( options, "trusted-producer", my->chain_config->trusted_producers );
 
+      if( options.count( "wasm-cache-pinned-account" )) {
+         my->chain_config->wasm_cache_pinned_accounts.clear();
+         LOAD_VALUE_SET( options, "wasm-cache-pinned-account", my->chain_config->wasm_cache_pinned_accounts );
+      }
+
       if( options.count( "action-blacklist" )) {
          const std::vector<std::string>& acts = options["action-blacklist"].as<std::vector<std::string>>();
          auto& list = my->chain_config->action_blacklist;
@@ -399,10 +483,29 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       if( options.count( "wasm-runtime" ))
          my->wasm_runtime = options.at( "wasm-runtime" ).as<vm_type>();
 
+      if( options.count( "wasm-code-cache-dir" ) && !options.at( "disable-wasm-code-cache" ).as<bool>() ) {
+         auto ccd = options.at( "wasm-code-cache-dir" ).as<bfs::path>();
+         if( ccd.is_relative())
+            my->chain_config->wasm_code_cache_dir = app().data_dir() / ccd;
+         else
+            my->chain_config->wasm_code_cache_dir = ccd;
+      }
+
       if(options.count("abi-serializer-max-time-ms"))
          my->abi_serializer_max_time_ms = fc::microseconds(options.at("abi-serializer-max-time-ms").as<uint32_t>() * 1000);
 
       my->chain_config->blocks_dir = my->blocks_dir;
+
+      my->chain_config->blocks_log_segments.segment_size = options.at( "blocks-log-segment-size-mb" ).as<uint64_t>() * 1024 * 1024;
+      my->chain_config->blocks_log_segments.compress = options.at( "blocks-log-compress-segments" ).as<bool>();
+      my->chain_config->blocks_log_segments.retained_segments = options.at( "blocks-log-retained-segments" ).as<uint32_t>();
+      if( options.count( "blocks-archive-dir" )) {
+         auto bad = options.at( "blocks-archive-dir" ).as<bfs::path>();
+         if( bad.is_relative())
+            my->chain_config->blocks_log_segments.archive_dir = my->blocks_dir / bad;
+         else
+            my->chain_config->blocks_log_segments.archive_dir = bad;
+      }
       my->chain_config->state_dir = app().data_dir() / config::default_state_dir_name;
       my->chain_config->read_only = my->readonly;
 
@@ -412,6 +515,9 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       if( options.count( "chain-state-db-guard-size-mb" ))
          my->chain_config->state_guard_size = options.at( "chain-state-db-guard-size-mb" ).as<uint64_t>() * 1024 * 1024;
 
+      my->chain_config->state_map_mode = options.at( "database-map-mode" ).as<chainbase::database::map_mode>();
+      my->chain_config->state_hugepage_size = options.at( "database-hugepage-size-mb" ).as<uint64_t>() * 1024 * 1024;
+
       if( options.count( "reversible-blocks-db-size-mb" ))
          my->chain_config->reversible_cache_size =
                options.at( "reversible-blocks-db-size-mb" ).as<uint64_t>() * 1024 * 1024;
@@ -419,6 +525,24 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       if( options.count( "reversible-blocks-db-guard-size-mb" ))
          my->chain_config->reversible_guard_size = options.at( "reversible-blocks-db-guard-size-mb" ).as<uint64_t>() * 1024 * 1024;
 
+      if( options.count( "wasm-cache-max-entries" ))
+         my->chain_config->wasm_cache_max_entries = options.at( "wasm-cache-max-entries" ).as<uint32_t>();
+
+      if( options.count( "wasm-cache-max-size-mb" ))
+         my->chain_config->wasm_cache_max_bytes = options.at( "wasm-cache-max-size-mb" ).as<uint64_t>() * 1024 * 1024;
+
+      if( options.count( "abi-serializer-cache-size" ))
+         my->chain_config->abi_serializer_cache_size = options.at( "abi-serializer-cache-size" ).as<uint32_t>();
+
+      if( options.count( "chain-threads" )) {
+         my->chain_config->thread_pool_size = options.at( "chain-threads" ).as<uint16_t>();
+         dcc_ASSERT( my->chain_config->thread_pool_size > 0, plugin_config_exception,
+                     "chain-threads ${num} must be greater than 0", ("num", my->chain_config->thread_pool_size) );
+      }
+
+      if( options.count( "read-only-threads" ))
+         my->read_only_thread_count = options.at( "read-only-threads" ).as<uint16_t>();
+
       if( my->wasm_runtime )
          my->chain_config->wasm_runtime = *my->wasm_runtime;
 
@@ -710,6 +834,11 @@ void chain_plugin::plugin_startup()
    ilog("Blockchain started; head block is #${num}, genesis timestamp is ${ts}",
         ("num", my->chain->head_block_num())("ts", (std::string)my->chain_config->genesis.initial_timestamp));
 
+   if( my->read_only_thread_count > 0 ) {
+      ilog("serving read-only chain API calls on ${n} threads", ("n", my->read_only_thread_count));
+      my->read_only_thread_pool.emplace( my->read_only_thread_count );
+   }
+
    my->chain_config.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -721,6 +850,11 @@ void chain_plugin::plugin_shutdown() {
    my->accepted_transaction_connection.reset();
    my->applied_transaction_connection.reset();
    my->accepted_confirmation_connection.reset();
+   if( my->read_only_thread_pool ) {
+      my->read_only_thread_pool->stop();
+      my->read_only_thread_pool->join();
+      my->read_only_thread_pool.reset();
+   }
    my->chain.reset();
 }
 
@@ -963,6 +1097,17 @@ fc::microseconds chain_plugin::get_abi_serializer_max_time() const {
    return my->abi_serializer_max_time_ms;
 }
 
+void chain_plugin::post_read_only( std::function<void()> f ) {
+   if( !my->read_only_thread_pool ) {
+      f();
+      return;
+   }
+   const controller& c = chain();
+   boost::asio::post( *my->read_only_thread_pool, [&c, f = std::move(f)]() {
+      c.with_read_view( f );
+   });
+}
+
 void chain_plugin::log_guard_exception(const chain::guard_exception&e ) const {
    if (e.code() == chain::database_guard_exception::code_value) {
       elog("Database has reached an unsafe level of usage, shutting down to avoid corrupting the database.  "
@@ -1105,65 +1250,156 @@ string get_table_type( const abi_def& abi, const name& table_name ) {
    dcc_ASSERT( false, chain::contract_table_query_exception, "Table ${table} is not specified in the ABI", ("table",table_name) );
 }
 
-read_only::get_table_rows_result read_only::get_table_rows( const read_only::get_table_rows_params& p )const {
-   const abi_def abi = dccio::chain_apis::get_abi( db, p.code );
+fc::variant read_only::key_to_variant( uint64_t v, const string& key_type ) {
+   if( key_type == "name" )
+      return fc::variant( name(v) );
+   return fc::variant( v );
+}
 
+fc::variant read_only::key_to_variant( const chain::uint128_t& v, const string& ) {
+   return fc::variant( v );
+}
+
+fc::variant read_only::key_to_variant( const chain::key256_t& v, const string& ) {
+   return fc::variant( fc::to_hex( reinterpret_cast<const char*>(v.data()), sizeof(v) ) );
+}
+
+fc::variant read_only::key_to_variant( const float64_t& v, const string& ) {
+   double d;
+   memcpy( &d, &v, sizeof(d) );
+   return fc::variant( d );
+}
+
+fc::variant read_only::key_to_variant( const float128_t& v, const string& key_type ) {
+   return key_to_variant( f128M_to_f64( &v ), key_type );
+}
+
+template<typename RowFn, typename KeyFn>
+void read_only::walk_table_rows( const read_only::get_table_rows_params& p, read_only::get_table_rows_result& result, RowFn row, KeyFn key )const {
    bool primary = false;
    auto table_with_index = get_table_index_name( p, primary );
    if( primary ) {
       dcc_ASSERT( p.table == table_with_index, chain::contract_table_query_exception, "Invalid table name ${t}", ( "t", p.table ));
+      if( p.key_type == "i64" || p.key_type == "name" ) {
+         return get_table_rows_ex<key_value_index>(p, result, row, key);
+      }
+      // only unpack the ABI when the key type has to be taken from it
+      const abi_def abi = dccio::chain_apis::get_abi( db, p.code );
       auto table_type = get_table_type( abi, p.table );
-      if( table_type == KEYi64 || p.key_type == "i64" || p.key_type == "name" ) {
-         return get_table_rows_ex<key_value_index>(p,abi);
+      if( table_type == KEYi64 ) {
+         return get_table_rows_ex<key_value_index>(p, result, row, key);
       }
       dcc_ASSERT( false, chain::contract_table_query_exception,  "Invalid table type ${type}", ("type",table_type)("abi",abi));
    } else {
       dcc_ASSERT( !p.key_type.empty(), chain::contract_table_query_exception, "key type required for non-primary index" );
 
       if (p.key_type == chain_apis::i64 || p.key_type == "name") {
-         return get_table_rows_by_seckey<index64_index, uint64_t>(p, abi, [](uint64_t v)->uint64_t {
+         return get_table_rows_by_seckey<index64_index, uint64_t>(p, result, [](uint64_t v)->uint64_t {
             return v;
-         });
+         }, row, key);
       }
       else if (p.key_type == chain_apis::i128) {
-         return get_table_rows_by_seckey<index128_index, uint128_t>(p, abi, [](uint128_t v)->uint128_t {
+         return get_table_rows_by_seckey<index128_index, uint128_t>(p, result, [](uint128_t v)->uint128_t {
             return v;
-         });
+         }, row, key);
       }
       else if (p.key_type == chain_apis::i256) {
          if ( p.encode_type == chain_apis::hex) {
             using  conv = keytype_converter<chain_apis::sha256,chain_apis::hex>;
-            return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+            return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, result, conv::function(), row, key);
          }
          using  conv = keytype_converter<chain_apis::i256>;
-         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, result, conv::function(), row, key);
       }
       else if (p.key_type == chain_apis::float64) {
-         return get_table_rows_by_seckey<index_double_index, double>(p, abi, [](double v)->float64_t {
+         return get_table_rows_by_seckey<index_double_index, double>(p, result, [](double v)->float64_t {
             float64_t f = *(float64_t *)&v;
             return f;
-         });
+         }, row, key);
       }
       else if (p.key_type == chain_apis::float128) {
-         return get_table_rows_by_seckey<index_long_double_index, double>(p, abi, [](double v)->float128_t{
+         return get_table_rows_by_seckey<index_long_double_index, double>(p, result, [](double v)->float128_t{
             float64_t f = *(float64_t *)&v;
             float128_t f128;
             f64_to_f128M(f, &f128);
             return f128;
-         });
+         }, row, key);
       }
       else if (p.key_type == chain_apis::sha256) {
          using  conv = keytype_converter<chain_apis::sha256,chain_apis::hex>;
-         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, result, conv::function(), row, key);
       }
       else if(p.key_type == chain_apis::ripemd160) {
          using  conv = keytype_converter<chain_apis::ripemd160,chain_apis::hex>;
-         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, result, conv::function(), row, key);
       }
       dcc_ASSERT(false, chain::contract_table_query_exception,  "Unsupported secondary index type: ${t}", ("t", p.key_type));
    }
 }
 
+/// whether get_table_rows needs the contract ABI, keys and counts are returned without it
+static bool decodes_rows( const read_only::get_table_rows_params& p ) {
+   return p.json && !(p.keys_only && *p.keys_only) && !(p.count_only && *p.count_only);
+}
+
+read_only::get_table_rows_result read_only::get_table_rows( const read_only::get_table_rows_params& p )const {
+   read_only::get_table_rows_result result;
+   abi_serializer_cache::serializer_ptr abis;
+   if( decodes_rows( p ) ) {
+      abis = db.get_abi_serializer_cache().get( db.db(), p.code, abi_serializer_max_time );
+      dcc_ASSERT( abis, chain::contract_table_query_exception, "ABI for ${code} is required to decode rows as JSON", ("code", p.code) );
+   }
+   walk_table_rows( p, result, [&]( const bytes& data ) {
+      if( p.json ) {
+         result.rows.emplace_back( abis->binary_to_variant( abis->get_table_type(p.table), data, abi_serializer_max_time, shorten_abi_errors ) );
+      } else {
+         result.rows.emplace_back( fc::variant(data) );
+      }
+   }, [&]( fc::variant&& key ) {
+      result.rows.emplace_back( std::move(key) );
+   });
+   return result;
+}
+
+string read_only::get_table_rows_json( const read_only::get_table_rows_params& p )const {
+   abi_serializer_cache::serializer_ptr abis;
+   type_name table_type;
+   if( decodes_rows( p ) ) {
+      abis = db.get_abi_serializer_cache().get( db.db(), p.code, abi_serializer_max_time );
+      dcc_ASSERT( abis, chain::contract_table_query_exception, "ABI for ${code} is required to decode rows as JSON", ("code", p.code) );
+      table_type = abis->get_table_type( p.table );
+   }
+
+   std::ostringstream out;
+   impl::json_object_writer obj( out );
+   obj.key( "rows" ) << '[';
+   bool first = true;
+   auto next_row = [&]() -> std::ostream& {
+      if( !first ) out << ',';
+      first = false;
+      return out;
+   };
+   get_table_rows_result result;
+   walk_table_rows( p, result, [&]( const bytes& data ) {
+      next_row();
+      if( p.json ) {
+         fc::datastream<const char*> ds( data.data(), data.size() );
+         abis->binary_to_json( table_type, ds, out, abi_serializer_max_time, shorten_abi_errors );
+      } else {
+         out << '"' << fc::to_hex( data.data(), data.size() ) << '"';
+      }
+   }, [&]( fc::variant&& key ) {
+      fc::json::to_stream( next_row(), key );
+   });
+   out << ']';
+   obj( "more", result.more )
+      ( "next_key", result.next_key );
+   if( result.count )
+      obj( "count", *result.count );
+   obj.close();
+   return out.str();
+}
+
 read_only::get_table_by_scope_result read_only::get_table_by_scope( const read_only::get_table_by_scope_params& p )const {
    const auto& d = db.db();
    const auto& idx = d.get_index<chain::table_id_multi_index, chain::by_code_scope_table>();
@@ -1176,9 +1412,10 @@ read_only::get_table_by_scope_result read_only::get_table_by_scope( const read_o
    } else {
       lower = idx.lower_bound(boost::make_tuple(p.code, 0, p.table));
    }
+   uint64_t upper_scope = 0;
    if (p.upper_bound.size()) {
-      uint64_t scope = convert_to_type<uint64_t>(p.upper_bound, "upper_bound scope");
-      upper = idx.lower_bound( boost::make_tuple(p.code, scope, 0));
+      upper_scope = convert_to_type<uint64_t>(p.upper_bound, "upper_bound scope");
+      upper = idx.lower_bound( boost::make_tuple(p.code, upper_scope, 0));
    } else {
       upper = idx.lower_bound(boost::make_tuple((uint64_t)p.code + 1, 0, 0));
    }
@@ -1187,16 +1424,26 @@ read_only::get_table_by_scope_result read_only::get_table_by_scope( const read_o
    unsigned int count = 0;
    auto itr = lower;
    read_only::get_table_by_scope_result result;
-   for (; itr != upper; ++itr) {
+   while (itr != upper) {
       if (p.table && itr->table != p.table) {
          if (fc::time_point::now() > end) {
             break;
          }
+         // seek to the table in this scope, or in the next scope once it has been passed, instead of
+         // stepping over every other table of the contract
+         if (itr->table < p.table) {
+            itr = idx.lower_bound(boost::make_tuple(p.code, itr->scope, p.table));
+         } else if (itr->scope.value != std::numeric_limits<uint64_t>::max() &&
+                    (p.upper_bound.empty() || itr->scope.value + 1 < upper_scope)) {
+            itr = idx.lower_bound(boost::make_tuple(p.code, itr->scope.value + 1, p.table));
+         } else {
+            itr = upper;
+         }
          continue;
       }
       result.rows.push_back({itr->code, itr->scope, itr->table, itr->payer, itr->count});
+      ++itr;
       if (++count == p.limit || fc::time_point::now() > end) {
-         ++itr;
          break;
       }
    }
@@ -1282,7 +1529,8 @@ fc::variant get_global_row( const database& db, const abi_def& abi, const abi_se
 read_only::get_producers_result read_only::get_producers( const read_only::get_producers_params& p ) const {
    const abi_def abi = dccio::chain_apis::get_abi(db, config::system_account_name);
    const auto table_type = get_table_type(abi, N(producers));
-   const abi_serializer abis{ abi, abi_serializer_max_time };
+   const auto abis_ptr = db.get_abi_serializer_cache().get(db.db(), config::system_account_name, abi_serializer_max_time);
+   const abi_serializer& abis = *abis_ptr;
    dcc_ASSERT(table_type == KEYi64, chain::contract_table_query_exception, "Invalid table type ${type} for table producers", ("type",table_type));
 
    const auto& d = db.db();
@@ -1341,19 +1589,15 @@ read_only::get_producer_schedule_result read_only::get_producer_schedule( const
    return result;
 }
 
+read_only::get_wasm_cache_stats_result read_only::get_wasm_cache_stats( const read_only::get_wasm_cache_stats_params& p ) const {
+   return db.get_wasm_interface().get_cache_stats();
+}
+
 template<typename Api>
 struct resolver_factory {
    static auto make(const Api* api, const fc::microseconds& max_serialization_time) {
-      return [api, max_serialization_time](const account_name &name) -> optional<abi_serializer> {
-         const auto* accnt = api->db.db().template find<account_object, by_name>(name);
-         if (accnt != nullptr) {
-            abi_def abi;
-            if (abi_serializer::to_abi(accnt->abi, abi)) {
-               return abi_serializer(abi, max_serialization_time);
-            }
-         }
-
-         return optional<abi_serializer>();
+      return [api, max_serialization_time](const account_name &name) -> abi_serializer_cache::serializer_ptr {
+         return api->db.get_abi_serializer_cache().get(api->db.db(), name, max_serialization_time);
       };
    }
 };
@@ -1437,7 +1681,7 @@ read_only::get_scheduled_transactions( const read_only::get_scheduled_transactio
    return result;
 }
 
-fc::variant read_only::get_block(const read_only::get_block_params& params) const {
+static signed_block_ptr fetch_block( const controller& db, const read_only::get_block_params& params ) {
    signed_block_ptr block;
    dcc_ASSERT(!params.block_num_or_id.empty() && params.block_num_or_id.size() <= 64, chain::block_id_type_exception, "Invalid Block number or ID, must be greater than 0 and less than 64 characters" );
    try {
@@ -1449,6 +1693,11 @@ fc::variant read_only::get_block(const read_only::get_block_params& params) cons
    } dcc_RETHROW_EXCEPTIONS(chain::block_id_type_exception, "Invalid block ID: ${block_num_or_id}", ("block_num_or_id", params.block_num_or_id))
 
    dcc_ASSERT( block, unknown_block_exception, "Could not find block: ${block}", ("block", params.block_num_or_id));
+   return block;
+}
+
+fc::variant read_only::get_block(const read_only::get_block_params& params) const {
+   signed_block_ptr block = fetch_block( db, params );
 
    fc::variant pretty_output;
    abi_serializer::to_variant(*block, pretty_output, make_resolver(this, abi_serializer_max_time), abi_serializer_max_time);
@@ -1461,6 +1710,22 @@ fc::variant read_only::get_block(const read_only::get_block_params& params) cons
            ("ref_block_prefix", ref_block_prefix);
 }
 
+string read_only::get_block_json(const read_only::get_block_params& params) const {
+   signed_block_ptr block = fetch_block( db, params );
+
+   std::ostringstream out;
+   impl::json_object_writer obj( out );
+   abi_serializer::to_json(*block, obj, make_resolver(this, abi_serializer_max_time), abi_serializer_max_time);
+
+   uint32_t ref_block_prefix = block->id()._hash[1];
+
+   obj("id", block->id())
+      ("block_num", block->block_num())
+      ("ref_block_prefix", ref_block_prefix);
+   obj.close();
+   return out.str();
+}
+
 fc::variant read_only::get_block_header_state(const get_block_header_state_params& params) const {
    block_state_ptr b;
    optional<uint64_t> block_num;
@@ -1682,11 +1947,8 @@ read_only::get_account_results read_only::get_account( const get_account_params&
       ++perm;
    }
 
-   const auto& code_account = db.db().get<account_object,by_name>( config::system_account_name );
-
-   abi_def abi;
-   if( abi_serializer::to_abi(code_account.abi, abi) ) {
-      abi_serializer abis( abi, abi_serializer_max_time );
+   if( const auto abis_ptr = db.get_abi_serializer_cache().get( db.db(), config::system_account_name, abi_serializer_max_time ) ) {
+      const abi_serializer& abis = *abis_ptr;
 
       const auto token_code = N(dccio.token);
 
@@ -1770,16 +2032,14 @@ read_only::abi_json_to_bin_result read_only::abi_json_to_bin( const read_only::a
    const auto code_account = db.db().find<account_object,by_name>( params.code );
    dcc_ASSERT(code_account != nullptr, contract_query_exception, "Contract can't be found ${contract}", ("contract", params.code));
 
-   abi_def abi;
-   if( abi_serializer::to_abi(code_account->abi, abi) ) {
-      abi_serializer abis( abi, abi_serializer_max_time );
-      auto action_type = abis.get_action_type(params.action);
+   if( const auto abis = db.get_abi_serializer_cache().get( db.db(), params.code, abi_serializer_max_time ) ) {
+      auto action_type = abis->get_action_type(params.action);
       dcc_ASSERT(!action_type.empty(), action_validate_exception, "Unknown action ${action} in contract ${contract}", ("action", params.action)("contract", params.code));
       try {
-         result.binargs = abis.variant_to_binary( action_type, params.args, abi_serializer_max_time, shorten_abi_errors );
+         result.binargs = abis->variant_to_binary( action_type, params.args, abi_serializer_max_time, shorten_abi_errors );
       } dcc_RETHROW_EXCEPTIONS(chain::invalid_action_args_exception,
                                 "'${args}' is invalid args for action '${action}' code '${code}'. expected '${proto}'",
-                                ("args", params.args)("action", params.action)("code", params.code)("proto", action_abi_to_variant(abi, action_type)))
+                                ("args", params.args)("action", params.action)("code", params.code)("proto", action_abi_to_variant(dccio::chain_apis::get_abi(db, params.code), action_type)))
    } else {
       dcc_ASSERT(false, abi_not_found_exception, "No ABI found for ${contract}", ("contract", params.code));
    }
@@ -1789,11 +2049,9 @@ read_only::abi_json_to_bin_result read_only::abi_json_to_bin( const read_only::a
 
 read_only::abi_bin_to_json_result read_only::abi_bin_to_json( const read_only::abi_bin_to_json_params& params )const {
    abi_bin_to_json_result result;
-   const auto& code_account = db.db().get<account_object,by_name>( params.code );
-   abi_def abi;
-   if( abi_serializer::to_abi(code_account.abi, abi) ) {
-      abi_serializer abis( abi, abi_serializer_max_time );
-      result.args = abis.binary_to_variant( abis.get_action_type( params.action ), params.binargs, abi_serializer_max_time, shorten_abi_errors );
+   db.db().get<account_object,by_name>( params.code ); // throws if the account does not exist
+   if( const auto abis = db.get_abi_serializer_cache().get( db.db(), params.code, abi_serializer_max_time ) ) {
+      result.args = abis->binary_to_variant( abis->get_action_type( params.action ), params.binargs, abi_serializer_max_time, shorten_abi_errors );
    } else {
       dcc_ASSERT(false, abi_not_found_exception, "No ABI found for ${contract}", ("contract", params.code));
    }
@@ -250,6 +250,8 @@ public:
    };
 
    fc::variant get_block(const get_block_params& params) const;
+   /// get_block written directly as its JSON response
+   string get_block_json(const get_block_params& params) const;
 
    struct get_block_header_state_params {
       string block_num_or_id;
@@ -269,14 +271,22 @@ public:
       string      key_type;  // type of key specified by index_position
       string      index_position; // 1 - primary (first), 2 - secondary index (in order defined by multi_index), 3 - third index, etc
       string      encode_type{"dec"}; //dec, hex , default=dec
+      optional<bool> reverse; ///< walk from upper_bound down to lower_bound
+      string      next_key; ///< next_key of a previous result, resumes the walk at the row it refers to
+      optional<bool> keys_only; ///< return the index keys of the rows instead of the rows
+      optional<bool> count_only; ///< return only the number of rows in range, limit does not apply
     };
 
    struct get_table_rows_result {
       vector<fc::variant> rows; ///< one row per item, either encoded as hex String or JSON object
       bool                more = false; ///< true if last element in data is not the end and sizeof data() < limit
+      string              next_key; ///< when more is set, an opaque cursor to pass as next_key to fetch the following rows
+      optional<uint32_t>  count; ///< number of rows counted when count_only is set, partial when more is set
    };
 
    get_table_rows_result get_table_rows( const get_table_rows_params& params )const;
+   /// get_table_rows written directly as its JSON response, rows are rendered from the binary without fc::variant
+   string get_table_rows_json( const get_table_rows_params& params )const;
 
    struct get_table_by_scope_params {
       name        code; // mandatory
@@ -346,6 +356,13 @@ public:
 
    get_producer_schedule_result get_producer_schedule( const get_producer_schedule_params& params )const;
 
+   struct get_wasm_cache_stats_params {
+   };
+
+   using get_wasm_cache_stats_result = chain::wasm_interface::cache_stats;
+
+   get_wasm_cache_stats_result get_wasm_cache_stats( const get_wasm_cache_stats_params& params )const;
+
    struct get_scheduled_transactions_params {
       bool        json = false;
       string      lower_bound;  /// timestamp OR transaction ID
@@ -385,20 +402,95 @@ public:
 
    static uint64_t get_table_index_name(const read_only::get_table_rows_params& p, bool& primary);
 
-   template <typename IndexType, typename SecKeyType, typename ConvFn>
-   read_only::get_table_rows_result get_table_rows_by_seckey( const read_only::get_table_rows_params& p, const abi_def& abi, ConvFn conv )const {
-      read_only::get_table_rows_result result;
+   /// calls row with the packed data of each row, or key with the index key of each row when keys_only is set
+   template<typename RowFn, typename KeyFn>
+   void walk_table_rows( const read_only::get_table_rows_params& p, get_table_rows_result& result, RowFn row, KeyFn key )const;
+
+   /// index keys as returned by keys_only, in the form lower_bound and upper_bound accept them
+   static fc::variant key_to_variant( uint64_t v, const string& key_type );
+   static fc::variant key_to_variant( const chain::uint128_t& v, const string& key_type );
+   static fc::variant key_to_variant( const chain::key256_t& v, const string& key_type );
+   static fc::variant key_to_variant( const float64_t& v, const string& key_type );
+   static fc::variant key_to_variant( const float128_t& v, const string& key_type );
+
+   /// next_key is the hex of the raw bytes of the index key of the next row, which is unique within the table
+   template<typename Key>
+   static void append_next_key( string& next_key, const Key& key ) {
+      next_key += fc::to_hex( reinterpret_cast<const char*>(&key), sizeof(key) );
+   }
+
+   template<typename Key>
+   static Key read_next_key( const string& next_key, size_t& pos ) {
+      Key key;
+      dcc_ASSERT( next_key.size() >= pos + 2 * sizeof(key), chain::contract_table_query_exception,
+                  "Invalid next_key ${k}", ("k", next_key) );
+      fc::from_hex( next_key.substr( pos, 2 * sizeof(key) ), reinterpret_cast<char*>(&key), sizeof(key) );
+      pos += 2 * sizeof(key);
+      return key;
+   }
+
+   /// true if position a of the ordered index idx comes after position b, end() coming after every object
+   template<typename Index, typename Itr>
+   static bool is_after( const Index& idx, const Itr& a, const Itr& b ) {
+      if( a == idx.end() ) return b != idx.end();
+      if( b == idx.end() ) return false;
+      return idx.value_comp()( *b, *a );
+   }
+
+   /**
+    * Continues the walk of [lower, upper) at seek, the position of next_key; next_key only narrows the range so
+    * that a made up one cannot lead the walk out of the table
+    */
+   template<typename Index, typename Itr>
+   static void seek_next_key( const Index& idx, Itr& lower, Itr& upper, const Itr& seek, bool reverse ) {
+      if( reverse ) {
+         if( is_after( idx, upper, seek ) ) upper = seek;
+      } else {
+         if( is_after( idx, seek, lower ) ) lower = seek;
+      }
+   }
+
+   /**
+    * Calls emit with each object in [itr, end) until it has accepted limit of them or the time cap is reached,
+    * returns the position after the last object visited; a limit of 0 only stops at the time cap
+    */
+   template<typename Itr, typename EmitFn>
+   static Itr walk_rows( Itr itr, Itr end, uint32_t limit, EmitFn emit ) {
+      auto deadline = fc::time_point::now() + fc::microseconds(1000 * 10); /// 10ms max time
+
+      unsigned int count = 0;
+      for (; itr != end; ++itr) {
+         if (!emit(*itr)) continue;
+
+         if (++count == limit || fc::time_point::now() > deadline) {
+            ++itr;
+            break;
+         }
+      }
+      return itr;
+   }
+
+   /// walks the rows in range as described for walk_table_rows, sets result.more and result.next_key when rows remain
+   template <typename IndexType, typename SecKeyType, typename ConvFn, typename RowFn, typename KeyFn>
+   void get_table_rows_by_seckey( const read_only::get_table_rows_params& p, get_table_rows_result& result, ConvFn conv, RowFn row, KeyFn key )const {
       const auto& d = db.db();
+      const bool keys_only = p.keys_only && *p.keys_only;
+      const bool count_only = p.count_only && *p.count_only;
+      if (count_only) result.count = 0;
 
       uint64_t scope = convert_to_type<uint64_t>(p.scope, "scope");
 
-      abi_serializer abis;
-      abis.set_abi(abi, abi_serializer_max_time);
       bool primary = false;
       const uint64_t table_with_index = get_table_index_name(p, primary);
       const auto* t_id = d.find<chain::table_id_object, chain::by_code_scope_table>(boost::make_tuple(p.code, scope, p.table));
       const auto* index_t_id = d.find<chain::table_id_object, chain::by_code_scope_table>(boost::make_tuple(p.code, scope, table_with_index));
       if (t_id != nullptr && index_t_id != nullptr) {
+         if (count_only && p.lower_bound.empty() && p.upper_bound.empty() && p.next_key.empty()) {
+            result.count = index_t_id->count;
+            return;
+         }
+
+         using secondary_key_type = typename IndexType::value_type::secondary_key_type;
          const auto& secidx = d.get_index<IndexType, chain::by_secondary>();
          decltype(index_t_id->id) low_tid(index_t_id->id._id);
          decltype(index_t_id->id) next_tid(index_t_id->id._id + 1);
@@ -425,47 +517,69 @@ public:
                upper = secidx.lower_bound( boost::make_tuple( low_tid, conv( uv )));
             }
          }
+         if (p.next_key.size()) {
+            size_t pos = 0;
+            auto sv = read_next_key<secondary_key_type>( p.next_key, pos );
+            auto pv = read_next_key<uint64_t>( p.next_key, pos );
+            dcc_ASSERT( pos == p.next_key.size(), chain::contract_table_query_exception, "Invalid next_key ${k}", ("k", p.next_key) );
+            if (p.reverse && *p.reverse) {
+               seek_next_key( secidx, lower, upper, secidx.upper_bound( boost::make_tuple( low_tid, sv, pv )), true );
+            } else {
+               seek_next_key( secidx, lower, upper, secidx.lower_bound( boost::make_tuple( low_tid, sv, pv )), false );
+            }
+         }
+         // a lower_bound above the upper_bound, or a next_key past the range, selects no rows
+         if (is_after( secidx, lower, upper )) lower = upper;
 
+         // counts and keys come from the index entries alone, without looking up the rows
+         uint32_t count = 0;
          vector<char> data;
-
-         auto end = fc::time_point::now() + fc::microseconds(1000 * 10); /// 10ms max time
-
-         unsigned int count = 0;
-         auto itr = lower;
-         for (; itr != upper; ++itr) {
-
-            const auto* itr2 = d.find<chain::key_value_object, chain::by_scope_primary>(boost::make_tuple(t_id->id, itr->primary_key));
-            if (itr2 == nullptr) continue;
-            copy_inline_row(*itr2, data);
-
-            if (p.json) {
-               result.rows.emplace_back( abis.binary_to_variant( abis.get_table_type(p.table), data, abi_serializer_max_time, shorten_abi_errors ) );
+         auto emit = [&]( const typename IndexType::value_type& obj ) {
+            if (count_only) {
+               ++count;
+            } else if (keys_only) {
+               key( fc::mutable_variant_object()("key", key_to_variant(obj.secondary_key, p.key_type))("primary_key", obj.primary_key) );
             } else {
-               result.rows.emplace_back(fc::variant(data));
+               const auto* itr2 = d.find<chain::key_value_object, chain::by_scope_primary>(boost::make_tuple(t_id->id, obj.primary_key));
+               if (itr2 == nullptr) return false;
+               copy_inline_row(*itr2, data);
+               row(data);
             }
-
-            if (++count == p.limit || fc::time_point::now() > end) {
-               break;
+            return true;
+         };
+         auto walk = [&]( auto begin, auto end ) {
+            auto itr = walk_rows( begin, end, count_only ? 0 : p.limit, emit );
+            if (itr != end) {
+               result.more = true;
+               append_next_key( result.next_key, itr->secondary_key );
+               append_next_key( result.next_key, itr->primary_key );
             }
+         };
+         if (p.reverse && *p.reverse) {
+            walk( std::make_reverse_iterator(upper), std::make_reverse_iterator(lower) );
+         } else {
+            walk( lower, upper );
          }
-         if (itr != upper) {
-            result.more = true;
-         }
+         if (count_only) result.count = count;
       }
-      return result;
    }
 
-   template <typename IndexType>
-   read_only::get_table_rows_result get_table_rows_ex( const read_only::get_table_rows_params& p, const abi_def& abi )const {
-      read_only::get_table_rows_result result;
+   template <typename IndexType, typename RowFn, typename KeyFn>
+   void get_table_rows_ex( const read_only::get_table_rows_params& p, get_table_rows_result& result, RowFn row, KeyFn key )const {
       const auto& d = db.db();
+      const bool keys_only = p.keys_only && *p.keys_only;
+      const bool count_only = p.count_only && *p.count_only;
+      if (count_only) result.count = 0;
 
       uint64_t scope = convert_to_type<uint64_t>(p.scope, "scope");
 
-      abi_serializer abis;
-      abis.set_abi(abi, abi_serializer_max_time);
       const auto* t_id = d.find<chain::table_id_object, chain::by_code_scope_table>(boost::make_tuple(p.code, scope, p.table));
       if (t_id != nullptr) {
+         if (count_only && p.lower_bound.empty() && p.upper_bound.empty() && p.next_key.empty()) {
+            result.count = t_id->count;
+            return;
+         }
+
          const auto& idx = d.get_index<IndexType, chain::by_scope_primary>();
          decltype(t_id->id) next_tid(t_id->id._id + 1);
          auto lower = idx.lower_bound(boost::make_tuple(t_id->id));
@@ -489,32 +603,46 @@ public:
                upper = idx.lower_bound( boost::make_tuple( t_id->id, uv ));
             }
          }
+         if (p.next_key.size()) {
+            size_t pos = 0;
+            auto pv = read_next_key<uint64_t>( p.next_key, pos );
+            dcc_ASSERT( pos == p.next_key.size(), chain::contract_table_query_exception, "Invalid next_key ${k}", ("k", p.next_key) );
+            if (p.reverse && *p.reverse) {
+               seek_next_key( idx, lower, upper, idx.upper_bound( boost::make_tuple( t_id->id, pv )), true );
+            } else {
+               seek_next_key( idx, lower, upper, idx.lower_bound( boost::make_tuple( t_id->id, pv )), false );
+            }
+         }
+         // a lower_bound above the upper_bound, or a next_key past the range, selects no rows
+         if (is_after( idx, lower, upper )) lower = upper;
 
+         uint32_t count = 0;
          vector<char> data;
-
-         auto end = fc::time_point::now() + fc::microseconds(1000 * 10); /// 10ms max time
-
-         unsigned int count = 0;
-         auto itr = lower;
-         for (; itr != upper; ++itr) {
-            copy_inline_row(*itr, data);
-
-            if (p.json) {
-               result.rows.emplace_back( abis.binary_to_variant( abis.get_table_type(p.table), data, abi_serializer_max_time, shorten_abi_errors ) );
+         auto emit = [&]( const typename IndexType::value_type& obj ) {
+            if (count_only) {
+               ++count;
+            } else if (keys_only) {
+               key( key_to_variant(obj.primary_key, p.key_type) );
             } else {
-               result.rows.emplace_back(fc::variant(data));
+               copy_inline_row(obj, data);
+               row(data);
             }
-
-            if (++count == p.limit || fc::time_point::now() > end) {
-               ++itr;
-               break;
+            return true;
+         };
+         auto walk = [&]( auto begin, auto end ) {
+            auto itr = walk_rows( begin, end, count_only ? 0 : p.limit, emit );
+            if (itr != end) {
+               result.more = true;
+               append_next_key( result.next_key, itr->primary_key );
             }
+         };
+         if (p.reverse && *p.reverse) {
+            walk( std::make_reverse_iterator(upper), std::make_reverse_iterator(lower) );
+         } else {
+            walk( lower, upper );
          }
-         if (itr != upper) {
-            result.more = true;
-         }
+         if (count_only) result.count = count;
       }
-      return result;
    }
 
    chain::symbol extract_core_symbol()const;
@@ -652,6 +780,12 @@ public:
    chain::chain_id_type get_chain_id() const;
    fc::microseconds get_abi_serializer_max_time() const;
 
+   /**
+    * Runs f on the read-only thread pool while the controller is not mutating state, or
+    * directly on the calling thread when read-only-threads is 0. f must not modify chain state.
+    */
+   void post_read_only( std::function<void()> f );
+
    void handle_guard_exception(const chain::guard_exception& e) const;
 
    static void handle_db_exhaustion();
@@ -672,8 +806,8 @@ FC_REFLECT(dccio::chain_apis::read_only::get_block_header_state_params, (block_n
 
 FC_REFLECT( dccio::chain_apis::read_write::push_transaction_results, (transaction_id)(processed) )
 
-FC_REFLECT( dccio::chain_apis::read_only::get_table_rows_params, (json)(code)(scope)(table)(table_key)(lower_bound)(upper_bound)(limit)(key_type)(index_position)(encode_type) )
-FC_REFLECT( dccio::chain_apis::read_only::get_table_rows_result, (rows)(more) );
+FC_REFLECT( dccio::chain_apis::read_only::get_table_rows_params, (json)(code)(scope)(table)(table_key)(lower_bound)(upper_bound)(limit)(key_type)(index_position)(encode_type)(reverse)(next_key)(keys_only)(count_only) )
+FC_REFLECT( dccio::chain_apis::read_only::get_table_rows_result, (rows)(more)(next_key)(count) );
 
 FC_REFLECT( dccio::chain_apis::read_only::get_table_by_scope_params, (code)(table)(lower_bound)(upper_bound)(limit) )
 FC_REFLECT( dccio::chain_apis::read_only::get_table_by_scope_result_row, (code)(scope)(table)(payer)(count));
@@ -688,6 +822,7 @@ FC_REFLECT( dccio::chain_apis::read_only::get_producers_result, (rows)(total_pro
 
 FC_REFLECT_EMPTY( dccio::chain_apis::read_only::get_producer_schedule_params )
 FC_REFLECT( dccio::chain_apis::read_only::get_producer_schedule_result, (active)(pending)(proposed) );
+FC_REFLECT_EMPTY( dccio::chain_apis::read_only::get_wasm_cache_stats_params )
 
 FC_REFLECT( dccio::chain_apis::read_only::get_scheduled_transactions_params, (json)(lower_bound)(limit) )
 FC_REFLECT( dccio::chain_apis::read_only::get_scheduled_transactions_result, (transactions)(more) );
@@ -19,19 +19,28 @@ history_api_plugin::~history_api_plugin(){}
 void history_api_plugin::set_program_options(options_description&, options_description&) {}
 void history_api_plugin::plugin_initialize(const variables_map&) {}
 
-#define CALL(api_name, api_handle, api_namespace, call_name) \
+// call_method produces the result of call_name and to_json turns it into the response body
+#define CALL_WITH(api_name, api_handle, api_namespace, call_name, call_method, to_json) \
 {std::string("/v1/" #api_name "/" #call_name), \
    [api_handle](string, string body, url_response_callback cb) mutable { \
           try { \
              if (body.empty()) body = "{}"; \
-             auto result = api_handle.call_name(fc::json::from_string(body).as<api_namespace::call_name ## _params>()); \
-             cb(200, fc::json::to_string(result)); \
+             auto result = api_handle.call_method(fc::json::from_string(body).as<api_namespace::call_name ## _params>()); \
+             cb(200, to_json(result)); \
           } catch (...) { \
              http_plugin::handle_exception(#api_name, #call_name, body, cb); \
           } \
        }}
 
+#define CALL(api_name, api_handle, api_namespace, call_name) \
+   CALL_WITH(api_name, api_handle, api_namespace, call_name, call_name, fc::json::to_string)
+
+// for calls with a call_name_json method that writes the response itself instead of building an fc::variant
+#define CALL_JSON(api_name, api_handle, api_namespace, call_name) \
+   CALL_WITH(api_name, api_handle, api_namespace, call_name, call_name ## _json, std::move)
+
 #define CHAIN_RO_CALL(call_name) CALL(history, ro_api, history_apis::read_only, call_name)
+#define CHAIN_RO_JSON_CALL(call_name) CALL_JSON(history, ro_api, history_apis::read_only, call_name)
 //#define CHAIN_RW_CALL(call_name) CALL(history, rw_api, history_apis::read_write, call_name)
 
 void history_api_plugin::plugin_startup() {
@@ -41,7 +50,7 @@ void history_api_plugin::plugin_startup() {
 
    app().get_plugin<http_plugin>().add_api({
 //      CHAIN_RO_CALL(get_transaction),
-      CHAIN_RO_CALL(get_actions),
+      CHAIN_RO_JSON_CALL(get_actions),
       CHAIN_RO_CALL(get_transaction),
       CHAIN_RO_CALL(get_key_accounts),
       CHAIN_RO_CALL(get_controlled_accounts)
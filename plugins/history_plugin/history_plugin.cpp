@@ -369,11 +369,11 @@ namespace dccio {
 
 
    namespace history_apis {
-      read_only::get_actions_result read_only::get_actions( const read_only::get_actions_params& params )const {
+      template<typename ActionFn>
+      bool read_only::for_each_action( const read_only::get_actions_params& params, ActionFn fn )const {
          edump((params));
         auto& chain = history->chain_plug->chain();
         const auto& db = chain.db();
-        const auto abi_serializer_max_time = history->chain_plug->get_abi_serializer_max_time();
 
         const auto& idx = db.get_index<account_history_index, by_account_action_seq>();
 
@@ -414,30 +414,70 @@ namespace dccio {
         auto start_time = fc::time_point::now();
         auto end_time = start_time;
 
-        get_actions_result result;
-        result.last_irreversible_block = chain.last_irreversible_block_num();
         while( start_itr != end_itr ) {
            const auto& a = db.get<action_history_object, by_action_sequence_num>( start_itr->action_sequence_num );
            fc::datastream<const char*> ds( a.packed_action_trace.data(), a.packed_action_trace.size() );
            action_trace t;
            fc::raw::unpack( ds, t );
-           result.actions.emplace_back( ordered_action_result{
-                                 start_itr->action_sequence_num,
-                                 start_itr->account_sequence_num,
-                                 a.block_num, a.block_time,
-                                 chain.to_variant_with_abi(t, abi_serializer_max_time)
-                                 });
+           fn( *start_itr, a, t );
 
            end_time = fc::time_point::now();
            if( end_time - start_time > fc::microseconds(100000) ) {
-              result.time_limit_exceeded_error = true;
-              break;
+              return true;
            }
            ++start_itr;
         }
+        return false;
+      }
+
+      read_only::get_actions_result read_only::get_actions( const read_only::get_actions_params& params )const {
+        auto& chain = history->chain_plug->chain();
+        const auto abi_serializer_max_time = history->chain_plug->get_abi_serializer_max_time();
+
+        get_actions_result result;
+        result.last_irreversible_block = chain.last_irreversible_block_num();
+        bool time_limit_exceeded = for_each_action( params,
+           [&]( const account_history_object& h, const action_history_object& a, const action_trace& t ) {
+              result.actions.emplace_back( ordered_action_result{
+                                    h.action_sequence_num,
+                                    h.account_sequence_num,
+                                    a.block_num, a.block_time,
+                                    chain.to_variant_with_abi(t, abi_serializer_max_time)
+                                    });
+           });
+        if( time_limit_exceeded )
+           result.time_limit_exceeded_error = true;
         return result;
       }
 
+      string read_only::get_actions_json( const read_only::get_actions_params& params )const {
+        auto& chain = history->chain_plug->chain();
+        const auto abi_serializer_max_time = history->chain_plug->get_abi_serializer_max_time();
+
+        std::ostringstream out;
+        chain::impl::json_object_writer result( out );
+        result.key( "actions" ) << '[';
+        bool first = true;
+        bool time_limit_exceeded = for_each_action( params,
+           [&]( const account_history_object& h, const action_history_object& a, const action_trace& t ) {
+              if( !first ) out << ',';
+              first = false;
+              chain::impl::json_object_writer action( out );
+              action( "global_action_seq", h.action_sequence_num )
+                    ( "account_action_seq", h.account_sequence_num )
+                    ( "block_num", a.block_num )
+                    ( "block_time", a.block_time );
+              chain.to_json_with_abi( t, action.key( "action_trace" ), abi_serializer_max_time );
+              action.close();
+           });
+        out << ']';
+        result( "last_irreversible_block", chain.last_irreversible_block_num() );
+        if( time_limit_exceeded )
+           result( "time_limit_exceeded_error", true );
+        result.close();
+        return out.str();
+      }
+
 
       read_only::get_transaction_result read_only::get_transaction( const read_only::get_transaction_params& p )const {
          auto& chain = history->chain_plug->chain();
@@ -52,6 +52,8 @@ class read_only {
 
 
       get_actions_result get_actions( const get_actions_params& )const;
+      /// get_actions written directly as its JSON response, traces are rendered without building an fc::variant
+      string get_actions_json( const get_actions_params& )const;
 
 
       struct get_transaction_params {
@@ -100,6 +102,11 @@ class read_only {
          vector<chain::account_name> controlled_accounts;
       };
       get_controlled_accounts_results get_controlled_accounts(const get_controlled_accounts_params& params) const;
+
+   private:
+      /// calls fn with each history object in the range selected by params, returns true if the time limit cut it short
+      template<typename ActionFn>
+      bool for_each_action( const get_actions_params& params, ActionFn fn )const;
 };
 
 
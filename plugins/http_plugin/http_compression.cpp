@@ -0,0 +1,70 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#include <dccio/http_plugin/http_compression.hpp>
+
+#include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace dccio {
+
+   content_encoding accepted_encoding( const std::string& accept_encoding ) {
+      // q values of -1 mark codings that are not listed
+      double gzip = -1, deflate = -1, any = -1;
+      std::vector<std::string> codings;
+      boost::split( codings, accept_encoding, boost::is_any_of( "," ));
+      for( auto& coding : codings ) {
+         std::vector<std::string> params;
+         boost::split( params, coding, boost::is_any_of( ";" ));
+         std::string name = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[0] ));
+         double q = 1;
+         for( size_t i = 1; i < params.size(); ++i ) {
+            auto param = boost::algorithm::trim_copy( params[i] );
+            if( param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=' )
+               q = std::strtod( param.c_str() + 2, nullptr );
+         }
+         if( name == "gzip" || name == "x-gzip" )
+            gzip = std::max( gzip, q );
+         else if( name == "deflate" )
+            deflate = std::max( deflate, q );
+         else if( name == "*" )
+            any = std::max( any, q );
+      }
+      if( gzip < 0 )
+         gzip = any;
+      if( deflate < 0 )
+         deflate = any;
+
+      if( gzip > 0 && gzip >= deflate )
+         return content_encoding::gzip;
+      if( deflate > 0 )
+         return content_encoding::deflate;
+      return content_encoding::identity;
+   }
+
+   const char* compress_response( std::string& body, content_encoding encoding, uint32_t min_bytes ) {
+      if( encoding == content_encoding::identity || body.size() < min_bytes )
+         return nullptr;
+      try {
+         if( encoding == content_encoding::gzip ) {
+            body = fc::gzip_compress( body );
+            return "gzip";
+         }
+         body = fc::zlib_compress( body );
+         return "deflate";
+      } catch( const fc::exception& e ) {
+         // send the body as it is
+         elog( "http: unable to compress response: ${e}", ("e", e.to_detail_string()));
+      }
+      return nullptr;
+   }
+
+}
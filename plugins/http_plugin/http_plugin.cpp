@@ -4,6 +4,7 @@
  */
 #include <dccio/http_plugin/http_plugin.hpp>
 #include <dccio/http_plugin/local_endpoint.hpp>
+#include <dccio/http_plugin/http_compression.hpp>
 #include <dccio/chain/exceptions.hpp>
 
 #include <fc/network/ip.hpp>
@@ -14,6 +15,8 @@
 
 #include <boost/asio.hpp>
 #include <boost/optional.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
 
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/config/asio.hpp>
@@ -22,8 +25,10 @@
 #include <websocketpp/client.hpp>
 #include <websocketpp/logger/stub.hpp>
 
+#include <algorithm>
 #include <thread>
 #include <memory>
+#include <mutex>
 #include <regex>
 
 namespace dccio {
@@ -42,6 +47,7 @@ namespace dccio {
    using boost::asio::ip::address_v4;
    using boost::asio::ip::address_v6;
    using std::shared_ptr;
+   using std::unique_ptr;
    using websocketpp::connection_hdl;
 
    static http_plugin_defaults current_http_plugin_defaults;
@@ -126,9 +132,48 @@ namespace dccio {
 
    static bool verbose_http_errors = false;
 
+   constexpr uint16_t def_http_threads = 2;
+   constexpr uint32_t def_max_queued_requests = 1000;
+   constexpr uint32_t def_compression_min_bytes = 1024;
+
    class http_plugin_impl {
       public:
-         map<string,url_handler>  url_handlers;
+         /// A registered URL and the number of its requests which have not been responded to yet
+         struct endpoint {
+            url_handler handler;
+            int         priority = http_priority::medium;
+            uint32_t    max_queued = 0;
+            uint32_t    queued = 0; ///< waiting for the application thread or still being handled, guarded by handlers_mtx
+         };
+
+         struct queued_request {
+            int                   priority;
+            uint64_t              order;
+            endpoint*             ep;
+            string                resource;
+            string                body;
+            url_response_callback cb;
+
+            /// heap order: higher priority first, then arrival order
+            bool operator<( const queued_request& r )const {
+               return std::tie( priority, r.order ) < std::tie( r.priority, order );
+            }
+         };
+
+         // declared before the servers so that the io_context outlives them
+         uint16_t                 thread_count = def_http_threads;
+         unique_ptr<asio::io_context> http_ioc;
+         unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> http_work;
+         vector<std::thread>      http_threads;
+
+         std::mutex               handlers_mtx; ///< guards url_handlers, pending_requests and next_request_order
+         map<string,endpoint>     url_handlers;
+         vector<queued_request>   pending_requests; ///< heap, see queued_request::operator<
+         uint64_t                 next_request_order = 0;
+         uint32_t                 max_queued_requests = def_max_queued_requests;
+         map<string,uint32_t>     endpoint_queue_limits;
+         uint32_t                 compression_min_bytes = def_compression_min_bytes; ///< 0 disables compression
+
          optional<tcp::endpoint>  listen_endpoint;
          string                   access_control_allow_origin;
          string                   access_control_allow_headers;
@@ -283,16 +328,52 @@ namespace dccio {
                con->append_header( "Content-type", "application/json" );
                auto body = con->get_request_body();
                auto resource = con->get_uri()->get_resource();
+               std::unique_lock<std::mutex> lock( handlers_mtx );
                auto handler_itr = url_handlers.find( resource );
                if( handler_itr != url_handlers.end()) {
+                  endpoint& ep = handler_itr->second;
+                  if( ep.queued >= ep.max_queued ) {
+                     lock.unlock();
+                     dlog( "503 - too many queued requests: ${ep}", ("ep", resource));
+                     error_results results{websocketpp::http::status_code::service_unavailable,
+                                           "Service Unavailable", error_results::error_info(fc::exception( FC_LOG_MESSAGE( error, "Too many queued requests" )), verbose_http_errors )};
+                     con->set_body( fc::json::to_string( results ));
+                     con->set_status( websocketpp::http::status_code::service_unavailable );
+                     return;
+                  }
                   con->defer_http_response();
-                  handler_itr->second( resource, body, [con]( auto code, auto&& body ) {
-                     con->set_body( std::move( body ));
-                     con->set_status( websocketpp::http::status_code::value( code ));
-                     con->send_http_response();
-                  } );
-
+                  ++ep.queued;
+                  auto encoding = compression_min_bytes ? accepted_encoding( req.get_header( "Accept-Encoding" )) : content_encoding::identity;
+                  pending_requests.emplace_back( queued_request{ ep.priority, next_request_order++, &ep, std::move( resource ), std::move( body ),
+                     [this, ep = &ep, con, ioc = http_ioc.get(), encoding, min_bytes = compression_min_bytes]( int code, string body ) {
+                        // the request counts against the queue limit until here, handlers which hand the call on to
+                        // another thread pool (read-only chain API calls) keep holding their place
+                        {
+                           std::lock_guard<std::mutex> g( handlers_mtx );
+                           --ep->queued;
+                        }
+                        // the handler may respond from any thread; encode and write the response on the http threads
+                        asio::post( *ioc, [con, code, body = std::move( body ), encoding, min_bytes]() mutable {
+                           // the response is compressed whole: websocketpp writes the body as one buffer with a
+                           // Content-Length, so chunked transfer encoding of a compressed stream is not supported
+                           if( encoding != content_encoding::identity ) {
+                              con->append_header( "Vary", "Accept-Encoding" );
+                              if( auto coding = compress_response( body, encoding, min_bytes ))
+                                 con->append_header( "Content-Encoding", coding );
+                           }
+                           con->set_body( std::move( body ));
+                           con->set_status( websocketpp::http::status_code::value( code ));
+                           con->send_http_response();
+                        } );
+                     } } );
+                  std::push_heap( pending_requests.begin(), pending_requests.end() );
+                  // pushed blocks and transactions compete with the ones arriving over p2p, queries yield to both
+                  int app_priority = ep.priority >= http_priority::high ? appbase::priority::medium : appbase::priority::low;
+                  lock.unlock();
+                  // each queued request schedules one dispatch, which runs the highest priority request waiting
+                  app().post( app_priority, [this]() { dispatch_next_request(); } );
                } else {
+                  lock.unlock();
                   dlog( "404 - not found: ${ep}", ("ep", resource));
                   error_results results{websocketpp::http::status_code::not_found,
                                         "Not Found", error_results::error_info(fc::exception( FC_LOG_MESSAGE( error, "Unknown Endpoint" )), verbose_http_errors )};
@@ -304,11 +385,28 @@ namespace dccio {
             }
          }
 
+         /// runs on the application thread
+         void dispatch_next_request() {
+            std::unique_lock<std::mutex> lock( handlers_mtx );
+            if( pending_requests.empty() )
+               return;
+            std::pop_heap( pending_requests.begin(), pending_requests.end() );
+            queued_request req = std::move( pending_requests.back() );
+            pending_requests.pop_back();
+            lock.unlock();
+
+            try {
+               req.ep->handler( req.resource, req.body, req.cb );
+            } catch( ... ) {
+               http_plugin::handle_exception( "http", req.resource.c_str(), req.body, req.cb );
+            }
+         }
+
          template<class T>
          void create_server_for_endpoint(const tcp::endpoint& ep, websocketpp::server<detail::asio_with_stub_log<T>>& ws) {
             try {
                ws.clear_access_channels(websocketpp::log::alevel::all);
-               ws.init_asio(&app().get_io_service());
+               ws.init_asio(http_ioc.get());
                ws.set_reuse_addr(true);
                ws.set_max_http_body_size(max_body_size);
                ws.set_http_handler([&](connection_hdl hdl) {
@@ -400,6 +498,14 @@ namespace dccio {
             ("verbose-http-errors", bpo::bool_switch()->default_value(false), "Append the error log to HTTP responses")
             ("http-validate-host", boost::program_options::value<bool>()->default_value(true), "If set to false, then any incoming \"Host\" header is considered valid")
             ("http-alias", bpo::value<std::vector<string>>()->composing(), "Additionaly acceptable values for the \"Host\" header of incoming HTTP requests, can be specified multiple times.  Includes http/s_server_address by default.")
+            ("http-threads", bpo::value<uint16_t>()->default_value(def_http_threads),
+             "Number of worker threads reading HTTP requests and writing responses")
+            ("http-max-queued-requests", bpo::value<uint32_t>()->default_value(def_max_queued_requests),
+             "Maximum number of requests for a single URL waiting to be handled or being handled; further requests are rejected with 503")
+            ("http-endpoint-queue-limit", bpo::value<std::vector<string>>()->composing(),
+             "Override http-max-queued-requests for one URL, as <url>=<limit> (may specify multiple times)")
+            ("http-compression-min-bytes", bpo::value<uint32_t>()->default_value(def_compression_min_bytes),
+             "Compress response bodies of at least this many bytes with gzip or deflate when the client's Accept-Encoding allows it; 0 to disable")
             ;
    }
 
@@ -474,11 +580,33 @@ namespace dccio {
          my->max_body_size = options.at( "max-body-size" ).as<uint32_t>();
          verbose_http_errors = options.at( "verbose-http-errors" ).as<bool>();
 
+         my->thread_count = options.at( "http-threads" ).as<uint16_t>();
+         dcc_ASSERT( my->thread_count > 0, chain::plugin_config_exception,
+                     "http-threads ${num} must be greater than 0", ("num", my->thread_count) );
+
+         my->max_queued_requests = options.at( "http-max-queued-requests" ).as<uint32_t>();
+         my->compression_min_bytes = options.at( "http-compression-min-bytes" ).as<uint32_t>();
+         if( options.count( "http-endpoint-queue-limit" )) {
+            for( const auto& limit : options.at( "http-endpoint-queue-limit" ).as<vector<string>>() ) {
+               auto pos = limit.rfind( '=' );
+               dcc_ASSERT( pos != string::npos && pos > 0, chain::plugin_config_exception,
+                           "Invalid http-endpoint-queue-limit ${l}, expected <url>=<limit>", ("l", limit) );
+               my->endpoint_queue_limits[limit.substr( 0, pos )] = boost::lexical_cast<uint32_t>( limit.substr( pos + 1 ));
+            }
+         }
+
          //watch out for the returns above when adding new code here
       } FC_LOG_AND_RETHROW()
    }
 
    void http_plugin::plugin_startup() {
+      my->http_ioc.reset( new asio::io_context{ my->thread_count } );
+      my->http_work.reset( new asio::executor_work_guard<asio::io_context::executor_type>( my->http_ioc->get_executor() ) );
+      my->http_threads.reserve( my->thread_count );
+      for( uint16_t i = 0; i < my->thread_count; ++i ) {
+         my->http_threads.emplace_back( [ioc = my->http_ioc.get()]() { ioc->run(); } );
+      }
+
       if(my->listen_endpoint) {
          try {
             my->create_server_for_endpoint(*my->listen_endpoint, my->server);
@@ -501,7 +629,7 @@ namespace dccio {
       if(my->unix_endpoint) {
          try {
             my->unix_server.clear_access_channels(websocketpp::log::alevel::all);
-            my->unix_server.init_asio(&app().get_io_service());
+            my->unix_server.init_asio(my->http_ioc.get());
             my->unix_server.set_max_http_body_size(my->max_body_size);
             my->unix_server.listen(*my->unix_endpoint);
             my->unix_server.set_http_handler([&](connection_hdl hdl) {
@@ -548,13 +676,25 @@ namespace dccio {
          my->server.stop_listening();
       if(my->https_server.is_listening())
          my->https_server.stop_listening();
+
+      if( my->http_ioc ) {
+         my->http_work.reset();
+         my->http_ioc->stop();
+         for( auto& t : my->http_threads ) {
+            t.join();
+         }
+         my->http_threads.clear();
+      }
    }
 
-   void http_plugin::add_handler(const string& url, const url_handler& handler) {
+   void http_plugin::add_handler(const string& url, const url_handler& handler, int priority) {
       ilog( "add api url: ${c}", ("c",url) );
-      app().get_io_service().post([=](){
-        my->url_handlers.insert(std::make_pair(url,handler));
-      });
+      std::lock_guard<std::mutex> lock( my->handlers_mtx );
+      auto& ep = my->url_handlers[url];
+      ep.handler = handler;
+      ep.priority = priority;
+      auto limit = my->endpoint_queue_limits.find( url );
+      ep.max_queued = limit != my->endpoint_queue_limits.end() ? limit->second : my->max_queued_requests;
    }
 
    void http_plugin::handle_exception( const char *api_name, const char *call_name, const string& body, url_response_callback cb ) {
@@ -0,0 +1,28 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace dccio {
+
+   enum class content_encoding { identity, gzip, deflate };
+
+   /**
+    * Picks the encoding for a response from the request's Accept-Encoding header.
+    *
+    * A coding's q value is the one it is listed with, or the q value of "*" when it is not listed; codings with
+    * a q value of 0 are never picked. gzip is picked over deflate unless deflate has the higher q value.
+    */
+   content_encoding accepted_encoding( const std::string& accept_encoding );
+
+   /**
+    * Compresses body in place with encoding when it is at least min_bytes long.
+    *
+    * @return the Content-Encoding to send body with, or nullptr if body was left as it is
+    */
+   const char* compress_response( std::string& body, content_encoding encoding, uint32_t min_bytes );
+
+}
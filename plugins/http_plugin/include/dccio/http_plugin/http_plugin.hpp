@@ -40,6 +40,19 @@ namespace dccio {
     */
    using api_description = std::map<string, url_handler>;
 
+   /**
+    * @brief Relative priority of a URL handler
+    *
+    * Requests waiting for the application thread are dispatched highest
+    * priority first, so cheap state-changing calls are not stuck behind
+    * a backlog of expensive queries.
+    */
+   struct http_priority {
+      static constexpr int low    = 10;
+      static constexpr int medium = 50;
+      static constexpr int high   = 100;
+   };
+
    struct http_plugin_defaults {
       //If not empty, this string is prepended on to the various configuration
       // items for setting listen addresses
@@ -61,11 +74,13 @@ namespace dccio {
     *
     *  The handler will be called from the appbase application io_service
     *  thread.  The callback can be called from any thread and will
-    *  automatically propagate the call to the http thread.
+    *  automatically propagate the call to the http threads.
     *
-    *  The HTTP service will run in its own thread with its own io_service to
-    *  make sure that HTTP request processing does not interfer with other
-    *  plugins.
+    *  The HTTP service runs on its own pool of threads with its own io_service
+    *  so that reading requests and writing responses does not interfere with
+    *  other plugins. Requests for each URL wait in a bounded queue until the
+    *  application thread dispatches them in order of handler priority; a
+    *  request arriving at a full queue is rejected with 503.
     */
    class http_plugin : public appbase::plugin<http_plugin>
    {
@@ -83,10 +98,10 @@ namespace dccio {
         void plugin_startup();
         void plugin_shutdown();
 
-        void add_handler(const string& url, const url_handler&);
-        void add_api(const api_description& api) {
+        void add_handler(const string& url, const url_handler&, int priority = http_priority::medium);
+        void add_api(const api_description& api, int priority = http_priority::medium) {
            for (const auto& call : api)
-              add_handler(call.first, call.second);
+              add_handler(call.first, call.second, priority);
         }
 
         // standard exception handling for api handlers
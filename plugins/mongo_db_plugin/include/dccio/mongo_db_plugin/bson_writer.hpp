@@ -0,0 +1,109 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#pragma once
+
+#include <dccio/chain/abi_writer.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/utf8.hpp>
+
+#include <bsoncxx/builder/core.hpp>
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/types.hpp>
+
+#include <limits>
+
+namespace dccio {
+
+/**
+ * Builds the BSON document of an object handed to it by abi_serializer::to_writer or abi_writer::variant_value.
+ *
+ * The document holds what bsoncxx::from_json of the object's fc::json text held: integers wider than 32 bits and
+ * doubles are strings, other integers are int32 when they fit, and strings that are not valid UTF-8 are stored with
+ * the invalid sequences pruned.
+ */
+class bson_writer : public chain::abi_writer {
+   public:
+      void begin_object() override {
+         // the outermost object is the document itself
+         if( depth++ > 0 )
+            builder.open_document();
+      }
+
+      void key( const std::string& name ) override {
+         if( fc::is_utf8( name ) )
+            builder.key_owned( name );
+         else
+            builder.key_owned( pruned( name ) );
+      }
+
+      void end_object() override {
+         if( --depth > 0 )
+            builder.close_document();
+      }
+
+      void begin_array() override {
+         FC_ASSERT( depth++ > 0, "a BSON document cannot be an array" );
+         builder.open_array();
+      }
+
+      void end_array() override {
+         --depth;
+         builder.close_array();
+      }
+
+      void null_value() override {
+         builder.append( bsoncxx::types::b_null{} );
+      }
+
+      void bool_value( bool v ) override {
+         builder.append( bsoncxx::types::b_bool{v} );
+      }
+
+      void int64_value( int64_t v ) override {
+         if( v > 0xffffffff )
+            string_value( std::to_string( v ) );
+         else if( v >= std::numeric_limits<int32_t>::min() && v <= std::numeric_limits<int32_t>::max() )
+            builder.append( bsoncxx::types::b_int32{static_cast<int32_t>(v)} );
+         else
+            builder.append( bsoncxx::types::b_int64{v} );
+      }
+
+      void uint64_value( uint64_t v ) override {
+         if( v > 0xffffffff )
+            string_value( std::to_string( v ) );
+         else
+            int64_value( static_cast<int64_t>(v) );
+      }
+
+      void double_value( double v ) override {
+         string_value( fc::variant( v ).as_string() );
+      }
+
+      void string_value( const std::string& v ) override {
+         if( fc::is_utf8( v ) )
+            builder.append( bsoncxx::types::b_utf8{v} );
+         else
+            builder.append( bsoncxx::types::b_utf8{pruned( v )} );
+      }
+
+      /// true if a key or string was pruned of invalid UTF-8
+      bool purged_invalid_utf8()const { return purged; }
+
+      bsoncxx::document::value extract() {
+         return builder.extract_document();
+      }
+
+   private:
+      std::string pruned( const std::string& v ) {
+         purged = true;
+         return fc::prune_invalid_utf8( v );
+      }
+
+      bsoncxx::builder::core builder{false};
+      uint32_t               depth = 0;
+      bool                   purged = false;
+};
+
+} // dccio
@@ -3,11 +3,13 @@
  *  @copyright defined in dcc/LICENSE.txt
  */
 #include <dccio/mongo_db_plugin/mongo_db_plugin.hpp>
+#include <dccio/mongo_db_plugin/bson_writer.hpp>
 #include <dccio/chain/dccio_contract.hpp>
 #include <dccio/chain/config.hpp>
 #include <dccio/chain/exceptions.hpp>
 #include <dccio/chain/transaction.hpp>
 #include <dccio/chain/types.hpp>
+#include <dccio/chain/abi_serializer_cache.hpp>
 
 #include <fc/io/json.hpp>
 #include <fc/utf8.hpp>
@@ -20,6 +22,7 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
 
+#include <array>
 #include <queue>
 
 #include <bsoncxx/builder/basic/kvp.hpp>
@@ -30,6 +33,7 @@
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/pool.hpp>
+#include <mongocxx/model/write.hpp>
 #include <mongocxx/exception/operation_exception.hpp>
 #include <mongocxx/exception/logic_error.hpp>
 
@@ -91,13 +95,10 @@ public:
    void process_irreversible_block(const chain::block_state_ptr&);
    void _process_irreversible_block(const chain::block_state_ptr&);
 
-   optional<abi_serializer> get_abi_serializer( account_name n );
-   template<typename T> fc::variant to_variant_with_abi( const T& obj );
+   abi_serializer_cache::serializer_ptr get_abi_serializer( account_name n );
+   template<typename T> bsoncxx::document::value to_bson_with_abi( const T& obj, bool& purged_invalid_utf8 );
 
-   void purge_abi_cache();
-
-   bool add_action_trace( mongocxx::bulk_write& bulk_action_traces, const chain::action_trace& atrace,
-                          const chain::transaction_trace_ptr& t,
+   bool add_action_trace( const chain::action_trace& atrace, const chain::transaction_trace_ptr& t,
                           bool executed, const std::chrono::milliseconds& now );
 
    void update_account(const chain::action& act);
@@ -120,6 +121,21 @@ public:
 
    template<typename Queue, typename Entry> void queue(Queue& queue, const Entry& e);
 
+   /// writes for one collection, built by the consume thread and executed as one bulk write by a writer thread
+   struct write_batch {
+      std::string collection;
+      bool ordered = true;
+      std::vector<mongocxx::model::write> writes;
+   };
+   using write_batch_ptr = std::shared_ptr<write_batch>;
+   enum batch_index { action_traces_batch, trans_traces_batch, trans_batch, trans_irreversible_batch, blocks_batch,
+                      block_states_batch, batch_count };
+
+   void add_write( batch_index i, mongocxx::model::write w );
+   void flush_writes();
+   size_t writer_for( batch_index i ) const;
+   void execute_batch( mongocxx::pool::entry& client, const write_batch& batch );
+
    bool configured{false};
    bool wipe_database_on_startup{false};
    uint32_t start_block_num = 0;
@@ -140,18 +156,20 @@ public:
    mongocxx::instance mongo_inst;
    fc::optional<mongocxx::pool> mongo_pool;
 
-   // consum thread
+   // consum thread, accounts are written inline as later ABI lookups read them back
    mongocxx::collection _accounts;
-   mongocxx::collection _trans;
-   mongocxx::collection _trans_traces;
-   mongocxx::collection _action_traces;
-   mongocxx::collection _block_states;
-   mongocxx::collection _blocks;
    mongocxx::collection _pub_keys;
    mongocxx::collection _account_controls;
+   std::array<write_batch_ptr, batch_count> batches; ///< handed to the writers at the end of each pass over the queues
+   std::set<std::pair<uint32_t, block_id_type>> accepted_blocks; ///< block num and id written, until irreversible
+
+   // each collection is written by one writer, in the order its batches were built
+   uint32_t writer_threads = 4;
+   std::vector<std::unique_ptr<appbase::async_dispatcher<write_batch_ptr>>> writers;
 
    size_t max_queue_size = 0;
-   int queue_sleep_time = 0;
+   appbase::backpressure queue_policy = appbase::backpressure::block;
+   appbase::async_dispatch_stats queue_stats; ///< guarded by mtx, depth unused
    size_t abi_cache_size = 0;
    std::deque<chain::transaction_metadata_ptr> transaction_metadata_queue;
    std::deque<chain::transaction_metadata_ptr> transaction_metadata_process_queue;
@@ -163,29 +181,16 @@ public:
    std::deque<chain::block_state_ptr> irreversible_block_state_process_queue;
    boost::mutex mtx;
    boost::condition_variable condition;
+   boost::condition_variable space_available; ///< signalled when the consume thread takes the queued entries
    boost::thread consume_thread;
    std::atomic_bool done{false};
+   bool consume_thread_exited = false; ///< guarded by mtx, entries are no longer queued once set
    std::atomic_bool startup{true};
    fc::optional<chain::chain_id_type> chain_id;
    fc::microseconds abi_serializer_max_time;
 
-   struct by_account;
-   struct by_last_access;
-
-   struct abi_cache {
-      account_name                     account;
-      fc::time_point                   last_accessed;
-      fc::optional<abi_serializer>     serializer;
-   };
-
-   typedef boost::multi_index_container<abi_cache,
-         indexed_by<
-               ordered_unique< tag<by_account>,  member<abi_cache,account_name,&abi_cache::account> >,
-               ordered_non_unique< tag<by_last_access>,  member<abi_cache,fc::time_point,&abi_cache::last_accessed> >
-         >
-   > abi_cache_index_t;
-
-   abi_cache_index_t abi_cache_index;
+   // serializers built from the ABIs stored in mongo, which trail chain state; entries are replaced on setabi
+   std::unique_ptr<abi_serializer_cache> abi_cache;
 
    static const action_name newaccount;
    static const action_name setabi;
@@ -290,20 +295,24 @@ bool mongo_db_plugin_impl::filter_include( const transaction& trx ) const
 template<typename Queue, typename Entry>
 void mongo_db_plugin_impl::queue( Queue& queue, const Entry& e ) {
    boost::mutex::scoped_lock lock( mtx );
-   auto queue_size = queue.size();
-   if( queue_size > max_queue_size ) {
-      lock.unlock();
-      condition.notify_one();
-      queue_sleep_time += 10;
-      if( queue_sleep_time > 1000 )
-         wlog("queue size: ${q}", ("q", queue_size));
-      boost::this_thread::sleep_for( boost::chrono::milliseconds( queue_sleep_time ));
-      lock.lock();
-   } else {
-      queue_sleep_time -= 10;
-      if( queue_sleep_time < 0 ) queue_sleep_time = 0;
+   if( consume_thread_exited )
+      return;
+   if( queue.size() >= max_queue_size && !done ) {
+      if( queue_policy == appbase::backpressure::drop ) {
+         if( queue_stats.dropped++ % 1000 == 0 )
+            wlog( "queue full, dropped ${d} entries so far", ("d", queue_stats.dropped) );
+         return;
+      }
+      ++queue_stats.blocked;
+      auto start = fc::time_point::now();
+      space_available.wait( lock, [&]() { return queue.size() < max_queue_size || done; } );
+      auto waited = fc::time_point::now() - start;
+      if( waited > fc::seconds(1) )
+         wlog( "waited ${t} for queue space, queue size: ${q}", ("t", waited)("q", queue.size()) );
    }
    queue.emplace_back( e );
+   if( queue.size() > queue_stats.max_depth )
+      queue_stats.max_depth = queue.size();
    lock.unlock();
    condition.notify_one();
 }
@@ -396,11 +405,6 @@ void mongo_db_plugin_impl::consume_blocks() {
       auto& mongo_conn = *mongo_client;
 
       _accounts = mongo_conn[db_name][accounts_col];
-      _trans = mongo_conn[db_name][trans_col];
-      _trans_traces = mongo_conn[db_name][trans_traces_col];
-      _action_traces = mongo_conn[db_name][action_traces_col];
-      _blocks = mongo_conn[db_name][blocks_col];
-      _block_states = mongo_conn[db_name][block_states_col];
       _pub_keys = mongo_conn[db_name][pub_keys_col];
       _account_controls = mongo_conn[db_name][account_controls_col];
 
@@ -435,11 +439,15 @@ void mongo_db_plugin_impl::consume_blocks() {
             irreversible_block_state_process_queue = move(irreversible_block_state_queue);
             irreversible_block_state_queue.clear();
          }
+         auto stats = queue_stats;
 
          lock.unlock();
+         space_available.notify_all();
 
          if (done) {
             ilog("draining queue, size: ${q}", ("q", transaction_metadata_size + transaction_trace_size + block_state_size + irreversible_block_size));
+            ilog("queue max size: ${m}, publishes blocked: ${b}, entries dropped: ${d}",
+                 ("m", stats.max_depth)("b", stats.blocked)("d", stats.dropped));
          }
 
          // process transactions
@@ -493,6 +501,8 @@ void mongo_db_plugin_impl::consume_blocks() {
          if( time > fc::microseconds(500000) ) // reduce logging, .5 secs
             ilog( "process_irreversible_block,   time per: ${p}, size: ${s}, time: ${t}", ("s", size)("t", time)("p", per) );
 
+         flush_writes();
+
          if( transaction_metadata_size == 0 &&
              transaction_trace_size == 0 &&
              block_state_size == 0 &&
@@ -509,6 +519,14 @@ void mongo_db_plugin_impl::consume_blocks() {
    } catch (...) {
       elog("Unknown exception while consuming block");
    }
+
+   // publishers blocked on a full queue would otherwise wait forever on a thread that is gone
+   {
+      boost::mutex::scoped_lock lock( mtx );
+      done = true;
+      consume_thread_exited = true;
+   }
+   space_available.notify_all();
 }
 
 namespace {
@@ -519,15 +537,6 @@ auto find_account( mongocxx::collection& accounts, const account_name& name ) {
    return accounts.find_one( make_document( kvp( "name", name.to_string())));
 }
 
-auto find_block( mongocxx::collection& blocks, const string& id ) {
-   using bsoncxx::builder::basic::make_document;
-   using bsoncxx::builder::basic::kvp;
-
-   mongocxx::options::find options;
-   options.projection( make_document( kvp( "_id", 1 )) ); // only return _id
-   return blocks.find_one( make_document( kvp( "block_id", id )), options);
-}
-
 void handle_mongo_exception( const std::string& desc, int line_num ) {
    bool shutdown = true;
    try {
@@ -571,95 +580,128 @@ void handle_mongo_exception( const std::string& desc, int line_num ) {
 
 } // anonymous namespace
 
-void mongo_db_plugin_impl::purge_abi_cache() {
-   if( abi_cache_index.size() < abi_cache_size ) return;
+void mongo_db_plugin_impl::add_write( batch_index i, mongocxx::model::write w ) {
+   auto& batch = batches[i];
+   if( !batch ) {
+      batch = std::make_shared<write_batch>();
+      switch( i ) {
+         case action_traces_batch:      batch->collection = action_traces_col; batch->ordered = false; break;
+         case trans_traces_batch:       batch->collection = trans_traces_col;  batch->ordered = false; break;
+         case trans_batch:              batch->collection = trans_col;         batch->ordered = false; break;
+         case trans_irreversible_batch: batch->collection = trans_col;         break;
+         case blocks_batch:             batch->collection = blocks_col;        break;
+         case block_states_batch:       batch->collection = block_states_col;  break;
+         case batch_count:              break;
+      }
+   }
+   batch->writes.emplace_back( std::move( w ) );
+}
+
+void mongo_db_plugin_impl::flush_writes() {
+   for( size_t i = 0; i < batches.size(); ++i ) {
+      if( batches[i] ) {
+         // blocks while the writer is behind, which in turn holds up the queues above
+         writers[writer_for( static_cast<batch_index>( i ) )]->push( batches[i] );
+         batches[i].reset();
+      }
+   }
+}
+
+size_t mongo_db_plugin_impl::writer_for( batch_index i ) const {
+   // the irreversible updates do not upsert, so they follow the transaction upserts through the same writer
+   if( i == trans_irreversible_batch )
+      i = trans_batch;
+   return i % writers.size();
+}
+
+void mongo_db_plugin_impl::execute_batch( mongocxx::pool::entry& client, const write_batch& batch ) {
+   try {
+      if( !client )
+         client = mongo_pool->acquire();
+      auto collection = (*client)[db_name][batch.collection];
 
-   // remove the oldest (smallest) last accessed
-   auto& idx = abi_cache_index.get<by_last_access>();
-   auto itr = idx.begin();
-   if( itr != idx.end() ) {
-      idx.erase( itr );
+      mongocxx::options::bulk_write bulk_opts;
+      bulk_opts.ordered( batch.ordered );
+      auto bulk = collection.create_bulk_write( bulk_opts );
+      for( const auto& w : batch.writes ) {
+         bulk.append( w );
+      }
+      if( !bulk.execute() ) {
+         dcc_ASSERT( false, chain::mongo_db_insert_fail, "Bulk ${c} write of ${n} failed",
+                     ("c", batch.collection)("n", batch.writes.size()) );
+      }
+   } catch( ... ) {
+      handle_mongo_exception( "bulk " + batch.collection + " write", __LINE__ );
    }
 }
 
-optional<abi_serializer> mongo_db_plugin_impl::get_abi_serializer( account_name n ) {
+abi_serializer_cache::serializer_ptr mongo_db_plugin_impl::get_abi_serializer( account_name n ) {
    using bsoncxx::builder::basic::kvp;
    using bsoncxx::builder::basic::make_document;
    if( n.good()) {
       try {
-
-         auto itr = abi_cache_index.find( n );
-         if( itr != abi_cache_index.end() ) {
-            abi_cache_index.modify( itr, []( auto& entry ) {
-               entry.last_accessed = fc::time_point::now();
-            });
-
-            return itr->serializer;
-         }
-
-         auto account = _accounts.find_one( make_document( kvp("name", n.to_string())) );
-         if(account) {
+         // the stored ABIs carry no abi_sequence, setabi invalidates the entry instead
+         return abi_cache->get( n, 0, [&]() -> abi_serializer_cache::serializer_ptr {
+            auto account = _accounts.find_one( make_document( kvp("name", n.to_string())) );
+            if( !account )
+               return {};
             auto view = account->view();
+            if( view.find( "abi" ) == view.end())
+               return {};
             abi_def abi;
-            if( view.find( "abi" ) != view.end()) {
-               try {
-                  abi = fc::json::from_string( bsoncxx::to_json( view["abi"].get_document())).as<abi_def>();
-               } catch (...) {
-                  ilog( "Unable to convert account abi to abi_def for ${n}", ( "n", n ));
-                  return optional<abi_serializer>();
-               }
+            try {
+               abi = fc::json::from_string( bsoncxx::to_json( view["abi"].get_document())).as<abi_def>();
+            } catch (...) {
+               ilog( "Unable to convert account abi to abi_def for ${n}", ( "n", n ));
+               return {};
+            }
 
-               purge_abi_cache(); // make room if necessary
-               abi_cache entry;
-               entry.account = n;
-               entry.last_accessed = fc::time_point::now();
-               abi_serializer abis;
-               if( n == chain::config::system_account_name ) {
-                  // redefine dccio setabi.abi from bytes to abi_def
-                  // Done so that abi is stored as abi_def in mongo instead of as bytes
-                  auto itr = std::find_if( abi.structs.begin(), abi.structs.end(),
-                                           []( const auto& s ) { return s.name == "setabi"; } );
-                  if( itr != abi.structs.end() ) {
-                     auto itr2 = std::find_if( itr->fields.begin(), itr->fields.end(),
-                                               []( const auto& f ) { return f.name == "abi"; } );
-                     if( itr2 != itr->fields.end() ) {
-                        if( itr2->type == "bytes" ) {
-                           itr2->type = "abi_def";
-                           // unpack setabi.abi as abi_def instead of as bytes
-                           abis.add_specialized_unpack_pack( "abi_def",
-                                 std::make_pair<abi_serializer::unpack_function, abi_serializer::pack_function>(
-                                       []( fc::datastream<const char*>& stream, bool is_array, bool is_optional ) -> fc::variant {
-                                          dcc_ASSERT( !is_array && !is_optional, chain::mongo_db_exception, "unexpected abi_def");
-                                          chain::bytes temp;
-                                          fc::raw::unpack( stream, temp );
-                                          return fc::variant( fc::raw::unpack<abi_def>( temp ) );
-                                       },
-                                       []( const fc::variant& var, fc::datastream<char*>& ds, bool is_array, bool is_optional ) {
-                                          dcc_ASSERT( false, chain::mongo_db_exception, "never called" );
-                                       }
-                                 ) );
-                        }
+            auto abis = std::make_shared<abi_serializer>();
+            if( n == chain::config::system_account_name ) {
+               // redefine dccio setabi.abi from bytes to abi_def
+               // Done so that abi is stored as abi_def in mongo instead of as bytes
+               auto itr = std::find_if( abi.structs.begin(), abi.structs.end(),
+                                        []( const auto& s ) { return s.name == "setabi"; } );
+               if( itr != abi.structs.end() ) {
+                  auto itr2 = std::find_if( itr->fields.begin(), itr->fields.end(),
+                                            []( const auto& f ) { return f.name == "abi"; } );
+                  if( itr2 != itr->fields.end() ) {
+                     if( itr2->type == "bytes" ) {
+                        itr2->type = "abi_def";
+                        // unpack setabi.abi as abi_def instead of as bytes
+                        abis->add_specialized_unpack_pack( "abi_def",
+                              std::make_pair<abi_serializer::unpack_function, abi_serializer::pack_function>(
+                                    []( fc::datastream<const char*>& stream, bool is_array, bool is_optional ) -> fc::variant {
+                                       dcc_ASSERT( !is_array && !is_optional, chain::mongo_db_exception, "unexpected abi_def");
+                                       chain::bytes temp;
+                                       fc::raw::unpack( stream, temp );
+                                       return fc::variant( fc::raw::unpack<abi_def>( temp ) );
+                                    },
+                                    []( const fc::variant& var, fc::datastream<char*>& ds, bool is_array, bool is_optional ) {
+                                       dcc_ASSERT( false, chain::mongo_db_exception, "never called" );
+                                    }
+                              ) );
                      }
                   }
                }
-               abis.set_abi( abi, abi_serializer_max_time );
-               entry.serializer.emplace( std::move( abis ) );
-               abi_cache_index.insert( entry );
-               return entry.serializer;
             }
-         }
+            abis->set_abi( abi, abi_serializer_max_time );
+            return abis;
+         });
       } FC_CAPTURE_AND_LOG((n))
    }
-   return optional<abi_serializer>();
+   return abi_serializer_cache::serializer_ptr();
 }
 
+/// the document bsoncxx::from_json made of the JSON of abi_serializer::to_variant, without the fc::variant or the JSON
 template<typename T>
-fc::variant mongo_db_plugin_impl::to_variant_with_abi( const T& obj ) {
-   fc::variant pretty_output;
-   abi_serializer::to_variant( obj, pretty_output,
-                               [&]( account_name n ) { return get_abi_serializer( n ); },
-                               abi_serializer_max_time );
-   return pretty_output;
+bsoncxx::document::value mongo_db_plugin_impl::to_bson_with_abi( const T& obj, bool& purged_invalid_utf8 ) {
+   bson_writer writer;
+   abi_serializer::to_writer( obj, writer,
+                              [&]( account_name n ) { return get_abi_serializer( n ); },
+                              abi_serializer_max_time );
+   purged_invalid_utf8 = writer.purged_invalid_utf8();
+   return writer.extract();
 }
 
 void mongo_db_plugin_impl::process_accepted_transaction( const chain::transaction_metadata_ptr& t ) {
@@ -738,23 +780,11 @@ void mongo_db_plugin_impl::_process_accepted_transaction( const chain::transacti
 
    trans_doc.append( kvp( "trx_id", trx_id_str ) );
 
-   auto v = to_variant_with_abi( trx );
-   string trx_json = fc::json::to_string( v );
-
-   try {
-      const auto& trx_value = bsoncxx::from_json( trx_json );
-      trans_doc.append( bsoncxx::builder::concatenate_doc{trx_value.view()} );
-   } catch( bsoncxx::exception& ) {
-      try {
-         trx_json = fc::prune_invalid_utf8( trx_json );
-         const auto& trx_value = bsoncxx::from_json( trx_json );
-         trans_doc.append( bsoncxx::builder::concatenate_doc{trx_value.view()} );
-         trans_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
-      } catch( bsoncxx::exception& e ) {
-         elog( "Unable to convert transaction JSON to MongoDB JSON: ${e}", ("e", e.what()) );
-         elog( "  JSON: ${j}", ("j", trx_json) );
-      }
-   }
+   bool purged = false;
+   const auto trx_value = to_bson_with_abi( trx, purged );
+   trans_doc.append( bsoncxx::builder::concatenate_doc{trx_value.view()} );
+   if( purged )
+      trans_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
 
    string signing_keys_json;
    if( t->signing_keys.valid() ) {
@@ -783,22 +813,14 @@ void mongo_db_plugin_impl::_process_accepted_transaction( const chain::transacti
 
    trans_doc.append( kvp( "createdAt", b_date{now} ) );
 
-   try {
-      mongocxx::options::update update_opts{};
-      update_opts.upsert( true );
-      if( !_trans.update_one( make_document( kvp( "trx_id", trx_id_str ) ),
-                              make_document( kvp( "$set", trans_doc.view() ) ), update_opts ) ) {
-         dcc_ASSERT( false, chain::mongo_db_insert_fail, "Failed to insert trans ${id}", ("id", trx_id) );
-      }
-   } catch( ... ) {
-      handle_mongo_exception( "trans insert", __LINE__ );
-   }
-
+   mongocxx::model::update_one update_op{make_document( kvp( "trx_id", trx_id_str ) ),
+                                         make_document( kvp( "$set", trans_doc.view() ) )};
+   update_op.upsert( true );
+   add_write( trans_batch, std::move( update_op ) );
 }
 
 bool
-mongo_db_plugin_impl::add_action_trace( mongocxx::bulk_write& bulk_action_traces, const chain::action_trace& atrace,
-                                        const chain::transaction_trace_ptr& t,
+mongo_db_plugin_impl::add_action_trace( const chain::action_trace& atrace, const chain::transaction_trace_ptr& t,
                                         bool executed, const std::chrono::milliseconds& now )
 {
    using namespace bsoncxx::types;
@@ -814,34 +836,22 @@ mongo_db_plugin_impl::add_action_trace( mongocxx::bulk_write& bulk_action_traces
       auto action_traces_doc = bsoncxx::builder::basic::document{};
       const chain::base_action_trace& base = atrace; // without inline action traces
 
-      auto v = to_variant_with_abi( base );
-      string json = fc::json::to_string( v );
-      try {
-         const auto& value = bsoncxx::from_json( json );
-         action_traces_doc.append( bsoncxx::builder::concatenate_doc{value.view()} );
-      } catch( bsoncxx::exception& ) {
-         try {
-            json = fc::prune_invalid_utf8( json );
-            const auto& value = bsoncxx::from_json( json );
-            action_traces_doc.append( bsoncxx::builder::concatenate_doc{value.view()} );
-            action_traces_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
-         } catch( bsoncxx::exception& e ) {
-            elog( "Unable to convert action trace JSON to MongoDB JSON: ${e}", ("e", e.what()) );
-            elog( "  JSON: ${j}", ("j", json) );
-         }
-      }
+      bool purged = false;
+      const auto value = to_bson_with_abi( base, purged );
+      action_traces_doc.append( bsoncxx::builder::concatenate_doc{value.view()} );
+      if( purged )
+         action_traces_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
       if( t->receipt.valid() ) {
          action_traces_doc.append( kvp( "trx_status", std::string( t->receipt->status ) ) );
       }
       action_traces_doc.append( kvp( "createdAt", b_date{now} ) );
 
-      mongocxx::model::insert_one insert_op{action_traces_doc.view()};
-      bulk_action_traces.append( insert_op );
+      add_write( action_traces_batch, mongocxx::model::insert_one{action_traces_doc.extract()} );
       added = true;
    }
 
    for( const auto& iline_atrace : atrace.inline_traces ) {
-      added |= add_action_trace( bulk_action_traces, iline_atrace, t, executed, now );
+      added |= add_action_trace( iline_atrace, t, executed, now );
    }
 
    return added;
@@ -857,15 +867,12 @@ void mongo_db_plugin_impl::_process_applied_transaction( const chain::transactio
    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
          std::chrono::microseconds{fc::time_point::now().time_since_epoch().count()});
 
-   mongocxx::options::bulk_write bulk_opts;
-   bulk_opts.ordered(false);
-   mongocxx::bulk_write bulk_action_traces = _action_traces.create_bulk_write(bulk_opts);
    bool write_atraces = false;
    bool executed = t->receipt.valid() && t->receipt->status == chain::transaction_receipt_header::executed;
 
    for( const auto& atrace : t->action_traces ) {
       try {
-         write_atraces |= add_action_trace( bulk_action_traces, atrace, t, executed, now );
+         write_atraces |= add_action_trace( atrace, t, executed, now );
       } catch(...) {
          handle_mongo_exception("add action traces", __LINE__);
       }
@@ -878,46 +885,18 @@ void mongo_db_plugin_impl::_process_applied_transaction( const chain::transactio
 
    if( store_transaction_traces ) {
       try {
-         auto v = to_variant_with_abi( *t );
-         string json = fc::json::to_string( v );
-         try {
-            const auto& value = bsoncxx::from_json( json );
-            trans_traces_doc.append( bsoncxx::builder::concatenate_doc{value.view()} );
-         } catch( bsoncxx::exception& ) {
-            try {
-               json = fc::prune_invalid_utf8( json );
-               const auto& value = bsoncxx::from_json( json );
-               trans_traces_doc.append( bsoncxx::builder::concatenate_doc{value.view()} );
-               trans_traces_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
-            } catch( bsoncxx::exception& e ) {
-               elog( "Unable to convert transaction JSON to MongoDB JSON: ${e}", ("e", e.what()) );
-               elog( "  JSON: ${j}", ("j", json) );
-            }
-         }
+         bool purged = false;
+         const auto value = to_bson_with_abi( *t, purged );
+         trans_traces_doc.append( bsoncxx::builder::concatenate_doc{value.view()} );
+         if( purged )
+            trans_traces_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
          trans_traces_doc.append( kvp( "createdAt", b_date{now} ) );
 
-         try {
-            if( !_trans_traces.insert_one( trans_traces_doc.view() ) ) {
-               dcc_ASSERT( false, chain::mongo_db_insert_fail, "Failed to insert trans ${id}", ("id", t->id) );
-            }
-         } catch( ... ) {
-            handle_mongo_exception( "trans_traces insert: " + json, __LINE__ );
-         }
+         add_write( trans_traces_batch, mongocxx::model::insert_one{trans_traces_doc.extract()} );
       } catch( ... ) {
          handle_mongo_exception( "trans_traces serialization: " + t->id.str(), __LINE__ );
       }
    }
-
-   // insert action_traces
-   try {
-      if( !bulk_action_traces.execute() ) {
-         dcc_ASSERT( false, chain::mongo_db_insert_fail,
-                     "Bulk action traces insert failed for transaction trace: ${id}", ("id", t->id) );
-      }
-   } catch( ... ) {
-      handle_mongo_exception( "action traces insert", __LINE__ );
-   }
-
 }
 
 void mongo_db_plugin_impl::_process_accepted_block( const chain::block_state_ptr& bs ) {
@@ -926,9 +905,6 @@ void mongo_db_plugin_impl::_process_accepted_block( const chain::block_state_ptr
    using bsoncxx::builder::basic::kvp;
    using bsoncxx::builder::basic::make_document;
 
-   mongocxx::options::update update_opts{};
-   update_opts.upsert( true );
-
    auto block_num = bs->block_num;
    if( block_num % 1000 == 0 )
       ilog( "block_num: ${b}", ("b", block_num) );
@@ -938,6 +914,18 @@ void mongo_db_plugin_impl::_process_accepted_block( const chain::block_state_ptr
    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
          std::chrono::microseconds{fc::time_point::now().time_since_epoch().count()});
 
+   auto filter_doc = [&]() {
+      return update_blocks_via_block_num ? make_document( kvp( "block_num", b_int32{static_cast<int32_t>(block_num)} ) )
+                                         : make_document( kvp( "block_id", block_id_str ) );
+   };
+
+   if( update_blocks_via_block_num ) {
+      // the block written last for this number replaces any other
+      accepted_blocks.erase( accepted_blocks.lower_bound( std::make_pair( block_num, block_id_type() ) ),
+                             accepted_blocks.lower_bound( std::make_pair( block_num + 1, block_id_type() ) ) );
+   }
+   accepted_blocks.emplace( block_num, block_id );
+
    if( store_block_states ) {
       auto block_state_doc = bsoncxx::builder::basic::document{};
       block_state_doc.append( kvp( "block_num", b_int32{static_cast<int32_t>(block_num)} ),
@@ -946,38 +934,17 @@ void mongo_db_plugin_impl::_process_accepted_block( const chain::block_state_ptr
 
       const chain::block_header_state& bhs = *bs;
 
-      auto json = fc::json::to_string( bhs );
-      try {
-         const auto& value = bsoncxx::from_json( json );
-         block_state_doc.append( kvp( "block_header_state", value ) );
-      } catch( bsoncxx::exception& ) {
-         try {
-            json = fc::prune_invalid_utf8( json );
-            const auto& value = bsoncxx::from_json( json );
-            block_state_doc.append( kvp( "block_header_state", value ) );
-            block_state_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
-         } catch( bsoncxx::exception& e ) {
-            elog( "Unable to convert block_header_state JSON to MongoDB JSON: ${e}", ("e", e.what()) );
-            elog( "  JSON: ${j}", ("j", json) );
-         }
-      }
+      bson_writer bhs_writer;
+      bhs_writer.variant_value( fc::variant( bhs ) );
+      const bool purged = bhs_writer.purged_invalid_utf8();
+      block_state_doc.append( kvp( "block_header_state", bhs_writer.extract() ) );
+      if( purged )
+         block_state_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
       block_state_doc.append( kvp( "createdAt", b_date{now} ) );
 
-      try {
-         if( update_blocks_via_block_num ) {
-            if( !_block_states.update_one( make_document( kvp( "block_num", b_int32{static_cast<int32_t>(block_num)} ) ),
-                                           make_document( kvp( "$set", block_state_doc.view() ) ), update_opts ) ) {
-               dcc_ASSERT( false, chain::mongo_db_insert_fail, "Failed to insert block_state ${num}", ("num", block_num) );
-            }
-         } else {
-            if( !_block_states.update_one( make_document( kvp( "block_id", block_id_str ) ),
-                                           make_document( kvp( "$set", block_state_doc.view() ) ), update_opts ) ) {
-               dcc_ASSERT( false, chain::mongo_db_insert_fail, "Failed to insert block_state ${bid}", ("bid", block_id) );
-            }
-         }
-      } catch( ... ) {
-         handle_mongo_exception( "block_states insert: " + json, __LINE__ );
-      }
+      mongocxx::model::update_one update_op{filter_doc(), make_document( kvp( "$set", block_state_doc.view() ) )};
+      update_op.upsert( true );
+      add_write( block_states_batch, std::move( update_op ) );
    }
 
    if( store_blocks ) {
@@ -985,39 +952,15 @@ void mongo_db_plugin_impl::_process_accepted_block( const chain::block_state_ptr
       block_doc.append( kvp( "block_num", b_int32{static_cast<int32_t>(block_num)} ),
                         kvp( "block_id", block_id_str ) );
 
-      auto v = to_variant_with_abi( *bs->block );
-      auto json = fc::json::to_string( v );
-      try {
-         const auto& value = bsoncxx::from_json( json );
-         block_doc.append( kvp( "block", value ) );
-      } catch( bsoncxx::exception& ) {
-         try {
-            json = fc::prune_invalid_utf8( json );
-            const auto& value = bsoncxx::from_json( json );
-            block_doc.append( kvp( "block", value ) );
-            block_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
-         } catch( bsoncxx::exception& e ) {
-            elog( "Unable to convert block JSON to MongoDB JSON: ${e}", ("e", e.what()) );
-            elog( "  JSON: ${j}", ("j", json) );
-         }
-      }
+      bool purged = false;
+      block_doc.append( kvp( "block", to_bson_with_abi( *bs->block, purged ) ) );
+      if( purged )
+         block_doc.append( kvp( "non-utf8-purged", b_bool{true} ) );
       block_doc.append( kvp( "createdAt", b_date{now} ) );
 
-      try {
-         if( update_blocks_via_block_num ) {
-            if( !_blocks.update_one( make_document( kvp( "block_num", b_int32{static_cast<int32_t>(block_num)} ) ),
-                                     make_document( kvp( "$set", block_doc.view() ) ), update_opts ) ) {
-               dcc_ASSERT( false, chain::mongo_db_insert_fail, "Failed to insert block ${num}", ("num", block_num) );
-            }
-         } else {
-            if( !_blocks.update_one( make_document( kvp( "block_id", block_id_str ) ),
-                                     make_document( kvp( "$set", block_doc.view() ) ), update_opts ) ) {
-               dcc_ASSERT( false, chain::mongo_db_insert_fail, "Failed to insert block ${bid}", ("bid", block_id) );
-            }
-         }
-      } catch( ... ) {
-         handle_mongo_exception( "blocks insert: " + json, __LINE__ );
-      }
+      mongocxx::model::update_one update_op{filter_doc(), make_document( kvp( "$set", block_doc.view() ) )};
+      update_op.upsert( true );
+      add_write( blocks_batch, std::move( update_op ) );
    }
 }
 
@@ -1035,43 +978,33 @@ void mongo_db_plugin_impl::_process_irreversible_block(const chain::block_state_
    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
          std::chrono::microseconds{fc::time_point::now().time_since_epoch().count()});
 
-   if( store_blocks ) {
-      auto ir_block = find_block( _blocks, block_id_str );
-      if( !ir_block ) {
-         _process_accepted_block( bs );
-         ir_block = find_block( _blocks, block_id_str );
-         if( !ir_block ) return; // should never happen
-      }
-
-      auto update_doc = make_document( kvp( "$set", make_document( kvp( "irreversible", b_bool{true} ),
-                                                                   kvp( "validated", b_bool{bs->validated} ),
-                                                                   kvp( "updatedAt", b_date{now} ) ) ) );
+   const auto block_num = bs->block->block_num();
 
-      _blocks.update_one( make_document( kvp( "_id", ir_block->view()["_id"].get_oid() ) ), update_doc.view() );
-   }
-
-   if( store_block_states ) {
-      auto ir_block = find_block( _block_states, block_id_str );
-      if( !ir_block ) {
+   if( store_blocks || store_block_states ) {
+      // written by the same writer ahead of the updates below, so they find the block in place
+      if( accepted_blocks.count( std::make_pair( block_num, block_id ) ) == 0 ) {
          _process_accepted_block( bs );
-         ir_block = find_block( _block_states, block_id_str );
-         if( !ir_block ) return; // should never happen
       }
-
-      auto update_doc = make_document( kvp( "$set", make_document( kvp( "irreversible", b_bool{true} ),
-                                                                   kvp( "validated", b_bool{bs->validated} ),
-                                                                   kvp( "updatedAt", b_date{now} ) ) ) );
-
-      _block_states.update_one( make_document( kvp( "_id", ir_block->view()["_id"].get_oid() ) ), update_doc.view() );
+      accepted_blocks.erase( accepted_blocks.begin(),
+                             accepted_blocks.lower_bound( std::make_pair( block_num + 1, block_id_type() ) ) );
+
+      auto update_op = [&]() {
+         mongocxx::model::update_one op{make_document( kvp( "block_id", block_id_str ) ),
+                                        make_document( kvp( "$set", make_document( kvp( "irreversible", b_bool{true} ),
+                                                                                   kvp( "validated", b_bool{bs->validated} ),
+                                                                                   kvp( "updatedAt", b_date{now} ) ) ) )};
+         op.upsert( false );
+         return op;
+      };
+      if( store_blocks ) {
+         add_write( blocks_batch, update_op() );
+      }
+      if( store_block_states ) {
+         add_write( block_states_batch, update_op() );
+      }
    }
 
    if( store_transactions ) {
-      const auto block_num = bs->block->block_num();
-      bool transactions_in_block = false;
-      mongocxx::options::bulk_write bulk_opts;
-      bulk_opts.ordered( false );
-      auto bulk = _trans.create_bulk_write( bulk_opts );
-
       for( const auto& receipt : bs->block->transactions ) {
          string trx_id_str;
          if( receipt.trx.contains<packed_transaction>() ) {
@@ -1092,20 +1025,10 @@ void mongo_db_plugin_impl::_process_irreversible_block(const chain::block_state_
                                                                       kvp( "block_num", b_int32{static_cast<int32_t>(block_num)} ),
                                                                       kvp( "updatedAt", b_date{now} ) ) ) );
 
-         mongocxx::model::update_one update_op{make_document( kvp( "trx_id", trx_id_str ) ), update_doc.view()};
+         // flushed after the trans_batch holding the upsert from accepted_transaction, on the same writer
+         mongocxx::model::update_one update_op{make_document( kvp( "trx_id", trx_id_str ) ), std::move( update_doc )};
          update_op.upsert( false );
-         bulk.append( update_op );
-         transactions_in_block = true;
-      }
-
-      if( transactions_in_block ) {
-         try {
-            if( !bulk.execute() ) {
-               dcc_ASSERT( false, chain::mongo_db_insert_fail, "Bulk transaction insert failed for block: ${bid}", ("bid", block_id) );
-            }
-         } catch( ... ) {
-            handle_mongo_exception( "bulk transaction insert", __LINE__ );
-         }
+         add_write( trans_irreversible_batch, std::move( update_op ) );
       }
    }
 }
@@ -1288,7 +1211,7 @@ void mongo_db_plugin_impl::update_account(const chain::action& act)
                std::chrono::microseconds{fc::time_point::now().time_since_epoch().count()} );
          auto setabi = act.data_as<chain::setabi>();
 
-         abi_cache_index.erase( setabi.account );
+         abi_cache->invalidate( setabi.account );
 
          auto account = find_account( _accounts, setabi.account );
          if( !account ) {
@@ -1331,11 +1254,18 @@ mongo_db_plugin_impl::~mongo_db_plugin_impl() {
    if (!startup) {
       try {
          ilog( "mongo_db_plugin shutdown in process please be patient this can take a few minutes" );
-         done = true;
+         {
+            boost::mutex::scoped_lock lock( mtx );
+            done = true;
+         }
          condition.notify_one();
+         space_available.notify_all();
 
          consume_thread.join();
 
+         // each writer finishes the batches queued to it
+         writers.clear();
+
          mongo_pool.reset();
       } catch( std::exception& e ) {
          elog( "Exception on mongo_db_plugin shutdown of consume thread: ${e}", ("e", e.what()));
@@ -1441,7 +1371,16 @@ void mongo_db_plugin_impl::init() {
       handle_mongo_exception( "mongo init", __LINE__ );
    }
 
-   ilog("starting db plugin thread");
+   ilog("starting db plugin threads");
+
+   appbase::async_dispatch_options writer_opts;
+   writer_opts.max_queue_size = 8;
+   writer_opts.policy = appbase::backpressure::block;
+   for( uint32_t i = 0; i < writer_threads; ++i ) {
+      auto client = std::make_shared<mongocxx::pool::entry>();
+      writers.emplace_back( std::make_unique<appbase::async_dispatcher<write_batch_ptr>>(
+            [this, client]( const write_batch_ptr& batch ) { execute_batch( *client, *batch ); }, writer_opts ) );
+   }
 
    consume_thread = boost::thread([this] { consume_blocks(); });
 
@@ -1466,6 +1405,11 @@ void mongo_db_plugin::set_program_options(options_description& cli, options_desc
    cfg.add_options()
          ("mongodb-queue-size,q", bpo::value<uint32_t>()->default_value(1024),
          "The target queue size between noddcc and MongoDB plugin thread.")
+         ("mongodb-queue-policy", bpo::value<appbase::backpressure>()->default_value(appbase::backpressure::block),
+         "What to do when a queue is full: 'block' block application until the MongoDB plugin thread catches up,"
+         " 'drop' discard the new entry so that block application is never held up.")
+         ("mongodb-writer-threads", bpo::value<uint32_t>()->default_value(4),
+         "The number of threads writing to MongoDB, collections are divided among them.")
          ("mongodb-abi-cache-size", bpo::value<uint32_t>()->default_value(2048),
           "The maximum size of the abi cache for serializing data.")
          ("mongodb-wipe", bpo::bool_switch()->default_value(false),
@@ -1520,11 +1464,22 @@ void mongo_db_plugin::plugin_initialize(const variables_map& options)
 
          if( options.count( "mongodb-queue-size" )) {
             my->max_queue_size = options.at( "mongodb-queue-size" ).as<uint32_t>();
+            dcc_ASSERT( my->max_queue_size > 0, chain::plugin_config_exception, "mongodb-queue-size > 0 required" );
+         }
+         if( options.count( "mongodb-queue-policy" )) {
+            my->queue_policy = options.at( "mongodb-queue-policy" ).as<appbase::backpressure>();
+            dcc_ASSERT( my->queue_policy != appbase::backpressure::coalesce, chain::plugin_config_exception,
+                        "mongodb-queue-policy coalesce not supported, entries can not be merged" );
+         }
+         if( options.count( "mongodb-writer-threads" )) {
+            my->writer_threads = options.at( "mongodb-writer-threads" ).as<uint32_t>();
+            dcc_ASSERT( my->writer_threads > 0, chain::plugin_config_exception, "mongodb-writer-threads > 0 required" );
          }
          if( options.count( "mongodb-abi-cache-size" )) {
             my->abi_cache_size = options.at( "mongodb-abi-cache-size" ).as<uint32_t>();
             dcc_ASSERT( my->abi_cache_size > 0, chain::plugin_config_exception, "mongodb-abi-cache-size > 0 required" );
          }
+         my->abi_cache.reset( new abi_serializer_cache( my->abi_cache_size ));
          if( options.count( "mongodb-block-start" )) {
             my->start_block_num = options.at( "mongodb-block-start" ).as<uint32_t>();
          }
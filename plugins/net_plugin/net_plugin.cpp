@@ -27,8 +27,14 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/intrusive/set.hpp>
 
+#include <thread>
+
 using namespace dccio::chain::plugin_interface::compat;
 
 namespace fc {
@@ -62,6 +68,22 @@ namespace dccio {
    using socket_ptr = std::shared_ptr<tcp::socket>;
 
    using net_message_ptr = shared_ptr<net_message>;
+   using send_buffer_ptr = std::shared_ptr<const vector<char>>; ///< a serialized message, shared by every peer it is sent to
+
+   /// Serializes a message with its size header, once for however many peers it is sent to
+   static send_buffer_ptr create_send_buffer( const net_message& m ) {
+      uint32_t payload_size = fc::raw::pack_size( m );
+      char * header = reinterpret_cast<char*>(&payload_size);
+      size_t header_size = sizeof(payload_size);
+
+      size_t buffer_size = header_size + payload_size;
+
+      auto send_buffer = std::make_shared<vector<char>>(buffer_size);
+      fc::datastream<char*> ds( send_buffer->data(), buffer_size);
+      ds.write( header, header_size );
+      fc::raw::pack( ds, m );
+      return send_buffer;
+   }
 
    struct node_transaction_state {
       transaction_id_type id;
@@ -69,7 +91,7 @@ namespace dccio {
                                 /// Expires increased while the txn is
                                 /// "in flight" to anoher peer
       packed_transaction packed_txn;
-      vector<char>    serialized_txn; /// the received raw bundle
+      send_buffer_ptr serialized_txn; /// the received raw bundle
       uint32_t        block_num = 0; /// block transaction was included in
       uint32_t        true_block = 0; /// used to reset block_uum when request is 0
       uint16_t        requests = 0; /// the number of "in flight" requests for this txn
@@ -120,6 +142,13 @@ namespace dccio {
 
    class net_plugin_impl {
    public:
+      /// sockets are read, written and incoming messages unpacked on these threads, one strand per connection;
+      /// declared first so that it outlives the connections
+      unique_ptr<boost::asio::io_context>  net_ioc;
+      unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> net_work;
+      vector<std::thread>              net_threads;
+      uint16_t                         net_thread_count = 0;
+
       unique_ptr<tcp::acceptor>        acceptor;
       tcp::endpoint                    listen_endpoint;
       string                           p2p_address;
@@ -179,12 +208,17 @@ namespace dccio {
       bool start_session( connection_ptr c );
       void start_listen_loop( );
       void start_read_message( connection_ptr c);
+      void read_message( const connection_ptr& c, const socket_ptr& socket );
+      void process_messages( const connection_ptr& c, const socket_ptr& socket,
+                             const vector<net_message>& messages, const string& read_error );
 
       void   close( connection_ptr c );
       size_t count_open_sockets() const;
 
       template<typename VerifierFunc>
       void send_all( const net_message &msg, VerifierFunc verify );
+      template<typename VerifierFunc>
+      void send_all( const send_buffer_ptr& send_buffer, VerifierFunc verify );
 
       void accepted_block_header(const block_state_ptr&);
       void accepted_block(const block_state_ptr&);
@@ -311,6 +345,8 @@ namespace dccio {
    constexpr auto     def_txn_expire_wait = std::chrono::seconds(3);
    constexpr auto     def_resp_expected_wait = std::chrono::seconds(5);
    constexpr auto     def_sync_fetch_span = 100;
+   constexpr uint32_t def_sync_read_ahead = 32; // irreversible blocks read from the block log at once when serving sync
+   constexpr uint16_t def_net_threads = 2;
    constexpr uint32_t  def_max_just_send = 1500; // roughly 1 "mtu"
    constexpr bool     large_msg_notify = false;
 
@@ -464,14 +500,16 @@ namespace dccio {
       peer_block_state_index  blk_state;
       transaction_state_index trx_state;
       optional<sync_state>    peer_requested;  // this peer is requesting info from us
+      deque<signed_block_ptr> sync_read_ahead; // next blocks for peer_requested, read together from the block log
       socket_ptr              socket;
+      boost::asio::strand<boost::asio::io_context::executor_type> strand; ///< serializes all operations on socket
 
+      /// only accessed on strand
       fc::message_buffer<1024*1024>    pending_message_buffer;
       fc::optional<std::size_t>        outstanding_read_bytes;
-      vector<char>            blk_buffer;
 
       struct queued_write {
-         std::shared_ptr<vector<char>> buff;
+         send_buffer_ptr buff;
          std::function<void(boost::system::error_code, std::size_t)> callback;
       };
       deque<queued_write>     write_queue;
@@ -559,6 +597,8 @@ namespace dccio {
       void stop_send();
 
       void enqueue( const net_message &msg, bool trigger_send = true );
+      void enqueue_buffer( const send_buffer_ptr& send_buffer, bool trigger_send = true,
+                           go_away_reason close_after_send = no_reason );
       void cancel_sync(go_away_reason);
       void flush_queues();
       bool enqueue_sync_block();
@@ -570,21 +610,19 @@ namespace dccio {
       void sync_timeout(boost::system::error_code ec);
       void fetch_timeout(boost::system::error_code ec);
 
-      void queue_write(std::shared_ptr<vector<char>> buff,
+      void queue_write(const send_buffer_ptr& buff,
                        bool trigger_send,
                        std::function<void(boost::system::error_code, std::size_t)> callback);
       void do_queue_write();
 
-      /** \brief Process the next message from the pending message buffer
+      /** \brief Unpack the next message from the pending message buffer
        *
-       * Process the next message from the pending_message_buffer.
-       * message_length is the already determined length of the data
-       * part of the message and impl in the net plugin implementation
-       * that will handle the message.
-       * Returns true is successful. Returns false if an error was
-       * encountered unpacking or processing the message.
+       * Runs on strand. The complete message is already in the
+       * pending_message_buffer; it is appended to messages, which are
+       * handled on the main thread by net_plugin_impl::process_messages.
+       * Throws if the message can not be unpacked.
        */
-      bool process_next_message(net_plugin_impl& impl, uint32_t message_length);
+      void unpack_next_message(vector<net_message>& messages);
 
       bool add_peer_block(const peer_block_state &pbs);
 
@@ -689,7 +727,8 @@ namespace dccio {
       : blk_state(),
         trx_state(),
         peer_requested(),
-        socket( std::make_shared<tcp::socket>( std::ref( app().get_io_service() ))),
+        socket( std::make_shared<tcp::socket>( std::ref( *my_impl->net_ioc ))),
+        strand( my_impl->net_ioc->get_executor() ),
         node_id(),
         last_handshake_recv(),
         last_handshake_sent(),
@@ -714,6 +753,7 @@ namespace dccio {
         trx_state(),
         peer_requested(),
         socket( s ),
+        strand( my_impl->net_ioc->get_executor() ),
         node_id(),
         last_handshake_recv(),
         last_handshake_sent(),
@@ -751,6 +791,7 @@ namespace dccio {
 
    void connection::reset() {
       peer_requested.reset();
+      sync_read_ahead.clear();
       blk_state.clear();
       trx_state.clear();
    }
@@ -761,7 +802,17 @@ namespace dccio {
 
    void connection::close() {
       if(socket) {
-         socket->close();
+         // The socket is closed on strand, where operations still pending on it complete and are
+         // ignored. A fresh socket takes its place, so that a reconnect never races with them.
+         auto old_socket = socket;
+         socket = std::make_shared<tcp::socket>( std::ref( *my_impl->net_ioc ) );
+         boost::asio::post( strand, [self = shared_from_this(), old_socket]() {
+            boost::system::error_code ec;
+            old_socket->shutdown( tcp::socket::shutdown_both, ec );
+            old_socket->close( ec );
+            self->pending_message_buffer.reset();
+            self->outstanding_read_bytes.reset();
+         });
       }
       else {
          wlog("no socket to close!");
@@ -779,12 +830,11 @@ namespace dccio {
       my_impl->sync_master->reset_lib_num(shared_from_this());
       fc_dlog(logger, "canceling wait on ${p}", ("p",peer_name()));
       cancel_wait();
-      pending_message_buffer.reset();
    }
 
    void connection::txn_send_pending(const vector<transaction_id_type> &ids) {
       for(auto tx = my_impl->local_txns.begin(); tx != my_impl->local_txns.end(); ++tx ){
-         if(tx->serialized_txn.size() && tx->block_num == 0) {
+         if(tx->serialized_txn && tx->block_num == 0) {
             bool found = false;
             for(auto known : ids) {
                if( known == tx->id) {
@@ -794,7 +844,7 @@ namespace dccio {
             }
             if(!found) {
                my_impl->local_txns.modify(tx,incr_in_flight);
-               queue_write(std::make_shared<vector<char>>(tx->serialized_txn),
+               queue_write(tx->serialized_txn,
                            true,
                            [tx_id=tx->id](boost::system::error_code ec, std::size_t ) {
                               auto& local_txns = my_impl->local_txns;
@@ -813,9 +863,9 @@ namespace dccio {
    void connection::txn_send(const vector<transaction_id_type> &ids) {
       for(auto t : ids) {
          auto tx = my_impl->local_txns.get<by_id>().find(t);
-         if( tx != my_impl->local_txns.end() && tx->serialized_txn.size()) {
+         if( tx != my_impl->local_txns.end() && tx->serialized_txn) {
             my_impl->local_txns.modify( tx,incr_in_flight);
-            queue_write(std::make_shared<vector<char>>(tx->serialized_txn),
+            queue_write(tx->serialized_txn,
                         true,
                         [t](boost::system::error_code ec, std::size_t ) {
                            auto& local_txns = my_impl->local_txns;
@@ -980,7 +1030,7 @@ namespace dccio {
       enqueue(xpkt);
    }
 
-   void connection::queue_write(std::shared_ptr<vector<char>> buff,
+   void connection::queue_write(const send_buffer_ptr& buff,
                                 bool trigger_send,
                                 std::function<void(boost::system::error_code, std::size_t)> callback) {
       write_queue.push_back({buff, callback});
@@ -1004,49 +1054,62 @@ namespace dccio {
          out_queue.push_back(m);
          write_queue.pop_front();
       }
-      boost::asio::async_write(*socket, bufs, [c](boost::system::error_code ec, std::size_t w) {
-            try {
-               auto conn = c.lock();
-               if(!conn)
-                  return;
+      // out_queue keeps the buffers alive until the completion has been handled on the main thread
+      boost::asio::post( strand, [c, socket = socket, bufs = std::move(bufs), strand = strand]() {
+         boost::asio::async_write( *socket, bufs, boost::asio::bind_executor( strand,
+               [c, socket]( boost::system::error_code ec, std::size_t w ) {
+            app().get_io_service().post( [c, socket, ec, w]() {
+               try {
+                  auto conn = c.lock();
+                  if(!conn)
+                     return;
 
-               for (auto& m: conn->out_queue) {
-                  m.callback(ec, w);
-               }
+                  for (auto& m: conn->out_queue) {
+                     m.callback(ec, w);
+                  }
 
-               if(ec) {
-                  string pname = conn ? conn->peer_name() : "no connection name";
-                  if( ec.value() != boost::asio::error::eof) {
-                     elog("Error sending to peer ${p}: ${i}", ("p",pname)("i", ec.message()));
+                  if( socket != conn->socket ) {
+                     // closed while the write was in flight, writes queued since then go to the new socket
+                     conn->out_queue.clear();
+                     conn->do_queue_write();
+                     return;
                   }
-                  else {
-                     ilog("connection closure detected on write to ${p}",("p",pname));
+
+                  if(ec) {
+                     string pname = conn ? conn->peer_name() : "no connection name";
+                     if( ec.value() != boost::asio::error::eof) {
+                        elog("Error sending to peer ${p}: ${i}", ("p",pname)("i", ec.message()));
+                     }
+                     else {
+                        ilog("connection closure detected on write to ${p}",("p",pname));
+                     }
+                     my_impl->close(conn);
+                     return;
                   }
-                  my_impl->close(conn);
-                  return;
+                  while (conn->out_queue.size() > 0) {
+                     conn->out_queue.pop_front();
+                  }
+                  conn->enqueue_sync_block();
+                  conn->do_queue_write();
                }
-               while (conn->out_queue.size() > 0) {
-                  conn->out_queue.pop_front();
+               catch(const std::exception &ex) {
+                  auto conn = c.lock();
+                  string pname = conn ? conn->peer_name() : "no connection name";
+                  elog("Exception in do_queue_write to ${p} ${s}", ("p",pname)("s",ex.what()));
                }
-               conn->enqueue_sync_block();
-               conn->do_queue_write();
-            }
-            catch(const std::exception &ex) {
-               auto conn = c.lock();
-               string pname = conn ? conn->peer_name() : "no connection name";
-               elog("Exception in do_queue_write to ${p} ${s}", ("p",pname)("s",ex.what()));
-            }
-            catch(const fc::exception &ex) {
-               auto conn = c.lock();
-               string pname = conn ? conn->peer_name() : "no connection name";
-               elog("Exception in do_queue_write to ${p} ${s}", ("p",pname)("s",ex.to_string()));
-            }
-            catch(...) {
-               auto conn = c.lock();
-               string pname = conn ? conn->peer_name() : "no connection name";
-               elog("Exception in do_queue_write to ${p}", ("p",pname) );
-            }
-         });
+               catch(const fc::exception &ex) {
+                  auto conn = c.lock();
+                  string pname = conn ? conn->peer_name() : "no connection name";
+                  elog("Exception in do_queue_write to ${p} ${s}", ("p",pname)("s",ex.to_string()));
+               }
+               catch(...) {
+                  auto conn = c.lock();
+                  string pname = conn ? conn->peer_name() : "no connection name";
+                  elog("Exception in do_queue_write to ${p}", ("p",pname) );
+               }
+            });
+         }));
+      });
    }
 
    void connection::cancel_sync(go_away_reason reason) {
@@ -1072,12 +1135,31 @@ namespace dccio {
       if (!peer_requested)
          return false;
       uint32_t num = ++peer_requested->last;
+      uint32_t end_block = peer_requested->end_block;
       bool trigger_send = num == peer_requested->start_block;
       if(num == peer_requested->end_block) {
          peer_requested.reset();
       }
       try {
-         signed_block_ptr sb = cc.fetch_block_by_number(num);
+         while( !sync_read_ahead.empty() && sync_read_ahead.front()->block_num() < num ) {
+            sync_read_ahead.pop_front();
+         }
+         if( sync_read_ahead.empty() || sync_read_ahead.front()->block_num() != num ) {
+            sync_read_ahead.clear();
+            // reversible blocks may still be forked out, so only irreversible ones are read ahead
+            uint32_t last = std::min( { end_block, num + def_sync_read_ahead - 1, cc.last_irreversible_block_num() } );
+            if( num <= last ) {
+               auto blocks = cc.fetch_irreversible_blocks_by_number( num, last );
+               sync_read_ahead.insert( sync_read_ahead.end(), blocks.begin(), blocks.end() );
+            }
+         }
+         signed_block_ptr sb;
+         if( !sync_read_ahead.empty() && sync_read_ahead.front()->block_num() == num ) {
+            sb = sync_read_ahead.front();
+            sync_read_ahead.pop_front();
+         } else {
+            sb = cc.fetch_block_by_number(num);
+         }
          if(sb) {
             enqueue( *sb, trigger_send);
             return true;
@@ -1094,16 +1176,10 @@ namespace dccio {
          close_after_send = m.get<go_away_message>().reason;
       }
 
-      uint32_t payload_size = fc::raw::pack_size( m );
-      char * header = reinterpret_cast<char*>(&payload_size);
-      size_t header_size = sizeof(payload_size);
-
-      size_t buffer_size = header_size + payload_size;
+      enqueue_buffer( create_send_buffer( m ), trigger_send, close_after_send );
+   }
 
-      auto send_buffer = std::make_shared<vector<char>>(buffer_size);
-      fc::datastream<char*> ds( send_buffer->data(), buffer_size);
-      ds.write( header, header_size );
-      fc::raw::pack( ds, m );
+   void connection::enqueue_buffer( const send_buffer_ptr& send_buffer, bool trigger_send, go_away_reason close_after_send ) {
       connection_wptr weak_this = shared_from_this();
       queue_write(send_buffer,trigger_send,
                   [weak_this, close_after_send](boost::system::error_code ec, std::size_t ) {
@@ -1196,35 +1272,10 @@ namespace dccio {
       sync_wait();
    }
 
-   bool connection::process_next_message(net_plugin_impl& impl, uint32_t message_length) {
-      try {
-         // If it is a signed_block, then save the raw message for the cache
-         // This must be done before we unpack the message.
-         // This code is copied from fc::io::unpack(..., unsigned_int)
-         auto index = pending_message_buffer.read_index();
-         uint64_t which = 0; char b = 0; uint8_t by = 0;
-         do {
-            pending_message_buffer.peek(&b, 1, index);
-            which |= uint32_t(uint8_t(b) & 0x7f) << by;
-            by += 7;
-         } while( uint8_t(b) & 0x80 && by < 32);
-
-         if (which == uint64_t(net_message::tag<signed_block>::value)) {
-            blk_buffer.resize(message_length);
-            auto index = pending_message_buffer.read_index();
-            pending_message_buffer.peek(blk_buffer.data(), message_length, index);
-         }
-         auto ds = pending_message_buffer.create_datastream();
-         net_message msg;
-         fc::raw::unpack(ds, msg);
-         msgHandler m(impl, shared_from_this() );
-         msg.visit(m);
-      } catch(  const fc::exception& e ) {
-         edump((e.to_detail_string() ));
-         impl.close( shared_from_this() );
-         return false;
-      }
-      return true;
+   void connection::unpack_next_message(vector<net_message>& messages) {
+      auto ds = pending_message_buffer.create_datastream();
+      messages.emplace_back();
+      fc::raw::unpack(ds, messages.back());
    }
 
    bool connection::add_peer_block(const peer_block_state &entry) {
@@ -1616,9 +1667,9 @@ namespace dccio {
       }
       received_blocks.erase(range.first, range.second);
 
-      net_message msg(bsum);
-      uint32_t packsiz = fc::raw::pack_size(msg);
-      uint32_t msgsiz = packsiz + sizeof(packsiz);
+      // serialized once for every peer it is sent to
+      auto send_buffer = create_send_buffer( net_message(bsum) );
+      uint32_t msgsiz = send_buffer->size();
       notice_message pending_notify;
       block_id_type bid = bsum.id();
       uint32_t bnum = bsum.block_num();
@@ -1648,7 +1699,7 @@ namespace dccio {
                continue;
             }
             cp->add_peer_block(pbstate);
-            cp->enqueue( bsum );
+            cp->enqueue_buffer( send_buffer );
          }
       }
    }
@@ -1695,27 +1746,20 @@ namespace dccio {
          fc_dlog(logger, "found trxid in local_trxs" );
          return;
       }
-      uint32_t packsiz = 0;
-      uint32_t bufsiz = 0;
-
       time_point_sec trx_expiration = trx.expiration();
 
-      net_message msg(trx);
-      packsiz = fc::raw::pack_size(msg);
-      bufsiz = packsiz + sizeof(packsiz);
-      vector<char> buff(bufsiz);
-      fc::datastream<char*> ds( buff.data(), bufsiz);
-      ds.write( reinterpret_cast<char*>(&packsiz), sizeof(packsiz) );
-      fc::raw::pack( ds, msg );
+      // serialized once, for every peer it is sent to now and those that request it later
+      auto send_buffer = create_send_buffer( net_message(trx) );
+      uint32_t bufsiz = send_buffer->size();
       node_transaction_state nts = {id,
                                     trx_expiration,
                                     trx,
-                                    std::move(buff),
+                                    send_buffer,
                                     0, 0, 0};
       my_impl->local_txns.insert(std::move(nts));
 
       if( !large_msg_notify || bufsiz <= just_send_it_max) {
-         my_impl->send_all( trx, [id, &skips, trx_expiration](connection_ptr c) -> bool {
+         my_impl->send_all( send_buffer, [id, &skips, trx_expiration](connection_ptr c) -> bool {
                if( skips.find(c) != skips.end() || c->syncing ) {
                   return false;
                }
@@ -1946,9 +1990,11 @@ namespace dccio {
       ++endpoint_itr;
       c->connecting = true;
       connection_wptr weak_conn = c;
-      c->socket->async_connect( current_endpoint, [weak_conn, endpoint_itr, this] ( const boost::system::error_code& err ) {
+      auto socket = c->socket;
+      socket->async_connect( current_endpoint, [weak_conn, endpoint_itr, socket, this] ( const boost::system::error_code& err ) {
+         app().get_io_service().post( [weak_conn, endpoint_itr, socket, err, this]() {
             auto c = weak_conn.lock();
-            if (!c) return;
+            if (!c || socket != c->socket) return;
             if( !err && c->socket->is_open() ) {
                if (start_session( c )) {
                   c->send_handshake ();
@@ -1965,7 +2011,8 @@ namespace dccio {
                   my_impl->close(c);
                }
             }
-         } );
+         });
+      });
    }
 
    bool net_plugin_impl::start_session( connection_ptr con ) {
@@ -1991,7 +2038,7 @@ namespace dccio {
 
 
    void net_plugin_impl::start_listen_loop( ) {
-      auto socket = std::make_shared<tcp::socket>( std::ref( app().get_io_service() ) );
+      auto socket = std::make_shared<tcp::socket>( std::ref( *net_ioc ) );
       acceptor->async_accept( *socket, [socket,this]( boost::system::error_code ec ) {
             if( !ec ) {
                uint32_t visitors = 0;
@@ -2055,114 +2102,149 @@ namespace dccio {
    }
 
    void net_plugin_impl::start_read_message( connection_ptr conn ) {
+      if(!conn->socket) {
+         return;
+      }
+      boost::asio::post( conn->strand, [this, conn, socket = conn->socket]() {
+         read_message( conn, socket );
+      });
+   }
 
-      try {
-         if(!conn->socket) {
-            return;
-         }
-         connection_wptr weak_conn = conn;
+   void net_plugin_impl::read_message( const connection_ptr& conn, const socket_ptr& socket ) {
+      // runs on conn->strand, a socket closed by connection::close is no longer read
+      if( !socket->is_open() ) {
+         return;
+      }
+      connection_wptr weak_conn = conn;
 
-         std::size_t minimum_read = conn->outstanding_read_bytes ? *conn->outstanding_read_bytes : message_header_size;
+      std::size_t minimum_read = conn->outstanding_read_bytes ? *conn->outstanding_read_bytes : message_header_size;
 
-         if (use_socket_read_watermark) {
-            const size_t max_socket_read_watermark = 4096;
-            std::size_t socket_read_watermark = std::min<std::size_t>(minimum_read, max_socket_read_watermark);
-            boost::asio::socket_base::receive_low_watermark read_watermark_opt(socket_read_watermark);
-            conn->socket->set_option(read_watermark_opt);
+      if (use_socket_read_watermark) {
+         const size_t max_socket_read_watermark = 4096;
+         std::size_t socket_read_watermark = std::min<std::size_t>(minimum_read, max_socket_read_watermark);
+         boost::asio::socket_base::receive_low_watermark read_watermark_opt(socket_read_watermark);
+         boost::system::error_code ec;
+         socket->set_option(read_watermark_opt, ec);
+      }
+
+      auto completion_handler = [minimum_read](boost::system::error_code ec, std::size_t bytes_transferred) -> std::size_t {
+         if (ec || bytes_transferred >= minimum_read ) {
+            return 0;
+         } else {
+            return minimum_read - bytes_transferred;
          }
+      };
 
-         auto completion_handler = [minimum_read](boost::system::error_code ec, std::size_t bytes_transferred) -> std::size_t {
-            if (ec || bytes_transferred >= minimum_read ) {
-               return 0;
-            } else {
-               return minimum_read - bytes_transferred;
+      boost::asio::async_read(*socket,
+         conn->pending_message_buffer.get_buffer_sequence_for_boost_async_read(), completion_handler,
+         boost::asio::bind_executor( conn->strand, [this,weak_conn,socket]( boost::system::error_code ec, std::size_t bytes_transferred ) {
+            auto conn = weak_conn.lock();
+            if( !conn || !socket->is_open() ) {
+               return;
             }
-         };
 
-         boost::asio::async_read(*conn->socket,
-            conn->pending_message_buffer.get_buffer_sequence_for_boost_async_read(), completion_handler,
-            [this,weak_conn]( boost::system::error_code ec, std::size_t bytes_transferred ) {
-               auto conn = weak_conn.lock();
-               if (!conn) {
-                  return;
-               }
+            conn->outstanding_read_bytes.reset();
 
-               conn->outstanding_read_bytes.reset();
+            // messages are framed and unpacked here, only complete messages are handed to the main thread
+            auto messages = std::make_shared<vector<net_message>>();
+            string read_error;
+            try {
+               if( !ec ) {
+                  if (bytes_transferred > conn->pending_message_buffer.bytes_to_write()) {
+                     elog("async_read_some callback: bytes_transfered = ${bt}, buffer.bytes_to_write = ${btw}",
+                          ("bt",bytes_transferred)("btw",conn->pending_message_buffer.bytes_to_write()));
+                  }
+                  dcc_ASSERT(bytes_transferred <= conn->pending_message_buffer.bytes_to_write(), plugin_exception, "");
+                  conn->pending_message_buffer.advance_write_ptr(bytes_transferred);
+                  while (conn->pending_message_buffer.bytes_to_read() > 0) {
+                     uint32_t bytes_in_buffer = conn->pending_message_buffer.bytes_to_read();
+
+                     if (bytes_in_buffer < message_header_size) {
+                        conn->outstanding_read_bytes.emplace(message_header_size - bytes_in_buffer);
+                        break;
+                     } else {
+                        uint32_t message_length;
+                        auto index = conn->pending_message_buffer.read_index();
+                        conn->pending_message_buffer.peek(&message_length, sizeof(message_length), index);
+                        if(message_length > def_send_buffer_size*2 || message_length == 0) {
+                           read_error = "incoming message length unexpected (" + std::to_string(message_length) + ")";
+                           break;
+                        }
 
-               try {
-                  if( !ec ) {
-                     if (bytes_transferred > conn->pending_message_buffer.bytes_to_write()) {
-                        elog("async_read_some callback: bytes_transfered = ${bt}, buffer.bytes_to_write = ${btw}",
-                             ("bt",bytes_transferred)("btw",conn->pending_message_buffer.bytes_to_write()));
-                     }
-                     dcc_ASSERT(bytes_transferred <= conn->pending_message_buffer.bytes_to_write(), plugin_exception, "");
-                     conn->pending_message_buffer.advance_write_ptr(bytes_transferred);
-                     while (conn->pending_message_buffer.bytes_to_read() > 0) {
-                        uint32_t bytes_in_buffer = conn->pending_message_buffer.bytes_to_read();
+                        auto total_message_bytes = message_length + message_header_size;
 
-                        if (bytes_in_buffer < message_header_size) {
-                           conn->outstanding_read_bytes.emplace(message_header_size - bytes_in_buffer);
-                           break;
+                        if (bytes_in_buffer >= total_message_bytes) {
+                           conn->pending_message_buffer.advance_read_ptr(message_header_size);
+                           conn->unpack_next_message(*messages);
                         } else {
-                           uint32_t message_length;
-                           auto index = conn->pending_message_buffer.read_index();
-                           conn->pending_message_buffer.peek(&message_length, sizeof(message_length), index);
-                           if(message_length > def_send_buffer_size*2 || message_length == 0) {
-                              boost::system::error_code ec;
-                              elog("incoming message length unexpected (${i}), from ${p}", ("i", message_length)("p",boost::lexical_cast<std::string>(conn->socket->remote_endpoint(ec))));
-                              close(conn);
-                              return;
+                           auto outstanding_message_bytes = total_message_bytes - bytes_in_buffer;
+                           auto available_buffer_bytes = conn->pending_message_buffer.bytes_to_write();
+                           if (outstanding_message_bytes > available_buffer_bytes) {
+                              conn->pending_message_buffer.add_space( outstanding_message_bytes - available_buffer_bytes );
                            }
 
-                           auto total_message_bytes = message_length + message_header_size;
-
-                           if (bytes_in_buffer >= total_message_bytes) {
-                              conn->pending_message_buffer.advance_read_ptr(message_header_size);
-                              if (!conn->process_next_message(*this, message_length)) {
-                                 return;
-                              }
-                           } else {
-                              auto outstanding_message_bytes = total_message_bytes - bytes_in_buffer;
-                              auto available_buffer_bytes = conn->pending_message_buffer.bytes_to_write();
-                              if (outstanding_message_bytes > available_buffer_bytes) {
-                                 conn->pending_message_buffer.add_space( outstanding_message_bytes - available_buffer_bytes );
-                              }
-
-                              conn->outstanding_read_bytes.emplace(outstanding_message_bytes);
-                              break;
-                           }
+                           conn->outstanding_read_bytes.emplace(outstanding_message_bytes);
+                           break;
                         }
                      }
-                     start_read_message(conn);
-                  } else {
-                     auto pname = conn->peer_name();
-                     if (ec.value() != boost::asio::error::eof) {
-                        elog( "Error reading message from ${p}: ${m}",("p",pname)( "m", ec.message() ) );
-                     } else {
-                        ilog( "Peer ${p} closed connection",("p",pname) );
-                     }
-                     close( conn );
                   }
+               } else if (ec.value() != boost::asio::error::eof) {
+                  read_error = "error reading message: " + ec.message();
+               } else {
+                  read_error = "closed connection";
                }
-               catch(const std::exception &ex) {
-                  string pname = conn ? conn->peer_name() : "no connection name";
-                  elog("Exception in handling read data from ${p} ${s}",("p",pname)("s",ex.what()));
-                  close( conn );
-               }
-               catch(const fc::exception &ex) {
-                  string pname = conn ? conn->peer_name() : "no connection name";
-                  elog("Exception in handling read data ${s}", ("p",pname)("s",ex.to_string()));
-                  close( conn );
-               }
-               catch (...) {
-                  string pname = conn ? conn->peer_name() : "no connection name";
-                  elog( "Undefined exception hanlding the read data from connection ${p}",( "p",pname));
-                  close( conn );
-               }
-            } );
-      } catch (...) {
-         string pname = conn ? conn->peer_name() : "no connection name";
-         elog( "Undefined exception handling reading ${p}",("p",pname) );
+            }
+            catch(const fc::exception &ex) {
+               read_error = "error unpacking message: " + ex.to_detail_string();
+            }
+            catch(const std::exception &ex) {
+               read_error = string("error handling read data: ") + ex.what();
+            }
+            catch (...) {
+               read_error = "undefined exception handling read data";
+            }
+
+            // blocks go ahead of queued transactions and API requests, everything else waits its turn with transactions
+            bool has_block = std::any_of( messages->begin(), messages->end(),
+                                          []( const net_message& msg ) { return msg.contains<signed_block>(); } );
+            app().post( has_block ? priority::high : priority::medium, [this, conn, socket, messages, read_error]() {
+               process_messages( conn, socket, *messages, read_error );
+            });
+         }));
+   }
+
+   void net_plugin_impl::process_messages( const connection_ptr& conn, const socket_ptr& socket,
+                                           const vector<net_message>& messages, const string& read_error ) {
+      try {
+         for( const auto& msg : messages ) {
+            // closed, and possibly reconnected, while the messages were in flight or by one of them
+            if( socket != conn->socket ) {
+               return;
+            }
+            msgHandler m( *this, conn );
+            msg.visit( m );
+         }
+         if( socket != conn->socket ) {
+            return;
+         }
+         if( !read_error.empty() ) {
+            elog( "Peer ${p}: ${e}", ("p", conn->peer_name())("e", read_error) );
+            close( conn );
+            return;
+         }
+         // the next read is only started once these messages have been handled
+         start_read_message( conn );
+      }
+      catch(const fc::exception &ex) {
+         elog("Exception in handling messages from ${p} ${s}", ("p",conn->peer_name())("s",ex.to_detail_string()));
+         close( conn );
+      }
+      catch(const std::exception &ex) {
+         elog("Exception in handling messages from ${p} ${s}", ("p",conn->peer_name())("s",ex.what()));
+         close( conn );
+      }
+      catch (...) {
+         elog( "Undefined exception handling messages from ${p}", ("p",conn->peer_name()) );
          close( conn );
       }
    }
@@ -2180,9 +2262,21 @@ namespace dccio {
 
    template<typename VerifierFunc>
    void net_plugin_impl::send_all( const net_message &msg, VerifierFunc verify) {
+      send_buffer_ptr send_buffer;
+      for( auto &c : connections) {
+         if( c->current() && verify( c)) {
+            if( !send_buffer )
+               send_buffer = create_send_buffer( msg );
+            c->enqueue_buffer( send_buffer );
+         }
+      }
+   }
+
+   template<typename VerifierFunc>
+   void net_plugin_impl::send_all( const send_buffer_ptr& send_buffer, VerifierFunc verify) {
       for( auto &c : connections) {
          if( c->current() && verify( c)) {
-            c->enqueue( msg );
+            c->enqueue_buffer( send_buffer );
          }
       }
    }
@@ -2879,6 +2973,7 @@ namespace dccio {
          ( "sync-fetch-span", bpo::value<uint32_t>()->default_value(def_sync_fetch_span), "number of blocks to retrieve in a chunk from any individual peer during synchronization")
          ( "max-implicit-request", bpo::value<uint32_t>()->default_value(def_max_just_send), "maximum sizes of transaction or block messages that are sent without first sending a notice")
          ( "use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable expirimental socket read watermark optimization")
+         ( "net-threads", bpo::value<uint16_t>()->default_value(def_net_threads), "Number of worker threads reading, writing and unpacking network messages")
          ( "peer-log-format", bpo::value<string>()->default_value( "[\"${_name}\" ${_ip}:${_port}]" ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
            "Available Variables:\n"
@@ -2919,6 +3014,10 @@ namespace dccio {
 
          my->use_socket_read_watermark = options.at( "use-socket-read-watermark" ).as<bool>();
 
+         my->net_thread_count = options.at( "net-threads" ).as<uint16_t>();
+         dcc_ASSERT( my->net_thread_count > 0, plugin_config_exception,
+                     "net-threads ${num} must be greater than 0", ("num", my->net_thread_count) );
+
          my->resolver = std::make_shared<tcp::resolver>( std::ref( app().get_io_service()));
          if( options.count( "p2p-listen-endpoint" )) {
             my->p2p_address = options.at( "p2p-listen-endpoint" ).as<string>();
@@ -3003,6 +3102,13 @@ namespace dccio {
    }
 
    void net_plugin::plugin_startup() {
+      my->net_ioc.reset( new boost::asio::io_context{ my->net_thread_count } );
+      my->net_work.reset( new boost::asio::executor_work_guard<boost::asio::io_context::executor_type>( my->net_ioc->get_executor() ) );
+      my->net_threads.reserve( my->net_thread_count );
+      for( uint16_t i = 0; i < my->net_thread_count; ++i ) {
+         my->net_threads.emplace_back( [ioc = my->net_ioc.get()]() { ioc->run(); } );
+      }
+
       if( my->acceptor ) {
          my->acceptor->open(my->listen_endpoint.protocol());
          my->acceptor->set_option(tcp::acceptor::reuse_address(true));
@@ -3060,6 +3166,15 @@ namespace dccio {
 
             my->acceptor.reset(nullptr);
          }
+         if( my->net_ioc ) {
+            ilog( "stop net threads" );
+            my->net_work.reset();
+            my->net_ioc->stop();
+            for( auto& t : my->net_threads ) {
+               t.join();
+            }
+            my->net_threads.clear();
+         }
          ilog( "exit shutdown" );
       }
       FC_CAPTURE_AND_RETHROW()
@@ -2016,6 +2016,10 @@ int main( int argc, char** argv ) {
    string key_type;
    string encode_type{"dec"};
    bool binary = false;
+   bool reverse = false;
+   bool keys_only = false;
+   bool count_only = false;
+   string next_key;
    uint32_t limit = 10;
    string index_position;
    auto getTable = get->add_subcommand( "table", localized("Retrieve the contents of a database table"), false);
@@ -2036,7 +2040,10 @@ int main( int argc, char** argv ) {
    getTable->add_option( "--encode-type", encode_type,
                          localized("The encoding type of key_type (i64 , i128 , float64, float128) only support decimal encoding e.g. 'dec'"
                                     "i256 - supports both 'dec' and 'hex', ripemd160 and sha256 is 'hex' only\n"));
-
+   getTable->add_flag( "-r,--reverse", reverse, localized("Iterate in reverse order, from upper bound down to lower bound") );
+   getTable->add_option( "--next-key", next_key, localized("The next_key of a previous result, continues from the row where it stopped") );
+   getTable->add_flag( "--keys-only", keys_only, localized("Return the keys of --index instead of the rows") );
+   getTable->add_flag( "--count-only", count_only, localized("Return only the number of rows in range") );
 
    getTable->set_callback([&] {
       auto result = call(get_table_func, fc::mutable_variant_object("json", !binary)
@@ -2050,6 +2057,10 @@ int main( int argc, char** argv ) {
                          ("key_type",key_type)
                          ("index_position", index_position)
                          ("encode_type", encode_type)
+                         ("reverse", reverse)
+                         ("next_key", next_key)
+                         ("keys_only", keys_only)
+                         ("count_only", count_only)
                          );
 
       std::cout << fc::json::to_pretty_string(result)
@@ -28,7 +28,11 @@
 #include <fc/variant_object.hpp>
 #include <fc/io/json.hpp>
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
 #include <array>
+#include <atomic>
 #include <utility>
 
 #ifdef NON_VALIDATING_TEST
@@ -128,5 +132,72 @@ BOOST_FIXTURE_TEST_CASE( get_block_with_invalid_abi, TESTER ) try {
 
 } FC_LOG_AND_RETHROW() /// get_block_with_invalid_abi
 
+BOOST_FIXTURE_TEST_CASE( read_only_calls_while_applying_blocks, TESTER ) try {
+   produce_blocks(2);
+   create_accounts( {N(asserter), N(alice)} );
+   set_code(N(asserter), asserter_wast);
+   set_abi(N(asserter), asserter_abi);
+   produce_blocks(1);
+
+   chain_apis::read_only plugin(*(this->control), fc::microseconds(INT_MAX));
+   std::atomic<bool> done{false};
+   std::atomic<uint32_t> calls{0};
+   std::atomic<uint32_t> failures{0};
+
+   // as chain_plugin::post_read_only does with read-only-threads set
+   boost::asio::thread_pool pool(4);
+   const controller& c = *control;
+   for( int t = 0; t < 4; ++t ) {
+      boost::asio::post( pool, [&]() {
+         while( !done ) {
+            c.with_read_view( [&]() {
+               try {
+                  auto info = plugin.get_info( {} );
+                  if( info.last_irreversible_block_num > info.head_block_num ||
+                      c.fetch_block_by_number( info.head_block_num )->id() != info.head_block_id )
+                     ++failures;
+
+                  chain_apis::read_only::get_block_params param{ std::to_string( info.head_block_num ) };
+                  auto block = plugin.get_block( param );
+                  if( block["id"].as<block_id_type>() != info.head_block_id )
+                     ++failures;
+
+                  // the lists are replaced by the main thread between blocks
+                  for( const auto& a : c.get_actor_blacklist() )
+                     if( a != N(alice) )
+                        ++failures;
+                  c.is_resource_greylisted( N(alice) );
+               } catch( ... ) {
+                  ++failures;
+               }
+               ++calls;
+            });
+         }
+      });
+   }
+
+   for( int i = 0; i < 20; ++i ) {
+      push_action( N(asserter), N(procassert), N(asserter), mutable_variant_object()
+         ("condition", 1)
+         ("message", "Should Not Assert!")
+      );
+      if( i % 2 ) {
+         control->set_actor_blacklist( {} );
+         control->remove_resource_greylist( N(alice) );
+      } else {
+         control->set_actor_blacklist( {N(alice)} );
+         control->add_resource_greylist( N(alice) );
+      }
+      produce_block();
+   }
+   control->set_actor_blacklist( {} );
+
+   done = true;
+   pool.join();
+
+   BOOST_TEST( calls > 0u );
+   BOOST_TEST( failures == 0u );
+} FC_LOG_AND_RETHROW() /// read_only_calls_while_applying_blocks
+
 BOOST_AUTO_TEST_SUITE_END()
 
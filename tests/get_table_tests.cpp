@@ -21,6 +21,9 @@
 #include <dccio.token/dccio.token.wast.hpp>
 #include <dccio.token/dccio.token.abi.hpp>
 
+#include <snapshot_test/snapshot_test.wast.hpp>
+#include <snapshot_test/snapshot_test.abi.hpp>
+
 #include <fc/io/fstream.hpp>
 
 #include <Runtime/Runtime.h>
@@ -120,5 +123,281 @@ BOOST_FIXTURE_TEST_CASE( get_scope_test, TESTER ) try {
 
 } FC_LOG_AND_RETHROW() /// get_scope_test
 
+// one row per currency in the accounts table of inita
+static void issue_balances( TESTER& t ) {
+   t.produce_blocks(2);
+
+   t.create_accounts({ N(dccio.token), N(inita) });
+   t.produce_block();
+
+   t.set_code( N(dccio.token), dccio_token_wast );
+   t.set_abi( N(dccio.token), dccio_token_abi );
+   t.produce_blocks(1);
+
+   for (const char* sym : { "AAA", "BBB", "CCC", "DDD" }) {
+      t.push_action(N(dccio.token), N(create), N(dccio.token), mutable_variant_object()
+                    ("issuer", "dccio")
+                    ("maximum_supply", dccio::chain::asset::from_string(string("1000.0000 ") + sym)));
+      t.push_action(N(dccio.token), N(issue), "dccio", mutable_variant_object()
+                    ("to", "inita")
+                    ("quantity", dccio::chain::asset::from_string(string("1.0000 ") + sym))
+                    ("memo", ""));
+   }
+   t.produce_blocks(1);
+}
+
+BOOST_FIXTURE_TEST_CASE( get_table_next_key_test, TESTER ) try {
+   issue_balances(*this);
+
+   dccio::chain_apis::read_only plugin(*(this->control), fc::microseconds(INT_MAX));
+   dccio::chain_apis::read_only::get_table_rows_params p;
+   p.code = N(dccio.token);
+   p.scope = "inita";
+   p.table = N(accounts);
+   p.json = true;
+   p.limit = 3;
+
+   auto balance = [](const fc::variant& row) { return row["balance"].as_string(); };
+
+   auto result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(3, result.rows.size());
+   BOOST_REQUIRE_EQUAL(true, result.more);
+   BOOST_REQUIRE_EQUAL("1.0000 AAA", balance(result.rows[0]));
+   BOOST_REQUIRE_EQUAL("1.0000 CCC", balance(result.rows[2]));
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(result), plugin.get_table_rows_json(p));
+
+   p.next_key = result.next_key;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(1, result.rows.size());
+   BOOST_REQUIRE_EQUAL(false, result.more);
+   BOOST_REQUIRE_EQUAL("", result.next_key);
+   BOOST_REQUIRE_EQUAL("1.0000 DDD", balance(result.rows[0]));
+
+   p.next_key.clear();
+   p.reverse = true;
+   p.limit = 2;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL(true, result.more);
+   BOOST_REQUIRE_EQUAL("1.0000 DDD", balance(result.rows[0]));
+   BOOST_REQUIRE_EQUAL("1.0000 CCC", balance(result.rows[1]));
+
+   p.next_key = result.next_key;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL(false, result.more);
+   BOOST_REQUIRE_EQUAL("1.0000 BBB", balance(result.rows[0]));
+   BOOST_REQUIRE_EQUAL("1.0000 AAA", balance(result.rows[1]));
+
+   // raw rows
+   p.json = false;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(result), plugin.get_table_rows_json(p));
+
+   p.next_key = "00";
+   BOOST_REQUIRE_THROW(plugin.get_table_rows(p), contract_table_query_exception);
+
+   // a next_key outside of lower_bound and upper_bound selects no rows instead of leaving the range
+   auto key_of = [](const char* sym) {
+      uint64_t v = symbol(4, sym).to_symbol_code().value;
+      return fc::to_hex(reinterpret_cast<const char*>(&v), sizeof(v));
+   };
+   p.json = true;
+   p.limit = 10;
+   p.reverse = false;
+   p.upper_bound = std::to_string(symbol(4, "CCC").to_symbol_code().value);
+   p.next_key = key_of("DDD");
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, result.rows.size());
+   BOOST_REQUIRE_EQUAL(false, result.more);
+
+   p.next_key = key_of("AAA");
+   p.lower_bound = std::to_string(symbol(4, "BBB").to_symbol_code().value);
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(1, result.rows.size());
+   BOOST_REQUIRE_EQUAL("1.0000 BBB", balance(result.rows[0]));
+
+   p.reverse = true;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, result.rows.size());
+   BOOST_REQUIRE_EQUAL(false, result.more);
+
+   p.upper_bound = std::to_string(symbol(4, "AAA").to_symbol_code().value);
+   p.next_key.clear();
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, result.rows.size());
+   BOOST_REQUIRE_EQUAL(false, result.more);
+
+} FC_LOG_AND_RETHROW() /// get_table_next_key_test
+
+BOOST_FIXTURE_TEST_CASE( get_table_keys_count_test, TESTER ) try {
+   issue_balances(*this);
+
+   dccio::chain_apis::read_only plugin(*(this->control), fc::microseconds(INT_MAX));
+   dccio::chain_apis::read_only::get_table_rows_params p;
+   p.code = N(dccio.token);
+   p.scope = "inita";
+   p.table = N(accounts);
+   p.json = true;
+   p.count_only = true;
+
+   // whole table, taken from the table's row count
+   auto result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, result.rows.size());
+   BOOST_REQUIRE(result.count.valid());
+   BOOST_REQUIRE_EQUAL(4, *result.count);
+   BOOST_REQUIRE_EQUAL(false, result.more);
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(result), plugin.get_table_rows_json(p));
+
+   // range, counted by walking the index
+   p.lower_bound = std::to_string(symbol(4, "BBB").to_symbol_code().value);
+   p.limit = 1;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(3, *result.count);
+
+   p.count_only.reset();
+   p.keys_only = true;
+   p.limit = 2;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(false, result.count.valid());
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL(true, result.more);
+   BOOST_REQUIRE_EQUAL(symbol(4, "BBB").to_symbol_code().value, result.rows[0].as_uint64());
+   BOOST_REQUIRE_EQUAL(symbol(4, "CCC").to_symbol_code().value, result.rows[1].as_uint64());
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(result), plugin.get_table_rows_json(p));
+
+   // contract without an ABI can still be counted
+   p.code = N(inita);
+   p.key_type = "i64";
+   p.keys_only.reset();
+   p.count_only = true;
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, *result.count);
+
+} FC_LOG_AND_RETHROW() /// get_table_keys_count_test
+
+BOOST_FIXTURE_TEST_CASE( get_table_secondary_keys_count_test, TESTER ) try {
+   produce_blocks(2);
+   create_accounts({ N(snapshot) });
+   produce_block();
+
+   // one row with primary key 5, indexed by every secondary key type with the value 8
+   set_code( N(snapshot), snapshot_test_wast );
+   set_abi( N(snapshot), snapshot_test_abi );
+   produce_blocks(1);
+   push_action( N(snapshot), N(increment), N(snapshot), mutable_variant_object()("value", 5) );
+   push_action( N(snapshot), N(increment), N(snapshot), mutable_variant_object()("value", 3) );
+   produce_blocks(1);
+
+   dccio::chain_apis::read_only plugin(*(this->control), fc::microseconds(INT_MAX));
+   dccio::chain_apis::read_only::get_table_rows_params p;
+   p.code = N(snapshot);
+   p.scope = "snapshot";
+   p.table = N(data);
+   p.count_only = true;
+
+   // whole index, taken from the row count of the index table
+   p.index_position = "4";
+   p.key_type = "i64";
+   auto result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, result.rows.size());
+   BOOST_REQUIRE(result.count.valid());
+   BOOST_REQUIRE_EQUAL(1, *result.count);
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(result), plugin.get_table_rows_json(p));
+
+   // range, counted by walking the index
+   p.lower_bound = "9";
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(0, *result.count);
+   p.lower_bound = "8";
+   result = plugin.get_table_rows(p);
+   BOOST_REQUIRE_EQUAL(1, *result.count);
+
+   // the key of the only row as keys_only returns it, which lower_bound accepts back
+   p.count_only.reset();
+   p.keys_only = true;
+   auto key_of_row = [&]( const char* index_position, const char* key_type ) {
+      p.index_position = index_position;
+      p.key_type = key_type;
+      p.lower_bound.clear();
+      auto result = plugin.get_table_rows(p);
+      BOOST_REQUIRE_EQUAL(false, result.count.valid());
+      BOOST_REQUIRE_EQUAL(1, result.rows.size());
+      BOOST_REQUIRE_EQUAL(false, result.more);
+      BOOST_REQUIRE_EQUAL(5, result.rows[0]["primary_key"].as_uint64());
+      BOOST_REQUIRE_EQUAL(fc::json::to_string(result), plugin.get_table_rows_json(p));
+      return result.rows[0]["key"];
+   };
+   auto rows_from = [&]( const string& lower_bound ) {
+      p.lower_bound = lower_bound;
+      return plugin.get_table_rows(p).rows.size();
+   };
+
+   BOOST_REQUIRE_EQUAL(8, key_of_row("4", "i64").as_uint64());
+
+   const string i128_key = "0x08" + string(30, '0');
+   BOOST_REQUIRE_EQUAL(i128_key, key_of_row("5", "i128").as_string());
+   BOOST_REQUIRE_EQUAL(1, rows_from(i128_key));
+   BOOST_REQUIRE_EQUAL(0, rows_from("0x09" + string(30, '0')));
+
+   const string i256_key = "08" + string(62, '0');
+   BOOST_REQUIRE_EQUAL(i256_key, key_of_row("6", "sha256").as_string());
+   BOOST_REQUIRE_EQUAL(1, rows_from(i256_key));
+   BOOST_REQUIRE_EQUAL(0, rows_from("09" + string(62, '0')));
+   p.encode_type = "hex";
+   BOOST_REQUIRE_EQUAL(i256_key, key_of_row("6", "i256").as_string());
+   BOOST_REQUIRE_EQUAL(1, rows_from(i256_key));
+   p.encode_type = "dec";
+
+   BOOST_REQUIRE_EQUAL(8.0, key_of_row("2", "float64").as_double());
+   BOOST_REQUIRE_EQUAL(1, rows_from("8"));
+   BOOST_REQUIRE_EQUAL(0, rows_from("8.5"));
+   BOOST_REQUIRE_EQUAL(8.0, key_of_row("3", "float128").as_double());
+   BOOST_REQUIRE_EQUAL(1, rows_from("8"));
+
+} FC_LOG_AND_RETHROW() /// get_table_secondary_keys_count_test
+
+BOOST_FIXTURE_TEST_CASE( get_table_by_scope_filter_test, TESTER ) try {
+   // the stat table of each currency has a scope of its own, ordered before the accounts table of inita
+   issue_balances(*this);
+
+   dccio::chain_apis::read_only plugin(*(this->control), fc::microseconds(INT_MAX));
+   dccio::chain_apis::read_only::get_table_by_scope_params param{N(dccio.token), N(stat), "", "", 2};
+   auto scope_of = [](const char* sym) { return name(symbol(4, sym).to_symbol_code().value); };
+
+   auto result = plugin.read_only::get_table_by_scope(param);
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL(scope_of("AAA"), result.rows[0].scope);
+   BOOST_REQUIRE_EQUAL(scope_of("BBB"), result.rows[1].scope);
+   BOOST_REQUIRE_EQUAL(scope_of("CCC").to_string(), result.more);
+
+   param.lower_bound = result.more;
+   param.limit = 10;
+   result = plugin.read_only::get_table_by_scope(param);
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL(scope_of("CCC"), result.rows[0].scope);
+   BOOST_REQUIRE_EQUAL(scope_of("DDD"), result.rows[1].scope);
+   BOOST_REQUIRE_EQUAL(name(N(stat)), result.rows[1].table);
+   BOOST_REQUIRE_EQUAL("", result.more);
+
+   // skips the scopes which only hold a stat table
+   param.table = N(accounts);
+   param.lower_bound.clear();
+   result = plugin.read_only::get_table_by_scope(param);
+   BOOST_REQUIRE_EQUAL(1, result.rows.size());
+   BOOST_REQUIRE_EQUAL(name(N(inita)), result.rows[0].scope);
+   BOOST_REQUIRE_EQUAL(4, result.rows[0].count);
+   BOOST_REQUIRE_EQUAL("", result.more);
+
+   // an upper_bound ends the walk between the scopes
+   param.table = N(stat);
+   param.upper_bound = scope_of("CCC").to_string();
+   result = plugin.read_only::get_table_by_scope(param);
+   BOOST_REQUIRE_EQUAL(2, result.rows.size());
+   BOOST_REQUIRE_EQUAL("", result.more);
+
+} FC_LOG_AND_RETHROW() /// get_table_by_scope_filter_test
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,84 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+#include <dccio/http_plugin/http_compression.hpp>
+
+#include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+namespace dccio {
+
+BOOST_AUTO_TEST_SUITE(http_plugin_tests)
+
+BOOST_AUTO_TEST_CASE(gzip_round_trip)
+{
+   std::string json;
+   for( int i = 0; i < 1000; ++i )
+      json += "{\"block_num\":" + std::to_string( i ) + ",\"producer\":\"dccio\"},";
+
+   for( const std::string& in : { std::string(), std::string( "a" ), json } ) {
+      auto compressed = fc::gzip_compress( in );
+      BOOST_REQUIRE_GE( compressed.size(), 18u );
+      BOOST_CHECK_EQUAL( (unsigned char)compressed[0], 0x1f );
+      BOOST_CHECK_EQUAL( (unsigned char)compressed[1], 0x8b );
+      BOOST_CHECK( fc::gzip_decompress( compressed ) == in );
+   }
+   BOOST_CHECK_LT( fc::gzip_compress( json ).size(), json.size() / 4 );
+
+   // the trailer's CRC-32 is checked
+   auto corrupt = fc::gzip_compress( json );
+   corrupt[corrupt.size() - 8] ^= 1;
+   BOOST_CHECK_THROW( fc::gzip_decompress( corrupt ), fc::assert_exception );
+}
+
+BOOST_AUTO_TEST_CASE(accept_encoding)
+{
+   BOOST_CHECK( accepted_encoding( "" ) == content_encoding::identity );
+   BOOST_CHECK( accepted_encoding( "identity" ) == content_encoding::identity );
+   BOOST_CHECK( accepted_encoding( "gzip" ) == content_encoding::gzip );
+   BOOST_CHECK( accepted_encoding( "x-gzip" ) == content_encoding::gzip );
+   BOOST_CHECK( accepted_encoding( "deflate" ) == content_encoding::deflate );
+   BOOST_CHECK( accepted_encoding( "deflate, gzip" ) == content_encoding::gzip );
+   BOOST_CHECK( accepted_encoding( "GZIP;Q=0.5, deflate" ) == content_encoding::deflate );
+   BOOST_CHECK( accepted_encoding( "gzip;q=0, deflate" ) == content_encoding::deflate );
+   BOOST_CHECK( accepted_encoding( "*" ) == content_encoding::gzip );
+   BOOST_CHECK( accepted_encoding( "*;q=0" ) == content_encoding::identity );
+
+   // "*" only stands for the codings that are not listed
+   BOOST_CHECK( accepted_encoding( "gzip;q=0, *" ) == content_encoding::deflate );
+   BOOST_CHECK( accepted_encoding( "*, gzip;q=0" ) == content_encoding::deflate );
+   BOOST_CHECK( accepted_encoding( "gzip;q=0, deflate;q=0, *" ) == content_encoding::identity );
+   BOOST_CHECK( accepted_encoding( "*;q=0, gzip" ) == content_encoding::gzip );
+   BOOST_CHECK( accepted_encoding( "*;q=0.2, deflate;q=0.5" ) == content_encoding::deflate );
+}
+
+BOOST_AUTO_TEST_CASE(compression_min_bytes)
+{
+   const uint32_t min_bytes = 1024;
+   const std::string small( min_bytes - 1, 'a' );
+   const std::string large( min_bytes, 'a' );
+
+   // bodies below http-compression-min-bytes are sent as they are
+   std::string body = small;
+   BOOST_CHECK( compress_response( body, content_encoding::gzip, min_bytes ) == nullptr );
+   BOOST_CHECK( body == small );
+
+   body = large;
+   BOOST_CHECK_EQUAL( compress_response( body, content_encoding::gzip, min_bytes ), "gzip" );
+   BOOST_CHECK( fc::gzip_decompress( body ) == large );
+
+   body = large;
+   BOOST_CHECK_EQUAL( compress_response( body, content_encoding::deflate, min_bytes ), "deflate" );
+   BOOST_CHECK( fc::zlib_decompress( body ) == large );
+
+   body = large;
+   BOOST_CHECK( compress_response( body, content_encoding::identity, min_bytes ) == nullptr );
+   BOOST_CHECK( body == large );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // dccio
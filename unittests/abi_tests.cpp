@@ -17,6 +17,7 @@
 
 #include <dccio/chain/contract_types.hpp>
 #include <dccio/chain/abi_serializer.hpp>
+#include <dccio/chain/abi_serializer_cache.hpp>
 #include <dccio/chain/dccio_contract.hpp>
 #include <dccio/abi_generator/abi_generator.hpp>
 #include <dccio/testing/tester.hpp>
@@ -3991,4 +3992,274 @@ BOOST_AUTO_TEST_CASE(abi_deserialize_detailed_error_messages)
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(abi_serializer_cache_reuse_and_setabi)
+{ try {
+   dccio::testing::tester chain;
+   chain.create_account( N(abiowner) );
+   chain.produce_block();
+
+   const char* hi_abi = R"=====({
+      "version": "dccio::abi/1.0",
+      "structs": [{"name": "hi", "base": "", "fields": [{"name": "user", "type": "name"}]}],
+      "actions": [{"name": "hi", "type": "hi", "ricardian_contract": ""}]
+   })=====";
+   const char* bye_abi = R"=====({
+      "version": "dccio::abi/1.0",
+      "structs": [{"name": "bye", "base": "", "fields": [{"name": "user", "type": "name"}]}],
+      "actions": [{"name": "bye", "type": "bye", "ricardian_contract": ""}]
+   })=====";
+
+   auto& cache = chain.control->get_abi_serializer_cache();
+   BOOST_CHECK( !cache.get( chain.control->db(), N(abiowner), max_serialization_time ));
+
+   chain.set_abi( N(abiowner), hi_abi );
+   auto first = cache.get( chain.control->db(), N(abiowner), max_serialization_time );
+   BOOST_REQUIRE( first );
+   BOOST_CHECK_EQUAL( first->get_action_type( N(hi) ), "hi" );
+   BOOST_CHECK( first == cache.get( chain.control->db(), N(abiowner), max_serialization_time ));
+
+   // setabi bumps abi_sequence, the next lookup builds a serializer for the new ABI
+   chain.set_abi( N(abiowner), bye_abi );
+   auto second = cache.get( chain.control->db(), N(abiowner), max_serialization_time );
+   BOOST_REQUIRE( second );
+   BOOST_CHECK( second != first );
+   BOOST_CHECK_EQUAL( second->get_action_type( N(bye) ), "bye" );
+   BOOST_CHECK( second->get_action_type( N(hi) ).empty() );
+   BOOST_CHECK( first->get_action_type( N(bye) ).empty() );
+
+   // controller::get_abi_serializer shares the cached serializer
+   BOOST_CHECK( chain.control->get_abi_serializer( N(abiowner), max_serialization_time ) == second );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(abi_serializer_cache_eviction)
+{ try {
+   abi_serializer_cache cache( 2 );
+   int built = 0;
+   auto make = [&]() { ++built; return std::make_shared<const abi_serializer>(); };
+
+   auto a = cache.get( N(a), 1, make );
+   cache.get( N(b), 1, make );
+   BOOST_CHECK( cache.get( N(a), 1, make ) == a );
+   BOOST_CHECK_EQUAL( built, 2 );
+
+   // b is the least recently used
+   cache.get( N(c), 1, make );
+   BOOST_CHECK_EQUAL( cache.size(), 2u );
+   BOOST_CHECK( cache.get( N(a), 1, make ) == a );
+   cache.get( N(b), 1, make );
+   BOOST_CHECK_EQUAL( built, 4 );
+
+   // a new sequence replaces the account's entry
+   BOOST_CHECK( cache.get( N(b), 2, make ) != a );
+   BOOST_CHECK_EQUAL( built, 5 );
+
+   cache.invalidate( N(b) );
+   cache.get( N(b), 2, make );
+   BOOST_CHECK_EQUAL( built, 6 );
+
+   // null serializers are not cached
+   cache.get( N(d), 1, []() { return abi_serializer_cache::serializer_ptr(); } );
+   BOOST_CHECK_EQUAL( cache.size(), 2u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(abi_serializer_copies_outlive_source)
+{ try {
+   auto abi = R"({
+      "version": "dccio::abi/1.1",
+      "types": [
+         {"new_type_name": "foo", "type": "s"}
+      ],
+      "structs": [
+         {"name": "b", "base": "", "fields": [
+            {"name": "n", "type": "name[]"}
+         ]},
+         {"name": "s", "base": "b", "fields": [
+            {"name": "v", "type": "v1"},
+            {"name": "o", "type": "string?"},
+            {"name": "e", "type": "int8$"}
+         ]}
+      ],
+      "variants": [
+         {"name": "v1", "types": ["int8", "foo[]"]}
+      ]
+   })";
+
+   abi_serializer copied;
+   abi_serializer assigned;
+   {
+      abi_serializer source( fc::json::from_string(abi).as<abi_def>(), max_serialization_time );
+      copied = abi_serializer( source );
+      assigned = source;
+   }
+   for( const auto* abis : { &copied, &assigned } ) {
+      verify_round_trip_conversion( *abis, "foo", R"({"n":["a"],"v":["int8",1],"o":null})", "010000000000000030000100" );
+      verify_round_trip_conversion( *abis, "s", R"({"n":[],"v":["foo[]",[{"n":[],"v":["int8",2],"o":"x","e":3}]],"o":null,"e":4})",
+                                    "000101000002010178030004" );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(binary_to_json_matches_variant)
+{ try {
+   auto abi = R"({
+      "version": "dccio::abi/1.1",
+      "types": [
+         {"new_type_name": "foo", "type": "s"}
+      ],
+      "structs": [
+         {"name": "b", "base": "", "fields": [
+            {"name": "n", "type": "name[]"},
+            {"name": "big", "type": "uint64"},
+            {"name": "q", "type": "asset"}
+         ]},
+         {"name": "s", "base": "b", "fields": [
+            {"name": "v", "type": "v1"},
+            {"name": "o", "type": "string?"},
+            {"name": "f", "type": "float64"},
+            {"name": "e", "type": "int8$"}
+         ]}
+      ],
+      "variants": [
+         {"name": "v1", "types": ["int8", "foo[]"]}
+      ]
+   })";
+   abi_serializer abis( fc::json::from_string(abi).as<abi_def>(), max_serialization_time );
+
+   auto check = [&]( const type_name& type, const char* json ) {
+      bytes bin = abis.variant_to_binary( type, fc::json::from_string(json), max_serialization_time );
+      BOOST_TEST( abis.binary_to_json( type, bin, max_serialization_time ) ==
+                  fc::json::to_string( abis.binary_to_variant( type, bin, max_serialization_time ) ) );
+   };
+   check( "foo", R"({"n":["alice"],"big":"18446744073709551615","q":"1.0000 SYS","v":["int8",1],"o":null,"f":"0.5"})" );
+   check( "s", R"({"n":[],"big":5,"q":"0.0001 SYS","v":["foo[]",[{"n":["bob"],"big":7,"q":"2.0000 SYS","v":["int8",2],"o":"x\"\n","f":1,"e":3}]],"o":"y","f":-2.25,"e":4})" );
+   check( "foo[]", R"([])" );
+   check( "string?", R"(null)" );
+   check( "v1", R"(["int8",-1])" );
+
+   bytes bin = abis.variant_to_binary( "s", fc::json::from_string(R"({"n":[],"big":5,"q":"1.0000 SYS","v":["int8",1],"o":null,"f":0})"), max_serialization_time );
+   bin.resize( bin.size() - 1 );
+   BOOST_CHECK_THROW( abis.binary_to_json( "s", bin, max_serialization_time ), unpack_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(shadowed_fields_written_once)
+{ try {
+   auto abi = R"({
+      "version": "dccio::abi/1.0",
+      "structs": [
+         {"name": "b", "base": "", "fields": [
+            {"name": "a", "type": "uint8"},
+            {"name": "c", "type": "uint8"}
+         ]},
+         {"name": "s", "base": "b", "fields": [
+            {"name": "a", "type": "uint16"},
+            {"name": "d", "type": "uint8"}
+         ]},
+         {"name": "outer", "base": "", "fields": [
+            {"name": "items", "type": "s[]"}
+         ]}
+      ]
+   })";
+   abi_serializer abis( fc::json::from_string(abi).as<abi_def>(), max_serialization_time );
+
+   // the field of s replaces the field of b that it shadows, keeping its place
+   bytes bin{ 1, 3, 2, 1, 4 };
+   BOOST_TEST( fc::json::to_string( abis.binary_to_variant( "s", bin, max_serialization_time ) ) == R"({"a":258,"c":3,"d":4})" );
+   BOOST_TEST( abis.binary_to_json( "s", bin, max_serialization_time ) == R"({"a":258,"c":3,"d":4})" );
+
+   bytes outer_bin{ 2, 1, 3, 2, 1, 4, 5, 6, 0, 0, 7 };
+   BOOST_TEST( fc::json::to_string( abis.binary_to_variant( "outer", outer_bin, max_serialization_time ) ) ==
+               R"({"items":[{"a":258,"c":3,"d":4},{"a":0,"c":6,"d":7}]})" );
+   BOOST_TEST( abis.binary_to_json( "outer", outer_bin, max_serialization_time ) ==
+               R"({"items":[{"a":258,"c":3,"d":4},{"a":0,"c":6,"d":7}]})" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(to_json_matches_variant_for_traces)
+{ try {
+   auto abi = R"({
+      "version": "dccio::abi/1.0",
+      "structs": [
+         {"name": "transfer", "base": "", "fields": [
+            {"name": "from", "type": "name"},
+            {"name": "to", "type": "name"},
+            {"name": "memo", "type": "string"}
+         ]}
+      ],
+      "actions": [
+         {"name": "transfer", "type": "transfer", "ricardian_contract": ""}
+      ]
+   })";
+   auto abis = std::make_shared<const abi_serializer>( fc::json::from_string(abi).as<abi_def>(), max_serialization_time );
+   auto resolver = [&]( const account_name& n ) { return n == N(token) ? abis : nullptr; };
+
+   auto check = [&]( const auto& o ) {
+      fc::variant v;
+      abi_serializer::to_variant( o, v, resolver, max_serialization_time );
+      std::ostringstream out;
+      abi_serializer::to_json( o, out, resolver, max_serialization_time );
+      BOOST_TEST( out.str() == fc::json::to_string( v ) );
+
+      // other writers see the same walk, with action data that fails to render falling back the same way
+      abi_writer_buffer recorded;
+      abi_serializer::to_writer( o, recorded, resolver, max_serialization_time );
+      std::ostringstream replayed;
+      json_writer writer( replayed );
+      recorded.replay( writer );
+      BOOST_TEST( replayed.str() == out.str() );
+   };
+
+   action_trace at;
+   at.act.account = N(token);
+   at.act.name = N(transfer);
+   at.act.authorization = { permission_level{ N(alice), config::active_name }, permission_level{ N(bob), config::owner_name } };
+   at.act.data = abis->variant_to_binary( "transfer", fc::json::from_string(R"({"from":"alice","to":"bob","memo":"a\"b\n"})"),
+                                          max_serialization_time );
+   at.receipt.receiver = N(alice);
+   at.receipt.act_digest = fc::sha256::hash( std::string("act") );
+   at.receipt.global_sequence = 0x100000000ull;
+   at.receipt.recv_sequence = 7;
+   at.receipt.auth_sequence[N(alice)] = 5;
+   at.receipt.auth_sequence[N(bob)] = std::numeric_limits<uint64_t>::max();
+   at.receipt.code_sequence = 3;
+   at.receipt.abi_sequence = std::numeric_limits<uint32_t>::max();
+   at.elapsed = fc::microseconds( -5 );
+   at.console = "console \"output\"\t";
+   at.trx_id = fc::sha256::hash( std::string("trx") );
+   at.block_num = std::numeric_limits<uint32_t>::max();
+   at.producer_block_id = fc::sha256::hash( std::string("block") );
+   at.account_ram_deltas.insert( account_delta( N(alice), -0x100000000ll ) );
+   at.account_ram_deltas.insert( account_delta( N(bob), 0x100000001ll ) );
+   at.account_ram_deltas.insert( account_delta( N(carol), 12 ) );
+
+   check( action_trace() );
+   check( static_cast<const base_action_trace&>( at ) );
+   at.inline_traces.push_back( at );
+   check( at );
+
+   transaction_trace tt;
+   tt.id = at.trx_id;
+   tt.receipt = transaction_receipt_header();
+   tt.elapsed = fc::microseconds( 0x100000000ll );
+   tt.action_traces.push_back( at );
+   tt.failed_dtrx_trace = std::make_shared<transaction_trace>( tt );
+   check( tt );
+
+   signed_transaction trx;
+   trx.actions.push_back( at.act );
+   trx.actions.push_back( at.act );
+   trx.actions.back().data.resize( 10 );
+   check( trx );
+
+   signed_block block;
+   block.producer = N(alice);
+   block.timestamp = block_timestamp_type( 0x10000 );
+   block.producer_signature = signature_type();
+   block.transactions.emplace_back( packed_transaction( trx ) );
+   block.transactions.emplace_back( transaction_receipt( trx.id() ) );
+   block.transactions.back().status = transaction_receipt_header::soft_fail;
+   block.transactions.back().cpu_usage_us = 0xffffffff;
+   block.transactions.back().net_usage_words = 9;
+   block.block_extensions.emplace_back( 1, bytes{ 'x', 0, 'y' } );
+   check( signed_block() );
+   check( block );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
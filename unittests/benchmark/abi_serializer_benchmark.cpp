@@ -0,0 +1,114 @@
+/**
+ *  Measures abi_serializer throughput on dccio.system and dccio.token action and table payloads, in both
+ *  directions: binary_to_variant followed by fc::json::to_string as the chain API and history plugins used to
+ *  answer, binary_to_json as they answer now, and variant_to_binary as used by abi_json_to_bin and transaction
+ *  submission.
+ *
+ *  Usage: abi_serializer_benchmark [iterations]
+ */
+#include <dccio/chain/abi_serializer.hpp>
+#include <dccio/chain/asset.hpp>
+
+#include <fc/crypto/private_key.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <dccio.system/dccio.system.abi.hpp>
+#include <dccio.token/dccio.token.abi.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace dccio::chain;
+
+static const fc::microseconds max_serialization_time = fc::seconds(10);
+
+struct payload {
+   const char*  name;
+   type_name    type;
+   fc::variant  var;
+};
+
+static fc::variant public_key( const char* seed ) {
+   auto priv = fc::crypto::private_key::regenerate<fc::ecc::private_key_shim>( fc::sha256::hash( std::string(seed) ) );
+   return fc::variant( priv.get_public_key() );
+}
+
+static fc::variant authority( const char* seed ) {
+   return fc::mutable_variant_object()
+      ("threshold", 1)
+      ("keys", fc::variants{ fc::mutable_variant_object()("key", public_key(seed))("weight", 1) })
+      ("accounts", fc::variants{ fc::mutable_variant_object()
+         ("permission", fc::mutable_variant_object()("actor", "dccio.prods")("permission", "active"))
+         ("weight", 1) })
+      ("waits", fc::variants{});
+}
+
+static void run( const char* abi_name, const abi_serializer& abis, const payload& p, uint32_t iterations ) {
+   bytes bin = abis.variant_to_binary( p.type, p.var, max_serialization_time );
+
+   auto start = std::chrono::steady_clock::now();
+   size_t sink = 0;
+   for( uint32_t i = 0; i < iterations; ++i )
+      sink += abis.binary_to_variant( p.type, bin, max_serialization_time ).get_object().size();
+   auto unpack = std::chrono::steady_clock::now() - start;
+
+   start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < iterations; ++i )
+      sink += fc::json::to_string( abis.binary_to_variant( p.type, bin, max_serialization_time ) ).size();
+   auto to_string = std::chrono::steady_clock::now() - start;
+
+   start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < iterations; ++i )
+      sink += abis.binary_to_json( p.type, bin, max_serialization_time ).size();
+   auto to_json = std::chrono::steady_clock::now() - start;
+
+   start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < iterations; ++i )
+      sink += abis.variant_to_binary( p.type, p.var, max_serialization_time ).size();
+   auto pack = std::chrono::steady_clock::now() - start;
+
+   auto ns_per_op = [&]( std::chrono::steady_clock::duration d ) {
+      return double(std::chrono::duration_cast<std::chrono::nanoseconds>( d ).count()) / iterations;
+   };
+   std::printf( "%-14s %-14s %5zu bytes   binary_to_variant %8.0f ns   +to_string %8.0f ns   binary_to_json %8.0f ns"
+                "   variant_to_binary %8.0f ns   (%zu)\n",
+                abi_name, p.name, bin.size(), ns_per_op( unpack ), ns_per_op( to_string ), ns_per_op( to_json ),
+                ns_per_op( pack ), sink );
+}
+
+int main( int argc, char** argv ) {
+   uint32_t iterations = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 100000;
+
+   abi_serializer system_abis( fc::json::from_string( dccio_system_abi ).as<abi_def>(), max_serialization_time );
+   abi_serializer token_abis( fc::json::from_string( dccio_token_abi ).as<abi_def>(), max_serialization_time );
+
+   const payload system_payloads[] = {
+      { "newaccount", "newaccount", fc::mutable_variant_object()
+           ("creator", "dccio")("name", "alice")("owner", authority("owner"))("active", authority("active")) },
+      { "delegatebw", "delegatebw", fc::mutable_variant_object()
+           ("from", "dccio")("receiver", "alice")
+           ("stake_net_quantity", asset(100000))("stake_cpu_quantity", asset(250000))("transfer", true) },
+      { "voteproducer", "voteproducer", fc::mutable_variant_object()
+           ("voter", "alice")("proxy", "")
+           ("producers", fc::variants{ "produceraaaa", "producerbbbb", "producercccc", "producerdddd",
+                                       "producereeee", "producerffff", "producergggg", "producerhhhh" }) },
+      { "producers row", "producer_info", fc::mutable_variant_object()
+           ("owner", "produceraaaa")("total_votes", 1.5e17)("producer_key", public_key("producer"))("is_active", true)
+           ("url", "https://produceraaaa.example")("unpaid_blocks", 1200)("last_claim_time", 1540000000000000ull)("location", 840) }
+   };
+   const payload token_payloads[] = {
+      { "transfer", "transfer", fc::mutable_variant_object()
+           ("from", "alice")("to", "bob")("quantity", asset(12345))("memo", "benchmark transfer") },
+      { "issue", "issue", fc::mutable_variant_object()
+           ("to", "alice")("quantity", asset(1000000))("memo", "") }
+   };
+
+   for( const auto& p : system_payloads )
+      run( "dccio.system", system_abis, p, iterations );
+   for( const auto& p : token_payloads )
+      run( "dccio.token", token_abis, p, iterations );
+
+   return 0;
+}
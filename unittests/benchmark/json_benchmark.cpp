@@ -0,0 +1,108 @@
+/**
+ *  Measures fc::json parsing and serialization on the payloads that dominate HTTP traffic: a push_transaction
+ *  request body and a get_block response for a block full of dccio.token transfers.
+ *
+ *  Usage: json_benchmark [iterations] [transactions per block]
+ */
+#include <dccio/chain/abi_serializer.hpp>
+#include <dccio/chain/asset.hpp>
+#include <dccio/chain/block.hpp>
+#include <dccio/chain/transaction.hpp>
+
+#include <fc/crypto/private_key.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <dccio.token/dccio.token.abi.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace dccio::chain;
+
+static const fc::microseconds max_serialization_time = fc::seconds(10);
+
+static packed_transaction make_transfer( const abi_serializer& token_abis, const fc::crypto::private_key& key,
+                                         const chain_id_type& chain_id, uint32_t n ) {
+   signed_transaction trx;
+   trx.expiration = fc::time_point_sec( 1540000000 + n );
+   trx.ref_block_num = uint16_t( n );
+   trx.ref_block_prefix = 0x12345678;
+
+   action act;
+   act.account = N(dccio.token);
+   act.name = N(transfer);
+   act.authorization = { permission_level{ N(alice), config::active_name } };
+   act.data = token_abis.variant_to_binary( "transfer", fc::mutable_variant_object()
+                                               ("from", "alice")("to", "bob")
+                                               ("quantity", asset( 10000 + n ))
+                                               ("memo", "json benchmark transfer " + std::to_string( n )),
+                                            max_serialization_time );
+   trx.actions.emplace_back( std::move( act ));
+   trx.sign( key, chain_id );
+   return packed_transaction( trx );
+}
+
+static void run( const char* name, const std::string& json, uint32_t iterations ) {
+   auto start = std::chrono::steady_clock::now();
+   size_t sink = 0;
+   fc::variant v;
+   for( uint32_t i = 0; i < iterations; ++i ) {
+      v = fc::json::from_string( json );
+      sink += v.get_object().size();
+   }
+   auto parse = std::chrono::steady_clock::now() - start;
+
+   start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < iterations; ++i )
+      sink += fc::json::to_string( v ).size();
+   auto write = std::chrono::steady_clock::now() - start;
+
+   auto us_per_op = [&]( std::chrono::steady_clock::duration d ) {
+      return double(std::chrono::duration_cast<std::chrono::nanoseconds>( d ).count()) / iterations / 1000;
+   };
+   auto mb_per_s = [&]( std::chrono::steady_clock::duration d ) {
+      return double(json.size()) * iterations / std::chrono::duration_cast<std::chrono::microseconds>( d ).count();
+   };
+   std::printf( "%-18s %8zu bytes   from_string %9.1f us %7.1f MB/s   to_string %9.1f us %7.1f MB/s   (%zu)\n",
+                name, json.size(), us_per_op( parse ), mb_per_s( parse ), us_per_op( write ), mb_per_s( write ), sink );
+}
+
+int main( int argc, char** argv ) {
+   uint32_t iterations = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 1000;
+   uint32_t block_transactions = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 200;
+
+   auto token_abis = std::make_shared<const abi_serializer>( fc::json::from_string( dccio_token_abi ).as<abi_def>(),
+                                                             max_serialization_time );
+   auto key = fc::crypto::private_key::regenerate<fc::ecc::private_key_shim>( fc::sha256::hash( std::string("alice") ));
+   chain_id_type chain_id( fc::sha256::hash( std::string("json benchmark") ).str() );
+
+   // push_transaction request body as sent by cldcc
+   std::string push_transaction = fc::json::to_string( fc::variant( make_transfer( *token_abis, key, chain_id, 0 )));
+
+   // get_block response, transactions and action data expanded through the token ABI
+   signed_block block;
+   block.timestamp = block_timestamp_type( fc::time_point_sec( 1540000000 ));
+   block.producer = N(producera);
+   for( uint32_t n = 0; n < block_transactions; ++n ) {
+      block.transactions.emplace_back( make_transfer( *token_abis, key, chain_id, n ));
+      block.transactions.back().cpu_usage_us = 200 + n;
+      block.transactions.back().net_usage_words = 18;
+   }
+   block.producer_signature = key.sign( block.digest() );
+   fc::variant pretty_block;
+   abi_serializer::to_variant( block, pretty_block,
+                               [&]( account_name n ) { return n == N(dccio.token) ? token_abis : nullptr; },
+                               max_serialization_time );
+   std::string get_block = fc::json::to_string( fc::mutable_variant_object( pretty_block.get_object() )
+                                                   ("id", block.id())
+                                                   ("block_num", block.block_num())
+                                                   ("ref_block_prefix", block.id()._hash[1]) );
+
+   run( "push_transaction", push_transaction, iterations * 100 );
+   run( "get_block", get_block, iterations );
+
+   return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ *  Measures the conversion to BSON mongo_db_plugin does for every row it stores, over a range of blocks full of
+ *  dccio.token transfers as they would be seen on replay: each transfer's action traces, its transaction trace,
+ *  and the block itself. Compares abi_serializer::to_variant followed by fc::json::to_string and
+ *  bsoncxx::from_json, as the plugin used to convert them, with abi_serializer::to_writer into a bson_writer as it
+ *  converts them now.
+ *
+ *  Usage: trace_serialization_benchmark [blocks] [transactions per block] [passes]
+ */
+#include <dccio/chain/abi_serializer.hpp>
+#include <dccio/chain/asset.hpp>
+#include <dccio/chain/block.hpp>
+#include <dccio/chain/trace.hpp>
+#include <dccio/chain/transaction.hpp>
+#include <dccio/mongo_db_plugin/bson_writer.hpp>
+
+#include <fc/crypto/private_key.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <dccio.token/dccio.token.abi.hpp>
+
+#include <bsoncxx/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+using namespace dccio::chain;
+
+static const fc::microseconds max_serialization_time = fc::seconds(10);
+
+struct block_range {
+   vector<signed_block>          blocks;
+   vector<signed_transaction>    transactions;
+   vector<transaction_trace_ptr> traces;
+};
+
+static action_trace make_action_trace( const action& act, account_name receiver, const transaction_id_type& trx_id,
+                                       const signed_block& block, uint64_t global_sequence ) {
+   action_trace at;
+   at.receipt.receiver = receiver;
+   at.receipt.act_digest = digest_type::hash( act );
+   at.receipt.global_sequence = global_sequence;
+   at.receipt.recv_sequence = global_sequence;
+   at.receipt.auth_sequence[N(alice)] = global_sequence;
+   at.act = act;
+   at.elapsed = fc::microseconds( 120 );
+   at.trx_id = trx_id;
+   at.block_num = block.block_num();
+   at.block_time = block.timestamp;
+   at.producer_block_id = block.id();
+   return at;
+}
+
+static block_range make_block_range( const abi_serializer& token_abis, uint32_t num_blocks, uint32_t block_transactions ) {
+   auto key = fc::crypto::private_key::regenerate<fc::ecc::private_key_shim>( fc::sha256::hash( std::string("alice") ));
+   chain_id_type chain_id( fc::sha256::hash( std::string("trace benchmark") ).str() );
+
+   block_range range;
+   block_id_type previous;
+   uint64_t global_sequence = 0;
+   for( uint32_t b = 0; b < num_blocks; ++b ) {
+      signed_block block;
+      block.timestamp = block_timestamp_type( fc::time_point_sec( 1540000000 + b ));
+      block.producer = N(producera);
+      block.previous = previous;
+
+      vector<signed_transaction> trxs;
+      for( uint32_t n = 0; n < block_transactions; ++n ) {
+         signed_transaction trx;
+         trx.expiration = fc::time_point_sec( 1540000000 + b + 30 );
+         trx.ref_block_num = uint16_t( b );
+         trx.ref_block_prefix = 0x12345678 + n;
+
+         action act;
+         act.account = N(dccio.token);
+         act.name = N(transfer);
+         act.authorization = { permission_level{ N(alice), config::active_name } };
+         act.data = token_abis.variant_to_binary( "transfer", fc::mutable_variant_object()
+                                                     ("from", "alice")("to", "bob")
+                                                     ("quantity", asset( 10000 + n ))
+                                                     ("memo", "trace benchmark transfer " + std::to_string( n )),
+                                                  max_serialization_time );
+         trx.actions.emplace_back( std::move( act ));
+         trx.sign( key, chain_id );
+
+         block.transactions.emplace_back( packed_transaction( trx ));
+         block.transactions.back().cpu_usage_us = 200 + n;
+         block.transactions.back().net_usage_words = 18;
+         trxs.emplace_back( std::move( trx ));
+      }
+      block.producer_signature = key.sign( block.digest() );
+      previous = block.id();
+
+      for( uint32_t n = 0; n < block_transactions; ++n ) {
+         const auto& act = trxs[n].actions.front();
+         auto trace = std::make_shared<transaction_trace>();
+         trace->id = trxs[n].id();
+         trace->block_num = block.block_num();
+         trace->block_time = block.timestamp;
+         trace->producer_block_id = block.id();
+         trace->receipt = static_cast<const transaction_receipt_header&>( block.transactions[n] );
+         trace->elapsed = fc::microseconds( 350 );
+         trace->net_usage = 144;
+         // the transfer and its notifications of sender and receiver
+         trace->action_traces.emplace_back( make_action_trace( act, N(dccio.token), trace->id, block, ++global_sequence ));
+         auto& top = trace->action_traces.back();
+         top.inline_traces.emplace_back( make_action_trace( act, N(alice), trace->id, block, ++global_sequence ));
+         top.inline_traces.emplace_back( make_action_trace( act, N(bob), trace->id, block, ++global_sequence ));
+         range.traces.emplace_back( std::move( trace ));
+      }
+      std::move( trxs.begin(), trxs.end(), std::back_inserter( range.transactions ));
+      range.blocks.emplace_back( std::move( block ));
+   }
+   return range;
+}
+
+/// the fastest of a few passes over the rows
+template<typename Pass>
+static std::chrono::steady_clock::duration best_of( uint32_t passes, Pass&& pass ) {
+   auto best = std::chrono::steady_clock::duration::max();
+   for( uint32_t i = 0; i < passes; ++i ) {
+      auto start = std::chrono::steady_clock::now();
+      pass();
+      best = std::min( best, std::chrono::steady_clock::now() - start );
+   }
+   return best;
+}
+
+template<typename Resolver, typename Rows>
+static void run( const char* name, const Rows& rows, Resolver resolver, uint32_t passes ) {
+   size_t sink = 0;
+   size_t count = 0;
+   auto json = best_of( passes, [&]() {
+      count = 0;
+      rows( [&]( const auto& row ) {
+         fc::variant v;
+         abi_serializer::to_variant( row, v, resolver, max_serialization_time );
+         sink += bsoncxx::from_json( fc::json::to_string( v ) ).view().length();
+         ++count;
+      } );
+   } );
+
+   auto writer = best_of( passes, [&]() {
+      rows( [&]( const auto& row ) {
+         dccio::bson_writer out;
+         abi_serializer::to_writer( row, out, resolver, max_serialization_time );
+         sink += out.extract().view().length();
+      } );
+   } );
+
+   auto rows_per_s = [&]( std::chrono::steady_clock::duration d ) {
+      return double(count) * 1000000 / std::chrono::duration_cast<std::chrono::microseconds>( d ).count();
+   };
+   std::printf( "%-18s %8zu rows   to_variant+to_string+from_json %10.0f rows/s   to_writer %10.0f rows/s   %5.2fx   (%zu)\n",
+                name, count, rows_per_s( json ), rows_per_s( writer ), rows_per_s( writer ) / rows_per_s( json ), sink );
+}
+
+int main( int argc, char** argv ) {
+   uint32_t num_blocks = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 100;
+   uint32_t block_transactions = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 200;
+   uint32_t passes = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 5;
+
+   auto token_abis = std::make_shared<const abi_serializer>( fc::json::from_string( dccio_token_abi ).as<abi_def>(),
+                                                             max_serialization_time );
+   auto resolver = [&]( account_name n ) { return n == N(dccio.token) ? token_abis : nullptr; };
+
+   auto range = make_block_range( *token_abis, num_blocks, block_transactions );
+
+   run( "action_traces", [&]( auto&& f ) {
+      std::function<void(const action_trace&)> each = [&]( const action_trace& at ) {
+         f( static_cast<const base_action_trace&>( at ));
+         for( const auto& iat : at.inline_traces )
+            each( iat );
+      };
+      for( const auto& t : range.traces )
+         for( const auto& at : t->action_traces )
+            each( at );
+   }, resolver, passes );
+   run( "transaction_traces", [&]( auto&& f ) {
+      for( const auto& t : range.traces )
+         f( *t );
+   }, resolver, passes );
+   run( "transactions", [&]( auto&& f ) {
+      for( const auto& t : range.transactions )
+         f( t );
+   }, resolver, passes );
+   run( "blocks", [&]( auto&& f ) {
+      for( const auto& b : range.blocks )
+         f( b );
+   }, resolver, passes );
+
+   return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ *  @file
+ *  @copyright defined in dcc/LICENSE.txt
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <dccio/testing/tester.hpp>
+#include <dccio/chain/block_log.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace dccio;
+using namespace testing;
+using namespace chain;
+
+namespace {
+   // sealed segments are compressed and pruned on a background thread
+   template<typename Predicate>
+   bool wait_for( Predicate&& pred ) {
+      for( int i = 0; i < 1000 && !pred(); ++i )
+         std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+      return pred();
+   }
+
+   size_t count_segment_files( const fc::path& dir, const string& extension ) {
+      size_t count = 0;
+      if( !fc::is_directory( dir ) )
+         return count;
+      for( fc::directory_iterator itr( dir ), end; itr != end; ++itr ) {
+         const auto name = (*itr).filename().generic_string();
+         if( name.find( "blocks-" ) == 0 && (*itr).extension().generic_string() == extension )
+            ++count;
+      }
+      return count;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(block_log_tests)
+
+BOOST_AUTO_TEST_CASE(segmented_block_log) { try {
+   tester chain;
+   chain.produce_blocks(100);
+
+   vector<signed_block_ptr> blocks;
+   for( uint32_t num = 1; num <= chain.control->head_block_num(); ++num )
+      blocks.push_back( chain.control->fetch_block_by_number( num ) );
+
+   auto check_blocks = [&]( const block_log& log, uint32_t first_block_num ) {
+      BOOST_REQUIRE_EQUAL( log.first_block_num(), first_block_num );
+      for( uint32_t num = 1; num < first_block_num; ++num )
+         BOOST_TEST( !log.read_block_by_num( num ) );
+      for( uint32_t num = first_block_num; num <= blocks.size(); ++num ) {
+         auto b = log.read_block_by_num( num );
+         BOOST_REQUIRE( b );
+         BOOST_TEST( b->id() == blocks[num - 1]->id() );
+      }
+
+      auto range = log.read_blocks( 1, blocks.size() + 10 );
+      BOOST_REQUIRE_EQUAL( range.size(), blocks.size() - first_block_num + 1 );
+      for( size_t i = 0; i < range.size(); ++i )
+         BOOST_TEST( range[i]->id() == blocks[first_block_num + i - 1]->id() );
+
+      BOOST_TEST( log.read_head()->id() == blocks.back()->id() );
+   };
+
+   fc::temp_directory tempdir;
+   const auto log_dir = tempdir.path() / "blocks";
+   block_log_segment_config segments;
+   segments.segment_size = 4096;
+   segments.compress = true;
+
+   {
+      block_log log( log_dir, segments );
+      log.reset( chain.get_config().genesis, blocks.front() );
+      for( size_t i = 1; i < blocks.size(); ++i )
+         log.append( blocks[i] );
+
+      BOOST_REQUIRE( count_segment_files( log_dir, ".log" ) + count_segment_files( log_dir, ".zlog" ) > 2 );
+      check_blocks( log, 1 );
+
+      BOOST_REQUIRE( wait_for( [&]() { return count_segment_files( log_dir, ".log" ) == 0; } ) );
+      BOOST_TEST( count_segment_files( log_dir, ".index" ) == 0u );
+      check_blocks( log, 1 );
+   }
+
+   // reopened keeping only the two newest segments, the others are archived
+   const auto num_segments = count_segment_files( log_dir, ".zlog" );
+   segments.retained_segments = 2;
+   segments.archive_dir = tempdir.path() / "archive";
+   block_log log( log_dir, segments );
+   BOOST_REQUIRE( wait_for( [&]() { return count_segment_files( log_dir, ".zlog" ) == 2; } ) );
+   BOOST_TEST( count_segment_files( segments.archive_dir, ".zlog" ) == num_segments - 2 );
+   BOOST_REQUIRE( log.first_block_num() > 1 );
+   check_blocks( log, log.first_block_num() );
+
+   chain.produce_block();
+   blocks.push_back( chain.control->head_block_state()->block );
+   log.append( blocks.back() );
+   check_blocks( log, log.first_block_num() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
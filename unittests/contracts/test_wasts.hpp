@@ -633,3 +633,74 @@ static const char memory_growth_memset_test[] = R"=====(
  )
 )
 )=====";
+
+static const char memory_snapshot_reset_wast[] = R"=====(
+(module
+ (import "env" "dccio_assert" (func $dccio_assert (param i32 i32)))
+ (table 0 anyfunc)
+ (memory $0 8)
+ (data (i32.const 300000) "\2a")
+ (export "memory" (memory $0))
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64) (param $1 i64) (param $2 i64)
+   (call $dccio_assert (i32.eq (i32.load8_u (i32.const 300000)) (i32.const 42)) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 400000))) (i32.const 0))
+   (call $dccio_assert (i32.eq (grow_memory (i32.const 1)) (i32.const 8)) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 524289))) (i32.const 0))
+   (i32.store8 (i32.const 300000) (i32.const 0))
+   (i32.store8 (i32.const 400000) (i32.const 7))
+   (i32.store8 (i32.const 524289) (i32.const 7))
+ )
+)
+)=====";
+
+static const char memory_snapshot_large_wast[] = R"=====(
+(module
+ (import "env" "dccio_assert" (func $dccio_assert (param i32 i32)))
+ (table 0 anyfunc)
+ (memory $0 8)
+ (data (i32.const 100000) "\2a")
+ (data (i32.const 400000) "\2a")
+ (export "memory" (memory $0))
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64) (param $1 i64) (param $2 i64)
+   (call $dccio_assert (i32.eq (i32.load8_u (i32.const 400000)) (i32.const 42)) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 450000))) (i32.const 0))
+   (i32.store8 (i32.const 450000) (i32.const 7))
+ )
+)
+)=====";
+
+static const char memory_snapshot_small_wast[] = R"=====(
+(module
+ (import "env" "dccio_assert" (func $dccio_assert (param i32 i32)))
+ (table 0 anyfunc)
+ (memory $0 1)
+ (export "memory" (memory $0))
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64) (param $1 i64) (param $2 i64)
+   (call $dccio_assert (i32.eq (grow_memory (i32.const 7)) (i32.const 1)) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 100000))) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 400000))) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 450000))) (i32.const 0))
+ )
+)
+)=====";
+
+static const char memory_snapshot_medium_wast[] = R"=====(
+(module
+ (import "env" "dccio_assert" (func $dccio_assert (param i32 i32)))
+ (table 0 anyfunc)
+ (memory $0 5)
+ (data (i32.const 10) "\2a")
+ (export "memory" (memory $0))
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64) (param $1 i64) (param $2 i64)
+   (call $dccio_assert (i32.eq (i32.load8_u (i32.const 10)) (i32.const 42)) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 100000))) (i32.const 0))
+   (call $dccio_assert (i32.eq (grow_memory (i32.const 3)) (i32.const 5)) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 400000))) (i32.const 0))
+   (call $dccio_assert (i32.eqz (i32.load8_u (i32.const 450000))) (i32.const 0))
+ )
+)
+)=====";
@@ -9,6 +9,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <thread>
+
 #ifdef NON_VALIDATING_TEST
 #define TESTER tester
 #else
@@ -100,5 +103,48 @@ BOOST_AUTO_TEST_SUITE(database_tests)
       } FC_LOG_AND_RETHROW()
    }
 
+   // Test reading ranges of irreversible blocks, including from another thread while blocks are produced
+   BOOST_AUTO_TEST_CASE(get_irreversible_blocks) {
+      try {
+         TESTER test;
+         test.produce_blocks(100);
+
+         const uint32_t lib = test.control->last_irreversible_block_num();
+         BOOST_REQUIRE(lib > 10);
+         auto blocks = test.control->fetch_irreversible_blocks_by_number(1, lib + 10);
+         BOOST_REQUIRE_EQUAL(blocks.size(), lib);
+         for (uint32_t i = 0; i < blocks.size(); ++i) {
+            BOOST_TEST(blocks[i]->block_num() == i + 1);
+            BOOST_TEST(blocks[i]->id() == test.control->fetch_block_by_number(i + 1)->id());
+         }
+
+         blocks = test.control->fetch_irreversible_blocks_by_number(5, 9);
+         BOOST_REQUIRE_EQUAL(blocks.size(), 5);
+         BOOST_TEST(blocks.front()->block_num() == 5);
+         BOOST_TEST(blocks.back()->block_num() == 9);
+
+         BOOST_TEST(test.control->fetch_irreversible_blocks_by_number(lib + 1, lib + 10).empty());
+         BOOST_TEST(test.control->fetch_irreversible_blocks_by_number(9, 5).empty());
+
+         std::atomic<bool> done(false);
+         std::atomic<uint32_t> mismatches(0);
+         std::thread reader([&]() {
+            while (!done) {
+               auto read = test.control->fetch_irreversible_blocks_by_number(1, std::numeric_limits<uint32_t>::max());
+               for (uint32_t i = 0; i < read.size(); ++i) {
+                  if (read[i]->block_num() != i + 1)
+                     ++mismatches;
+               }
+            }
+         });
+         test.produce_blocks(100);
+         done = true;
+         reader.join();
+         BOOST_TEST(mismatches == 0u);
+         BOOST_TEST(test.control->fetch_irreversible_blocks_by_number(1, std::numeric_limits<uint32_t>::max()).size() ==
+                    test.control->last_irreversible_block_num());
+      } FC_LOG_AND_RETHROW()
+   }
+
 
 BOOST_AUTO_TEST_SUITE_END()
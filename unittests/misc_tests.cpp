@@ -7,6 +7,7 @@
 #include <dccio/chain/authority.hpp>
 #include <dccio/chain/types.hpp>
 #include <dccio/chain/asset.hpp>
+#include <dccio/chain/transaction_metadata.hpp>
 #include <dccio/testing/tester.hpp>
 
 #include <dccio/utilities/key_conversion.hpp>
@@ -104,6 +105,27 @@ BOOST_AUTO_TEST_CASE(json_from_string_test)
   BOOST_CHECK_EQUAL(exc_found, true);
 }
 
+/// Test escaping and unescaping of strings that cross the 16 byte blocks scanned at a time
+BOOST_AUTO_TEST_CASE(json_string_escape_test)
+{
+  for( size_t prefix = 0; prefix < 40; ++prefix ) {
+    string s = string(prefix, 'a') + "\"q\"\\b\\\n\t" + string(prefix, 'z');
+    string json = fc::json::to_string( s );
+    BOOST_CHECK_EQUAL( json.find('\n'), string::npos );
+    BOOST_CHECK_EQUAL( fc::json::from_string( json ).as_string(), s );
+  }
+
+  BOOST_CHECK_EQUAL( fc::json::to_string( string("tab\there\x1f") ), "\"tab\\there\\u001f\"" );
+
+  auto obj = fc::json::from_string( "{\"big\":18446744073709551615,\"neg\":-12,\"arr\":[true,null,\"s\"]}" );
+  BOOST_CHECK_EQUAL( obj["big"].as_uint64(), 18446744073709551615ull );
+  BOOST_CHECK_EQUAL( obj["neg"].as_int64(), -12 );
+  BOOST_CHECK_EQUAL( fc::json::to_string( obj ),
+                     "{\"big\":\"18446744073709551615\",\"neg\":-12,\"arr\":[true,null,\"s\"]}" );
+
+  BOOST_CHECK_THROW( fc::json::from_string( string(1000, '[') + string(1000, ']') ), fc::parse_error_exception );
+}
+
 // Test overflow handling in asset::from_string
 BOOST_AUTO_TEST_CASE(asset_from_string_overflow)
 {
@@ -645,6 +667,66 @@ BOOST_AUTO_TEST_CASE(transaction_test) { try {
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(signing_keys_future_test) { try {
+
+   testing::TESTER test;
+   signed_transaction trx;
+   trx.actions.emplace_back( vector<permission_level>{{config::system_account_name, config::active_name}},
+                             newaccount{
+                             .creator  = config::system_account_name,
+                             .name     = N(alice),
+                             .owner    = authority( test.get_public_key( N(alice), "owner" ) ),
+                             .active   = authority( test.get_public_key( N(alice), "active" ) )
+                             });
+   test.set_transaction_headers(trx);
+   trx.sign( test.get_private_key( config::system_account_name, "active" ), test.control->get_chain_id() );
+   trx.sign( test.get_private_key( config::system_account_name, "owner" ), test.control->get_chain_id() );
+
+   const auto expected_keys = trx.get_signature_keys( test.control->get_chain_id() );
+   BOOST_CHECK_EQUAL(2, expected_keys.size());
+
+   boost::asio::thread_pool thread_pool( 2 );
+
+   auto mtrx = std::make_shared<transaction_metadata>( packed_transaction( trx ) );
+   BOOST_CHECK( !mtrx->signing_keys_future.valid() );
+   transaction_metadata::create_signing_keys_future( mtrx, thread_pool, test.control->get_chain_id() );
+   BOOST_REQUIRE( mtrx->signing_keys_future.valid() );
+
+   mtrx->signing_keys_future.wait();
+   BOOST_CHECK( !mtrx->signing_keys );
+   BOOST_CHECK( mtrx->recover_keys( test.control->get_chain_id() ) == expected_keys );
+   BOOST_REQUIRE( mtrx->signing_keys );
+   BOOST_CHECK( mtrx->signing_keys->first == test.control->get_chain_id() );
+
+   // a different chain_id does not reuse the future
+   chain_id_type other_chain_id( fc::sha256::hash( "other" ).str() );
+   BOOST_CHECK( mtrx->recover_keys( other_chain_id ) == trx.get_signature_keys( other_chain_id ) );
+   BOOST_CHECK( mtrx->signing_keys->first == other_chain_id );
+
+   // next runs on the thread pool once the keys are ready
+   std::promise<bool> next_called;
+   auto next_mtrx = std::make_shared<transaction_metadata>( packed_transaction( trx ) );
+   transaction_metadata::create_signing_keys_future( next_mtrx, thread_pool, test.control->get_chain_id(), [&]() {
+      next_called.set_value( next_mtrx->signing_keys_future.wait_for( std::chrono::seconds(0) ) == std::future_status::ready );
+   } );
+   BOOST_CHECK( next_called.get_future().get() );
+   BOOST_CHECK( next_mtrx->recover_keys( test.control->get_chain_id() ) == expected_keys );
+
+   // and right away if the keys are already recovered
+   bool called = false;
+   transaction_metadata::create_signing_keys_future( next_mtrx, thread_pool, test.control->get_chain_id(), [&]() { called = true; } );
+   BOOST_CHECK( called );
+
+   // duplicate signatures are reported when the keys are used, not when the future is created
+   trx.signatures.push_back( trx.signatures.front() );
+   auto dup_mtrx = std::make_shared<transaction_metadata>( packed_transaction( trx ) );
+   transaction_metadata::create_signing_keys_future( dup_mtrx, thread_pool, test.control->get_chain_id() );
+   BOOST_CHECK_THROW( dup_mtrx->recover_keys( test.control->get_chain_id() ), tx_duplicate_sig );
+
+   thread_pool.join();
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace dccio
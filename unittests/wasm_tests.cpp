@@ -164,6 +164,166 @@ BOOST_FIXTURE_TEST_CASE( prove_mem_reset, TESTER ) try {
 
 } FC_LOG_AND_RETHROW() /// prove_mem_reset
 
+/**
+ * Prove contracts loaded from the wavm code cache after a restart behave like freshly compiled ones
+ */
+BOOST_FIXTURE_TEST_CASE( wasm_code_cache, TESTER ) try {
+   fc::temp_directory code_cache_dir;
+   auto cache_cfg = get_config();
+   cache_cfg.wasm_code_cache_dir = code_cache_dir.path();
+   close();
+   init( cache_cfg );
+
+   produce_blocks(2);
+
+   create_accounts( {N(asserter)} );
+   produce_block();
+
+   set_code(N(asserter), asserter_wast);
+   produce_blocks(1);
+
+   auto count_cached = [&]() {
+      size_t count = 0;
+      for( fc::directory_iterator itr( code_cache_dir.path() ); itr != fc::directory_iterator(); ++itr )
+         ++count;
+      return count;
+   };
+   auto push_provereset = [&]() {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{N(asserter),config::active_name}},
+                                provereset {} );
+      set_transaction_headers(trx);
+      trx.sign( get_private_key( N(asserter), "active" ), control->get_chain_id() );
+      push_transaction( trx );
+      produce_blocks(1);
+      BOOST_REQUIRE_EQUAL(true, chain_has_transaction(trx.id()));
+      BOOST_CHECK_EQUAL(transaction_receipt::executed, get_transaction_receipt(trx.id()).status);
+   };
+   auto push_assert = [&]( uint32_t condition ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{N(asserter),config::active_name}},
+                                assertdef {condition, "Should Assert!"} );
+      set_transaction_headers(trx);
+      trx.sign( get_private_key( N(asserter), "active" ), control->get_chain_id() );
+      push_transaction( trx );
+   };
+
+   push_provereset();
+   push_provereset();
+
+   // only the wavm runtime compiles contracts ahead of execution
+   const bool is_wavm = cache_cfg.wasm_runtime == wasm_interface::vm_type::wavm;
+   const auto cached = count_cached();
+   BOOST_CHECK_EQUAL( is_wavm, cached > 0 );
+
+   close();
+   open( nullptr );
+
+   push_provereset();
+   push_provereset();
+   BOOST_CHECK_THROW( push_assert( 0 ), dccio_assert_message_exception );
+   BOOST_CHECK_EQUAL( cached, count_cached() );
+
+} FC_LOG_AND_RETHROW() /// wasm_code_cache
+
+/**
+ * Prove actions run the latest code when it is replaced before its background compilation was used
+ */
+BOOST_FIXTURE_TEST_CASE( precompile_replaced_code, TESTER ) try {
+   produce_blocks(2);
+
+   create_accounts( {N(asserter)} );
+   produce_block();
+
+   const auto before = control->get_wasm_interface().get_cache_stats();
+   set_code(N(asserter), noop_wast);
+   set_code(N(asserter), asserter_wast);
+   produce_blocks(1);
+
+   // the compilation of the replaced code is dropped without ever being used
+   auto stats = control->get_wasm_interface().get_cache_stats();
+   BOOST_CHECK_EQUAL( before.pending_entries + 1, stats.pending_entries );
+   BOOST_CHECK_EQUAL( before.pending_evictions + 1, stats.pending_evictions );
+
+   auto push_assert = [&]( uint32_t condition ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{N(asserter),config::active_name}},
+                                assertdef {condition, "Should Assert!"} );
+      set_transaction_headers(trx);
+      trx.sign( get_private_key( N(asserter), "active" ), control->get_chain_id() );
+      return push_transaction( trx );
+   };
+
+   BOOST_CHECK_EQUAL( transaction_receipt::executed, push_assert( 1 )->receipt->status );
+   BOOST_CHECK_THROW( push_assert( 0 ), dccio_assert_message_exception );
+   BOOST_CHECK_EQUAL( before.pending_entries, control->get_wasm_interface().get_cache_stats().pending_entries );
+   produce_blocks(1);
+
+} FC_LOG_AND_RETHROW() /// precompile_replaced_code
+
+/**
+ * Prove the least recently used contracts are evicted from the instantiation cache, except pinned ones
+ */
+BOOST_FIXTURE_TEST_CASE( instantiation_cache_eviction, TESTER ) try {
+   auto cache_cfg = get_config();
+   cache_cfg.wasm_cache_max_entries = 3;
+   cache_cfg.wasm_cache_pinned_accounts = { config::system_account_name, N(asserter) };
+   close();
+   init( cache_cfg );
+
+   produce_blocks(2);
+
+   create_accounts( {N(asserter), N(globalreset), N(noop)} );
+   produce_block();
+
+   set_code(N(asserter), asserter_wast);
+   set_code(N(globalreset), mutable_global_wast);
+   set_code(N(noop), noop_wast);
+   produce_blocks(1);
+
+   auto push_action = [&]( account_name account, action_name act_name ) {
+      signed_transaction trx;
+      action act;
+      act.account = account;
+      act.name = act_name;
+      act.authorization = vector<permission_level>{{account,config::active_name}};
+      trx.actions.push_back(act);
+      set_transaction_headers(trx);
+      trx.sign( get_private_key( account, "active" ), control->get_chain_id() );
+      push_transaction( trx );
+   };
+
+   // only the system contract, which runs every block, is cached so far; compilations not used yet count against
+   // the limit, so the oldest one was dropped
+   const auto before = control->get_wasm_interface().get_cache_stats();
+   BOOST_CHECK_EQUAL( 1u, before.entries );
+   BOOST_CHECK_EQUAL( 1u, before.pinned_entries );
+   BOOST_CHECK_EQUAL( 2u, before.pending_entries );
+   BOOST_CHECK_EQUAL( 1u, before.pending_evictions );
+
+   push_action( N(asserter), N(provereset) );
+   push_action( N(globalreset), name(0ULL) );
+   push_action( N(noop), N(nothing) );
+   push_action( N(asserter), N(provereset) );
+
+   auto stats = control->get_wasm_interface().get_cache_stats();
+   BOOST_CHECK_EQUAL( before.misses + 3, stats.misses );
+   BOOST_CHECK_EQUAL( before.hits + 1, stats.hits );
+   BOOST_CHECK_EQUAL( before.evictions + 1, stats.evictions );
+   BOOST_CHECK_EQUAL( 3u, stats.entries );
+   BOOST_CHECK_EQUAL( 2u, stats.pinned_entries );
+   BOOST_CHECK( stats.bytes > before.bytes );
+
+   // the evicted contract is instantiated again, evicting the least recently used unpinned one in its place
+   push_action( N(globalreset), name(0ULL) );
+   stats = control->get_wasm_interface().get_cache_stats();
+   BOOST_CHECK_EQUAL( before.misses + 4, stats.misses );
+   BOOST_CHECK_EQUAL( before.evictions + 2, stats.evictions );
+   BOOST_CHECK_EQUAL( 3u, stats.entries );
+   produce_blocks(1);
+
+} FC_LOG_AND_RETHROW() /// instantiation_cache_eviction
+
 /**
  * Prove the modifications to global variables are wiped between runs
  */
@@ -1673,6 +1833,84 @@ BOOST_FIXTURE_TEST_CASE( protect_injected, TESTER ) try {
    produce_blocks(1);
 } FC_LOG_AND_RETHROW()
 
+/**
+ * Prove memory is restored between actions of a contract large enough to be reset from a memory snapshot
+ */
+BOOST_FIXTURE_TEST_CASE( memory_snapshot_reset, TESTER ) try {
+   produce_blocks(2);
+
+   create_accounts( {N(snapshot), N(asserter)} );
+   produce_block();
+
+   set_code(N(snapshot), memory_snapshot_reset_wast);
+   set_code(N(asserter), asserter_wast);
+   produce_blocks(1);
+
+   action act;
+   act.account = N(snapshot);
+   act.name = N();
+   act.authorization = vector<permission_level>{{N(snapshot),config::active_name}};
+
+   auto push_actions = [&]( vector<action> actions ) {
+      signed_transaction trx;
+      trx.actions = std::move(actions);
+      set_transaction_headers(trx);
+      trx.sign(get_private_key( trx.actions.front().account, "active" ), control->get_chain_id());
+      push_transaction(trx);
+   };
+
+   // each action dirties the memory the next one checks
+   push_actions( {act, act} );
+
+   // another contract resets the shared memory its own way in between
+   push_actions( {action( vector<permission_level>{{N(asserter),config::active_name}}, provereset{} )} );
+   push_actions( {act} );
+   produce_blocks(1);
+} FC_LOG_AND_RETHROW() /// memory_snapshot_reset
+
+/**
+ * Prove memory left by a snapshot-backed contract reads as zeros to contracts that reset it another way, whether
+ * they start below the snapshot's pages and grow over them or map a smaller snapshot of their own
+ */
+BOOST_FIXTURE_TEST_CASE( memory_snapshot_leaves_zeros, TESTER ) try {
+   produce_blocks(2);
+
+   create_accounts( {N(largemem), N(smallmem), N(mediummem)} );
+   produce_block();
+
+   set_code(N(largemem), memory_snapshot_large_wast);
+   set_code(N(smallmem), memory_snapshot_small_wast);
+   set_code(N(mediummem), memory_snapshot_medium_wast);
+   produce_blocks(1);
+
+   auto make_action = [&]( account_name account ) {
+      action act;
+      act.account = account;
+      act.name = N();
+      act.authorization = vector<permission_level>{{N(largemem),config::active_name}};
+      return act;
+   };
+   auto large = make_action( N(largemem) );
+   auto small = make_action( N(smallmem) );
+   auto medium = make_action( N(mediummem) );
+
+   auto push_actions = [&]( vector<action> actions ) {
+      signed_transaction trx;
+      trx.actions = std::move(actions);
+      set_transaction_headers(trx);
+      trx.sign(get_private_key( N(largemem), "active" ), control->get_chain_id());
+      push_transaction(trx);
+   };
+
+   // the copy path shrinks into and grows back over the snapshot's pages
+   push_actions( {large, small} );
+   push_actions( {large, large, small, small} );
+   // a smaller snapshot is mapped over part of the larger one's pages and grown past them
+   push_actions( {large, medium} );
+   push_actions( {large, medium, large, medium, small} );
+   produce_blocks(1);
+} FC_LOG_AND_RETHROW() /// memory_snapshot_leaves_zeros
+
 BOOST_FIXTURE_TEST_CASE( mem_growth_memset, TESTER ) try {
    produce_blocks(2);
 